@@ -2,6 +2,7 @@
 
 #include "color.h"
 #include "system.h"
+#include "tl/threading.h"
 
 #include <atomic>
 #include <cstdio>
@@ -211,18 +212,231 @@ std::unique_ptr<ILogger> log_logger_collection(std::vector<std::shared_ptr<ILogg
 	return std::make_unique<CLoggerCollection>(std::move(vpLoggers));
 }
 
+CLogMessageQueue::CLogMessageQueue() :
+	m_pHead(&m_Stub),
+	m_pTail(&m_Stub)
+{
+	AddChunk();
+}
+
+CLogMessageQueue::~CLogMessageQueue()
+{
+	for(int i = 0; i < m_NumChunks.load(std::memory_order_relaxed); i++)
+		delete[] m_apChunks[i];
+}
+
+bool CLogMessageQueue::AddChunk()
+{
+	std::unique_lock<std::mutex> Lock(m_ChunkMutex);
+	// another thread may have added a chunk in the meantime
+	if((uint32_t)m_FreeHead.load(std::memory_order_acquire) != 0)
+		return true;
+	const int Chunk = m_NumChunks.load(std::memory_order_relaxed);
+	if(Chunk == MAX_CHUNKS)
+		return false;
+	CNode *pNodes = new CNode[NODES_PER_CHUNK];
+	m_apChunks[Chunk] = pNodes;
+	m_NumChunks.store(Chunk + 1, std::memory_order_release);
+	for(int i = 0; i < NODES_PER_CHUNK; i++)
+	{
+		pNodes[i].m_Index = Chunk * NODES_PER_CHUNK + i;
+		FreeNode(&pNodes[i]);
+	}
+	return true;
+}
+
+CLogMessageQueue::CNode *CLogMessageQueue::AllocNode()
+{
+	while(true)
+	{
+		uint64_t Head = m_FreeHead.load(std::memory_order_acquire);
+		while((uint32_t)Head != 0)
+		{
+			CNode *pNode = NodeAt((uint32_t)Head - 1);
+			const uint64_t Next = pNode->m_NextFree.load(std::memory_order_relaxed);
+			if(m_FreeHead.compare_exchange_weak(Head, (((Head >> 32) + 1) << 32) | Next, std::memory_order_acq_rel, std::memory_order_acquire))
+				return pNode;
+		}
+		if(!AddChunk())
+			return nullptr;
+	}
+}
+
+void CLogMessageQueue::FreeNode(CNode *pNode)
+{
+	uint64_t Head = m_FreeHead.load(std::memory_order_relaxed);
+	do
+	{
+		pNode->m_NextFree.store((uint32_t)Head, std::memory_order_relaxed);
+	} while(!m_FreeHead.compare_exchange_weak(Head, (((Head >> 32) + 1) << 32) | (pNode->m_Index + 1), std::memory_order_release, std::memory_order_relaxed));
+}
+
+void CLogMessageQueue::PushNode(CNode *pNode)
+{
+	pNode->m_pNext.store(nullptr, std::memory_order_relaxed);
+	CNode *pPrev = m_pHead.exchange(pNode, std::memory_order_acq_rel);
+	pPrev->m_pNext.store(pNode, std::memory_order_release);
+}
+
+bool CLogMessageQueue::Push(const CLogMessage *pMessage)
+{
+	CNode *pNode = AllocNode();
+	if(!pNode)
+		return false;
+	pNode->m_Message = *pMessage;
+	PushNode(pNode);
+	return true;
+}
+
+bool CLogMessageQueue::Pop(CLogMessage *pMessage)
+{
+	CNode *pTail = m_pTail;
+	CNode *pNext = pTail->m_pNext.load(std::memory_order_acquire);
+	if(pTail == &m_Stub)
+	{
+		if(!pNext)
+			return false;
+		m_pTail = pNext;
+		pTail = pNext;
+		pNext = pNext->m_pNext.load(std::memory_order_acquire);
+	}
+	if(!pNext)
+	{
+		// the tail is the last node, put the stub behind it so it can be
+		// removed without racing with the producers
+		if(pTail != m_pHead.load(std::memory_order_acquire))
+			return false;
+		PushNode(&m_Stub);
+		pNext = pTail->m_pNext.load(std::memory_order_acquire);
+		if(!pNext)
+			return false;
+	}
+	m_pTail = pNext;
+	*pMessage = pTail->m_Message;
+	FreeNode(pTail);
+	return true;
+}
+
+// Log messages are queued without taking a lock and written in batches by a
+// separate thread, so logging never waits for the output.
 class CLoggerAsync : public ILogger
 {
-	ASYNCIO *m_pAio;
+	enum
+	{
+		BATCH_SIZE = 64 * 1024,
+	};
+
+	IOHANDLE m_File;
 	bool m_AnsiTruecolor;
 	bool m_Close;
 
+	CLogMessageQueue m_Queue;
+	CSemaphore m_Wakeup;
+	std::atomic_bool m_WakeupPending{false};
+	std::atomic_bool m_Stopping{false};
+	// threads that are between checking m_Stopping and queueing a message
+	std::atomic_int m_NumPushing{0};
+	bool m_Stopped = false;
+	void *m_pThread;
+
+	char m_aBatch[BATCH_SIZE];
+	int m_BatchSize = 0;
+
+	void Write(const void *pData, int Size)
+	{
+		if(m_BatchSize + Size > (int)sizeof(m_aBatch))
+			FlushBatch();
+		if(Size > (int)sizeof(m_aBatch))
+		{
+			io_write(m_File, pData, Size);
+			return;
+		}
+		mem_copy(m_aBatch + m_BatchSize, pData, Size);
+		m_BatchSize += Size;
+	}
+
+	void FlushBatch()
+	{
+		if(m_BatchSize == 0)
+			return;
+		io_write(m_File, m_aBatch, m_BatchSize);
+		m_BatchSize = 0;
+	}
+
+	void WriteMessage(const CLogMessage *pMessage)
+	{
+		if(m_AnsiTruecolor && pMessage->m_HaveColor)
+		{
+			// https://en.wikipedia.org/w/index.php?title=ANSI_escape_code&oldid=1077146479#24-bit
+			char aAnsi[32];
+			str_format(aAnsi, sizeof(aAnsi),
+				"\x1b[38;2;%d;%d;%dm",
+				pMessage->m_Color.r,
+				pMessage->m_Color.g,
+				pMessage->m_Color.b);
+			Write(aAnsi, str_length(aAnsi));
+		}
+		Write(pMessage->m_aLine, pMessage->m_LineLength);
+		if(m_AnsiTruecolor && pMessage->m_HaveColor)
+		{
+			const char aResetColor[] = "\x1b[0m";
+			Write(aResetColor, str_length(aResetColor)); // reset
+		}
+#if defined(CONF_FAMILY_WINDOWS)
+		Write("\r\n", 2);
+#else
+		Write("\n", 1);
+#endif
+	}
+
+	void Drain()
+	{
+		CLogMessage Message;
+		while(m_Queue.Pop(&Message))
+			WriteMessage(&Message);
+		FlushBatch();
+		io_flush(m_File);
+	}
+
+	static void DrainThread(void *pUser)
+	{
+		CLoggerAsync *pThis = (CLoggerAsync *)pUser;
+		while(true)
+		{
+			pThis->m_Wakeup.Wait();
+			// reset before draining, messages pushed from now on signal again
+			pThis->m_WakeupPending.store(false, std::memory_order_seq_cst);
+			const bool Stopping = pThis->m_Stopping.load(std::memory_order_acquire);
+			pThis->Drain();
+			if(Stopping)
+				break;
+		}
+	}
+
+	void Stop()
+	{
+		if(m_Stopped)
+			return;
+		m_Stopped = true;
+		m_Stopping.store(true, std::memory_order_seq_cst);
+		while(m_NumPushing.load(std::memory_order_seq_cst))
+			thread_yield();
+		m_Wakeup.Signal();
+		thread_wait(m_pThread);
+		// the drain thread stops at messages that are still being linked,
+		// everything is linked now and this is the only consumer left
+		Drain();
+		if(m_Close)
+			io_close(m_File);
+	}
+
 public:
 	CLoggerAsync(IOHANDLE File, bool AnsiTruecolor, bool Close) :
-		m_pAio(aio_new(File)),
+		m_File(File),
 		m_AnsiTruecolor(AnsiTruecolor),
 		m_Close(Close)
 	{
+		m_pThread = thread_init(DrainThread, this, "logger");
 	}
 	void Log(const CLogMessage *pMessage) override
 	{
@@ -230,46 +444,24 @@ public:
 		{
 			return;
 		}
-		aio_lock(m_pAio);
-		if(m_AnsiTruecolor)
+		m_NumPushing.fetch_add(1, std::memory_order_seq_cst);
+		if(!m_Stopping.load(std::memory_order_seq_cst))
 		{
-			// https://en.wikipedia.org/w/index.php?title=ANSI_escape_code&oldid=1077146479#24-bit
-			char aAnsi[32];
-			if(pMessage->m_HaveColor)
+			m_Queue.Push(pMessage);
+			if(!m_WakeupPending.exchange(true, std::memory_order_seq_cst))
 			{
-				str_format(aAnsi, sizeof(aAnsi),
-					"\x1b[38;2;%d;%d;%dm",
-					pMessage->m_Color.r,
-					pMessage->m_Color.g,
-					pMessage->m_Color.b);
-				aio_write_unlocked(m_pAio, aAnsi, str_length(aAnsi));
+				m_Wakeup.Signal();
 			}
 		}
-		aio_write_unlocked(m_pAio, pMessage->m_aLine, pMessage->m_LineLength);
-		if(m_AnsiTruecolor && pMessage->m_HaveColor)
-		{
-			const char aResetColor[] = "\x1b[0m";
-			aio_write_unlocked(m_pAio, aResetColor, str_length(aResetColor)); // reset
-		}
-		aio_write_newline_unlocked(m_pAio);
-		aio_unlock(m_pAio);
+		m_NumPushing.fetch_sub(1, std::memory_order_seq_cst);
 	}
 	~CLoggerAsync()
 	{
-		if(m_Close)
-		{
-			aio_close(m_pAio);
-		}
-		aio_wait(m_pAio);
-		aio_free(m_pAio);
+		Stop();
 	}
 	void GlobalFinish() override
 	{
-		if(m_Close)
-		{
-			aio_close(m_pAio);
-		}
-		aio_wait(m_pAio);
+		Stop();
 	}
 };
 
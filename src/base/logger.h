@@ -62,6 +62,75 @@ public:
 	bool Filters(const CLogMessage *pMessage);
 };
 
+/**
+ * @ingroup Log
+ *
+ * Lock-free queue of log messages with any number of producers and a single
+ * consumer.
+ *
+ * `Push` copies the message into a node and links it with a single atomic
+ * exchange. The nodes are allocated in chunks and reused through a free
+ * list, so pushing only allocates when more messages are queued than ever
+ * before. Messages beyond `MAX_CHUNKS * NODES_PER_CHUNK` queued ones are
+ * dropped. Only one thread at a time may call `Pop`.
+ */
+class CLogMessageQueue
+{
+	class CNode
+	{
+	public:
+		std::atomic<CNode *> m_pNext{nullptr};
+		// index + 1 of the next free node, 0 ends the free list
+		std::atomic<uint32_t> m_NextFree{0};
+		uint32_t m_Index = 0;
+		CLogMessage m_Message;
+	};
+
+	enum
+	{
+		NODES_PER_CHUNK = 16,
+		MAX_CHUNKS = 4096,
+	};
+
+	std::atomic<CNode *> m_pHead;
+	CNode *m_pTail;
+	CNode m_Stub;
+
+	// the lower 32 bits are the index + 1 of the first free node, the upper
+	// ones a tag that changes with every update against the ABA problem
+	std::atomic<uint64_t> m_FreeHead{0};
+	CNode *m_apChunks[MAX_CHUNKS];
+	std::atomic<int> m_NumChunks{0};
+	std::mutex m_ChunkMutex;
+
+	CNode *NodeAt(uint32_t Index) { return &m_apChunks[Index / NODES_PER_CHUNK][Index % NODES_PER_CHUNK]; }
+	bool AddChunk();
+	CNode *AllocNode();
+	void FreeNode(CNode *pNode);
+	void PushNode(CNode *pNode);
+
+public:
+	CLogMessageQueue();
+	~CLogMessageQueue();
+	CLogMessageQueue(const CLogMessageQueue &) = delete;
+
+	/**
+	 * Adds a copy of the message to the queue.
+	 *
+	 * @return `false` if the message was dropped because the queue is full.
+	 */
+	bool Push(const CLogMessage *pMessage);
+	/**
+	 * Removes the oldest message from the queue.
+	 *
+	 * @param pMessage Receives the message.
+	 *
+	 * @return `true` if a message was removed. `false` if the queue is empty
+	 * or the next message is still being pushed by another thread.
+	 */
+	bool Pop(CLogMessage *pMessage);
+};
+
 class ILogger
 {
 protected:
@@ -2323,15 +2323,16 @@ void fs_listdir_fileinfo(const char *dir, FS_LISTDIR_CALLBACK_FILEINFO cb, int t
 		info.m_pName = current_entry.c_str();
 		info.m_TimeCreated = filetime_to_unixtime(&finddata.ftCreationTime);
 		info.m_TimeModified = filetime_to_unixtime(&finddata.ftLastWriteTime);
+		const bool is_dir = (finddata.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+		info.m_Size = is_dir ? 0 : ((int64_t)finddata.nFileSizeHigh << 32) | finddata.nFileSizeLow;
 
-		if(cb(&info, (finddata.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0, type, user))
+		if(cb(&info, is_dir, type, user))
 			break;
 	} while(FindNextFileW(handle, &finddata));
 
 	FindClose(handle);
 #else
 	struct dirent *entry;
-	time_t created = -1, modified = -1;
 	char buffer[IO_MAX_PATH_LENGTH];
 	int length;
 	DIR *d = opendir(dir);
@@ -2347,13 +2348,17 @@ void fs_listdir_fileinfo(const char *dir, FS_LISTDIR_CALLBACK_FILEINFO cb, int t
 		CFsFileInfo info;
 
 		str_copy(buffer + length, entry->d_name, (int)sizeof(buffer) - length);
-		fs_file_time(buffer, &created, &modified);
+		// one stat for the times, the size and the type
+		struct stat sb;
+		const bool stat_ok = stat(buffer, &sb) == 0;
+		const bool is_dir = stat_ok && S_ISDIR(sb.st_mode);
 
 		info.m_pName = entry->d_name;
-		info.m_TimeCreated = created;
-		info.m_TimeModified = modified;
+		info.m_TimeCreated = stat_ok ? sb.st_ctime : -1;
+		info.m_TimeModified = stat_ok ? sb.st_mtime : -1;
+		info.m_Size = stat_ok && !is_dir ? (int64_t)sb.st_size : 0;
 
-		if(cb(&info, fs_is_dir(buffer), type, user))
+		if(cb(&info, is_dir, type, user))
 			break;
 	}
 
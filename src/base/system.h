@@ -1901,6 +1901,7 @@ typedef struct
 	const char *m_pName;
 	time_t m_TimeCreated; // seconds since UNIX Epoch
 	time_t m_TimeModified; // seconds since UNIX Epoch
+	int64_t m_Size; // in bytes, 0 for directories
 } CFsFileInfo;
 
 /**
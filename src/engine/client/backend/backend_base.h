@@ -94,6 +94,8 @@ public:
 	virtual ~CCommandProcessorFragment_GLBase() = default;
 	virtual ERunCommandReturnTypes RunCommand(const CCommandBuffer::SCommand *pBaseCommand) = 0;
 
+	// called with the whole buffer before its commands are run
+	virtual void PrepareCommands(CCommandBuffer *pBuffer) {}
 	virtual void StartCommands(size_t CommandCount, size_t EstimatedRenderCallCount) {}
 	virtual void EndCommands() {}
 
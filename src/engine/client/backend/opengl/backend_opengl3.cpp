@@ -37,6 +37,225 @@ int CCommandProcessorFragment_OpenGL3_3::TexFormatToNewOpenGLFormat(int TexForma
 	return GL_RGBA;
 }
 
+static int VerticesPerPrimitive(unsigned PrimType)
+{
+	switch(PrimType)
+	{
+	case CCommandBuffer::PRIMTYPE_LINES: return 2;
+	case CCommandBuffer::PRIMTYPE_TRIANGLES: return 3;
+	case CCommandBuffer::PRIMTYPE_QUADS: return 4;
+	default: return 0;
+	}
+}
+
+static bool CanMergeRenders(const CCommandBuffer::SCommand_Render &First, const CCommandBuffer::SCommand_Render &Other)
+{
+	return First.m_PrimType == Other.m_PrimType && First.m_State == Other.m_State;
+}
+
+CCommandProcessorFragment_OpenGL3_3::~CCommandProcessorFragment_OpenGL3_3()
+{
+	StopPrepareThreads();
+}
+
+void CCommandProcessorFragment_OpenGL3_3::StartPrepareThreads()
+{
+#ifndef CONF_WEBASM
+	// the thread that runs the commands counts as one of the render threads
+	const int NumThreads = minimum<int>(g_Config.m_GfxRenderThreadCount - 1, (int)std::thread::hardware_concurrency() - 1);
+	m_StopPreparing = false;
+	for(int i = 0; i < NumThreads; i++)
+		m_vPrepareThreads.emplace_back([this]() { RunPrepareThread(); });
+#endif
+}
+
+void CCommandProcessorFragment_OpenGL3_3::StopPrepareThreads()
+{
+	FinishPreparing();
+	{
+		std::unique_lock<std::mutex> Lock(m_PrepareMutex);
+		m_StopPreparing = true;
+		m_PrepareCond.notify_all();
+	}
+	for(auto &Thread : m_vPrepareThreads)
+		Thread.join();
+	m_vPrepareThreads.clear();
+}
+
+void CCommandProcessorFragment_OpenGL3_3::RunPrepareThread()
+{
+	while(true)
+	{
+		size_t Chunk;
+		{
+			std::unique_lock<std::mutex> Lock(m_PrepareMutex);
+			m_PrepareCond.wait(Lock, [this]() { return m_StopPreparing || m_NextChunkToPrepare < m_NumPreparedChunks; });
+			if(m_StopPreparing)
+				return;
+			Chunk = m_NextChunkToPrepare++;
+		}
+		TryPrepareChunk(Chunk);
+	}
+}
+
+void CCommandProcessorFragment_OpenGL3_3::TryPrepareChunk(size_t Chunk)
+{
+	SPreparedChunk &PreparedChunk = *m_vpPreparedChunks[Chunk];
+	int Expected = CHUNK_PENDING;
+	if(!PreparedChunk.m_State.compare_exchange_strong(Expected, CHUNK_PREPARING, std::memory_order_acquire))
+		return;
+
+	const size_t FirstCommandIndex = Chunk * PREPARE_CHUNK_SIZE;
+	PrepareChunk(PreparedChunk, FirstCommandIndex, minimum(FirstCommandIndex + PREPARE_CHUNK_SIZE, m_NumPreparedCommands));
+
+	std::unique_lock<std::mutex> Lock(m_PrepareMutex);
+	PreparedChunk.m_State.store(CHUNK_READY, std::memory_order_release);
+	m_PrepareCond.notify_all();
+}
+
+void CCommandProcessorFragment_OpenGL3_3::PrepareChunk(SPreparedChunk &Chunk, size_t FirstCommandIndex, size_t EndCommandIndex)
+{
+	Chunk.m_vMergedRenders.clear();
+	Chunk.m_vVertices.clear();
+
+	const CCommandBuffer::SCommand *pCommand = Chunk.m_pFirstCommand;
+	size_t Index = FirstCommandIndex;
+	while(Index < EndCommandIndex)
+	{
+		if(pCommand->m_Cmd != CCommandBuffer::CMD_RENDER)
+		{
+			pCommand = pCommand->m_pNext;
+			Index++;
+			continue;
+		}
+
+		const CCommandBuffer::SCommand_Render *pFirst = static_cast<const CCommandBuffer::SCommand_Render *>(pCommand);
+		const int VertsPerPrim = VerticesPerPrimitive(pFirst->m_PrimType);
+		SMergedRender Merged = {Index, 1, pFirst->m_PrimCount, pFirst->m_pVertices, 0};
+		size_t NumVertices = (size_t)pFirst->m_PrimCount * VertsPerPrim;
+		bool Copied = false;
+
+		pCommand = pCommand->m_pNext;
+		Index++;
+		// the quad index buffer holds indices for at least MAX_VERTICES vertices
+		while(VertsPerPrim > 0 && Index < EndCommandIndex && pCommand->m_Cmd == CCommandBuffer::CMD_RENDER)
+		{
+			const CCommandBuffer::SCommand_Render *pRender = static_cast<const CCommandBuffer::SCommand_Render *>(pCommand);
+			const size_t NumRenderVertices = (size_t)pRender->m_PrimCount * VertsPerPrim;
+			if(!CanMergeRenders(*pFirst, *pRender) || NumVertices + NumRenderVertices > CCommandBuffer::MAX_VERTICES)
+				break;
+
+			// the vertices of consecutive commands are usually allocated one after another
+			if(Copied || Merged.m_pVertices + NumVertices != pRender->m_pVertices)
+			{
+				if(!Copied)
+				{
+					Merged.m_VertexOffset = Chunk.m_vVertices.size();
+					Chunk.m_vVertices.insert(Chunk.m_vVertices.end(), Merged.m_pVertices, Merged.m_pVertices + NumVertices);
+					Copied = true;
+				}
+				Chunk.m_vVertices.insert(Chunk.m_vVertices.end(), pRender->m_pVertices, pRender->m_pVertices + NumRenderVertices);
+			}
+
+			NumVertices += NumRenderVertices;
+			Merged.m_PrimCount += pRender->m_PrimCount;
+			Merged.m_NumCommands++;
+			pCommand = pCommand->m_pNext;
+			Index++;
+		}
+
+		if(Merged.m_NumCommands > 1)
+		{
+			if(Copied)
+				Merged.m_pVertices = nullptr;
+			Chunk.m_vMergedRenders.push_back(Merged);
+		}
+	}
+}
+
+void CCommandProcessorFragment_OpenGL3_3::FinishPreparing()
+{
+	std::unique_lock<std::mutex> Lock(m_PrepareMutex);
+	m_NextChunkToPrepare = m_NumPreparedChunks;
+	for(size_t i = 0; i < m_NumPreparedChunks; i++)
+	{
+		SPreparedChunk &Chunk = *m_vpPreparedChunks[i];
+		int Expected = CHUNK_PENDING;
+		if(!Chunk.m_State.compare_exchange_strong(Expected, CHUNK_READY))
+			m_PrepareCond.wait(Lock, [&Chunk]() { return Chunk.m_State.load(std::memory_order_acquire) == CHUNK_READY; });
+	}
+	m_NumPreparedChunks = 0;
+	m_NumPreparedCommands = 0;
+}
+
+void CCommandProcessorFragment_OpenGL3_3::PrepareCommands(CCommandBuffer *pBuffer)
+{
+	// in case the last buffer ended with an error
+	FinishPreparing();
+
+	m_CurCommand = 0;
+	m_CurChunk = (size_t)-1;
+	m_NextMergedRender = 0;
+	m_SkipRenderCommands = 0;
+
+	std::unique_lock<std::mutex> Lock(m_PrepareMutex);
+	size_t NumChunks = 0;
+	size_t Index = 0;
+	for(const CCommandBuffer::SCommand *pCommand = pBuffer->Head(); pCommand; pCommand = pCommand->m_pNext, Index++)
+	{
+		if(Index % PREPARE_CHUNK_SIZE != 0)
+			continue;
+		if(NumChunks == m_vpPreparedChunks.size())
+			m_vpPreparedChunks.push_back(std::make_unique<SPreparedChunk>());
+		SPreparedChunk &Chunk = *m_vpPreparedChunks[NumChunks++];
+		Chunk.m_pFirstCommand = pCommand;
+		Chunk.m_State.store(CHUNK_PENDING, std::memory_order_relaxed);
+	}
+	m_NumPreparedCommands = Index;
+	m_NumPreparedChunks = NumChunks;
+	m_NextChunkToPrepare = 0;
+	m_PrepareCond.notify_all();
+}
+
+void CCommandProcessorFragment_OpenGL3_3::EndCommands()
+{
+	FinishPreparing();
+}
+
+ERunCommandReturnTypes CCommandProcessorFragment_OpenGL3_3::RunCommand(const CCommandBuffer::SCommand *pBaseCommand)
+{
+	const ERunCommandReturnTypes Result = CCommandProcessorFragment_OpenGL3::RunCommand(pBaseCommand);
+	m_CurCommand++;
+	return Result;
+}
+
+const CCommandProcessorFragment_OpenGL3_3::SMergedRender *CCommandProcessorFragment_OpenGL3_3::FindMergedRender()
+{
+	const size_t Chunk = m_CurCommand / PREPARE_CHUNK_SIZE;
+	if(Chunk >= m_NumPreparedChunks)
+		return nullptr;
+
+	if(Chunk != m_CurChunk)
+	{
+		TryPrepareChunk(Chunk);
+		SPreparedChunk &PreparedChunk = *m_vpPreparedChunks[Chunk];
+		if(PreparedChunk.m_State.load(std::memory_order_acquire) != CHUNK_READY)
+		{
+			std::unique_lock<std::mutex> Lock(m_PrepareMutex);
+			m_PrepareCond.wait(Lock, [&PreparedChunk]() { return PreparedChunk.m_State.load(std::memory_order_acquire) == CHUNK_READY; });
+		}
+		m_CurChunk = Chunk;
+		m_NextMergedRender = 0;
+	}
+
+	const std::vector<SMergedRender> &vMergedRenders = m_vpPreparedChunks[Chunk]->m_vMergedRenders;
+	while(m_NextMergedRender < vMergedRenders.size() && vMergedRenders[m_NextMergedRender].m_CommandIndex < m_CurCommand)
+		m_NextMergedRender++;
+	if(m_NextMergedRender < vMergedRenders.size() && vMergedRenders[m_NextMergedRender].m_CommandIndex == m_CurCommand)
+		return &vMergedRenders[m_NextMergedRender++];
+	return nullptr;
+}
+
 void CCommandProcessorFragment_OpenGL3_3::UseProgram(CGLSLTWProgram *pProgram)
 {
 	if(m_LastProgramID != pProgram->GetProgramID())
@@ -474,11 +693,15 @@ bool CCommandProcessorFragment_OpenGL3_3::Cmd_Init(const SCommand_Init *pCommand
 	// fix the alignment to allow even 1byte changes, e.g. for alpha components
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
+	StartPrepareThreads();
+
 	return true;
 }
 
 void CCommandProcessorFragment_OpenGL3_3::Cmd_Shutdown(const SCommand_Shutdown *pCommand)
 {
+	StopPrepareThreads();
+
 	glUseProgram(0);
 
 	m_pPrimitiveProgram->DeleteProgram();
@@ -800,26 +1023,26 @@ void CCommandProcessorFragment_OpenGL3_3::UploadStreamBufferData(unsigned int Pr
 	glBufferData(GL_ARRAY_BUFFER, VertSize * Count, pVertices, GL_STREAM_DRAW);
 }
 
-void CCommandProcessorFragment_OpenGL3_3::Cmd_Render(const CCommandBuffer::SCommand_Render *pCommand)
+void CCommandProcessorFragment_OpenGL3_3::RenderVertices(const CCommandBuffer::SState &State, unsigned PrimType, const CCommandBuffer::SVertex *pVertices, unsigned PrimCount)
 {
 	CGLSLTWProgram *pProgram = m_pPrimitiveProgram;
-	if(IsTexturedState(pCommand->m_State))
+	if(IsTexturedState(State))
 		pProgram = m_pPrimitiveProgramTextured;
 	UseProgram(pProgram);
-	SetState(pCommand->m_State, pProgram);
+	SetState(State, pProgram);
 
-	UploadStreamBufferData(pCommand->m_PrimType, pCommand->m_pVertices, sizeof(CCommandBuffer::SVertex), pCommand->m_PrimCount);
+	UploadStreamBufferData(PrimType, pVertices, sizeof(CCommandBuffer::SVertex), PrimCount);
 
 	glBindVertexArray(m_aPrimitiveDrawVertexID[m_LastStreamBuffer]);
 
-	switch(pCommand->m_PrimType)
+	switch(PrimType)
 	{
 	// We don't support GL_QUADS due to core profile
 	case CCommandBuffer::PRIMTYPE_LINES:
-		glDrawArrays(GL_LINES, 0, pCommand->m_PrimCount * 2);
+		glDrawArrays(GL_LINES, 0, PrimCount * 2);
 		break;
 	case CCommandBuffer::PRIMTYPE_TRIANGLES:
-		glDrawArrays(GL_TRIANGLES, 0, pCommand->m_PrimCount * 3);
+		glDrawArrays(GL_TRIANGLES, 0, PrimCount * 3);
 		break;
 	case CCommandBuffer::PRIMTYPE_QUADS:
 		if(m_aLastIndexBufferBound[m_LastStreamBuffer] != m_QuadDrawIndexBufferID)
@@ -827,15 +1050,38 @@ void CCommandProcessorFragment_OpenGL3_3::Cmd_Render(const CCommandBuffer::SComm
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_QuadDrawIndexBufferID);
 			m_aLastIndexBufferBound[m_LastStreamBuffer] = m_QuadDrawIndexBufferID;
 		}
-		glDrawElements(GL_TRIANGLES, pCommand->m_PrimCount * 6, GL_UNSIGNED_INT, 0);
+		glDrawElements(GL_TRIANGLES, PrimCount * 6, GL_UNSIGNED_INT, 0);
 		break;
 	default:
-		dbg_msg("render", "unknown primtype %d\n", pCommand->m_PrimType);
+		dbg_msg("render", "unknown primtype %d\n", PrimType);
 	};
 
 	m_LastStreamBuffer = (m_LastStreamBuffer + 1 >= MAX_STREAM_BUFFER_COUNT ? 0 : m_LastStreamBuffer + 1);
 }
 
+void CCommandProcessorFragment_OpenGL3_3::Cmd_Render(const CCommandBuffer::SCommand_Render *pCommand)
+{
+	// already drawn as part of a merged render
+	if(m_SkipRenderCommands > 0)
+	{
+		m_SkipRenderCommands--;
+		return;
+	}
+
+	const SMergedRender *pMerged = FindMergedRender();
+	if(pMerged)
+	{
+		const SPreparedChunk &Chunk = *m_vpPreparedChunks[m_CurChunk];
+		const CCommandBuffer::SVertex *pVertices = pMerged->m_pVertices ? pMerged->m_pVertices : Chunk.m_vVertices.data() + pMerged->m_VertexOffset;
+		RenderVertices(pCommand->m_State, pCommand->m_PrimType, pVertices, pMerged->m_PrimCount);
+		m_SkipRenderCommands = pMerged->m_NumCommands - 1;
+	}
+	else
+	{
+		RenderVertices(pCommand->m_State, pCommand->m_PrimType, pCommand->m_pVertices, pCommand->m_PrimCount);
+	}
+}
+
 void CCommandProcessorFragment_OpenGL3_3::Cmd_RenderTex3D(const CCommandBuffer::SCommand_RenderTex3D *pCommand)
 {
 	CGLSLPrimitiveProgram *pProg = m_pPrimitive3DProgram;
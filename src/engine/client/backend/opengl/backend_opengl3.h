@@ -12,6 +12,13 @@
 
 #include "backend_opengl.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 class CGLSLPrimitiveExProgram;
 class CGLSLQuadProgram;
 class CGLSLSpriteMultipleProgram;
@@ -73,6 +80,64 @@ protected:
 
 	CCommandBuffer::SColorf m_ClearColor;
 
+	// Consecutive render commands with the same state are merged into one
+	// draw call. Helper threads search the command buffer for them in chunks
+	// of PREPARE_CHUNK_SIZE commands, while this thread issues the GL calls.
+	// A chunk that no helper took yet is prepared here when it is reached.
+	enum
+	{
+		PREPARE_CHUNK_SIZE = 256,
+	};
+
+	enum
+	{
+		CHUNK_PENDING = 0,
+		CHUNK_PREPARING,
+		CHUNK_READY,
+	};
+
+	struct SMergedRender
+	{
+		size_t m_CommandIndex;
+		size_t m_NumCommands;
+		unsigned m_PrimCount;
+		// nullptr if the vertices were copied to the chunk
+		const CCommandBuffer::SVertex *m_pVertices;
+		size_t m_VertexOffset;
+	};
+
+	struct SPreparedChunk
+	{
+		std::atomic<int> m_State{CHUNK_READY};
+		const CCommandBuffer::SCommand *m_pFirstCommand = nullptr;
+		std::vector<SMergedRender> m_vMergedRenders;
+		std::vector<CCommandBuffer::SVertex> m_vVertices;
+	};
+
+	std::vector<std::unique_ptr<SPreparedChunk>> m_vpPreparedChunks;
+	size_t m_NumPreparedChunks = 0;
+	size_t m_NumPreparedCommands = 0;
+	size_t m_NextChunkToPrepare = 0;
+	std::vector<std::thread> m_vPrepareThreads;
+	std::mutex m_PrepareMutex;
+	std::condition_variable m_PrepareCond;
+	bool m_StopPreparing = false;
+
+	// state of this thread while it runs the commands
+	size_t m_CurCommand = 0;
+	size_t m_CurChunk = 0;
+	size_t m_NextMergedRender = 0;
+	size_t m_SkipRenderCommands = 0;
+
+	void StartPrepareThreads();
+	void StopPrepareThreads();
+	void RunPrepareThread();
+	void TryPrepareChunk(size_t Chunk);
+	void PrepareChunk(SPreparedChunk &Chunk, size_t FirstCommandIndex, size_t EndCommandIndex);
+	void FinishPreparing();
+	const SMergedRender *FindMergedRender();
+	void RenderVertices(const CCommandBuffer::SState &State, unsigned PrimType, const CCommandBuffer::SVertex *pVertices, unsigned PrimCount);
+
 	void InitPrimExProgram(CGLSLPrimitiveExProgram *pProgram, class CGLSLCompiler *pCompiler, class IStorage *pStorage, bool Textured, bool Rotationless);
 
 	static int TexFormatToNewOpenGLFormat(int TexFormat);
@@ -119,6 +184,11 @@ protected:
 
 public:
 	CCommandProcessorFragment_OpenGL3_3() = default;
+	~CCommandProcessorFragment_OpenGL3_3() override;
+
+	ERunCommandReturnTypes RunCommand(const CCommandBuffer::SCommand *pBaseCommand) override;
+	void PrepareCommands(CCommandBuffer *pBuffer) override;
+	void EndCommands() override;
 };
 
 #endif
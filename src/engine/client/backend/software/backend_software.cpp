@@ -0,0 +1,213 @@
+#include "backend_software.h"
+
+#include <base/math.h>
+
+#include <engine/client/backend_sdl.h>
+#include <engine/shared/config.h>
+
+#include <thread>
+
+void CCommandProcessorFragment_Software::TextureCreate(int Slot, int Width, int Height, int PixelSize, int Flags, void *pData)
+{
+	if(!(Flags & CCommandBuffer::TEXFLAG_NO_2D_TEXTURE))
+	{
+		m_Rasterizer.CreateTexture(Slot, Width, Height, PixelSize, (const uint8_t *)pData);
+
+		if((size_t)Slot >= m_vTextureMemory.size())
+			m_vTextureMemory.resize(Slot + 1, 0);
+		m_vTextureMemory[Slot] = (size_t)Width * Height * PixelSize;
+		m_pTextureMemoryUsage->store(m_pTextureMemoryUsage->load(std::memory_order_relaxed) + m_vTextureMemory[Slot], std::memory_order_relaxed);
+	}
+	free(pData);
+}
+
+void CCommandProcessorFragment_Software::TextureDestroy(int Slot)
+{
+	m_Rasterizer.DestroyTexture(Slot);
+	if((size_t)Slot < m_vTextureMemory.size())
+	{
+		m_pTextureMemoryUsage->store(m_pTextureMemoryUsage->load(std::memory_order_relaxed) - m_vTextureMemory[Slot], std::memory_order_relaxed);
+		m_vTextureMemory[Slot] = 0;
+	}
+}
+
+bool CCommandProcessorFragment_Software::GetPresentedImageData(uint32_t &Width, uint32_t &Height, CImageInfo::EImageFormat &Format, std::vector<uint8_t> &vDstData)
+{
+	if(m_Rasterizer.Width() == 0 || m_Rasterizer.Height() == 0)
+		return false;
+
+	Width = m_Rasterizer.Width();
+	Height = m_Rasterizer.Height();
+	Format = CImageInfo::FORMAT_RGBA;
+	vDstData.resize((size_t)Width * Height * 4);
+	mem_copy(vDstData.data(), m_Rasterizer.FrontBuffer(), vDstData.size());
+	return true;
+}
+
+ERunCommandReturnTypes CCommandProcessorFragment_Software::RunCommand(const CCommandBuffer::SCommand *pBaseCommand)
+{
+	switch(pBaseCommand->m_Cmd)
+	{
+	case CCommandProcessorFragment_Software::CMD_INIT:
+		Cmd_Init(static_cast<const SCommand_Init *>(pBaseCommand));
+		break;
+	case CCommandProcessorFragment_Software::CMD_SHUTDOWN:
+		Cmd_Shutdown(static_cast<const SCommand_Shutdown *>(pBaseCommand));
+		break;
+	case CCommandBuffer::CMD_TEXTURE_CREATE:
+		Cmd_Texture_Create(static_cast<const CCommandBuffer::SCommand_Texture_Create *>(pBaseCommand));
+		break;
+	case CCommandBuffer::CMD_TEXTURE_UPDATE:
+		Cmd_Texture_Update(static_cast<const CCommandBuffer::SCommand_Texture_Update *>(pBaseCommand));
+		break;
+	case CCommandBuffer::CMD_TEXTURE_DESTROY:
+		Cmd_Texture_Destroy(static_cast<const CCommandBuffer::SCommand_Texture_Destroy *>(pBaseCommand));
+		break;
+	case CCommandBuffer::CMD_TEXT_TEXTURES_CREATE:
+		Cmd_TextTextures_Create(static_cast<const CCommandBuffer::SCommand_TextTextures_Create *>(pBaseCommand));
+		break;
+	case CCommandBuffer::CMD_TEXT_TEXTURE_UPDATE:
+		Cmd_TextTexture_Update(static_cast<const CCommandBuffer::SCommand_TextTexture_Update *>(pBaseCommand));
+		break;
+	case CCommandBuffer::CMD_TEXT_TEXTURES_DESTROY:
+		Cmd_TextTextures_Destroy(static_cast<const CCommandBuffer::SCommand_TextTextures_Destroy *>(pBaseCommand));
+		break;
+	case CCommandBuffer::CMD_CLEAR:
+		Cmd_Clear(static_cast<const CCommandBuffer::SCommand_Clear *>(pBaseCommand));
+		break;
+	case CCommandBuffer::CMD_RENDER:
+		Cmd_Render(static_cast<const CCommandBuffer::SCommand_Render *>(pBaseCommand));
+		break;
+	case CCommandBuffer::CMD_SWAP:
+		Cmd_Swap(static_cast<const CCommandBuffer::SCommand_Swap *>(pBaseCommand));
+		break;
+	case CCommandBuffer::CMD_TRY_SWAP_AND_SCREENSHOT:
+		Cmd_Screenshot(static_cast<const CCommandBuffer::SCommand_TrySwapAndScreenshot *>(pBaseCommand));
+		break;
+	case CCommandBuffer::CMD_UPDATE_VIEWPORT:
+		Cmd_Update_Viewport(static_cast<const CCommandBuffer::SCommand_Update_Viewport *>(pBaseCommand));
+		break;
+	}
+	// like the null backend, there is no window that could be swapped by SDL
+	return ERunCommandReturnTypes::RUN_COMMAND_COMMAND_HANDLED;
+}
+
+void CCommandProcessorFragment_Software::Cmd_Init(const SCommand_Init *pCommand)
+{
+	TGLBackendReadPresentedImageData &ReadPresentedImgDataFunc = *pCommand->m_pReadPresentedImageDataFunc;
+	ReadPresentedImgDataFunc = [this](uint32_t &Width, uint32_t &Height, CImageInfo::EImageFormat &Format, std::vector<uint8_t> &vDstData) { return GetPresentedImageData(Width, Height, Format, vDstData); };
+
+	str_copy(pCommand->m_pVendorString, "DDNet", gs_GPUInfoStringSize);
+	str_copy(pCommand->m_pVersionString, "1.0", gs_GPUInfoStringSize);
+	str_copy(pCommand->m_pRendererString, "Software rasterizer", gs_GPUInfoStringSize);
+
+	// the frontend lowers tile layers, quad containers and text to plain
+	// renders if the backend cannot buffer them
+	pCommand->m_pCapabilities->m_TileBuffering = false;
+	pCommand->m_pCapabilities->m_QuadBuffering = false;
+	pCommand->m_pCapabilities->m_TextBuffering = false;
+	pCommand->m_pCapabilities->m_QuadContainerBuffering = false;
+
+	pCommand->m_pCapabilities->m_MipMapping = false;
+	pCommand->m_pCapabilities->m_NPOTTextures = true;
+	pCommand->m_pCapabilities->m_3DTextures = false;
+	pCommand->m_pCapabilities->m_2DArrayTextures = false;
+	pCommand->m_pCapabilities->m_2DArrayTexturesAsExtension = false;
+	pCommand->m_pCapabilities->m_ShaderSupport = false;
+
+	pCommand->m_pCapabilities->m_TrianglesAsQuads = false;
+
+	pCommand->m_pCapabilities->m_ContextMajor = 0;
+	pCommand->m_pCapabilities->m_ContextMinor = 0;
+	pCommand->m_pCapabilities->m_ContextPatch = 0;
+
+	m_pTextureMemoryUsage = pCommand->m_pTextureMemoryUsage;
+	m_pTextureMemoryUsage->store(0, std::memory_order_relaxed);
+
+	int NumThreads = 0;
+#ifndef CONF_WEBASM
+	// the thread that runs the commands renders tiles too
+	NumThreads = maximum(0, minimum<int>(g_Config.m_GfxRenderThreadCount - 1, (int)std::thread::hardware_concurrency() - 1));
+#endif
+	m_Rasterizer.Init(pCommand->m_Width, pCommand->m_Height, NumThreads);
+}
+
+void CCommandProcessorFragment_Software::Cmd_Shutdown(const SCommand_Shutdown *pCommand)
+{
+	m_Rasterizer.Shutdown();
+	m_vTextureMemory.clear();
+}
+
+void CCommandProcessorFragment_Software::Cmd_Texture_Create(const CCommandBuffer::SCommand_Texture_Create *pCommand)
+{
+	TextureCreate(pCommand->m_Slot, pCommand->m_Width, pCommand->m_Height, 4, pCommand->m_Flags, pCommand->m_pData);
+}
+
+void CCommandProcessorFragment_Software::Cmd_Texture_Update(const CCommandBuffer::SCommand_Texture_Update *pCommand)
+{
+	m_Rasterizer.UpdateTexture(pCommand->m_Slot, pCommand->m_X, pCommand->m_Y, pCommand->m_Width, pCommand->m_Height, (const uint8_t *)pCommand->m_pData);
+	free(pCommand->m_pData);
+}
+
+void CCommandProcessorFragment_Software::Cmd_Texture_Destroy(const CCommandBuffer::SCommand_Texture_Destroy *pCommand)
+{
+	TextureDestroy(pCommand->m_Slot);
+}
+
+void CCommandProcessorFragment_Software::Cmd_TextTextures_Create(const CCommandBuffer::SCommand_TextTextures_Create *pCommand)
+{
+	TextureCreate(pCommand->m_Slot, pCommand->m_Width, pCommand->m_Height, 1, 0, pCommand->m_pTextData);
+	TextureCreate(pCommand->m_SlotOutline, pCommand->m_Width, pCommand->m_Height, 1, 0, pCommand->m_pTextOutlineData);
+}
+
+void CCommandProcessorFragment_Software::Cmd_TextTexture_Update(const CCommandBuffer::SCommand_TextTexture_Update *pCommand)
+{
+	m_Rasterizer.UpdateTexture(pCommand->m_Slot, pCommand->m_X, pCommand->m_Y, pCommand->m_Width, pCommand->m_Height, (const uint8_t *)pCommand->m_pData);
+	free(pCommand->m_pData);
+}
+
+void CCommandProcessorFragment_Software::Cmd_TextTextures_Destroy(const CCommandBuffer::SCommand_TextTextures_Destroy *pCommand)
+{
+	TextureDestroy(pCommand->m_Slot);
+	TextureDestroy(pCommand->m_SlotOutline);
+}
+
+void CCommandProcessorFragment_Software::Cmd_Clear(const CCommandBuffer::SCommand_Clear *pCommand)
+{
+	m_Rasterizer.Clear(pCommand->m_Color);
+}
+
+void CCommandProcessorFragment_Software::Cmd_Render(const CCommandBuffer::SCommand_Render *pCommand)
+{
+	m_Rasterizer.Render(pCommand->m_State, pCommand->m_PrimType, pCommand->m_PrimCount, pCommand->m_pVertices);
+}
+
+void CCommandProcessorFragment_Software::Cmd_Swap(const CCommandBuffer::SCommand_Swap *pCommand)
+{
+	m_Rasterizer.Swap();
+}
+
+void CCommandProcessorFragment_Software::Cmd_Screenshot(const CCommandBuffer::SCommand_TrySwapAndScreenshot *pCommand)
+{
+	*pCommand->m_pSwapped = false;
+	m_Rasterizer.Flush();
+
+	const int Width = m_Rasterizer.Width();
+	const int Height = m_Rasterizer.Height();
+	uint8_t *pPixelData = (uint8_t *)malloc((size_t)Width * Height * 4);
+	mem_copy(pPixelData, m_Rasterizer.BackBuffer(), (size_t)Width * Height * 4);
+	for(size_t i = 3; i < (size_t)Width * Height * 4; i += 4)
+		pPixelData[i] = 255;
+
+	pCommand->m_pImage->m_Width = Width;
+	pCommand->m_pImage->m_Height = Height;
+	pCommand->m_pImage->m_Format = CImageInfo::FORMAT_RGBA;
+	pCommand->m_pImage->m_pData = pPixelData;
+}
+
+void CCommandProcessorFragment_Software::Cmd_Update_Viewport(const CCommandBuffer::SCommand_Update_Viewport *pCommand)
+{
+	if(pCommand->m_ByResize)
+		m_Rasterizer.Resize(pCommand->m_X + pCommand->m_Width, pCommand->m_Y + pCommand->m_Height);
+	m_Rasterizer.SetViewport(pCommand->m_X, pCommand->m_Y, pCommand->m_Width, pCommand->m_Height);
+}
@@ -0,0 +1,36 @@
+#ifndef ENGINE_CLIENT_BACKEND_SOFTWARE_BACKEND_SOFTWARE_H
+#define ENGINE_CLIENT_BACKEND_SOFTWARE_BACKEND_SOFTWARE_H
+
+#include "rasterizer.h"
+
+#include <engine/client/backend/backend_base.h>
+
+// renders on the CPU, used by the headless client to render demos to videos
+class CCommandProcessorFragment_Software : public CCommandProcessorFragment_GLBase
+{
+	CSoftwareRasterizer m_Rasterizer;
+	std::atomic<uint64_t> *m_pTextureMemoryUsage = nullptr;
+	std::vector<size_t> m_vTextureMemory;
+
+	void TextureCreate(int Slot, int Width, int Height, int PixelSize, int Flags, void *pData);
+	void TextureDestroy(int Slot);
+
+	bool GetPresentedImageData(uint32_t &Width, uint32_t &Height, CImageInfo::EImageFormat &Format, std::vector<uint8_t> &vDstData) override;
+	ERunCommandReturnTypes RunCommand(const CCommandBuffer::SCommand *pBaseCommand) override;
+
+	void Cmd_Init(const SCommand_Init *pCommand);
+	void Cmd_Shutdown(const SCommand_Shutdown *pCommand);
+	void Cmd_Texture_Create(const CCommandBuffer::SCommand_Texture_Create *pCommand);
+	void Cmd_Texture_Update(const CCommandBuffer::SCommand_Texture_Update *pCommand);
+	void Cmd_Texture_Destroy(const CCommandBuffer::SCommand_Texture_Destroy *pCommand);
+	void Cmd_TextTextures_Create(const CCommandBuffer::SCommand_TextTextures_Create *pCommand);
+	void Cmd_TextTexture_Update(const CCommandBuffer::SCommand_TextTexture_Update *pCommand);
+	void Cmd_TextTextures_Destroy(const CCommandBuffer::SCommand_TextTextures_Destroy *pCommand);
+	void Cmd_Clear(const CCommandBuffer::SCommand_Clear *pCommand);
+	void Cmd_Render(const CCommandBuffer::SCommand_Render *pCommand);
+	void Cmd_Swap(const CCommandBuffer::SCommand_Swap *pCommand);
+	void Cmd_Screenshot(const CCommandBuffer::SCommand_TrySwapAndScreenshot *pCommand);
+	void Cmd_Update_Viewport(const CCommandBuffer::SCommand_Update_Viewport *pCommand);
+};
+
+#endif
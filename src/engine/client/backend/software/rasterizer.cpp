@@ -0,0 +1,478 @@
+#include "rasterizer.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <cmath>
+
+static const float gs_GuardBand = (float)(1 << 20);
+
+static bool IntersectRect(int &X0, int &Y0, int &X1, int &Y1, int OtherX0, int OtherY0, int OtherX1, int OtherY1)
+{
+	X0 = maximum(X0, OtherX0);
+	Y0 = maximum(Y0, OtherY0);
+	X1 = minimum(X1, OtherX1);
+	Y1 = minimum(Y1, OtherY1);
+	return X0 < X1 && Y0 < Y1;
+}
+
+static int WrapCoord(int Coord, int Size, int WrapMode)
+{
+	if(WrapMode == CCommandBuffer::WRAP_CLAMP)
+		return clamp(Coord, 0, Size - 1);
+	Coord %= Size;
+	return Coord < 0 ? Coord + Size : Coord;
+}
+
+static void FetchTexel(const uint8_t *pData, int PixelSize, float *pTexel)
+{
+	if(PixelSize == 1)
+	{
+		pTexel[0] = pTexel[1] = pTexel[2] = 1.0f;
+		pTexel[3] = pData[0] / 255.0f;
+		return;
+	}
+	for(int i = 0; i < 4; i++)
+		pTexel[i] = pData[i] / 255.0f;
+}
+
+static void SampleBilinear(const uint8_t *pData, int Width, int Height, int PixelSize, int WrapMode, float U, float V, float *pTexel)
+{
+	const float X = U * Width - 0.5f;
+	const float Y = V * Height - 0.5f;
+	const float FloorX = std::floor(X);
+	const float FloorY = std::floor(Y);
+	const float FracX = X - FloorX;
+	const float FracY = Y - FloorY;
+	// the float to int conversion is only defined for values in range
+	const int X0 = (int)clamp(FloorX, -gs_GuardBand, gs_GuardBand);
+	const int Y0 = (int)clamp(FloorY, -gs_GuardBand, gs_GuardBand);
+	const int aX[2] = {WrapCoord(X0, Width, WrapMode), WrapCoord(X0 + 1, Width, WrapMode)};
+	const int aY[2] = {WrapCoord(Y0, Height, WrapMode), WrapCoord(Y0 + 1, Height, WrapMode)};
+
+	float aaTexels[4][4];
+	for(int i = 0; i < 4; i++)
+		FetchTexel(pData + ((size_t)aY[i / 2] * Width + aX[i % 2]) * PixelSize, PixelSize, aaTexels[i]);
+	for(int c = 0; c < 4; c++)
+	{
+		const float Top = aaTexels[0][c] + (aaTexels[1][c] - aaTexels[0][c]) * FracX;
+		const float Bottom = aaTexels[2][c] + (aaTexels[3][c] - aaTexels[2][c]) * FracX;
+		pTexel[c] = Top + (Bottom - Top) * FracY;
+	}
+}
+
+static uint8_t ToByte(float Value)
+{
+	return (uint8_t)(clamp(Value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+CSoftwareRasterizer::CSoftwareRasterizer()
+{
+	m_vTextures.resize(CCommandBuffer::MAX_TEXTURES);
+}
+
+CSoftwareRasterizer::~CSoftwareRasterizer()
+{
+	Shutdown();
+}
+
+void CSoftwareRasterizer::Init(int Width, int Height, int NumThreads)
+{
+	Resize(Width, Height);
+	SetViewport(0, 0, Width, Height);
+
+	m_Stop = false;
+	for(int i = 0; i < NumThreads; i++)
+		m_vThreads.emplace_back([this]() { RunThread(); });
+}
+
+void CSoftwareRasterizer::Shutdown()
+{
+	{
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		m_Stop = true;
+		m_WorkCond.notify_all();
+	}
+	for(auto &Thread : m_vThreads)
+		Thread.join();
+	m_vThreads.clear();
+}
+
+void CSoftwareRasterizer::Resize(int Width, int Height)
+{
+	Flush();
+	m_Width = maximum(Width, 0);
+	m_Height = maximum(Height, 0);
+	m_vBackBuffer.assign((size_t)m_Width * m_Height * 4, 0);
+	m_vFrontBuffer.assign((size_t)m_Width * m_Height * 4, 0);
+}
+
+void CSoftwareRasterizer::SetViewport(int X, int Y, int Width, int Height)
+{
+	m_ViewportX = X;
+	m_ViewportY = Y;
+	m_ViewportWidth = Width;
+	m_ViewportHeight = Height;
+}
+
+void CSoftwareRasterizer::CreateTexture(int Slot, int Width, int Height, int PixelSize, const uint8_t *pData)
+{
+	Flush();
+	if(Slot >= (int)m_vTextures.size())
+		m_vTextures.resize(maximum<size_t>(Slot + 1, m_vTextures.size() * 2));
+
+	STexture &Texture = m_vTextures[Slot];
+	Texture.m_Width = Width;
+	Texture.m_Height = Height;
+	Texture.m_PixelSize = PixelSize;
+	Texture.m_vData.assign(pData, pData + (size_t)Width * Height * PixelSize);
+}
+
+void CSoftwareRasterizer::UpdateTexture(int Slot, int X, int Y, int Width, int Height, const uint8_t *pData)
+{
+	Flush();
+	STexture &Texture = m_vTextures[Slot];
+	if(X < 0 || Y < 0 || X + Width > Texture.m_Width || Y + Height > Texture.m_Height)
+		return;
+	const size_t RowSize = (size_t)Width * Texture.m_PixelSize;
+	for(int Row = 0; Row < Height; Row++)
+		mem_copy(&Texture.m_vData[((size_t)(Y + Row) * Texture.m_Width + X) * Texture.m_PixelSize], pData + Row * RowSize, RowSize);
+}
+
+void CSoftwareRasterizer::DestroyTexture(int Slot)
+{
+	Flush();
+	STexture &Texture = m_vTextures[Slot];
+	Texture.m_Width = 0;
+	Texture.m_Height = 0;
+	Texture.m_PixelSize = 0;
+	Texture.m_vData.clear();
+	Texture.m_vData.shrink_to_fit();
+}
+
+void CSoftwareRasterizer::Clear(const ColorRGBA &Color)
+{
+	// the scissor test doesn't apply to clears
+	SDraw Draw;
+	Draw.m_PrimType = CCommandBuffer::PRIMTYPE_INVALID;
+	Draw.m_BlendMode = CCommandBuffer::BLEND_NONE;
+	Draw.m_WrapMode = CCommandBuffer::WRAP_REPEAT;
+	Draw.m_Texture = -1;
+	Draw.m_Clip = {0, 0, m_Width, m_Height};
+	Draw.m_aClearColor[0] = Color.r;
+	Draw.m_aClearColor[1] = Color.g;
+	Draw.m_aClearColor[2] = Color.b;
+	Draw.m_FirstVertex = 0;
+	Draw.m_NumVertices = 0;
+	m_vDraws.push_back(Draw);
+}
+
+void CSoftwareRasterizer::Render(const CCommandBuffer::SState &State, unsigned PrimType, unsigned PrimCount, const CCommandBuffer::SVertex *pVertices)
+{
+	size_t NumVertices;
+	switch(PrimType)
+	{
+	case CCommandBuffer::PRIMTYPE_LINES: NumVertices = (size_t)PrimCount * 2; break;
+	case CCommandBuffer::PRIMTYPE_QUADS: NumVertices = (size_t)PrimCount * 4; break;
+	case CCommandBuffer::PRIMTYPE_TRIANGLES: NumVertices = (size_t)PrimCount * 3; break;
+	default:
+		dbg_msg("render", "unknown primtype %d", PrimType);
+		return;
+	}
+
+	const float ScreenWidth = State.m_ScreenBR.x - State.m_ScreenTL.x;
+	const float ScreenHeight = State.m_ScreenBR.y - State.m_ScreenTL.y;
+	if(NumVertices == 0 || ScreenWidth == 0.0f || ScreenHeight == 0.0f)
+		return;
+
+	// the viewport and the scissor rectangle count from the bottom
+	const int ViewportTop = m_Height - m_ViewportY - m_ViewportHeight;
+	SDraw Draw;
+	Draw.m_Clip = {m_ViewportX, ViewportTop, m_ViewportX + m_ViewportWidth, ViewportTop + m_ViewportHeight};
+	if(!IntersectRect(Draw.m_Clip.m_X0, Draw.m_Clip.m_Y0, Draw.m_Clip.m_X1, Draw.m_Clip.m_Y1, 0, 0, m_Width, m_Height))
+		return;
+	if(State.m_ClipEnable && !IntersectRect(Draw.m_Clip.m_X0, Draw.m_Clip.m_Y0, Draw.m_Clip.m_X1, Draw.m_Clip.m_Y1,
+					State.m_ClipX, m_Height - State.m_ClipY - State.m_ClipH, State.m_ClipX + State.m_ClipW, m_Height - State.m_ClipY))
+		return;
+
+	const bool Textured = State.m_Texture >= 0 && State.m_Texture < (int)m_vTextures.size() && !m_vTextures[State.m_Texture].m_vData.empty();
+	Draw.m_PrimType = PrimType;
+	Draw.m_BlendMode = State.m_BlendMode;
+	Draw.m_WrapMode = State.m_WrapMode;
+	Draw.m_Texture = Textured ? State.m_Texture : -1;
+	Draw.m_FirstVertex = m_vVertices.size();
+	Draw.m_NumVertices = NumVertices;
+
+	const float ScaleX = m_ViewportWidth / ScreenWidth;
+	const float ScaleY = m_ViewportHeight / ScreenHeight;
+	for(size_t i = 0; i < NumVertices; i++)
+	{
+		const CCommandBuffer::SVertex &Vertex = pVertices[i];
+		SVertex Transformed;
+		Transformed.m_X = clamp(m_ViewportX + (Vertex.m_Pos.x - State.m_ScreenTL.x) * ScaleX, -gs_GuardBand, gs_GuardBand);
+		Transformed.m_Y = clamp(ViewportTop + (Vertex.m_Pos.y - State.m_ScreenTL.y) * ScaleY, -gs_GuardBand, gs_GuardBand);
+		Transformed.m_U = Vertex.m_Tex.x;
+		Transformed.m_V = Vertex.m_Tex.y;
+		Transformed.m_aColor[0] = Vertex.m_Color.r / 255.0f;
+		Transformed.m_aColor[1] = Vertex.m_Color.g / 255.0f;
+		Transformed.m_aColor[2] = Vertex.m_Color.b / 255.0f;
+		Transformed.m_aColor[3] = Vertex.m_Color.a / 255.0f;
+		m_vVertices.push_back(Transformed);
+	}
+	m_vDraws.push_back(Draw);
+}
+
+void CSoftwareRasterizer::Flush()
+{
+	if(m_vDraws.empty())
+		return;
+
+	m_NumTiles = (m_Height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+	m_NextTile.store(0, std::memory_order_relaxed);
+	if(!m_vThreads.empty())
+	{
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		m_Generation++;
+		m_NumBusyThreads = m_vThreads.size();
+		m_WorkCond.notify_all();
+	}
+
+	RenderTiles();
+
+	if(!m_vThreads.empty())
+	{
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		m_DoneCond.wait(Lock, [this]() { return m_NumBusyThreads == 0; });
+	}
+
+	m_vDraws.clear();
+	m_vVertices.clear();
+}
+
+void CSoftwareRasterizer::Swap()
+{
+	Flush();
+	std::swap(m_vBackBuffer, m_vFrontBuffer);
+}
+
+void CSoftwareRasterizer::RunThread()
+{
+	uint64_t Generation = 0;
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+			m_WorkCond.wait(Lock, [this, Generation]() { return m_Stop || m_Generation != Generation; });
+			if(m_Stop)
+				return;
+			Generation = m_Generation;
+		}
+
+		RenderTiles();
+
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		if(--m_NumBusyThreads == 0)
+			m_DoneCond.notify_all();
+	}
+}
+
+void CSoftwareRasterizer::RenderTiles()
+{
+	while(true)
+	{
+		const int Tile = m_NextTile.fetch_add(1, std::memory_order_relaxed);
+		if(Tile >= m_NumTiles)
+			break;
+		RenderTile(Tile);
+	}
+}
+
+void CSoftwareRasterizer::RenderTile(int Tile)
+{
+	const int TileY0 = Tile * TILE_HEIGHT;
+	const int TileY1 = minimum(TileY0 + TILE_HEIGHT, m_Height);
+	for(const SDraw &Draw : m_vDraws)
+	{
+		SRect Clip = Draw.m_Clip;
+		if(!IntersectRect(Clip.m_X0, Clip.m_Y0, Clip.m_X1, Clip.m_Y1, 0, TileY0, m_Width, TileY1))
+			continue;
+
+		if(Draw.m_PrimType == CCommandBuffer::PRIMTYPE_INVALID)
+		{
+			uint8_t aClear[4] = {ToByte(Draw.m_aClearColor[0]), ToByte(Draw.m_aClearColor[1]), ToByte(Draw.m_aClearColor[2]), 0};
+			for(int Y = Clip.m_Y0; Y < Clip.m_Y1; Y++)
+			{
+				uint8_t *pRow = &m_vBackBuffer[((size_t)Y * m_Width + Clip.m_X0) * 4];
+				for(int X = Clip.m_X0; X < Clip.m_X1; X++, pRow += 4)
+					mem_copy(pRow, aClear, sizeof(aClear));
+			}
+			continue;
+		}
+
+		const STexture *pTexture = Draw.m_Texture >= 0 ? &m_vTextures[Draw.m_Texture] : nullptr;
+		const SVertex *pVertices = &m_vVertices[Draw.m_FirstVertex];
+		switch(Draw.m_PrimType)
+		{
+		case CCommandBuffer::PRIMTYPE_QUADS:
+			for(size_t i = 0; i < Draw.m_NumVertices; i += 4)
+			{
+				RenderTriangle(Draw, pTexture, pVertices[i], pVertices[i + 1], pVertices[i + 2], Clip);
+				RenderTriangle(Draw, pTexture, pVertices[i], pVertices[i + 2], pVertices[i + 3], Clip);
+			}
+			break;
+		case CCommandBuffer::PRIMTYPE_TRIANGLES:
+			for(size_t i = 0; i < Draw.m_NumVertices; i += 3)
+				RenderTriangle(Draw, pTexture, pVertices[i], pVertices[i + 1], pVertices[i + 2], Clip);
+			break;
+		case CCommandBuffer::PRIMTYPE_LINES:
+			for(size_t i = 0; i < Draw.m_NumVertices; i += 2)
+				RenderLine(Draw, pTexture, pVertices[i], pVertices[i + 1], Clip);
+			break;
+		}
+	}
+}
+
+void CSoftwareRasterizer::RenderTriangle(const SDraw &Draw, const STexture *pTexture, const SVertex &V0, const SVertex &V1, const SVertex &V2, const SRect &Clip)
+{
+	const float MinX = minimum(V0.m_X, minimum(V1.m_X, V2.m_X));
+	const float MaxX = maximum(V0.m_X, maximum(V1.m_X, V2.m_X));
+	const float MinY = minimum(V0.m_Y, minimum(V1.m_Y, V2.m_Y));
+	const float MaxY = maximum(V0.m_Y, maximum(V1.m_Y, V2.m_Y));
+	if(MaxX <= Clip.m_X0 || MinX >= Clip.m_X1 || MaxY <= Clip.m_Y0 || MinY >= Clip.m_Y1)
+		return;
+
+	// fixed point positions, the edge functions are exact so that pixels on
+	// an edge shared by two triangles are only rendered once
+	const int64_t One = 1 << SUBPIXEL_BITS;
+	const SVertex *apVertices[3] = {&V0, &V1, &V2};
+	int64_t aX[3], aY[3];
+	for(int i = 0; i < 3; i++)
+	{
+		aX[i] = (int64_t)std::lround(apVertices[i]->m_X * One);
+		aY[i] = (int64_t)std::lround(apVertices[i]->m_Y * One);
+	}
+	int64_t Area = (aX[1] - aX[0]) * (aY[2] - aY[0]) - (aY[1] - aY[0]) * (aX[2] - aX[0]);
+	if(Area == 0)
+		return;
+	if(Area < 0)
+	{
+		std::swap(apVertices[1], apVertices[2]);
+		std::swap(aX[1], aX[2]);
+		std::swap(aY[1], aY[2]);
+		Area = -Area;
+	}
+
+	// edge i is opposite of vertex i, its function is the barycentric weight
+	// of that vertex times Area
+	int64_t aStepX[3], aStepY[3], aBias[3];
+	for(int i = 0; i < 3; i++)
+	{
+		const int From = (i + 1) % 3;
+		const int To = (i + 2) % 3;
+		const int64_t Dx = aX[To] - aX[From];
+		const int64_t Dy = aY[To] - aY[From];
+		aStepX[i] = -Dy;
+		aStepY[i] = Dx;
+		// top-left fill rule
+		aBias[i] = (Dy < 0 || (Dy == 0 && Dx > 0)) ? 0 : -1;
+	}
+
+	const int StartX = maximum(Clip.m_X0, (int)std::floor(MinX));
+	const int EndX = minimum(Clip.m_X1, (int)std::ceil(MaxX));
+	const int StartY = maximum(Clip.m_Y0, (int)std::floor(MinY));
+	const int EndY = minimum(Clip.m_Y1, (int)std::ceil(MaxY));
+
+	const float InvArea = 1.0f / (float)Area;
+	float aU[3], aV[3], aaColor[3][4];
+	for(int i = 0; i < 3; i++)
+	{
+		aU[i] = apVertices[i]->m_U;
+		aV[i] = apVertices[i]->m_V;
+		for(int c = 0; c < 4; c++)
+			aaColor[i][c] = apVertices[i]->m_aColor[c];
+	}
+
+	for(int Y = StartY; Y < EndY; Y++)
+	{
+		const int64_t PixelX = StartX * One + One / 2;
+		const int64_t PixelY = Y * One + One / 2;
+		int64_t aEdge[3];
+		for(int i = 0; i < 3; i++)
+		{
+			const int From = (i + 1) % 3;
+			aEdge[i] = aStepX[i] * (PixelX - aX[From]) + aStepY[i] * (PixelY - aY[From]) + aBias[i];
+		}
+
+		for(int X = StartX; X < EndX; X++)
+		{
+			if((aEdge[0] | aEdge[1] | aEdge[2]) >= 0)
+			{
+				const float W1 = (aEdge[1] - aBias[1]) * InvArea;
+				const float W2 = (aEdge[2] - aBias[2]) * InvArea;
+				const float W0 = 1.0f - W1 - W2;
+				float aColor[4];
+				for(int c = 0; c < 4; c++)
+					aColor[c] = aaColor[0][c] * W0 + aaColor[1][c] * W1 + aaColor[2][c] * W2;
+				ShadePixel(Draw, pTexture, X, Y, aU[0] * W0 + aU[1] * W1 + aU[2] * W2, aV[0] * W0 + aV[1] * W1 + aV[2] * W2, aColor);
+			}
+			for(int i = 0; i < 3; i++)
+				aEdge[i] += aStepX[i] * One;
+		}
+	}
+}
+
+void CSoftwareRasterizer::RenderLine(const SDraw &Draw, const STexture *pTexture, const SVertex &V0, const SVertex &V1, const SRect &Clip)
+{
+	const float Dx = V1.m_X - V0.m_X;
+	const float Dy = V1.m_Y - V0.m_Y;
+	const int Steps = (int)std::ceil(maximum(absolute(Dx), absolute(Dy)));
+	if(Steps <= 0 || Steps > 2 * maximum(m_Width, m_Height) + 2)
+		return;
+
+	// the last pixel of a line is not rendered, like in OpenGL
+	for(int Step = 0; Step < Steps; Step++)
+	{
+		const float T = (Step + 0.5f) / Steps;
+		const int X = (int)std::floor(V0.m_X + Dx * T);
+		const int Y = (int)std::floor(V0.m_Y + Dy * T);
+		if(X < Clip.m_X0 || X >= Clip.m_X1 || Y < Clip.m_Y0 || Y >= Clip.m_Y1)
+			continue;
+		float aColor[4];
+		for(int c = 0; c < 4; c++)
+			aColor[c] = V0.m_aColor[c] + (V1.m_aColor[c] - V0.m_aColor[c]) * T;
+		ShadePixel(Draw, pTexture, X, Y, V0.m_U + (V1.m_U - V0.m_U) * T, V0.m_V + (V1.m_V - V0.m_V) * T, aColor);
+	}
+}
+
+void CSoftwareRasterizer::ShadePixel(const SDraw &Draw, const STexture *pTexture, int X, int Y, float U, float V, const float *pColor)
+{
+	float aSrc[4] = {pColor[0], pColor[1], pColor[2], pColor[3]};
+	if(pTexture)
+	{
+		float aTexel[4];
+		SampleBilinear(pTexture->m_vData.data(), pTexture->m_Width, pTexture->m_Height, pTexture->m_PixelSize, Draw.m_WrapMode, U, V, aTexel);
+		for(int c = 0; c < 4; c++)
+			aSrc[c] *= aTexel[c];
+	}
+
+	uint8_t *pDst = &m_vBackBuffer[((size_t)Y * m_Width + X) * 4];
+	const float Alpha = aSrc[3];
+	switch(Draw.m_BlendMode)
+	{
+	case CCommandBuffer::BLEND_ALPHA:
+		if(Alpha <= 0.0f)
+			return;
+		for(int c = 0; c < 4; c++)
+			pDst[c] = ToByte(aSrc[c] * Alpha + pDst[c] / 255.0f * (1.0f - Alpha));
+		break;
+	case CCommandBuffer::BLEND_ADDITIVE:
+		if(Alpha <= 0.0f)
+			return;
+		for(int c = 0; c < 4; c++)
+			pDst[c] = ToByte(aSrc[c] * Alpha + pDst[c] / 255.0f);
+		break;
+	default:
+		for(int c = 0; c < 4; c++)
+			pDst[c] = ToByte(aSrc[c]);
+	}
+}
@@ -0,0 +1,142 @@
+#ifndef ENGINE_CLIENT_BACKEND_SOFTWARE_RASTERIZER_H
+#define ENGINE_CLIENT_BACKEND_SOFTWARE_RASTERIZER_H
+
+#include <engine/client/graphics_threaded.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Renders the draws of the graphics frontend into an RGBA framebuffer on the
+ * CPU, for clients without a GPU.
+ *
+ * Draws are recorded with their vertices already transformed to pixels and
+ * rendered by Flush(). It splits the framebuffer into horizontal tiles of
+ * TILE_HEIGHT rows, every tile is rendered by one thread which runs all
+ * recorded draws clipped to its rows. So the draws keep their order for every
+ * pixel without synchronisation between the threads.
+ *
+ * Textures are sampled bilinearly without mipmaps, the blend modes match the
+ * OpenGL backends.
+ */
+class CSoftwareRasterizer
+{
+public:
+	enum
+	{
+		TILE_HEIGHT = 32,
+		// vertex positions are snapped to 1/16 pixel
+		SUBPIXEL_BITS = 4,
+	};
+
+private:
+	struct STexture
+	{
+		int m_Width = 0;
+		int m_Height = 0;
+		// 4 for RGBA, 1 for the alpha-only text textures
+		int m_PixelSize = 0;
+		std::vector<uint8_t> m_vData;
+	};
+
+	struct SVertex
+	{
+		// pixels from the top left corner of the framebuffer
+		float m_X;
+		float m_Y;
+		float m_U;
+		float m_V;
+		float m_aColor[4];
+	};
+
+	struct SRect
+	{
+		int m_X0;
+		int m_Y0;
+		int m_X1;
+		int m_Y1;
+	};
+
+	struct SDraw
+	{
+		// PRIMTYPE_INVALID clears the framebuffer
+		unsigned m_PrimType;
+		int m_BlendMode;
+		int m_WrapMode;
+		int m_Texture;
+		SRect m_Clip;
+		float m_aClearColor[3];
+		size_t m_FirstVertex;
+		size_t m_NumVertices;
+	};
+
+	int m_Width = 0;
+	int m_Height = 0;
+	// as passed to SetViewport()
+	int m_ViewportX = 0;
+	int m_ViewportY = 0;
+	int m_ViewportWidth = 0;
+	int m_ViewportHeight = 0;
+	std::vector<uint8_t> m_vBackBuffer;
+	std::vector<uint8_t> m_vFrontBuffer;
+
+	std::vector<STexture> m_vTextures;
+
+	std::vector<SDraw> m_vDraws;
+	std::vector<SVertex> m_vVertices;
+
+	std::vector<std::thread> m_vThreads;
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkCond;
+	std::condition_variable m_DoneCond;
+	uint64_t m_Generation = 0;
+	int m_NumBusyThreads = 0;
+	bool m_Stop = false;
+	std::atomic<int> m_NextTile{0};
+	int m_NumTiles = 0;
+
+	void RunThread();
+	void RenderTiles();
+	void RenderTile(int Tile);
+	void RenderTriangle(const SDraw &Draw, const STexture *pTexture, const SVertex &V0, const SVertex &V1, const SVertex &V2, const SRect &Clip);
+	void RenderLine(const SDraw &Draw, const STexture *pTexture, const SVertex &V0, const SVertex &V1, const SRect &Clip);
+	void ShadePixel(const SDraw &Draw, const STexture *pTexture, int X, int Y, float U, float V, const float *pColor);
+
+public:
+	CSoftwareRasterizer();
+	~CSoftwareRasterizer();
+
+	// starts NumThreads threads that render tiles in addition to the one
+	// that calls Flush()
+	void Init(int Width, int Height, int NumThreads);
+	void Shutdown();
+
+	void Resize(int Width, int Height);
+	// like glViewport, Y is the distance from the bottom of the framebuffer
+	void SetViewport(int X, int Y, int Width, int Height);
+
+	// PixelSize is 4 for RGBA and 1 for alpha-only textures
+	void CreateTexture(int Slot, int Width, int Height, int PixelSize, const uint8_t *pData);
+	void UpdateTexture(int Slot, int X, int Y, int Width, int Height, const uint8_t *pData);
+	void DestroyTexture(int Slot);
+
+	void Clear(const ColorRGBA &Color);
+	void Render(const CCommandBuffer::SState &State, unsigned PrimType, unsigned PrimCount, const CCommandBuffer::SVertex *pVertices);
+
+	// renders the recorded draws into the back buffer
+	void Flush();
+	// flushes and makes the back buffer the presented one
+	void Swap();
+
+	int Width() const { return m_Width; }
+	int Height() const { return m_Height; }
+	// RGBA pixels, the top row first
+	const uint8_t *BackBuffer() const { return m_vBackBuffer.data(); }
+	const uint8_t *FrontBuffer() const { return m_vFrontBuffer.data(); }
+};
+
+#endif
@@ -23,6 +23,7 @@
 
 #if defined(CONF_HEADLESS_CLIENT)
 #include "backend/null/backend_null.h"
+#include "backend/software/backend_software.h"
 #endif
 
 #if !defined(CONF_BACKEND_OPENGL_ES)
@@ -328,6 +329,7 @@ void CCommandProcessor_SDL_GL::HandleWarning()
 
 void CCommandProcessor_SDL_GL::RunBuffer(CCommandBuffer *pBuffer)
 {
+	m_pGLBackend->PrepareCommands(pBuffer);
 	m_pGLBackend->StartCommands(pBuffer->m_CommandCount, pBuffer->m_RenderCallCount);
 
 	for(CCommandBuffer::SCommand *pCommand = pBuffer->Head(); pCommand; pCommand = pCommand->m_pNext)
@@ -367,7 +369,10 @@ CCommandProcessor_SDL_GL::CCommandProcessor_SDL_GL(EBackendType BackendType, int
 	m_BackendType = BackendType;
 
 #if defined(CONF_HEADLESS_CLIENT)
-	m_pGLBackend = new CCommandProcessorFragment_Null();
+	if(g_Config.m_GfxSoftwareRenderer)
+		m_pGLBackend = new CCommandProcessorFragment_Software();
+	else
+		m_pGLBackend = new CCommandProcessorFragment_Null();
 #else
 	if(BackendType == BACKEND_TYPE_OPENGL_ES)
 	{
@@ -1010,6 +1015,9 @@ int CGraphicsBackend_SDL_GL::Init(const char *pName, int *pScreen, int *pWidth,
 	int GlewPatch = 0;
 	IsVersionSupportedGlew(m_BackendType, g_Config.m_GfxGLMajor, g_Config.m_GfxGLMinor, g_Config.m_GfxGLPatch, GlewMajor, GlewMinor, GlewPatch);
 	BackendInitGlew(m_BackendType, GlewMajor, GlewMinor, GlewPatch);
+	// there is no window, the software renderer renders at the configured size
+	*pCurrentWidth = *pWidth;
+	*pCurrentHeight = *pHeight;
 #else
 	// print sdl version
 	{
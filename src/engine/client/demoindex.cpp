@@ -0,0 +1,160 @@
+#include "demoindex.h"
+
+#include <engine/console.h>
+#include <engine/storage.h>
+
+#include <sqlite3.h>
+
+CDemoIndex::CDemoIndex(IConsole *pConsole, IStorage *pStorage) :
+	m_pConsole(pConsole)
+{
+	m_pDisk = SqliteOpen(pConsole, pStorage, "ddnet-cache.sqlite3");
+	if(!m_pDisk)
+	{
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_index", "failed to open ddnet-cache.sqlite3");
+		return;
+	}
+	sqlite3 *pSqlite = m_pDisk.get();
+	static const char TABLE[] = "CREATE TABLE IF NOT EXISTS demo_infos (path TEXT PRIMARY KEY NOT NULL, size INTEGER NOT NULL, date INTEGER NOT NULL, valid INTEGER NOT NULL, header BLOB NOT NULL, markers BLOB NOT NULL, map_sha256 BLOB NOT NULL)";
+	if(SQLITE_HANDLE_ERROR(sqlite3_exec(pSqlite, TABLE, nullptr, nullptr, nullptr)))
+	{
+		m_pDisk = nullptr;
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_index", "failed to create demo_infos table");
+		return;
+	}
+	m_pLookupStmt = SqlitePrepare(pConsole, pSqlite, "SELECT valid, header, markers, map_sha256 FROM demo_infos WHERE path = ? AND size = ? AND date = ?");
+	m_pStoreStmt = SqlitePrepare(pConsole, pSqlite, "INSERT OR REPLACE INTO demo_infos (path, size, date, valid, header, markers, map_sha256) VALUES (?, ?, ?, ?, ?, ?, ?)");
+	m_pBeginStmt = SqlitePrepare(pConsole, pSqlite, "BEGIN");
+	m_pCommitStmt = SqlitePrepare(pConsole, pSqlite, "COMMIT");
+}
+
+bool CDemoIndex::Lookup(const char *pPath, CEntry *pEntry)
+{
+	if(!m_pDisk || !m_pLookupStmt)
+		return false;
+
+	sqlite3 *pSqlite = m_pDisk.get();
+	IConsole *pConsole = m_pConsole;
+	sqlite3_stmt *pStmt = m_pLookupStmt.get();
+	bool Error = false;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_reset(pStmt)) != SQLITE_OK;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_text(pStmt, 1, pPath, -1, SQLITE_STATIC)) != SQLITE_OK;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int64(pStmt, 2, pEntry->m_Size)) != SQLITE_OK;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int64(pStmt, 3, pEntry->m_Date)) != SQLITE_OK;
+	if(Error || SQLITE_HANDLE_ERROR(sqlite3_step(pStmt)) != SQLITE_ROW)
+		return false;
+
+	// entries written by another version of the structures are read again
+	if(sqlite3_column_bytes(pStmt, 1) != sizeof(pEntry->m_Info) ||
+		sqlite3_column_bytes(pStmt, 2) != sizeof(pEntry->m_TimelineMarkers) ||
+		sqlite3_column_bytes(pStmt, 3) != sizeof(pEntry->m_MapInfo.m_Sha256))
+		return false;
+
+	pEntry->m_Valid = sqlite3_column_int(pStmt, 0) != 0;
+	mem_copy(&pEntry->m_Info, sqlite3_column_blob(pStmt, 1), sizeof(pEntry->m_Info));
+	mem_copy(&pEntry->m_TimelineMarkers, sqlite3_column_blob(pStmt, 2), sizeof(pEntry->m_TimelineMarkers));
+	mem_copy(&pEntry->m_MapInfo.m_Sha256, sqlite3_column_blob(pStmt, 3), sizeof(pEntry->m_MapInfo.m_Sha256));
+	str_copy(pEntry->m_MapInfo.m_aName, pEntry->m_Info.m_aMapName);
+	pEntry->m_MapInfo.m_Crc = bytes_be_to_uint(pEntry->m_Info.m_aMapCrc);
+	pEntry->m_MapInfo.m_Size = bytes_be_to_uint(pEntry->m_Info.m_aMapSize);
+	return true;
+}
+
+void CDemoIndex::Store(const char *pPath, const CEntry &Entry)
+{
+	if(!m_pDisk || !m_pStoreStmt)
+		return;
+
+	sqlite3 *pSqlite = m_pDisk.get();
+	IConsole *pConsole = m_pConsole;
+	sqlite3_stmt *pStmt = m_pStoreStmt.get();
+	bool Error = false;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_reset(pStmt)) != SQLITE_OK;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_text(pStmt, 1, pPath, -1, SQLITE_STATIC)) != SQLITE_OK;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int64(pStmt, 2, Entry.m_Size)) != SQLITE_OK;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int64(pStmt, 3, Entry.m_Date)) != SQLITE_OK;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int(pStmt, 4, Entry.m_Valid)) != SQLITE_OK;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_blob(pStmt, 5, &Entry.m_Info, sizeof(Entry.m_Info), SQLITE_STATIC)) != SQLITE_OK;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_blob(pStmt, 6, &Entry.m_TimelineMarkers, sizeof(Entry.m_TimelineMarkers), SQLITE_STATIC)) != SQLITE_OK;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_blob(pStmt, 7, &Entry.m_MapInfo.m_Sha256, sizeof(Entry.m_MapInfo.m_Sha256), SQLITE_STATIC)) != SQLITE_OK;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_step(pStmt)) != SQLITE_DONE;
+	if(Error)
+	{
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_index", "failed to store demo info");
+	}
+}
+
+void CDemoIndex::Begin()
+{
+	if(!m_pDisk || !m_pBeginStmt || m_InTransaction)
+		return;
+
+	sqlite3 *pSqlite = m_pDisk.get();
+	IConsole *pConsole = m_pConsole;
+	m_InTransaction = SQLITE_HANDLE_ERROR(sqlite3_reset(m_pBeginStmt.get())) == SQLITE_OK &&
+			  SQLITE_HANDLE_ERROR(sqlite3_step(m_pBeginStmt.get())) == SQLITE_DONE;
+}
+
+void CDemoIndex::Commit()
+{
+	if(!m_InTransaction)
+		return;
+
+	sqlite3 *pSqlite = m_pDisk.get();
+	IConsole *pConsole = m_pConsole;
+	m_InTransaction = false;
+	if(SQLITE_HANDLE_ERROR(sqlite3_reset(m_pCommitStmt.get())) != SQLITE_OK ||
+		SQLITE_HANDLE_ERROR(sqlite3_step(m_pCommitStmt.get())) != SQLITE_DONE)
+	{
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_index", "failed to commit demo infos");
+	}
+}
+
+CDemoScanJob::CDemoScanJob(std::shared_ptr<CDemoIndex> pIndex, IStorage *pStorage, const IDemoPlayer *pDemoPlayer, std::vector<CDemo> &&vDemos, bool ReadUncached) :
+	m_pIndex(std::move(pIndex)),
+	m_pStorage(pStorage),
+	m_pDemoPlayer(pDemoPlayer),
+	m_ReadUncached(ReadUncached),
+	m_vDemos(std::move(vDemos))
+{
+}
+
+void CDemoScanJob::Run()
+{
+	// commit regularly, so that an aborted scan keeps most of its progress
+	static const int STORES_PER_TRANSACTION = 256;
+
+	std::unique_lock<std::mutex> Lock;
+	if(m_pIndex)
+		Lock = std::unique_lock<std::mutex>(m_pIndex->Mutex());
+
+	int NumStores = 0;
+	for(size_t i = 0; i < m_vDemos.size() && !m_Abort.load(std::memory_order_relaxed); i++)
+	{
+		CDemo &Demo = m_vDemos[i];
+		char aPath[IO_MAX_PATH_LENGTH];
+		m_pStorage->GetCompletePath(Demo.m_StorageType, Demo.m_aFilename, aPath, sizeof(aPath));
+
+		Demo.m_InfosLoaded = m_pIndex && m_pIndex->Lookup(aPath, &Demo.m_Entry);
+		if(!Demo.m_InfosLoaded && m_ReadUncached)
+		{
+			// not filled if the demo can't be opened
+			mem_zero(&Demo.m_Entry.m_MapInfo, sizeof(Demo.m_Entry.m_MapInfo));
+			Demo.m_Entry.m_Valid = m_pDemoPlayer->GetDemoInfo(m_pStorage, Demo.m_aFilename, Demo.m_StorageType, &Demo.m_Entry.m_Info, &Demo.m_Entry.m_TimelineMarkers, &Demo.m_Entry.m_MapInfo);
+			Demo.m_InfosLoaded = true;
+			if(m_pIndex)
+			{
+				if(NumStores++ % STORES_PER_TRANSACTION == 0)
+				{
+					m_pIndex->Commit();
+					m_pIndex->Begin();
+				}
+				m_pIndex->Store(aPath, Demo.m_Entry);
+			}
+		}
+		m_NumDone.store(i + 1, std::memory_order_release);
+	}
+
+	if(m_pIndex)
+		m_pIndex->Commit();
+}
@@ -0,0 +1,104 @@
+#ifndef ENGINE_CLIENT_DEMOINDEX_H
+#define ENGINE_CLIENT_DEMOINDEX_H
+
+#include <base/system.h>
+
+#include <engine/demo.h>
+#include <engine/shared/jobs.h>
+#include <engine/sqlite.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class IConsole;
+class IStorage;
+
+/**
+ * Caches the headers of demos in ddnet-cache.sqlite3.
+ *
+ * Demos are identified by their complete path, a cached header is only used
+ * while the size and the modification time of the demo match. This lets the
+ * demo browser sort and filter big folders without opening every demo.
+ */
+class CDemoIndex
+{
+public:
+	class CEntry
+	{
+	public:
+		int64_t m_Size;
+		time_t m_Date;
+
+		bool m_Valid;
+		CDemoHeader m_Info;
+		CTimelineMarkers m_TimelineMarkers;
+		CMapInfo m_MapInfo;
+	};
+
+	CDemoIndex(IConsole *pConsole, IStorage *pStorage);
+
+	// held by a scan while it uses the index
+	std::mutex &Mutex() { return m_Mutex; }
+
+	// fills the infos of the entry if its path, size and date are cached
+	bool Lookup(const char *pPath, CEntry *pEntry);
+	void Store(const char *pPath, const CEntry &Entry);
+	// stores until the next call to Commit() are written at once
+	void Begin();
+	void Commit();
+
+private:
+	IConsole *m_pConsole;
+	std::mutex m_Mutex;
+
+	CSqlite m_pDisk;
+	CSqliteStmt m_pLookupStmt;
+	CSqliteStmt m_pStoreStmt;
+	CSqliteStmt m_pBeginStmt;
+	CSqliteStmt m_pCommitStmt;
+	bool m_InTransaction = false;
+};
+
+/**
+ * Fills the infos of the demos of a folder from the index in the background.
+ * Demos that are not cached are read and added to the index if requested.
+ */
+class CDemoScanJob : public IJob
+{
+public:
+	class CDemo
+	{
+	public:
+		// relative to the storage
+		char m_aFilename[IO_MAX_PATH_LENGTH];
+		int m_StorageType;
+		CDemoIndex::CEntry m_Entry;
+		// false if the demo was neither cached nor read
+		bool m_InfosLoaded = false;
+	};
+
+private:
+	std::shared_ptr<CDemoIndex> m_pIndex;
+	IStorage *m_pStorage;
+	const IDemoPlayer *m_pDemoPlayer;
+	bool m_ReadUncached;
+	std::vector<CDemo> m_vDemos;
+	std::atomic<int> m_NumDone{0};
+	std::atomic<bool> m_Abort{false};
+
+	void Run() override;
+
+public:
+	// pIndex can be null if the index could not be opened
+	CDemoScanJob(std::shared_ptr<CDemoIndex> pIndex, IStorage *pStorage, const IDemoPlayer *pDemoPlayer, std::vector<CDemo> &&vDemos, bool ReadUncached);
+
+	void Abort() { m_Abort.store(true, std::memory_order_relaxed); }
+	// the first NumDone() demos are scanned and can be accessed
+	int NumDone() const { return m_NumDone.load(std::memory_order_acquire); }
+	int NumDemos() const { return m_vDemos.size(); }
+	const CDemo &Demo(int Index) const { return m_vDemos[Index]; }
+};
+
+#endif
@@ -60,6 +60,9 @@ static CVideoMode g_aFakeModes[] = {
 
 void CGraphics_Threaded::FlushVertices(bool KeepVertices)
 {
+	if(m_PendingDrawing)
+		FlushPendingVertices();
+
 	CCommandBuffer::SCommand_Render Cmd;
 	int PrimType;
 	size_t PrimCount, NumVerts;
@@ -71,6 +74,39 @@ void CGraphics_Threaded::FlushVertices(bool KeepVertices)
 	}
 }
 
+void CGraphics_Threaded::FlushPendingVertices()
+{
+	const CCommandBuffer::SState State = m_State;
+	const int Drawing = m_Drawing;
+	m_State = m_PendingState;
+	m_Drawing = m_PendingDrawing;
+	m_PendingDrawing = 0;
+	FlushVertices();
+	m_State = State;
+	m_Drawing = Drawing;
+}
+
+void CGraphics_Threaded::ContinuePendingVertices()
+{
+	if(!m_PendingDrawing)
+		return;
+	if(m_PendingDrawing == m_Drawing && m_PendingState == m_State)
+		m_PendingDrawing = 0;
+	else
+		FlushPendingVertices();
+}
+
+void CGraphics_Threaded::EndVertices()
+{
+	if(m_NumVertices > 0)
+	{
+		m_PendingDrawing = m_Drawing;
+		m_PendingState = m_State;
+		m_DrawCallStats.m_Submitted++;
+	}
+	m_Drawing = 0;
+}
+
 void CGraphics_Threaded::FlushVerticesTex3D()
 {
 	CCommandBuffer::SCommand_RenderTex3D Cmd;
@@ -131,6 +167,7 @@ CGraphics_Threaded::CGraphics_Threaded()
 
 	m_Rotation = 0;
 	m_Drawing = 0;
+	m_PendingDrawing = 0;
 
 	m_TextureMemoryUsage = 0;
 
@@ -232,14 +269,14 @@ void CGraphics_Threaded::LinesBegin()
 {
 	dbg_assert(m_Drawing == 0, "called Graphics()->LinesBegin twice");
 	m_Drawing = DRAWING_LINES;
+	ContinuePendingVertices();
 	SetColor(1, 1, 1, 1);
 }
 
 void CGraphics_Threaded::LinesEnd()
 {
 	dbg_assert(m_Drawing == DRAWING_LINES, "called Graphics()->LinesEnd without begin");
-	FlushVertices();
-	m_Drawing = 0;
+	EndVertices();
 }
 
 void CGraphics_Threaded::LinesDraw(const CLineItem *pArray, int Num)
@@ -735,6 +772,9 @@ void CGraphics_Threaded::CopyTextureFromTextureBufferSub(uint8_t *pDestBuffer, s
 
 void CGraphics_Threaded::KickCommandBuffer()
 {
+	if(m_PendingDrawing)
+		FlushPendingVertices();
+
 	m_pBackend->RunBuffer(m_pCommandBuffer);
 
 	std::vector<std::string> WarningStrings;
@@ -850,6 +890,7 @@ void CGraphics_Threaded::QuadsBegin()
 {
 	dbg_assert(m_Drawing == 0, "called Graphics()->QuadsBegin twice");
 	m_Drawing = DRAWING_QUADS;
+	ContinuePendingVertices();
 
 	QuadsSetSubset(0, 0, 1, 1);
 	QuadsSetRotation(0);
@@ -859,18 +900,22 @@ void CGraphics_Threaded::QuadsBegin()
 void CGraphics_Threaded::QuadsEnd()
 {
 	dbg_assert(m_Drawing == DRAWING_QUADS, "called Graphics()->QuadsEnd without begin");
-	FlushVertices();
-	m_Drawing = 0;
+	EndVertices();
 }
 
 void CGraphics_Threaded::QuadsTex3DBegin()
 {
+	// the 3D texture vertices share the vertex count
+	if(m_PendingDrawing)
+		FlushPendingVertices();
 	QuadsBegin();
 }
 
 void CGraphics_Threaded::QuadsTex3DEnd()
 {
 	dbg_assert(m_Drawing == DRAWING_QUADS, "called Graphics()->QuadsEnd without begin");
+	if(m_NumVertices > 0)
+		m_DrawCallStats.m_Submitted++;
 	FlushVerticesTex3D();
 	m_Drawing = 0;
 }
@@ -879,6 +924,7 @@ void CGraphics_Threaded::TrianglesBegin()
 {
 	dbg_assert(m_Drawing == 0, "called Graphics()->TrianglesBegin twice");
 	m_Drawing = DRAWING_TRIANGLES;
+	ContinuePendingVertices();
 
 	QuadsSetSubset(0, 0, 1, 1);
 	QuadsSetRotation(0);
@@ -888,13 +934,14 @@ void CGraphics_Threaded::TrianglesBegin()
 void CGraphics_Threaded::TrianglesEnd()
 {
 	dbg_assert(m_Drawing == DRAWING_TRIANGLES, "called Graphics()->TrianglesEnd without begin");
-	FlushVertices();
-	m_Drawing = 0;
+	EndVertices();
 }
 
 void CGraphics_Threaded::QuadsEndKeepVertices()
 {
 	dbg_assert(m_Drawing == DRAWING_QUADS, "called Graphics()->QuadsEndKeepVertices without begin");
+	if(m_NumVertices > 0)
+		m_DrawCallStats.m_Submitted++;
 	FlushVertices(true);
 	m_Drawing = 0;
 }
@@ -902,6 +949,8 @@ void CGraphics_Threaded::QuadsEndKeepVertices()
 void CGraphics_Threaded::QuadsDrawCurrentVertices(bool KeepVertices)
 {
 	m_Drawing = DRAWING_QUADS;
+	if(m_NumVertices > 0)
+		m_DrawCallStats.m_Submitted++;
 	FlushVertices(KeepVertices);
 	m_Drawing = 0;
 }
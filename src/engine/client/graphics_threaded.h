@@ -208,6 +208,16 @@ public:
 		int m_ClipY;
 		int m_ClipW;
 		int m_ClipH;
+
+		bool operator==(const SState &Other) const
+		{
+			return m_BlendMode == Other.m_BlendMode && m_WrapMode == Other.m_WrapMode && m_Texture == Other.m_Texture &&
+			       m_ScreenTL.x == Other.m_ScreenTL.x && m_ScreenTL.y == Other.m_ScreenTL.y &&
+			       m_ScreenBR.x == Other.m_ScreenBR.x && m_ScreenBR.y == Other.m_ScreenBR.y &&
+			       m_ClipEnable == Other.m_ClipEnable &&
+			       (!m_ClipEnable || (m_ClipX == Other.m_ClipX && m_ClipY == Other.m_ClipY && m_ClipW == Other.m_ClipW && m_ClipH == Other.m_ClipH));
+		}
+		bool operator!=(const SState &Other) const { return !(*this == Other); }
 	};
 
 	struct SCommand_Clear : public SCommand
@@ -813,6 +823,12 @@ class CGraphics_Threaded : public IEngineGraphics
 
 	float m_Rotation;
 	int m_Drawing;
+	// The vertices of an ended draw are not flushed right away, so that the
+	// next draw with the same state can append to them. They are flushed
+	// before any other command is added.
+	int m_PendingDrawing;
+	CCommandBuffer::SState m_PendingState;
+	SDrawCallStats m_DrawCallStats;
 	bool m_DoScreenshot;
 	char m_aScreenshotName[IO_MAX_PATH_LENGTH];
 
@@ -906,6 +922,10 @@ class CGraphics_Threaded : public IEngineGraphics
 	void AddCmd(
 		TName &Cmd, std::function<bool()> FailFunc = [] { return true; })
 	{
+		// keep the order of the commands
+		if(m_PendingDrawing)
+			FlushPendingVertices();
+
 		if(m_pCommandBuffer->AddCommandUnsafe(Cmd))
 			return;
 
@@ -954,6 +974,8 @@ public:
 	uint64_t StreamedMemoryUsage() const override;
 	uint64_t StagingMemoryUsage() const override;
 
+	SDrawCallStats DrawCallStats() const override { return m_DrawCallStats; }
+
 	const TTWGraphicsGPUList &GetGPUs() const override;
 
 	void MapScreen(float TopLeftX, float TopLeftY, float BottomRightX, float BottomRightY) override;
@@ -1209,10 +1231,14 @@ public:
 		});
 
 		m_pCommandBuffer->AddRenderCalls(1);
+		m_DrawCallStats.m_Drawn++;
 	}
 
 	void FlushVertices(bool KeepVertices = false) override;
 	void FlushVerticesTex3D() override;
+	void FlushPendingVertices();
+	void ContinuePendingVertices();
+	void EndVertices();
 
 	void RenderTileLayer(int BufferContainerIndex, const ColorRGBA &Color, char **pOffsets, unsigned int *pIndicedVertexDrawNum, size_t NumIndicesOffset) override;
 	void RenderBorderTiles(int BufferContainerIndex, const ColorRGBA &Color, char *pIndexBufferOffset, const vec2 &Offset, const vec2 &Dir, int JumpIndex, unsigned int DrawNum) override;
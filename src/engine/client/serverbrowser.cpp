@@ -75,6 +75,10 @@ CServerBrowser::CServerBrowser()
 	m_Sorthash = 0;
 	m_aFilterString[0] = '\0';
 	m_aFilterGametypeString[0] = '\0';
+	m_aExcludeString[0] = '\0';
+	m_aFilterServerAddress[0] = '\0';
+	m_FilterCountryIndex = -1;
+	m_aFoldedFilterGametype[0] = '\0';
 
 	m_ServerlistType = 0;
 	m_BroadcastTime = 0;
@@ -262,164 +266,244 @@ bool CServerBrowser::SortCompareNumPlayersAndPing(int Index1, int Index2) const
 		return pIndex1->m_Info.m_Latency > pIndex2->m_Info.m_Latency;
 }
 
-void CServerBrowser::Filter()
+int CServerBrowser::FoldSearchKey(const char *pStr, char *pOut)
 {
-	m_NumSortedServers = 0;
+	int Size = 0;
+	char aEncoded[4];
+	while(int Code = str_utf8_decode(&pStr))
+	{
+		const int Length = str_utf8_encode(aEncoded, Code < 0 ? 0xFFFD : str_utf8_tolower(Code));
+		if(pOut)
+			mem_copy(pOut + Size, aEncoded, Length);
+		Size += Length;
+	}
+	if(pOut)
+		pOut[Size] = '\0';
+	return Size + 1;
+}
 
-	// allocate the sorted list
-	if(m_NumSortedServersCapacity < m_NumServers)
+static const char *NextSearchKey(const char *pKey)
+{
+	return pKey + str_length(pKey) + 1;
+}
+
+void CServerBrowser::ParseSearchTokens(const char *pStr, std::vector<CSearchToken> &vTokens)
+{
+	vTokens.clear();
+	char aToken[sizeof(g_Config.m_BrFilterString)];
+	while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aToken, sizeof(aToken))))
 	{
-		free(m_pSortedServerlist);
-		m_NumSortedServersCapacity = m_NumServers;
-		m_pSortedServerlist = (int *)calloc(m_NumSortedServersCapacity, sizeof(int));
+		if(aToken[0] == '\0')
+		{
+			continue;
+		}
+		CSearchToken Token;
+		const int Length = str_length(aToken);
+		Token.m_Exact = aToken[0] == '"' && aToken[Length - 1] == '"';
+		if(Token.m_Exact)
+		{
+			aToken[Length - 1] = '\0';
+			str_copy(Token.m_aStr, &aToken[1]);
+		}
+		else
+		{
+			char aFolded[sizeof(aToken) * 2];
+			FoldSearchKey(aToken, aFolded);
+			str_copy(Token.m_aStr, aFolded);
+		}
+		vTokens.push_back(Token);
 	}
+}
 
-	// filter the servers
-	for(int i = 0; i < m_NumServers; i++)
+bool CServerBrowser::MatchesToken(const CSearchToken &Token, const char *pStr, const char *pFoldedStr)
+{
+	if(Token.m_Exact)
+		return str_comp(pStr, Token.m_aStr) == 0;
+	return str_find(pFoldedStr, Token.m_aStr) != nullptr;
+}
+
+void CServerBrowser::UpdateSearchKeys(CServerEntry *pEntry)
+{
+	const CServerInfo &Info = pEntry->m_Info;
+	const int NumClients = minimum(Info.m_NumClients, (int)MAX_CLIENTS);
+
+	int Size = FoldSearchKey(Info.m_aName, nullptr) + FoldSearchKey(Info.m_aMap, nullptr) + FoldSearchKey(Info.m_aGameType, nullptr);
+	for(int p = 0; p < NumClients; p++)
+		Size += FoldSearchKey(Info.m_aClients[p].m_aName, nullptr) + FoldSearchKey(Info.m_aClients[p].m_aClan, nullptr);
+
+	// the heap is only reset on refresh, reuse the keys of the previous info
+	// and only allocate when they grow
+	if(Size > pEntry->m_SearchKeysCapacity)
 	{
-		bool Filtered = false;
+		pEntry->m_SearchKeysCapacity = maximum(Size, pEntry->m_SearchKeysCapacity * 2);
+		pEntry->m_pSearchKeys = (char *)m_ServerlistHeap.Allocate(pEntry->m_SearchKeysCapacity, 1);
+	}
+	char *pKey = pEntry->m_pSearchKeys;
+	pKey += FoldSearchKey(Info.m_aName, pKey);
+	pKey += FoldSearchKey(Info.m_aMap, pKey);
+	pKey += FoldSearchKey(Info.m_aGameType, pKey);
+	for(int p = 0; p < NumClients; p++)
+	{
+		pKey += FoldSearchKey(Info.m_aClients[p].m_aName, pKey);
+		pKey += FoldSearchKey(Info.m_aClients[p].m_aClan, pKey);
+	}
+}
 
-		if(g_Config.m_BrFilterEmpty && m_ppServerlist[i]->m_Info.m_NumFilteredPlayers == 0)
-			Filtered = true;
-		else if(g_Config.m_BrFilterFull && Players(m_ppServerlist[i]->m_Info) == Max(m_ppServerlist[i]->m_Info))
-			Filtered = true;
-		else if(g_Config.m_BrFilterPw && m_ppServerlist[i]->m_Info.m_Flags & SERVER_FLAG_PASSWORD)
-			Filtered = true;
-		else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(m_ppServerlist[i]->m_Info.m_aAddress, g_Config.m_BrFilterServerAddress))
-			Filtered = true;
-		else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(m_ppServerlist[i]->m_Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = true;
-		else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_utf8_find_nocase(m_ppServerlist[i]->m_Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = true;
-		else if(g_Config.m_BrFilterUnfinishedMap && m_ppServerlist[i]->m_Info.m_HasRank == 1)
-			Filtered = true;
-		else
+void CServerBrowser::PrepareFilter()
+{
+	ParseSearchTokens(g_Config.m_BrFilterString, m_vFilterTokens);
+	ParseSearchTokens(g_Config.m_BrExcludeString, m_vExcludeTokens);
+	FoldSearchKey(g_Config.m_BrFilterGametype, m_aFoldedFilterGametype);
+
+	str_copy(m_aFilterGametypeString, g_Config.m_BrFilterGametype);
+	str_copy(m_aFilterString, g_Config.m_BrFilterString);
+	str_copy(m_aExcludeString, g_Config.m_BrExcludeString);
+	str_copy(m_aFilterServerAddress, g_Config.m_BrFilterServerAddress);
+	m_FilterCountryIndex = g_Config.m_BrFilterCountryIndex;
+}
+
+bool CServerBrowser::FilterChanged() const
+{
+	return str_comp(m_aFilterString, g_Config.m_BrFilterString) != 0 ||
+	       str_comp(m_aFilterGametypeString, g_Config.m_BrFilterGametype) != 0 ||
+	       str_comp(m_aExcludeString, g_Config.m_BrExcludeString) != 0 ||
+	       str_comp(m_aFilterServerAddress, g_Config.m_BrFilterServerAddress) != 0 ||
+	       m_FilterCountryIndex != g_Config.m_BrFilterCountryIndex;
+}
+
+bool CServerBrowser::FilterEntry(CServerEntry *pEntry)
+{
+	CServerInfo &Info = pEntry->m_Info;
+	const char *pFoldedName = pEntry->m_pSearchKeys;
+	const char *pFoldedMap = NextSearchKey(pFoldedName);
+	const char *pFoldedGameType = NextSearchKey(pFoldedMap);
+	const char *pFoldedClients = NextSearchKey(pFoldedGameType);
+
+	bool Filtered = false;
+
+	if(g_Config.m_BrFilterEmpty && Info.m_NumFilteredPlayers == 0)
+		Filtered = true;
+	else if(g_Config.m_BrFilterFull && Players(Info) == Max(Info))
+		Filtered = true;
+	else if(g_Config.m_BrFilterPw && Info.m_Flags & SERVER_FLAG_PASSWORD)
+		Filtered = true;
+	else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(Info.m_aAddress, g_Config.m_BrFilterServerAddress))
+		Filtered = true;
+	else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
+		Filtered = true;
+	else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_find(pFoldedGameType, m_aFoldedFilterGametype))
+		Filtered = true;
+	else if(g_Config.m_BrFilterUnfinishedMap && Info.m_HasRank == 1)
+		Filtered = true;
+	else
+	{
+		if(g_Config.m_BrFilterCountry)
 		{
-			if(g_Config.m_BrFilterCountry)
+			Filtered = true;
+			// match against player country
+			for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
 			{
-				Filtered = true;
-				// match against player country
-				for(int p = 0; p < minimum(m_ppServerlist[i]->m_Info.m_NumClients, (int)MAX_CLIENTS); p++)
+				if(Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
 				{
-					if(m_ppServerlist[i]->m_Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
-					{
-						Filtered = false;
-						break;
-					}
+					Filtered = false;
+					break;
 				}
 			}
+		}
 
-			if(!Filtered && g_Config.m_BrFilterString[0] != '\0')
-			{
-				m_ppServerlist[i]->m_Info.m_QuickSearchHit = 0;
+		if(!Filtered && g_Config.m_BrFilterString[0] != '\0')
+		{
+			Info.m_QuickSearchHit = 0;
 
-				const char *pStr = g_Config.m_BrFilterString;
-				char aFilterStr[sizeof(g_Config.m_BrFilterString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aFilterStr, sizeof(aFilterStr))))
+			for(const auto &Token : m_vFilterTokens)
+			{
+				// match against server name
+				if(MatchesToken(Token, Info.m_aName, pFoldedName))
 				{
-					if(aFilterStr[0] == '\0')
-					{
-						continue;
-					}
-					auto MatchesFn = matchesPart;
-					const int FilterLen = str_length(aFilterStr);
-					if(aFilterStr[0] == '"' && aFilterStr[FilterLen - 1] == '"')
-					{
-						aFilterStr[FilterLen - 1] = '\0';
-						MatchesFn = matchesExactly;
-					}
-
-					// match against server name
-					if(MatchesFn(m_ppServerlist[i]->m_Info.m_aName, aFilterStr))
-					{
-						m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
-					}
+					Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
+				}
 
-					// match against players
-					for(int p = 0; p < minimum(m_ppServerlist[i]->m_Info.m_NumClients, (int)MAX_CLIENTS); p++)
+				// match against players
+				const char *pFoldedClient = pFoldedClients;
+				for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
+				{
+					const char *pFoldedClan = NextSearchKey(pFoldedClient);
+					const bool Matches = MatchesToken(Token, Info.m_aClients[p].m_aName, pFoldedClient) ||
+							     MatchesToken(Token, Info.m_aClients[p].m_aClan, pFoldedClan);
+					pFoldedClient = NextSearchKey(pFoldedClan);
+					if(Matches)
 					{
-						if(MatchesFn(m_ppServerlist[i]->m_Info.m_aClients[p].m_aName, aFilterStr) ||
-							MatchesFn(m_ppServerlist[i]->m_Info.m_aClients[p].m_aClan, aFilterStr))
+						if(g_Config.m_BrFilterConnectingPlayers &&
+							str_comp(Info.m_aClients[p].m_aName, "(connecting)") == 0 &&
+							Info.m_aClients[p].m_aClan[0] == '\0')
 						{
-							if(g_Config.m_BrFilterConnectingPlayers &&
-								str_comp(m_ppServerlist[i]->m_Info.m_aClients[p].m_aName, "(connecting)") == 0 &&
-								m_ppServerlist[i]->m_Info.m_aClients[p].m_aClan[0] == '\0')
-							{
-								continue;
-							}
-							m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
-							break;
+							continue;
 						}
-					}
-
-					// match against map
-					if(MatchesFn(m_ppServerlist[i]->m_Info.m_aMap, aFilterStr))
-					{
-						m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
+						Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
+						break;
 					}
 				}
 
-				if(!m_ppServerlist[i]->m_Info.m_QuickSearchHit)
-					Filtered = true;
-			}
-
-			if(!Filtered && g_Config.m_BrExcludeString[0] != '\0')
-			{
-				const char *pStr = g_Config.m_BrExcludeString;
-				char aExcludeStr[sizeof(g_Config.m_BrExcludeString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aExcludeStr, sizeof(aExcludeStr))))
+				// match against map
+				if(MatchesToken(Token, Info.m_aMap, pFoldedMap))
 				{
-					if(aExcludeStr[0] == '\0')
-					{
-						continue;
-					}
-					auto MatchesFn = matchesPart;
-					const int FilterLen = str_length(aExcludeStr);
-					if(aExcludeStr[0] == '"' && aExcludeStr[FilterLen - 1] == '"')
-					{
-						aExcludeStr[FilterLen - 1] = '\0';
-						MatchesFn = matchesExactly;
-					}
-
-					// match against server name
-					if(MatchesFn(m_ppServerlist[i]->m_Info.m_aName, aExcludeStr))
-					{
-						Filtered = true;
-						break;
-					}
-
-					// match against map
-					if(MatchesFn(m_ppServerlist[i]->m_Info.m_aMap, aExcludeStr))
-					{
-						Filtered = true;
-						break;
-					}
-
-					// match against gametype
-					if(MatchesFn(m_ppServerlist[i]->m_Info.m_aGameType, aExcludeStr))
-					{
-						Filtered = true;
-						break;
-					}
+					Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
 				}
 			}
+
+			if(!Info.m_QuickSearchHit)
+				Filtered = true;
 		}
 
-		if(!Filtered)
+		if(!Filtered && g_Config.m_BrExcludeString[0] != '\0')
 		{
-			// check for friend
-			m_ppServerlist[i]->m_Info.m_FriendState = IFriends::FRIEND_NO;
-			for(int p = 0; p < minimum(m_ppServerlist[i]->m_Info.m_NumClients, (int)MAX_CLIENTS); p++)
+			for(const auto &Token : m_vExcludeTokens)
 			{
-				m_ppServerlist[i]->m_Info.m_aClients[p].m_FriendState = m_pFriends->GetFriendState(m_ppServerlist[i]->m_Info.m_aClients[p].m_aName,
-					m_ppServerlist[i]->m_Info.m_aClients[p].m_aClan);
-				m_ppServerlist[i]->m_Info.m_FriendState = maximum(m_ppServerlist[i]->m_Info.m_FriendState, m_ppServerlist[i]->m_Info.m_aClients[p].m_FriendState);
+				// match against server name, map and gametype
+				if(MatchesToken(Token, Info.m_aName, pFoldedName) ||
+					MatchesToken(Token, Info.m_aMap, pFoldedMap) ||
+					MatchesToken(Token, Info.m_aGameType, pFoldedGameType))
+				{
+					Filtered = true;
+					break;
+				}
 			}
-
-			if(!g_Config.m_BrFilterFriends || m_ppServerlist[i]->m_Info.m_FriendState != IFriends::FRIEND_NO)
-				m_pSortedServerlist[m_NumSortedServers++] = i;
 		}
 	}
+
+	if(Filtered)
+		return false;
+
+	// check for friend
+	Info.m_FriendState = IFriends::FRIEND_NO;
+	for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
+	{
+		Info.m_aClients[p].m_FriendState = m_pFriends->GetFriendState(Info.m_aClients[p].m_aName, Info.m_aClients[p].m_aClan);
+		Info.m_FriendState = maximum(Info.m_FriendState, Info.m_aClients[p].m_FriendState);
+	}
+
+	return !g_Config.m_BrFilterFriends || Info.m_FriendState != IFriends::FRIEND_NO;
+}
+
+void CServerBrowser::Filter()
+{
+	m_NumSortedServers = 0;
+
+	// allocate the sorted list
+	if(m_NumSortedServersCapacity < m_NumServers)
+	{
+		free(m_pSortedServerlist);
+		m_NumSortedServersCapacity = m_NumServers;
+		m_pSortedServerlist = (int *)calloc(m_NumSortedServersCapacity, sizeof(int));
+	}
+
+	// filter the servers
+	PrepareFilter();
+	for(int i = 0; i < m_NumServers; i++)
+	{
+		if(FilterEntry(m_ppServerlist[i]))
+			m_pSortedServerlist[m_NumSortedServers++] = i;
+	}
 }
 
 int CServerBrowser::SortHash() const
@@ -451,36 +535,109 @@ void UpdateFilteredPlayers(CServerInfo &Item)
 	}
 }
 
+CServerBrowser::FSortCompare CServerBrowser::SortCompareFunc() const
+{
+	if(g_Config.m_BrSortOrder == 2 && (g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS || g_Config.m_BrSort == IServerBrowser::SORT_PING))
+		return &CServerBrowser::SortCompareNumPlayersAndPing;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_NAME)
+		return &CServerBrowser::SortCompareName;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_PING)
+		return &CServerBrowser::SortComparePing;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_MAP)
+		return &CServerBrowser::SortCompareMap;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS)
+		return &CServerBrowser::SortCompareNumPlayers;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_GAMETYPE)
+		return &CServerBrowser::SortCompareGametype;
+	return nullptr;
+}
+
 void CServerBrowser::Sort()
 {
 	// fill m_NumFilteredPlayers
 	for(int i = 0; i < m_NumServers; i++)
 	{
 		UpdateFilteredPlayers(m_ppServerlist[i]->m_Info);
+		m_ppServerlist[i]->m_Dirty = false;
 	}
+	m_vDirtyServers.clear();
 
 	// create filtered list
 	Filter();
 
 	// sort
-	if(g_Config.m_BrSortOrder == 2 && (g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS || g_Config.m_BrSort == IServerBrowser::SORT_PING))
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumPlayersAndPing));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NAME)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareName));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_PING)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortComparePing));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_MAP)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareMap));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumPlayers));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_GAMETYPE)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareGametype));
+	FSortCompare pfnCompare = SortCompareFunc();
+	if(pfnCompare)
+		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, pfnCompare));
 
-	str_copy(m_aFilterGametypeString, g_Config.m_BrFilterGametype);
-	str_copy(m_aFilterString, g_Config.m_BrFilterString);
 	m_Sorthash = SortHash();
 }
 
+void CServerBrowser::MarkDirty(CServerEntry *pEntry)
+{
+	if(pEntry->m_Dirty)
+		return;
+	pEntry->m_Dirty = true;
+	m_vDirtyServers.push_back(pEntry->m_Info.m_ServerIndex);
+}
+
+void CServerBrowser::SortDirty()
+{
+	// with many changed entries a full sort is cheaper than moving them one by one
+	if((int)m_vDirtyServers.size() > m_NumServers / 4)
+	{
+		Sort();
+		return;
+	}
+
+	if(m_NumSortedServersCapacity < m_NumServers)
+	{
+		int *pNewList = (int *)calloc(m_NumServers, sizeof(int));
+		if(m_NumSortedServers > 0)
+			mem_copy(pNewList, m_pSortedServerlist, m_NumSortedServers * sizeof(int));
+		free(m_pSortedServerlist);
+		m_pSortedServerlist = pNewList;
+		m_NumSortedServersCapacity = m_NumServers;
+	}
+
+	// ties are broken by the server index, which yields the same order as
+	// the stable sort of the list that is filled in index order
+	CSortWrap Compare(this, SortCompareFunc());
+	const bool Sorted = SortCompareFunc() != nullptr;
+	auto &&Less = [&](int Index1, int Index2) {
+		if(!Sorted)
+			return Index1 < Index2;
+		if(Compare(Index1, Index2))
+			return true;
+		return !Compare(Index2, Index1) && Index1 < Index2;
+	};
+
+	for(int Index : m_vDirtyServers)
+	{
+		CServerEntry *pEntry = m_ppServerlist[Index];
+		pEntry->m_Dirty = false;
+		UpdateFilteredPlayers(pEntry->m_Info);
+
+		int *pEnd = m_pSortedServerlist + m_NumSortedServers;
+		int *pOld = std::find(m_pSortedServerlist, pEnd, Index);
+		if(pOld != pEnd)
+		{
+			std::copy(pOld + 1, pEnd, pOld);
+			m_NumSortedServers--;
+			pEnd--;
+		}
+
+		if(!FilterEntry(pEntry))
+			continue;
+
+		int *pNew = std::lower_bound(m_pSortedServerlist, pEnd, Index, Less);
+		std::copy_backward(pNew, pEnd, pEnd + 1);
+		*pNew = Index;
+		m_NumSortedServers++;
+	}
+	m_vDirtyServers.clear();
+}
+
 void CServerBrowser::RemoveRequest(CServerEntry *pEntry)
 {
 	if(pEntry->m_pPrevReq || pEntry->m_pNextReq || m_pFirstReqServer == pEntry)
@@ -619,6 +776,7 @@ void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info)
 	std::sort(pEntry->m_Info.m_aClients, pEntry->m_Info.m_aClients + Info.m_NumReceivedClients, CPlayerScoreNameLess(pEntry->m_Info.m_ClientScoreKind));
 
 	pEntry->m_GotInfo = 1;
+	UpdateSearchKeys(pEntry);
 }
 
 void CServerBrowser::SetLatency(NETADDR Addr, int Latency)
@@ -654,6 +812,7 @@ void CServerBrowser::SetLatency(NETADDR Addr, int Latency)
 		}
 		m_ppServerlist[i]->m_Info.m_Latency = Ping;
 		m_ppServerlist[i]->m_Info.m_LatencyIsEstimated = false;
+		MarkDirty(m_ppServerlist[i]);
 	}
 }
 
@@ -724,6 +883,7 @@ CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR *pAddrs, int Num
 	pEntry->m_Info.m_ServerIndex = m_NumServers;
 	m_NumServers++;
 
+	UpdateSearchKeys(pEntry);
 	return pEntry;
 }
 
@@ -799,7 +959,7 @@ void CServerBrowser::OnServerInfoUpdate(const NETADDR &Addr, int Token, const CS
 		pEntry->m_RequestTime = -1; // Request has been answered
 	}
 	RemoveRequest(pEntry);
-	RequestResort();
+	MarkDirty(pEntry);
 }
 
 void CServerBrowser::Refresh(int Type)
@@ -846,6 +1006,8 @@ void CServerBrowser::Refresh(int Type)
 	}
 	else if(Type == IServerBrowser::TYPE_FAVORITES || Type == IServerBrowser::TYPE_INTERNET || Type == IServerBrowser::TYPE_DDNET || Type == IServerBrowser::TYPE_KOG)
 	{
+		if(!m_RefreshingHttp)
+			m_HttpRefreshVersion = m_pHttp->ServerListVersion();
 		m_pHttp->Refresh();
 		m_pPingCache->Load();
 		m_RefreshingHttp = true;
@@ -853,7 +1015,8 @@ void CServerBrowser::Refresh(int Type)
 		if(ServerListTypeChanged && m_pHttp->NumServers() > 0)
 		{
 			CleanUp();
-			UpdateFromHttp();
+			UpdateFromHttp(0, true);
+			m_HttpServerListVersion = -1;
 			Sort();
 		}
 	}
@@ -924,7 +1087,7 @@ void CServerBrowser::SetCurrentServerPing(const NETADDR &Addr, int Ping)
 	SetLatency(Addr, minimum(Ping, 999));
 }
 
-void CServerBrowser::UpdateFromHttp()
+void CServerBrowser::UpdateFromHttp(int FirstServer, bool Complete)
 {
 	int OwnLocation;
 	if(str_comp(g_Config.m_BrLocation, "auto") == 0)
@@ -1002,7 +1165,7 @@ void CServerBrowser::UpdateFromHttp()
 			};
 		}
 	}
-	for(int i = 0; i < NumServers; i++)
+	for(int i = FirstServer; i < NumServers; i++)
 	{
 		CServerInfo Info = m_pHttp->Server(i);
 		if(!Want(Info.m_aAddresses, Info.m_NumAddresses))
@@ -1023,7 +1186,13 @@ void CServerBrowser::UpdateFromHttp()
 		CServerEntry *pEntry = Add(Info.m_aAddresses, Info.m_NumAddresses);
 		SetInfo(pEntry, Info);
 		pEntry->m_RequestIgnoreInfo = true;
+		if(!Complete)
+			MarkDirty(pEntry);
 	}
+	m_NumHttpServersAdded = NumServers;
+	if(!Complete)
+		return;
+
 	for(int i = 0; i < NumLegacyServers; i++)
 	{
 		NETADDR Addr = m_pHttp->LegacyServer(i);
@@ -1072,6 +1241,7 @@ void CServerBrowser::CleanUp()
 	m_ServerlistHeap.Reset();
 	m_NumServers = 0;
 	m_NumSortedServers = 0;
+	m_vDirtyServers.clear();
 	m_ByAddr.clear();
 	m_pFirstReqServer = nullptr;
 	m_pLastReqServer = nullptr;
@@ -1093,14 +1263,38 @@ void CServerBrowser::Update()
 
 	m_pHttp->Update();
 
-	if(m_ServerlistType != TYPE_LAN && m_RefreshingHttp && !m_pHttp->IsRefreshing())
+	if(m_ServerlistType != TYPE_LAN && m_RefreshingHttp)
 	{
-		m_RefreshingHttp = false;
-		CleanUp();
-		UpdateFromHttp();
-		// TODO: move this somewhere else
-		Sort();
-		return;
+		const int Version = m_pHttp->ServerListVersion();
+		const bool Streamed = Version != m_HttpRefreshVersion && Version == m_HttpServerListVersion;
+		if(!m_pHttp->IsRefreshing())
+		{
+			m_RefreshingHttp = false;
+			// only the rest of a list that was added while it was received
+			// is missing, otherwise it replaces everything
+			if(!Streamed)
+			{
+				CleanUp();
+				m_NumHttpServersAdded = 0;
+			}
+			UpdateFromHttp(m_NumHttpServersAdded, true);
+			m_HttpServerListVersion = -1;
+			// TODO: move this somewhere else
+			Sort();
+			return;
+		}
+		if(Version != m_HttpRefreshVersion && m_pHttp->NumServers() > 0)
+		{
+			if(!Streamed)
+			{
+				// first batch of the new list
+				CleanUp();
+				m_HttpServerListVersion = Version;
+				m_NumHttpServersAdded = 0;
+			}
+			if(m_pHttp->NumServers() > m_NumHttpServersAdded)
+				UpdateFromHttp(m_NumHttpServersAdded, false);
+		}
 	}
 
 	CServerEntry *pEntry = m_pFirstReqServer;
@@ -1169,6 +1363,13 @@ void CServerBrowser::Update()
 		Sort();
 		m_NeedResort = false;
 	}
+	else if(!m_vDirtyServers.empty())
+	{
+		if(FilterChanged())
+			Sort();
+		else
+			SortDirty();
+	}
 }
 
 void CServerBrowser::LoadDDNetServers()
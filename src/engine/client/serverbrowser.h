@@ -34,6 +34,13 @@ public:
 		int m_GotInfo;
 		CServerInfo m_Info;
 
+		// case-folded copies of the strings the search matches against:
+		// name, map and game type, then name and clan of every client
+		char *m_pSearchKeys;
+		int m_SearchKeysCapacity;
+		// the info changed since the last time the entry was filtered
+		bool m_Dirty;
+
 		CServerEntry *m_pPrevReq; // request list
 		CServerEntry *m_pNextReq;
 	};
@@ -96,6 +103,20 @@ public:
 	int GetCurrentType() override { return m_ServerlistType; }
 	bool IsRegistered(const NETADDR &Addr);
 
+	class CSearchToken
+	{
+	public:
+		// case-folded for substring matches, the quoted string without the
+		// leading quote for exact matches
+		char m_aStr[sizeof(g_Config.m_BrFilterString) * 2];
+		bool m_Exact;
+	};
+	// writes the case-folded string to pOut if it is not null, returns the
+	// size of the folded string including the terminator
+	static int FoldSearchKey(const char *pStr, char *pOut);
+	static void ParseSearchTokens(const char *pStr, std::vector<CSearchToken> &vTokens);
+	static bool MatchesToken(const CSearchToken &Token, const char *pStr, const char *pFoldedStr);
+
 private:
 	CNetClient *m_pNetClient = nullptr;
 	IConsole *m_pConsole = nullptr;
@@ -106,6 +127,11 @@ private:
 	char m_aNetVersion[128];
 
 	bool m_RefreshingHttp = false;
+	// version of the HTTP server list when the refresh started, and of the
+	// list whose first m_NumHttpServersAdded servers were already added
+	int m_HttpRefreshVersion = -1;
+	int m_HttpServerListVersion = -1;
+	int m_NumHttpServersAdded = 0;
 	IServerBrowserHttp *m_pHttp = nullptr;
 	IServerBrowserPingCache *m_pPingCache = nullptr;
 	const char *m_pHttpPrevBestUrl = nullptr;
@@ -125,6 +151,9 @@ private:
 	int m_NumRequests;
 
 	bool m_NeedResort;
+	// entries whose info changed, they are re-filtered and re-positioned
+	// without sorting the whole list
+	std::vector<int> m_vDirtyServers;
 
 	// used instead of g_Config.br_max_requests to get more servers
 	int m_CurrentMaxRequests;
@@ -135,8 +164,15 @@ private:
 	int m_NumServerCapacity;
 
 	int m_Sorthash;
-	char m_aFilterString[64];
-	char m_aFilterGametypeString[128];
+	char m_aFilterString[sizeof(g_Config.m_BrFilterString)];
+	char m_aFilterGametypeString[sizeof(g_Config.m_BrFilterGametype)];
+	char m_aExcludeString[sizeof(g_Config.m_BrExcludeString)];
+	char m_aFilterServerAddress[sizeof(g_Config.m_BrFilterServerAddress)];
+	int m_FilterCountryIndex;
+
+	std::vector<CSearchToken> m_vFilterTokens;
+	std::vector<CSearchToken> m_vExcludeTokens;
+	char m_aFoldedFilterGametype[sizeof(g_Config.m_BrFilterGametype) * 2];
 
 	int m_ServerlistType;
 	int64_t m_BroadcastTime;
@@ -155,14 +191,25 @@ private:
 	bool SortCompareNumClients(int Index1, int Index2) const;
 	bool SortCompareNumPlayersAndPing(int Index1, int Index2) const;
 
+	typedef bool (CServerBrowser::*FSortCompare)(int Index1, int Index2) const;
+	FSortCompare SortCompareFunc() const;
+
 	//
+	void PrepareFilter();
+	bool FilterEntry(CServerEntry *pEntry);
 	void Filter();
 	void Sort();
+	void SortDirty();
+	bool FilterChanged() const;
 	int SortHash() const;
+	void MarkDirty(CServerEntry *pEntry);
+	void UpdateSearchKeys(CServerEntry *pEntry);
 
 	void CleanUp();
 
-	void UpdateFromHttp();
+	// adds the HTTP servers starting at FirstServer, the legacy servers and
+	// favorites are only added once the list is complete
+	void UpdateFromHttp(int FirstServer, bool Complete);
 	CServerEntry *Add(const NETADDR *pAddrs, int NumAddrs);
 
 	void RemoveRequest(CServerEntry *pEntry);
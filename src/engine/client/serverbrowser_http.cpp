@@ -13,6 +13,8 @@
 #include <base/lock_scope.h>
 #include <base/system.h>
 
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <vector>
 
@@ -23,7 +25,7 @@ using namespace std::chrono_literals;
 class CChooseMaster
 {
 public:
-	typedef bool (*VALIDATOR)(json_value *pJson);
+	typedef bool (*VALIDATOR)(const unsigned char *pData, size_t DataSize);
 
 	enum
 	{
@@ -208,14 +210,10 @@ void CChooseMaster::CJob::Run()
 		{
 			continue;
 		}
-		json_value *pJson = pGet->ResultJson();
-		if(!pJson)
-		{
-			continue;
-		}
-		bool ParseFailure = m_pData->m_pfnValidator(pJson);
-		json_value_free(pJson);
-		if(ParseFailure)
+		unsigned char *pResult;
+		size_t ResultLength;
+		pGet->Result(&pResult, &ResultLength);
+		if(!pResult || m_pData->m_pfnValidator(pResult, ResultLength))
 		{
 			continue;
 		}
@@ -256,6 +254,10 @@ public:
 	void Refresh() override;
 	bool GetBestUrl(const char **pBestUrl) const override { return m_pChooseMaster->GetBestUrl(pBestUrl); }
 
+	int ServerListVersion() const override
+	{
+		return m_ServerListVersion;
+	}
 	int NumServers() const override
 	{
 		return m_vServers.size();
@@ -282,18 +284,44 @@ private:
 		STATE_NO_MASTER,
 	};
 
-	static bool Validate(json_value *pJson);
-	static bool Parse(json_value *pJson, std::vector<CServerInfo> *pvServers, std::vector<NETADDR> *pvLegacyServers);
+	class CGetServers : public CHttpRequest
+	{
+		CServerListParser m_Parser;
+		bool m_Complete = false;
+
+		bool OnStreamData(const char *pData, size_t DataSize) override REQUIRES(!m_Lock);
+		int OnCompletion(int State) override REQUIRES(!m_Lock);
+
+	public:
+		LOCK m_Lock;
+		// parsed servers that were not taken by the main thread yet
+		std::vector<CServerInfo> m_vPending GUARDED_BY(m_Lock);
+		std::vector<NETADDR> m_vLegacyServers GUARDED_BY(m_Lock);
+
+		CGetServers(const char *pUrl) :
+			CHttpRequest(pUrl) { m_Lock = lock_create(); }
+		~CGetServers() { lock_destroy(m_Lock); }
+		// only valid once the request is done
+		bool Complete() const { return m_Complete; }
+	};
+
+	static bool Validate(const unsigned char *pData, size_t DataSize);
+	void TakePendingServers();
 
 	IEngine *m_pEngine;
 	IConsole *m_pConsole;
 
 	int m_State = STATE_DONE;
-	std::shared_ptr<CHttpRequest> m_pGetServers;
+	std::shared_ptr<CGetServers> m_pGetServers;
 	std::unique_ptr<CChooseMaster> m_pChooseMaster;
 
+	int m_ServerListVersion = 0;
+	// the servers of the request in progress have replaced the list
+	bool m_Receiving = false;
 	std::vector<CServerInfo> m_vServers;
 	std::vector<NETADDR> m_vLegacyServers;
+	// the complete list, restored if the request in progress fails
+	std::vector<CServerInfo> m_vPrevServers;
 };
 
 CServerBrowserHttp::CServerBrowserHttp(IEngine *pEngine, IConsole *pConsole, const char **ppUrls, int NumUrls, int PreviousBestIndex) :
@@ -326,27 +354,45 @@ void CServerBrowserHttp::Update()
 			}
 			return;
 		}
-		m_pGetServers = HttpGet(pBestUrl);
+		m_pGetServers = std::make_shared<CGetServers>(pBestUrl);
+		m_pGetServers->StreamResponse();
 		// 10 seconds connection timeout, lower than 8KB/s for 10 seconds to fail.
 		m_pGetServers->Timeout(CTimeout{10000, 0, 8000, 10});
 		m_pEngine->AddJob(m_pGetServers);
+		m_Receiving = false;
 		m_State = STATE_REFRESHING;
 	}
 	else if(m_State == STATE_REFRESHING)
 	{
 		if(m_pGetServers->State() == HTTP_QUEUED || m_pGetServers->State() == HTTP_RUNNING)
 		{
+			TakePendingServers();
 			return;
 		}
 		m_State = STATE_DONE;
-		std::shared_ptr<CHttpRequest> pGetServers = nullptr;
-		std::swap(m_pGetServers, pGetServers);
-
-		bool Success = true;
-		json_value *pJson = pGetServers->ResultJson();
-		Success = Success && pJson;
-		Success = Success && !Parse(pJson, &m_vServers, &m_vLegacyServers);
-		json_value_free(pJson);
+
+		const bool Success = m_pGetServers->State() == HTTP_DONE && m_pGetServers->Complete();
+		if(Success)
+		{
+			TakePendingServers();
+			if(!m_Receiving)
+			{
+				// empty list
+				m_vServers.clear();
+				m_ServerListVersion++;
+			}
+			CLockScope ls(m_pGetServers->m_Lock);
+			m_vLegacyServers = std::move(m_pGetServers->m_vLegacyServers);
+		}
+		else if(m_Receiving)
+		{
+			std::swap(m_vServers, m_vPrevServers);
+			m_ServerListVersion++;
+		}
+		m_vPrevServers.clear();
+		m_Receiving = false;
+		m_pGetServers = nullptr;
+
 		if(!Success)
 		{
 			m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_http", "failed getting serverlist, trying to find best URL");
@@ -355,6 +401,57 @@ void CServerBrowserHttp::Update()
 		}
 	}
 }
+
+void CServerBrowserHttp::TakePendingServers()
+{
+	CLockScope ls(m_pGetServers->m_Lock);
+	if(m_pGetServers->m_vPending.empty())
+	{
+		return;
+	}
+	if(!m_Receiving)
+	{
+		// the first batch replaces the list, keep the old one in case the
+		// request fails
+		m_Receiving = true;
+		std::swap(m_vServers, m_vPrevServers);
+		m_vServers.clear();
+		m_ServerListVersion++;
+	}
+	m_vServers.insert(m_vServers.end(), m_pGetServers->m_vPending.begin(), m_pGetServers->m_vPending.end());
+	m_pGetServers->m_vPending.clear();
+}
+
+bool CServerBrowserHttp::CGetServers::OnStreamData(const char *pData, size_t DataSize)
+{
+	if(!m_Parser.Feed(pData, DataSize))
+	{
+		return false;
+	}
+	if(!m_Parser.m_vServers.empty())
+	{
+		CLockScope ls(m_Lock);
+		if(m_vPending.empty())
+			std::swap(m_vPending, m_Parser.m_vServers);
+		else
+			m_vPending.insert(m_vPending.end(), std::make_move_iterator(m_Parser.m_vServers.begin()), std::make_move_iterator(m_Parser.m_vServers.end()));
+		m_Parser.m_vServers.clear();
+	}
+	return true;
+}
+
+int CServerBrowserHttp::CGetServers::OnCompletion(int State)
+{
+	State = CHttpRequest::OnCompletion(State);
+	m_Complete = State == HTTP_DONE && m_Parser.Finish();
+	if(m_Complete)
+	{
+		CLockScope ls(m_Lock);
+		m_vLegacyServers = std::move(m_Parser.m_vLegacyServers);
+	}
+	return State;
+}
+
 void CServerBrowserHttp::Refresh()
 {
 	if(m_State == STATE_WANTREFRESH || m_State == STATE_REFRESHING || m_State == STATE_NO_MASTER)
@@ -371,96 +468,316 @@ bool ServerbrowserParseUrl(NETADDR *pOut, const char *pUrl)
 {
 	return net_addr_from_url(pOut, pUrl, nullptr, 0) != 0;
 }
-bool CServerBrowserHttp::Validate(json_value *pJson)
+bool CServerBrowserHttp::Validate(const unsigned char *pData, size_t DataSize)
 {
-	std::vector<CServerInfo> vServers;
-	std::vector<NETADDR> vLegacyServers;
-	return Parse(pJson, &vServers, &vLegacyServers);
+	CServerListParser Parser;
+	return !Parser.Feed((const char *)pData, DataSize) || !Parser.Finish();
 }
-bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CServerInfo> *pvServers, std::vector<NETADDR> *pvLegacyServers)
+
+CServerListParser::CArena::~CArena()
 {
-	std::vector<CServerInfo> vServers;
-	std::vector<NETADDR> vLegacyServers;
+	Reset();
+	for(char *pBlock : m_vpBlocks)
+	{
+		free(pBlock);
+	}
+}
 
-	const json_value &Json = *pJson;
-	const json_value &Servers = Json["servers"];
-	const json_value &LegacyServers = Json["servers_legacy"];
-	if(Servers.type != json_array || (LegacyServers.type != json_array && LegacyServers.type != json_none))
+void *CServerListParser::CArena::Allocate(size_t Size)
+{
+	Size = (Size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+	if(Size > BLOCK_SIZE)
 	{
-		return true;
+		m_vpLarge.push_back((char *)malloc(Size));
+		return m_vpLarge.back();
 	}
-	for(unsigned int i = 0; i < Servers.u.array.length; i++)
+	if(m_Block < m_vpBlocks.size() && m_Used + Size > BLOCK_SIZE)
 	{
-		const json_value &Server = Servers[i];
-		const json_value &Addresses = Server["addresses"];
-		const json_value &Info = Server["info"];
-		const json_value &Location = Server["location"];
-		int ParsedLocation = CServerInfo::LOC_UNKNOWN;
-		CServerInfo2 ParsedInfo;
-		if(Addresses.type != json_array || (Location.type != json_string && Location.type != json_none))
+		m_Block++;
+		m_Used = 0;
+	}
+	if(m_Block == m_vpBlocks.size())
+	{
+		m_vpBlocks.push_back((char *)malloc(BLOCK_SIZE));
+		m_Used = 0;
+	}
+	void *pResult = m_vpBlocks[m_Block] + m_Used;
+	m_Used += Size;
+	return pResult;
+}
+
+void CServerListParser::CArena::Reset()
+{
+	for(char *pLarge : m_vpLarge)
+	{
+		free(pLarge);
+	}
+	m_vpLarge.clear();
+	m_Block = 0;
+	m_Used = 0;
+}
+
+void *CServerListParser::JsonAlloc(size_t Size, int Zero, void *pUser)
+{
+	void *pResult = ((CArena *)pUser)->Allocate(Size);
+	if(Zero)
+	{
+		mem_zero(pResult, Size);
+	}
+	return pResult;
+}
+
+bool CServerListParser::Feed(const char *pData, size_t DataSize)
+{
+	for(size_t i = 0; i < DataSize && !m_Error; i++)
+	{
+		m_Error = !ProcessChar(pData[i]);
+	}
+	return !m_Error;
+}
+
+bool CServerListParser::Finish() const
+{
+	return !m_Error && m_Done && m_SeenServers;
+}
+
+bool CServerListParser::ProcessChar(char c)
+{
+	if(m_InElement)
+	{
+		m_vElement.push_back(c);
+	}
+	if(m_InString)
+	{
+		if(m_Escape)
+		{
+			m_Escape = false;
+		}
+		else if(c == '\\')
+		{
+			m_Escape = true;
+		}
+		else if(c == '"')
 		{
+			m_InString = false;
+			if(m_CaptureKey)
+			{
+				m_CaptureKey = false;
+				m_aKey[m_KeyLength] = '\0';
+			}
 			return true;
 		}
-		if(Location.type == json_string)
+		if(m_CaptureKey && m_KeyLength < (int)sizeof(m_aKey) - 1)
 		{
-			if(CServerInfo::ParseLocation(&ParsedLocation, Location))
+			m_aKey[m_KeyLength++] = c;
+		}
+		return true;
+	}
+	if(c == ' ' || c == '\t' || c == '\n' || c == '\r')
+	{
+		return true;
+	}
+	if(m_Done)
+	{
+		return false;
+	}
+
+	// the element of one of the arrays we are interested in is complete
+	const bool ArrayLevel = m_Array != ARRAY_NONE && m_Depth == 2;
+	if(ArrayLevel && (c == ',' || c == ']'))
+	{
+		if(m_InElement)
+		{
+			m_vElement.pop_back();
+			if(!FinishElement())
 			{
-				return true;
+				return false;
 			}
 		}
-		if(CServerInfo2::FromJson(&ParsedInfo, &Info))
+		else if(c == ',')
 		{
-			//dbg_msg("dbg/serverbrowser", "skipped due to info, i=%d", i);
-			// Only skip the current server on parsing
-			// failure; the server info is "user input" by
-			// the game server and can be set to arbitrary
-			// values.
-			continue;
+			return false;
+		}
+		if(c == ']')
+		{
+			m_Array = ARRAY_NONE;
+			m_Depth--;
 		}
-		CServerInfo SetInfo = ParsedInfo;
-		SetInfo.m_Location = ParsedLocation;
-		SetInfo.m_NumAddresses = 0;
-		for(unsigned int a = 0; a < Addresses.u.array.length; a++)
+		return true;
+	}
+	if(ArrayLevel && !m_InElement)
+	{
+		m_InElement = true;
+		m_vElement.clear();
+		m_vElement.push_back(c);
+	}
+
+	switch(c)
+	{
+	case '"':
+		m_InString = true;
+		if(m_Depth == 1 && m_ExpectKey)
+		{
+			m_CaptureKey = true;
+			m_KeyLength = 0;
+		}
+		break;
+	case '{':
+	case '[':
+		if(m_Depth == 0)
 		{
-			const json_value &Address = Addresses[a];
-			if(Address.type != json_string)
+			if(c != '{')
 			{
-				return true;
+				return false;
 			}
-			NETADDR ParsedAddr;
-			if(ServerbrowserParseUrl(&ParsedAddr, Addresses[a]))
+			m_ExpectKey = true;
+		}
+		else if(m_Depth == 1)
+		{
+			if(m_ExpectKey)
 			{
-				//dbg_msg("dbg/serverbrowser", "unknown address, i=%d a=%d", i, a);
-				// Skip unknown addresses.
-				continue;
+				return false;
 			}
-			if(SetInfo.m_NumAddresses < (int)std::size(SetInfo.m_aAddresses))
+			const bool Servers = str_comp(m_aKey, "servers") == 0;
+			const bool LegacyServers = str_comp(m_aKey, "servers_legacy") == 0;
+			if((Servers || LegacyServers) && c != '[')
 			{
-				SetInfo.m_aAddresses[SetInfo.m_NumAddresses] = ParsedAddr;
-				SetInfo.m_NumAddresses += 1;
+				return false;
+			}
+			if(Servers)
+			{
+				m_Array = ARRAY_SERVERS;
+				m_SeenServers = true;
+			}
+			else if(LegacyServers)
+			{
+				m_Array = ARRAY_LEGACY_SERVERS;
 			}
 		}
-		if(SetInfo.m_NumAddresses > 0)
+		m_Depth++;
+		break;
+	case '}':
+	case ']':
+		if(m_Depth == 0)
 		{
-			vServers.push_back(SetInfo);
+			return false;
 		}
-	}
-	if(LegacyServers.type == json_array)
-	{
-		for(unsigned int i = 0; i < LegacyServers.u.array.length; i++)
+		m_Depth--;
+		if(m_Depth == 0)
+		{
+			m_Done = true;
+		}
+		break;
+	case ':':
+		if(m_Depth == 1)
 		{
-			const json_value &Address = LegacyServers[i];
-			NETADDR ParsedAddr;
-			if(Address.type != json_string || net_addr_from_str(&ParsedAddr, Address))
+			if(!m_ExpectKey)
 			{
-				return true;
+				return false;
 			}
-			vLegacyServers.push_back(ParsedAddr);
+			m_ExpectKey = false;
 		}
+		break;
+	case ',':
+		if(m_Depth == 1)
+		{
+			m_ExpectKey = true;
+			m_aKey[0] = '\0';
+		}
+		break;
+	default:
+		// the values of "servers" and "servers_legacy" must be arrays
+		if(m_Depth == 1 && !m_ExpectKey && (str_comp(m_aKey, "servers") == 0 || str_comp(m_aKey, "servers_legacy") == 0))
+		{
+			return false;
+		}
+		break;
 	}
-	*pvServers = vServers;
-	*pvLegacyServers = vLegacyServers;
-	return false;
+	return true;
+}
+
+bool CServerListParser::FinishElement()
+{
+	m_InElement = false;
+
+	json_settings Settings = {};
+	Settings.mem_alloc = JsonAlloc;
+	Settings.mem_free = JsonFree;
+	Settings.user_data = &m_Arena;
+	m_Arena.Reset();
+	char aError[256];
+	const json_value *pJson = json_parse_ex(&Settings, m_vElement.data(), m_vElement.size(), aError);
+	if(!pJson)
+	{
+		return false;
+	}
+
+	if(m_Array == ARRAY_SERVERS)
+	{
+		return ParseServer(*pJson);
+	}
+	NETADDR ParsedAddr;
+	if(pJson->type != json_string || net_addr_from_str(&ParsedAddr, *pJson))
+	{
+		return false;
+	}
+	m_vLegacyServers.push_back(ParsedAddr);
+	return true;
+}
+
+bool CServerListParser::ParseServer(const json_value &Server)
+{
+	const json_value &Addresses = Server["addresses"];
+	const json_value &Info = Server["info"];
+	const json_value &Location = Server["location"];
+	int ParsedLocation = CServerInfo::LOC_UNKNOWN;
+	CServerInfo2 ParsedInfo;
+	if(Addresses.type != json_array || (Location.type != json_string && Location.type != json_none))
+	{
+		return false;
+	}
+	if(Location.type == json_string)
+	{
+		if(CServerInfo::ParseLocation(&ParsedLocation, Location))
+		{
+			return false;
+		}
+	}
+	if(CServerInfo2::FromJson(&ParsedInfo, &Info))
+	{
+		// Only skip the current server on parsing
+		// failure; the server info is "user input" by
+		// the game server and can be set to arbitrary
+		// values.
+		return true;
+	}
+	CServerInfo SetInfo = ParsedInfo;
+	SetInfo.m_Location = ParsedLocation;
+	SetInfo.m_NumAddresses = 0;
+	for(unsigned int a = 0; a < Addresses.u.array.length; a++)
+	{
+		const json_value &Address = Addresses[a];
+		if(Address.type != json_string)
+		{
+			return false;
+		}
+		NETADDR ParsedAddr;
+		if(ServerbrowserParseUrl(&ParsedAddr, Addresses[a]))
+		{
+			// Skip unknown addresses.
+			continue;
+		}
+		if(SetInfo.m_NumAddresses < (int)std::size(SetInfo.m_aAddresses))
+		{
+			SetInfo.m_aAddresses[SetInfo.m_NumAddresses] = ParsedAddr;
+			SetInfo.m_NumAddresses += 1;
+		}
+	}
+	if(SetInfo.m_NumAddresses > 0)
+	{
+		m_vServers.push_back(SetInfo);
+	}
+	return true;
 }
 
 static const char *DEFAULT_SERVERLIST_URLS[] = {
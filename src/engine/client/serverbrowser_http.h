@@ -2,10 +2,14 @@
 #define ENGINE_CLIENT_SERVERBROWSER_HTTP_H
 #include <base/system.h>
 
-class CServerInfo;
+#include <engine/serverbrowser.h>
+
+#include <vector>
+
 class IConsole;
 class IEngine;
 class IStorage;
+typedef struct _json_value json_value;
 
 class IServerBrowserHttp
 {
@@ -19,11 +23,83 @@ public:
 
 	virtual bool GetBestUrl(const char **pBestUrl) const = 0;
 
+	// Changes whenever the server list is replaced. While a new list is
+	// being received, it is published in batches and NumServers() grows
+	// with every call to Update().
+	virtual int ServerListVersion() const = 0;
 	virtual int NumServers() const = 0;
 	virtual const CServerInfo &Server(int Index) const = 0;
 	virtual int NumLegacyServers() const = 0;
 	virtual const NETADDR &LegacyServer(int Index) const = 0;
 };
 
+/**
+ * Parses the server list JSON of the masters while it is being received.
+ *
+ * Only the top level object is tokenized here, each element of the
+ * "servers" and "servers_legacy" arrays is parsed on its own as soon as it
+ * is complete. The JSON values of an element are allocated from an arena
+ * that is reused for the next element.
+ */
+class CServerListParser
+{
+	class CArena
+	{
+		enum
+		{
+			BLOCK_SIZE = 64 * 1024,
+		};
+		std::vector<char *> m_vpBlocks;
+		// allocations bigger than a block, freed on reset
+		std::vector<char *> m_vpLarge;
+		size_t m_Block = 0;
+		size_t m_Used = 0;
+
+	public:
+		~CArena();
+		void *Allocate(size_t Size);
+		void Reset();
+	};
+
+	enum
+	{
+		ARRAY_NONE,
+		ARRAY_SERVERS,
+		ARRAY_LEGACY_SERVERS,
+	};
+
+	int m_Depth = 0;
+	bool m_InString = false;
+	bool m_Escape = false;
+	bool m_ExpectKey = false;
+	bool m_CaptureKey = false;
+	char m_aKey[32];
+	int m_KeyLength = 0;
+	int m_Array = ARRAY_NONE;
+	bool m_InElement = false;
+	std::vector<char> m_vElement;
+	bool m_SeenServers = false;
+	bool m_Done = false;
+	bool m_Error = false;
+	CArena m_Arena;
+
+	static void *JsonAlloc(size_t Size, int Zero, void *pUser);
+	static void JsonFree(void *pPtr, void *pUser) {}
+
+	bool ProcessChar(char c);
+	bool FinishElement();
+	bool ParseServer(const json_value &Server);
+
+public:
+	// servers parsed so far, may be taken and cleared between calls to Feed
+	std::vector<CServerInfo> m_vServers;
+	std::vector<NETADDR> m_vLegacyServers;
+
+	// returns false if the data is not a valid server list
+	bool Feed(const char *pData, size_t DataSize);
+	// returns false if the list is incomplete
+	bool Finish() const;
+};
+
 IServerBrowserHttp *CreateServerBrowserHttp(IEngine *pEngine, IConsole *pConsole, IStorage *pStorage, const char *pPreviousBestUrl);
 #endif // ENGINE_CLIENT_SERVERBROWSER_HTTP_H
@@ -10,6 +10,7 @@
 #include <engine/storage.h>
 
 #include "sound.h"
+#include "sound_mix.h"
 
 #if defined(CONF_VIDEORECORDER)
 #include <engine/shared/video.h>
@@ -21,41 +22,45 @@ extern "C" {
 
 #include <cmath>
 
+CSound::CSound()
+{
+	for(auto &VoiceSlot : m_aVoiceSlots)
+	{
+		VoiceSlot.m_Age = 0;
+		VoiceSlot.m_Sample = -1;
+	}
+	for(auto &EndedAge : m_aVoiceEndedAge)
+		EndedAge.store(0, std::memory_order_relaxed);
+}
+
 void CSound::Mix(short *pFinalOut, unsigned Frames)
 {
 	Frames = minimum(Frames, m_MaxFrames);
 	mem_zero(m_pMixBuffer, Frames * 2 * sizeof(int));
 
-	// acquire lock while we are mixing
-	m_SoundLock.lock();
+	// only excludes other threads mixing, the game queues its changes
+	// without waiting for us
+	std::unique_lock<std::mutex> Lock(m_MixLock);
+	ProcessCommands();
 
 	const int MasterVol = m_SoundVolume.load(std::memory_order_relaxed);
 
-	for(auto &Voice : m_aVoices)
+	for(int VoiceID = 0; VoiceID < NUM_VOICES; VoiceID++)
 	{
+		CVoice &Voice = m_aVoices[VoiceID];
 		if(!Voice.m_pSample)
 			continue;
 
-		// mix voice
-		int *pOut = m_pMixBuffer;
-
-		const int Step = Voice.m_pSample->m_Channels; // setup input sources
-		short *pInL = &Voice.m_pSample->m_pData[Voice.m_Tick * Step];
-		short *pInR = &Voice.m_pSample->m_pData[Voice.m_Tick * Step + 1];
-
 		unsigned End = Voice.m_pSample->m_NumFrames - Voice.m_Tick;
 
-		int VolumeR = round_truncate(Voice.m_pChannel->m_Vol * (Voice.m_Vol / 255.0f));
+		// the volume and panning are computed once for the whole block
+		int VolumeR = clamp(round_truncate(Voice.m_pChannel->m_Vol * (Voice.m_Vol / 255.0f)), 0, 255);
 		int VolumeL = VolumeR;
 
 		// make sure that we don't go outside the sound data
 		if(Frames < End)
 			End = Frames;
 
-		// check if we have a mono sound
-		if(Voice.m_pSample->m_Channels == 1)
-			pInR = pInL;
-
 		// volume calculation
 		if(Voice.m_Flags & ISound::FLAG_POS && Voice.m_pChannel->m_Pan)
 		{
@@ -147,14 +152,10 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 		}
 
 		// process all frames
-		for(unsigned s = 0; s < End; s++)
-		{
-			*pOut++ += (*pInL) * VolumeL;
-			*pOut++ += (*pInR) * VolumeR;
-			pInL += Step;
-			pInR += Step;
-			Voice.m_Tick++;
-		}
+		const int Channels = Voice.m_pSample->m_Channels;
+		if(VolumeL || VolumeR)
+			SoundMixVoice(m_pMixBuffer, &Voice.m_pSample->m_pData[Voice.m_Tick * Channels], Channels, End, VolumeL, VolumeR);
+		Voice.m_Tick += End;
 
 		// free voice if not used any more
 		if(Voice.m_Tick == Voice.m_pSample->m_NumFrames)
@@ -164,16 +165,15 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 			else
 			{
 				Voice.m_pSample = nullptr;
-				Voice.m_Age++;
+				m_aVoiceEndedAge[VoiceID].store(Voice.m_Age, std::memory_order_release);
 			}
 		}
 	}
 
-	m_SoundLock.unlock();
+	Lock.unlock();
 
 	// clamp accumulated values
-	for(unsigned i = 0; i < Frames * 2; i++)
-		pFinalOut[i] = clamp<int>(((m_pMixBuffer[i] * MasterVol) / 101) >> 8, std::numeric_limits<short>::min(), std::numeric_limits<short>::max());
+	SoundMixFinish(pFinalOut, m_pMixBuffer, Frames, MasterVol);
 
 #if defined(CONF_ARCH_ENDIAN_BIG)
 	swap_endian(pFinalOut, sizeof(short), Frames * 2);
@@ -638,6 +638,8 @@ void CSound::UnloadSample(int SampleID)
 		return;
 
 	Stop(SampleID);
+	// the mixer must not use the sample data anymore
+	SyncMixer();
 	free(m_aSamples[SampleID].m_pData);
 	m_aSamples[SampleID].m_pData = nullptr;
 }
@@ -650,138 +652,249 @@ float CSound::GetSampleDuration(int SampleID)
 	return (m_aSamples[SampleID].m_NumFrames / m_aSamples[SampleID].m_Rate);
 }
 
-void CSound::SetChannel(int ChannelID, float Vol, float Pan)
+bool CSound::VoiceSlotUsed(int VoiceID) const
 {
-	m_aChannels[ChannelID].m_Vol = (int)(Vol * 255.0f);
-	m_aChannels[ChannelID].m_Pan = (int)(Pan * 255.0f); // TODO: this is only on and off right now
+	const CVoiceSlot &VoiceSlot = m_aVoiceSlots[VoiceID];
+	return VoiceSlot.m_Sample != -1 && m_aVoiceEndedAge[VoiceID].load(std::memory_order_acquire) != VoiceSlot.m_Age;
 }
 
-void CSound::SetListenerPos(float x, float y)
+bool CSound::VoiceHandleUsed(CVoiceHandle Voice) const
 {
-	m_CenterX.store((int)x, std::memory_order_relaxed);
-	m_CenterY.store((int)y, std::memory_order_relaxed);
+	return Voice.IsValid() && m_aVoiceSlots[Voice.Id()].m_Age == Voice.Age() && VoiceSlotUsed(Voice.Id());
 }
 
-void CSound::SetVoiceVolume(CVoiceHandle Voice, float Volume)
+void CSound::PushCommand(const CSoundCommand &Command)
 {
-	if(!Voice.IsValid())
-		return;
+	const unsigned Write = m_CommandWrite.load(std::memory_order_relaxed);
+	if(Write - m_CommandRead.load(std::memory_order_acquire) == COMMAND_QUEUE_SIZE)
+	{
+		// the mixer is behind or nobody is mixing (no audio device or it
+		// is paused), wait for a running mix to finish and apply the
+		// commands ourselves to make room
+		std::unique_lock<std::mutex> MixLock(m_MixLock);
+		ProcessCommands();
+	}
+	m_aCommands[Write % COMMAND_QUEUE_SIZE] = Command;
+	m_CommandWrite.store(Write + 1, std::memory_order_release);
+}
 
-	int VoiceID = Voice.Id();
+void CSound::ProcessCommands()
+{
+	const unsigned Write = m_CommandWrite.load(std::memory_order_acquire);
+	unsigned Read = m_CommandRead.load(std::memory_order_relaxed);
+	for(; Read != Write; Read++)
+		ProcessCommand(m_aCommands[Read % COMMAND_QUEUE_SIZE]);
+	m_CommandRead.store(Read, std::memory_order_release);
+}
 
-	std::unique_lock<std::mutex> Lock(m_SoundLock);
-	if(m_aVoices[VoiceID].m_Age != Voice.Age())
-		return;
+void CSound::SyncMixer()
+{
+	std::unique_lock<std::mutex> Lock(m_MixLock);
+	ProcessCommands();
+}
 
-	Volume = clamp(Volume, 0.0f, 1.0f);
-	m_aVoices[VoiceID].m_Vol = (int)(Volume * 255.0f);
+void CSound::StopVoices(const CSample *pSample)
+{
+	for(auto &Voice : m_aVoices)
+	{
+		if(Voice.m_pSample && (!pSample || Voice.m_pSample == pSample))
+		{
+			if(Voice.m_Flags & FLAG_LOOP)
+				Voice.m_pSample->m_PausedAt = Voice.m_Tick;
+			else
+				Voice.m_pSample->m_PausedAt = 0;
+			Voice.m_pSample = nullptr;
+		}
+	}
 }
 
-void CSound::SetVoiceFalloff(CVoiceHandle Voice, float Falloff)
+void CSound::ProcessCommand(const CSoundCommand &Command)
 {
-	if(!Voice.IsValid())
+	if(Command.m_Type == CSoundCommand::STOP_SAMPLE)
+	{
+		StopVoices(&m_aSamples[Command.m_Sample]);
 		return;
+	}
+	else if(Command.m_Type == CSoundCommand::STOP_ALL)
+	{
+		StopVoices(nullptr);
+		return;
+	}
+	else if(Command.m_Type == CSoundCommand::SET_CHANNEL)
+	{
+		m_aChannels[Command.m_Channel].m_Vol = (int)(Command.m_X * 255.0f);
+		m_aChannels[Command.m_Channel].m_Pan = (int)(Command.m_Y * 255.0f); // TODO: this is only on and off right now
+		return;
+	}
 
-	int VoiceID = Voice.Id();
+	CVoice &Voice = m_aVoices[Command.m_Voice];
+	if(Command.m_Type == CSoundCommand::PLAY)
+	{
+		CSample &Sample = m_aSamples[Command.m_Sample];
+		Voice.m_pSample = &Sample;
+		Voice.m_pChannel = &m_aChannels[Command.m_Channel];
+		if(Command.m_Flags & FLAG_LOOP)
+			Voice.m_Tick = Sample.m_PausedAt;
+		else
+			Voice.m_Tick = 0;
+		Voice.m_Age = Command.m_Age;
+		Voice.m_Vol = 255;
+		Voice.m_Flags = Command.m_Flags;
+		Voice.m_X = (int)Command.m_X;
+		Voice.m_Y = (int)Command.m_Y;
+		Voice.m_Falloff = 0.0f;
+		Voice.m_Shape = ISound::SHAPE_CIRCLE;
+		Voice.m_Circle.m_Radius = 1500;
+		return;
+	}
 
-	std::unique_lock<std::mutex> Lock(m_SoundLock);
-	if(m_aVoices[VoiceID].m_Age != Voice.Age())
+	// the voice was stopped or reused in the meantime
+	if(!Voice.m_pSample || Voice.m_Age != Command.m_Age)
 		return;
 
-	Falloff = clamp(Falloff, 0.0f, 1.0f);
-	m_aVoices[VoiceID].m_Falloff = Falloff;
+	switch(Command.m_Type)
+	{
+	case CSoundCommand::STOP_VOICE:
+		Voice.m_pSample = nullptr;
+		break;
+	case CSoundCommand::SET_VOLUME:
+		Voice.m_Vol = (int)(Command.m_X * 255.0f);
+		break;
+	case CSoundCommand::SET_FALLOFF:
+		Voice.m_Falloff = Command.m_X;
+		break;
+	case CSoundCommand::SET_LOCATION:
+		Voice.m_X = Command.m_X;
+		Voice.m_Y = Command.m_Y;
+		break;
+	case CSoundCommand::SET_TIME_OFFSET:
+	{
+		int Tick = 0;
+		bool IsLooping = Voice.m_Flags & ISound::FLAG_LOOP;
+		uint64_t TickOffset = Voice.m_pSample->m_Rate * Command.m_X;
+		if(Voice.m_pSample->m_NumFrames > 0 && IsLooping)
+			Tick = TickOffset % Voice.m_pSample->m_NumFrames;
+		else
+			Tick = clamp(TickOffset, (uint64_t)0, (uint64_t)Voice.m_pSample->m_NumFrames);
+
+		// at least 200msec off, else depend on buffer size
+		float Threshold = maximum(0.2f * Voice.m_pSample->m_Rate, (float)m_MaxFrames);
+		if(absolute(Voice.m_Tick - Tick) > Threshold)
+		{
+			// take care of looping (modulo!)
+			if(!(IsLooping && (minimum(Voice.m_Tick, Tick) + Voice.m_pSample->m_NumFrames - maximum(Voice.m_Tick, Tick)) <= Threshold))
+			{
+				Voice.m_Tick = Tick;
+			}
+		}
+		break;
+	}
+	case CSoundCommand::SET_CIRCLE:
+		Voice.m_Shape = ISound::SHAPE_CIRCLE;
+		Voice.m_Circle.m_Radius = Command.m_X;
+		break;
+	case CSoundCommand::SET_RECTANGLE:
+		Voice.m_Shape = ISound::SHAPE_RECTANGLE;
+		Voice.m_Rectangle.m_Width = Command.m_X;
+		Voice.m_Rectangle.m_Height = Command.m_Y;
+		break;
+	}
 }
 
-void CSound::SetVoiceLocation(CVoiceHandle Voice, float x, float y)
+void CSound::SetChannel(int ChannelID, float Vol, float Pan)
 {
-	if(!Voice.IsValid())
-		return;
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
+	CSoundCommand Command = {CSoundCommand::SET_CHANNEL};
+	Command.m_Channel = ChannelID;
+	Command.m_X = Vol;
+	Command.m_Y = Pan;
+	PushCommand(Command);
+}
 
-	int VoiceID = Voice.Id();
+void CSound::SetListenerPos(float x, float y)
+{
+	m_CenterX.store((int)x, std::memory_order_relaxed);
+	m_CenterY.store((int)y, std::memory_order_relaxed);
+}
 
-	std::unique_lock<std::mutex> Lock(m_SoundLock);
-	if(m_aVoices[VoiceID].m_Age != Voice.Age())
+void CSound::SetVoiceVolume(CVoiceHandle Voice, float Volume)
+{
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
+	if(!VoiceHandleUsed(Voice))
 		return;
 
-	m_aVoices[VoiceID].m_X = x;
-	m_aVoices[VoiceID].m_Y = y;
+	CSoundCommand Command = {CSoundCommand::SET_VOLUME, Voice.Id(), Voice.Age()};
+	Command.m_X = clamp(Volume, 0.0f, 1.0f);
+	PushCommand(Command);
 }
 
-void CSound::SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset)
+void CSound::SetVoiceFalloff(CVoiceHandle Voice, float Falloff)
 {
-	if(!Voice.IsValid())
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
+	if(!VoiceHandleUsed(Voice))
 		return;
 
-	int VoiceID = Voice.Id();
-
-	std::unique_lock<std::mutex> Lock(m_SoundLock);
-	if(m_aVoices[VoiceID].m_Age != Voice.Age())
-		return;
+	CSoundCommand Command = {CSoundCommand::SET_FALLOFF, Voice.Id(), Voice.Age()};
+	Command.m_X = clamp(Falloff, 0.0f, 1.0f);
+	PushCommand(Command);
+}
 
-	if(!m_aVoices[VoiceID].m_pSample)
+void CSound::SetVoiceLocation(CVoiceHandle Voice, float x, float y)
+{
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
+	if(!VoiceHandleUsed(Voice))
 		return;
 
-	int Tick = 0;
-	bool IsLooping = m_aVoices[VoiceID].m_Flags & ISound::FLAG_LOOP;
-	uint64_t TickOffset = m_aVoices[VoiceID].m_pSample->m_Rate * TimeOffset;
-	if(m_aVoices[VoiceID].m_pSample->m_NumFrames > 0 && IsLooping)
-		Tick = TickOffset % m_aVoices[VoiceID].m_pSample->m_NumFrames;
-	else
-		Tick = clamp(TickOffset, (uint64_t)0, (uint64_t)m_aVoices[VoiceID].m_pSample->m_NumFrames);
-
-	// at least 200msec off, else depend on buffer size
-	float Threshold = maximum(0.2f * m_aVoices[VoiceID].m_pSample->m_Rate, (float)m_MaxFrames);
-	if(absolute(m_aVoices[VoiceID].m_Tick - Tick) > Threshold)
-	{
-		// take care of looping (modulo!)
-		if(!(IsLooping && (minimum(m_aVoices[VoiceID].m_Tick, Tick) + m_aVoices[VoiceID].m_pSample->m_NumFrames - maximum(m_aVoices[VoiceID].m_Tick, Tick)) <= Threshold))
-		{
-			m_aVoices[VoiceID].m_Tick = Tick;
-		}
-	}
+	CSoundCommand Command = {CSoundCommand::SET_LOCATION, Voice.Id(), Voice.Age()};
+	Command.m_X = x;
+	Command.m_Y = y;
+	PushCommand(Command);
 }
 
-void CSound::SetVoiceCircle(CVoiceHandle Voice, float Radius)
+void CSound::SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset)
 {
-	if(!Voice.IsValid())
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
+	if(!VoiceHandleUsed(Voice))
 		return;
 
-	int VoiceID = Voice.Id();
+	CSoundCommand Command = {CSoundCommand::SET_TIME_OFFSET, Voice.Id(), Voice.Age()};
+	Command.m_X = TimeOffset;
+	PushCommand(Command);
+}
 
-	std::unique_lock<std::mutex> Lock(m_SoundLock);
-	if(m_aVoices[VoiceID].m_Age != Voice.Age())
+void CSound::SetVoiceCircle(CVoiceHandle Voice, float Radius)
+{
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
+	if(!VoiceHandleUsed(Voice))
 		return;
 
-	m_aVoices[VoiceID].m_Shape = ISound::SHAPE_CIRCLE;
-	m_aVoices[VoiceID].m_Circle.m_Radius = maximum(0.0f, Radius);
+	CSoundCommand Command = {CSoundCommand::SET_CIRCLE, Voice.Id(), Voice.Age()};
+	Command.m_X = maximum(0.0f, Radius);
+	PushCommand(Command);
 }
 
 void CSound::SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height)
 {
-	if(!Voice.IsValid())
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
+	if(!VoiceHandleUsed(Voice))
 		return;
 
-	int VoiceID = Voice.Id();
-
-	std::unique_lock<std::mutex> Lock(m_SoundLock);
-	if(m_aVoices[VoiceID].m_Age != Voice.Age())
-		return;
-
-	m_aVoices[VoiceID].m_Shape = ISound::SHAPE_RECTANGLE;
-	m_aVoices[VoiceID].m_Rectangle.m_Width = maximum(0.0f, Width);
-	m_aVoices[VoiceID].m_Rectangle.m_Height = maximum(0.0f, Height);
+	CSoundCommand Command = {CSoundCommand::SET_RECTANGLE, Voice.Id(), Voice.Age()};
+	Command.m_X = maximum(0.0f, Width);
+	Command.m_Y = maximum(0.0f, Height);
+	PushCommand(Command);
 }
 
 ISound::CVoiceHandle CSound::Play(int ChannelID, int SampleID, int Flags, float x, float y)
 {
-	m_SoundLock.lock();
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
 
 	// search for voice
 	int VoiceID = -1;
 	for(int i = 0; i < NUM_VOICES; i++)
 	{
 		int NextID = (m_NextVoice + i) % NUM_VOICES;
-		if(!m_aVoices[NextID].m_pSample)
+		if(!VoiceSlotUsed(NextID))
 		{
 			VoiceID = NextID;
 			m_NextVoice = NextID + 1;
@@ -790,26 +903,21 @@ ISound::CVoiceHandle CSound::Play(int ChannelID, int SampleID, int Flags, float
 	}
 
 	// voice found, use it
-	int Age = -1;
-	if(VoiceID != -1)
-	{
-		m_aVoices[VoiceID].m_pSample = &m_aSamples[SampleID];
-		m_aVoices[VoiceID].m_pChannel = &m_aChannels[ChannelID];
-		if(Flags & FLAG_LOOP)
-			m_aVoices[VoiceID].m_Tick = m_aSamples[SampleID].m_PausedAt;
-		else
-			m_aVoices[VoiceID].m_Tick = 0;
-		m_aVoices[VoiceID].m_Vol = 255;
-		m_aVoices[VoiceID].m_Flags = Flags;
-		m_aVoices[VoiceID].m_X = (int)x;
-		m_aVoices[VoiceID].m_Y = (int)y;
-		m_aVoices[VoiceID].m_Falloff = 0.0f;
-		m_aVoices[VoiceID].m_Shape = ISound::SHAPE_CIRCLE;
-		m_aVoices[VoiceID].m_Circle.m_Radius = 1500;
-		Age = m_aVoices[VoiceID].m_Age;
-	}
-
-	m_SoundLock.unlock();
+	if(VoiceID == -1)
+		return CreateVoiceHandle(-1, -1);
+
+	CVoiceSlot &VoiceSlot = m_aVoiceSlots[VoiceID];
+	const int Age = (VoiceSlot.m_Age + 1) & 0x7fffffff;
+	CSoundCommand Command = {CSoundCommand::PLAY, VoiceID, Age};
+	Command.m_Sample = SampleID;
+	Command.m_Channel = ChannelID;
+	Command.m_Flags = Flags;
+	Command.m_X = x;
+	Command.m_Y = y;
+	PushCommand(Command);
+
+	VoiceSlot.m_Age = Age;
+	VoiceSlot.m_Sample = SampleID;
 	return CreateVoiceHandle(VoiceID, Age);
 }
 
@@ -825,59 +933,48 @@ ISound::CVoiceHandle CSound::Play(int ChannelID, int SampleID, int Flags)
 
 void CSound::Stop(int SampleID)
 {
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
 	// TODO: a nice fade out
-	std::unique_lock<std::mutex> Lock(m_SoundLock);
-	CSample *pSample = &m_aSamples[SampleID];
-	for(auto &Voice : m_aVoices)
+	for(auto &VoiceSlot : m_aVoiceSlots)
 	{
-		if(Voice.m_pSample == pSample)
-		{
-			if(Voice.m_Flags & FLAG_LOOP)
-				Voice.m_pSample->m_PausedAt = Voice.m_Tick;
-			else
-				Voice.m_pSample->m_PausedAt = 0;
-			Voice.m_pSample = nullptr;
-		}
+		if(VoiceSlot.m_Sample == SampleID)
+			VoiceSlot.m_Sample = -1;
 	}
+	CSoundCommand Command = {CSoundCommand::STOP_SAMPLE};
+	Command.m_Sample = SampleID;
+	PushCommand(Command);
 }
 
 void CSound::StopAll()
 {
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
 	// TODO: a nice fade out
-	std::unique_lock<std::mutex> Lock(m_SoundLock);
-	for(auto &Voice : m_aVoices)
-	{
-		if(Voice.m_pSample)
-		{
-			if(Voice.m_Flags & FLAG_LOOP)
-				Voice.m_pSample->m_PausedAt = Voice.m_Tick;
-			else
-				Voice.m_pSample->m_PausedAt = 0;
-		}
-		Voice.m_pSample = nullptr;
-	}
+	for(auto &VoiceSlot : m_aVoiceSlots)
+		VoiceSlot.m_Sample = -1;
+	CSoundCommand Command = {CSoundCommand::STOP_ALL};
+	PushCommand(Command);
 }
 
 void CSound::StopVoice(CVoiceHandle Voice)
 {
-	if(!Voice.IsValid())
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
+	if(!VoiceHandleUsed(Voice))
 		return;
 
-	int VoiceID = Voice.Id();
-
-	std::unique_lock<std::mutex> Lock(m_SoundLock);
-	if(m_aVoices[VoiceID].m_Age != Voice.Age())
-		return;
-
-	m_aVoices[VoiceID].m_pSample = nullptr;
-	m_aVoices[VoiceID].m_Age++;
+	m_aVoiceSlots[Voice.Id()].m_Sample = -1;
+	CSoundCommand Command = {CSoundCommand::STOP_VOICE, Voice.Id(), Voice.Age()};
+	PushCommand(Command);
 }
 
 bool CSound::IsPlaying(int SampleID)
 {
-	std::unique_lock<std::mutex> Lock(m_SoundLock);
-	const CSample *pSample = &m_aSamples[SampleID];
-	return std::any_of(std::begin(m_aVoices), std::end(m_aVoices), [pSample](const auto &Voice) { return Voice.m_pSample == pSample; });
+	std::unique_lock<std::mutex> Lock(m_CommandLock);
+	for(int VoiceID = 0; VoiceID < NUM_VOICES; VoiceID++)
+	{
+		if(m_aVoiceSlots[VoiceID].m_Sample == SampleID && VoiceSlotUsed(VoiceID))
+			return true;
+	}
+	return false;
 }
 
 void CSound::PauseAudioDevice()
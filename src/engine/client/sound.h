@@ -27,11 +27,12 @@ struct CChannel
 	int m_Pan;
 };
 
+// state of a voice, only accessed by the mixer
 struct CVoice
 {
 	CSample *m_pSample;
 	CChannel *m_pChannel;
-	int m_Age; // increases when reused
+	int m_Age; // age of the handle that started the voice
 	int m_Tick;
 	int m_Vol; // 0 - 255
 	int m_Flags;
@@ -46,6 +47,34 @@ struct CVoice
 	};
 };
 
+// a change of the voices, queued by the game for the mixer
+struct CSoundCommand
+{
+	enum
+	{
+		PLAY,
+		STOP_VOICE,
+		STOP_SAMPLE,
+		STOP_ALL,
+		SET_CHANNEL,
+		SET_VOLUME,
+		SET_FALLOFF,
+		SET_LOCATION,
+		SET_TIME_OFFSET,
+		SET_CIRCLE,
+		SET_RECTANGLE,
+	};
+
+	int m_Type;
+	int m_Voice;
+	int m_Age;
+	int m_Sample;
+	int m_Channel;
+	int m_Flags;
+	float m_X;
+	float m_Y;
+};
+
 class CSound : public IEngineSound
 {
 	enum
@@ -53,18 +82,41 @@ class CSound : public IEngineSound
 		NUM_SAMPLES = 512,
 		NUM_VOICES = 256,
 		NUM_CHANNELS = 16,
+		// must be a power of two
+		COMMAND_QUEUE_SIZE = 4096,
+	};
+
+	// the voices as seen by the game, a voice is in use until it is stopped
+	// or the mixer reports that its sample ended
+	struct CVoiceSlot
+	{
+		int m_Age;
+		int m_Sample;
 	};
 
 	bool m_SoundEnabled = false;
 	SDL_AudioDeviceID m_Device = 0;
-	std::mutex m_SoundLock;
 
 	CSample m_aSamples[NUM_SAMPLES] = {{0}};
-	CVoice m_aVoices[NUM_VOICES] = {{0}};
-	CChannel m_aChannels[NUM_CHANNELS] = {{255, 0}};
+	CVoiceSlot m_aVoiceSlots[NUM_VOICES] = {{0, -1}};
 	int m_NextVoice = 0;
 	uint32_t m_MaxFrames = 0;
 
+	// Voice changes are passed to the mixer through a single-producer
+	// single-consumer queue, so the game only waits for the audio callback
+	// when the queue is full. m_CommandLock serializes the game threads, it
+	// protects the voice slots and the write end of the queue. m_MixLock
+	// serializes the threads mixing and is never taken before m_CommandLock.
+	std::mutex m_CommandLock;
+	CSoundCommand m_aCommands[COMMAND_QUEUE_SIZE];
+	std::atomic<unsigned> m_CommandRead = 0;
+	std::atomic<unsigned> m_CommandWrite = 0;
+	std::mutex m_MixLock;
+	CVoice m_aVoices[NUM_VOICES] = {{0}};
+	CChannel m_aChannels[NUM_CHANNELS] = {{255, 0}};
+	// age of the last voice that ended by itself, written by the mixer
+	std::atomic<int> m_aVoiceEndedAge[NUM_VOICES];
+
 	std::atomic<int> m_CenterX = 0;
 	std::atomic<int> m_CenterY = 0;
 	std::atomic<int> m_SoundVolume = 100;
@@ -78,12 +130,27 @@ class CSound : public IEngineSound
 	int AllocID();
 	void RateConvert(CSample &Sample);
 
+	// the voice slot functions require m_CommandLock
+	bool VoiceSlotUsed(int VoiceID) const;
+	bool VoiceHandleUsed(CVoiceHandle Voice) const;
+	// requires m_CommandLock, applies the queued commands itself if the
+	// queue is full, so commands are never dropped
+	void PushCommand(const CSoundCommand &Command);
+	// applies the queued commands, requires m_MixLock
+	void ProcessCommands();
+	void ProcessCommand(const CSoundCommand &Command);
+	// waits until the mixer has applied all queued commands
+	void SyncMixer();
+	void StopVoices(const CSample *pSample);
+
 	bool DecodeOpus(CSample &Sample, const void *pData, unsigned DataSize);
 	bool DecodeWV(CSample &Sample, const void *pData, unsigned DataSize);
 
 	void UpdateVolume();
 
 public:
+	CSound();
+
 	int Init() override;
 	int Update() override;
 	void Shutdown() override;
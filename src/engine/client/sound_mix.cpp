@@ -0,0 +1,113 @@
+#include "sound_mix.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <limits>
+
+#if defined(CONF_ARCH_IA32) || defined(CONF_ARCH_AMD64)
+#include <emmintrin.h>
+#define SOUND_MIX_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SOUND_MIX_NEON
+#endif
+
+void SoundMixVoiceScalar(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+	const short *pInR = Channels == 1 ? pIn : pIn + 1;
+	for(unsigned i = 0; i < Frames; i++)
+	{
+		*pOut++ += pIn[i * Channels] * VolumeL;
+		*pOut++ += pInR[i * Channels] * VolumeR;
+	}
+}
+
+void SoundMixVoice(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+	unsigned i = 0;
+#if defined(SOUND_MIX_SSE2)
+	// the volumes fit into 16 bits, so each sample is multiplied by pairing
+	// it with a zero and using the multiply-add of 16 bit values
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i Volume = _mm_setr_epi16(VolumeL, 0, VolumeR, 0, VolumeL, 0, VolumeR, 0);
+	if(Channels == 2)
+	{
+		for(; i + 4 <= Frames; i += 4)
+		{
+			const __m128i In = _mm_loadu_si128((const __m128i *)(pIn + i * 2));
+			__m128i *pDst = (__m128i *)(pOut + i * 2);
+			const __m128i Lo = _mm_madd_epi16(_mm_unpacklo_epi16(In, Zero), Volume);
+			const __m128i Hi = _mm_madd_epi16(_mm_unpackhi_epi16(In, Zero), Volume);
+			_mm_storeu_si128(pDst, _mm_add_epi32(_mm_loadu_si128(pDst), Lo));
+			_mm_storeu_si128(pDst + 1, _mm_add_epi32(_mm_loadu_si128(pDst + 1), Hi));
+		}
+	}
+	else
+	{
+		for(; i + 8 <= Frames; i += 8)
+		{
+			const __m128i In = _mm_loadu_si128((const __m128i *)(pIn + i));
+			const __m128i Lo = _mm_unpacklo_epi16(In, In);
+			const __m128i Hi = _mm_unpackhi_epi16(In, In);
+			__m128i *pDst = (__m128i *)(pOut + i * 2);
+			_mm_storeu_si128(pDst, _mm_add_epi32(_mm_loadu_si128(pDst), _mm_madd_epi16(_mm_unpacklo_epi16(Lo, Zero), Volume)));
+			_mm_storeu_si128(pDst + 1, _mm_add_epi32(_mm_loadu_si128(pDst + 1), _mm_madd_epi16(_mm_unpackhi_epi16(Lo, Zero), Volume)));
+			_mm_storeu_si128(pDst + 2, _mm_add_epi32(_mm_loadu_si128(pDst + 2), _mm_madd_epi16(_mm_unpacklo_epi16(Hi, Zero), Volume)));
+			_mm_storeu_si128(pDst + 3, _mm_add_epi32(_mm_loadu_si128(pDst + 3), _mm_madd_epi16(_mm_unpackhi_epi16(Hi, Zero), Volume)));
+		}
+	}
+#elif defined(SOUND_MIX_NEON)
+	const int16_t aVolume[4] = {(int16_t)VolumeL, (int16_t)VolumeR, (int16_t)VolumeL, (int16_t)VolumeR};
+	const int16x4_t Volume = vld1_s16(aVolume);
+	if(Channels == 2)
+	{
+		for(; i + 4 <= Frames; i += 4)
+		{
+			const int16x8_t In = vld1q_s16(pIn + i * 2);
+			vst1q_s32(pOut + i * 2, vmlal_s16(vld1q_s32(pOut + i * 2), vget_low_s16(In), Volume));
+			vst1q_s32(pOut + i * 2 + 4, vmlal_s16(vld1q_s32(pOut + i * 2 + 4), vget_high_s16(In), Volume));
+		}
+	}
+	else
+	{
+		for(; i + 4 <= Frames; i += 4)
+		{
+			const int16x4x2_t In = vzip_s16(vld1_s16(pIn + i), vld1_s16(pIn + i));
+			vst1q_s32(pOut + i * 2, vmlal_s16(vld1q_s32(pOut + i * 2), In.val[0], Volume));
+			vst1q_s32(pOut + i * 2 + 4, vmlal_s16(vld1q_s32(pOut + i * 2 + 4), In.val[1], Volume));
+		}
+	}
+#endif
+	SoundMixVoiceScalar(pOut + i * 2, pIn + i * Channels, Channels, Frames - i, VolumeL, VolumeR);
+}
+
+void SoundMixFinishScalar(short *pFinalOut, const int *pMix, unsigned Frames, int MasterVol)
+{
+	for(unsigned i = 0; i < Frames * 2; i++)
+		pFinalOut[i] = clamp<int>(((pMix[i] * MasterVol) / 101) >> 8, std::numeric_limits<short>::min(), std::numeric_limits<short>::max());
+}
+
+void SoundMixFinish(short *pFinalOut, const int *pMix, unsigned Frames, int MasterVol)
+{
+	unsigned i = 0;
+#if defined(SOUND_MIX_SSE2)
+	// scaled in floating point, the saturating pack clamps to 16 bits
+	const __m128 Scale = _mm_set1_ps(MasterVol / (101.0f * 256.0f));
+	for(; i + 8 <= Frames * 2; i += 8)
+	{
+		const __m128i Lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(pMix + i))), Scale));
+		const __m128i Hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(pMix + i + 4))), Scale));
+		_mm_storeu_si128((__m128i *)(pFinalOut + i), _mm_packs_epi32(Lo, Hi));
+	}
+#elif defined(SOUND_MIX_NEON)
+	const float32x4_t Scale = vdupq_n_f32(MasterVol / (101.0f * 256.0f));
+	for(; i + 8 <= Frames * 2; i += 8)
+	{
+		const int32x4_t Lo = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(vld1q_s32(pMix + i)), Scale));
+		const int32x4_t Hi = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(vld1q_s32(pMix + i + 4)), Scale));
+		vst1q_s16(pFinalOut + i, vcombine_s16(vqmovn_s32(Lo), vqmovn_s32(Hi)));
+	}
+#endif
+	SoundMixFinishScalar(pFinalOut + i, pMix + i, Frames - i / 2, MasterVol);
+}
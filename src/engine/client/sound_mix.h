@@ -0,0 +1,18 @@
+#ifndef ENGINE_CLIENT_SOUND_MIX_H
+#define ENGINE_CLIENT_SOUND_MIX_H
+
+/**
+ * Adds Frames frames of a mono or stereo sample to the interleaved stereo
+ * mix buffer, scaled by VolumeL and VolumeR (0 - 255).
+ */
+void SoundMixVoice(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR);
+void SoundMixVoiceScalar(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR);
+
+/**
+ * Scales the mix buffer by the master volume (0 - 100) and clamps it into
+ * the final 16 bit output.
+ */
+void SoundMixFinish(short *pFinalOut, const int *pMix, unsigned Frames, int MasterVol);
+void SoundMixFinishScalar(short *pFinalOut, const int *pMix, unsigned Frames, int MasterVol);
+
+#endif
@@ -1,11 +1,15 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/hash.h>
 #include <base/log.h>
 #include <base/math.h>
 #include <base/system.h>
 
 #include <engine/console.h>
+#include <engine/engine.h>
 #include <engine/graphics.h>
+#include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
 #include <engine/shared/json.h>
 #include <engine/storage.h>
 #include <engine/textrender.h>
@@ -14,11 +18,19 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <deque>
 #include <limits>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 using namespace std::chrono_literals;
@@ -76,6 +88,377 @@ struct SGlyphKeyEquals
 	}
 };
 
+/**
+ * A glyph that was rasterised but is not in the atlas yet.
+ * Width and height include the padding for the outline, the fill
+ * bitmap is followed by the outline bitmap in m_vData.
+ */
+struct SRasterizedGlyph
+{
+	FT_UInt m_GlyphIndex;
+	int m_Width;
+	int m_Height;
+	int m_CharWidth;
+	int m_CharHeight;
+	int m_OffsetX;
+	int m_OffsetY;
+	int m_AdvanceX;
+	std::vector<uint8_t> m_vData;
+};
+
+static int AdjustOutlineThicknessToFontSize(int OutlineThickness, int FontSize)
+{
+	if(FontSize > 48)
+		OutlineThickness *= 4;
+	else if(FontSize >= 18)
+		OutlineThickness *= 2;
+	return OutlineThickness;
+}
+
+static void Grow(const unsigned char *pIn, unsigned char *pOut, int w, int h, int OutlineCount)
+{
+	for(int y = 0; y < h; y++)
+	{
+		for(int x = 0; x < w; x++)
+		{
+			int c = pIn[y * w + x];
+
+			for(int sy = -OutlineCount; sy <= OutlineCount; sy++)
+			{
+				for(int sx = -OutlineCount; sx <= OutlineCount; sx++)
+				{
+					int GetX = x + sx;
+					int GetY = y + sy;
+					if(GetX >= 0 && GetY >= 0 && GetX < w && GetY < h)
+					{
+						int Index = GetY * w + GetX;
+						if(pIn[Index] > c)
+							c = pIn[Index];
+					}
+				}
+			}
+
+			pOut[y * w + x] = c;
+		}
+	}
+}
+
+// only uses the face, so it can run on any thread that owns the face
+static bool RasterizeGlyph(FT_Face Face, FT_UInt GlyphIndex, int FontSize, SRasterizedGlyph &Result)
+{
+	FT_Set_Pixel_Sizes(Face, 0, FontSize);
+
+	if(FT_Load_Glyph(Face, GlyphIndex, FT_LOAD_RENDER | FT_LOAD_NO_BITMAP))
+		return false;
+
+	const FT_Bitmap *pBitmap = &Face->glyph->bitmap;
+
+	const unsigned RealWidth = pBitmap->width;
+	const unsigned RealHeight = pBitmap->rows;
+
+	// adjust spacing
+	int OutlineThickness = 0;
+	int x = 0;
+	int y = 0;
+	if(RealWidth > 0)
+	{
+		OutlineThickness = AdjustOutlineThicknessToFontSize(1, FontSize);
+		x += (OutlineThickness + 1);
+		y += (OutlineThickness + 1);
+	}
+
+	const unsigned Width = RealWidth + x * 2;
+	const unsigned Height = RealHeight + y * 2;
+
+	Result.m_GlyphIndex = GlyphIndex;
+	Result.m_Width = Width;
+	Result.m_Height = Height;
+	Result.m_CharWidth = RealWidth;
+	Result.m_CharHeight = RealHeight;
+	Result.m_OffsetX = Face->glyph->metrics.horiBearingX >> 6;
+	Result.m_OffsetY = -((Face->glyph->metrics.height >> 6) - (Face->glyph->metrics.horiBearingY >> 6));
+	Result.m_AdvanceX = Face->glyph->advance.x >> 6;
+
+	const size_t Size = (size_t)Width * Height;
+	Result.m_vData.assign(Size * 2, 0);
+	if(Size > 0)
+	{
+		for(unsigned py = 0; py < pBitmap->rows; ++py)
+		{
+			mem_copy(&Result.m_vData[(py + y) * Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
+		}
+		Grow(Result.m_vData.data(), Result.m_vData.data() + Size, Width, Height, OutlineThickness);
+	}
+	return true;
+}
+
+struct SGlyphFontFile
+{
+	const FT_Byte *m_pData;
+	FT_Long m_DataSize;
+	SHA256_DIGEST m_Sha256;
+	bool m_HashKnown;
+};
+
+struct SGlyphFaceSource
+{
+	size_t m_FontFile;
+	FT_Long m_FaceIndex;
+};
+
+struct SGlyphRequest
+{
+	// index of the face in the glyph map
+	size_t m_Face;
+	int m_Chr;
+	FT_UInt m_GlyphIndex;
+	int m_FontSize;
+};
+
+/**
+ * Rasterised glyphs are stored in cache/glyphs/<sha256 of the font file>.bin,
+ * a header followed by the entries, each with its fill and outline bitmap.
+ * The fields of the header and the entries are stored big-endian one after
+ * another, in the order they are declared in.
+ */
+static const unsigned char GLYPH_CACHE_MAGIC[4] = {'D', 'G', 'L', 'C'};
+static constexpr int GLYPH_CACHE_VERSION = 2;
+static constexpr size_t GLYPH_CACHE_MAX_SIZE = 8 * 1024 * 1024;
+
+struct SGlyphCacheHeader
+{
+	static constexpr size_t SERIALIZED_SIZE = sizeof(GLYPH_CACHE_MAGIC) + 3 * 4;
+
+	int m_Version;
+	// the bitmaps depend on the FreeType version
+	int m_FreetypeVersion;
+	int m_NumGlyphs;
+
+	void Serialize(uint8_t *pOut) const
+	{
+		mem_copy(pOut, GLYPH_CACHE_MAGIC, sizeof(GLYPH_CACHE_MAGIC));
+		pOut += sizeof(GLYPH_CACHE_MAGIC);
+		uint_to_bytes_be(pOut, m_Version);
+		uint_to_bytes_be(pOut + 4, m_FreetypeVersion);
+		uint_to_bytes_be(pOut + 8, m_NumGlyphs);
+	}
+
+	// returns false if the data does not start with the magic
+	bool Unserialize(const uint8_t *pData)
+	{
+		if(mem_comp(pData, GLYPH_CACHE_MAGIC, sizeof(GLYPH_CACHE_MAGIC)) != 0)
+			return false;
+		pData += sizeof(GLYPH_CACHE_MAGIC);
+		m_Version = bytes_be_to_uint(pData);
+		m_FreetypeVersion = bytes_be_to_uint(pData + 4);
+		m_NumGlyphs = bytes_be_to_uint(pData + 8);
+		return true;
+	}
+};
+
+struct SGlyphCacheEntry
+{
+	static constexpr size_t SERIALIZED_SIZE = 11 * 4;
+
+	int m_FaceIndex;
+	int m_Chr;
+	int m_FontSize;
+	unsigned m_GlyphIndex;
+	int m_Width;
+	int m_Height;
+	int m_CharWidth;
+	int m_CharHeight;
+	int m_OffsetX;
+	int m_OffsetY;
+	int m_AdvanceX;
+
+	void Serialize(uint8_t *pOut) const
+	{
+		uint_to_bytes_be(pOut, m_FaceIndex);
+		uint_to_bytes_be(pOut + 4, m_Chr);
+		uint_to_bytes_be(pOut + 8, m_FontSize);
+		uint_to_bytes_be(pOut + 12, m_GlyphIndex);
+		uint_to_bytes_be(pOut + 16, m_Width);
+		uint_to_bytes_be(pOut + 20, m_Height);
+		uint_to_bytes_be(pOut + 24, m_CharWidth);
+		uint_to_bytes_be(pOut + 28, m_CharHeight);
+		uint_to_bytes_be(pOut + 32, m_OffsetX);
+		uint_to_bytes_be(pOut + 36, m_OffsetY);
+		uint_to_bytes_be(pOut + 40, m_AdvanceX);
+	}
+
+	void Unserialize(const uint8_t *pData)
+	{
+		m_FaceIndex = bytes_be_to_uint(pData);
+		m_Chr = bytes_be_to_uint(pData + 4);
+		m_FontSize = bytes_be_to_uint(pData + 8);
+		m_GlyphIndex = bytes_be_to_uint(pData + 12);
+		m_Width = bytes_be_to_uint(pData + 16);
+		m_Height = bytes_be_to_uint(pData + 20);
+		m_CharWidth = bytes_be_to_uint(pData + 24);
+		m_CharHeight = bytes_be_to_uint(pData + 28);
+		m_OffsetX = bytes_be_to_uint(pData + 32);
+		m_OffsetY = bytes_be_to_uint(pData + 36);
+		m_AdvanceX = bytes_be_to_uint(pData + 40);
+	}
+};
+
+static int FreetypeVersion(FT_Library Library)
+{
+	int Major, Minor, Patch;
+	FT_Library_Version(Library, &Major, &Minor, &Patch);
+	return Major * 10000 + Minor * 100 + Patch;
+}
+
+static void GlyphCachePath(const SHA256_DIGEST &Sha256, char *pPath, size_t PathSize)
+{
+	char aSha256[SHA256_MAXSTRSIZE];
+	sha256_str(Sha256, aSha256, sizeof(aSha256));
+	str_format(pPath, PathSize, "cache/glyphs/%s.bin", aSha256);
+}
+
+/**
+ * FreeType faces must not be used by multiple threads at once, so the
+ * rasterise jobs have their own library and faces, which are created from the
+ * same font data as the faces of the glyph map. They are shared by all jobs,
+ * only one job runs at a time.
+ */
+struct SGlyphRasterizer
+{
+	FT_Library m_Library = nullptr;
+	std::vector<FT_Face> m_vFaces;
+
+	~SGlyphRasterizer()
+	{
+		if(m_Library != nullptr)
+			FT_Done_FreeType(m_Library);
+	}
+};
+
+class CGlyphRasterizeJob : public IJob
+{
+
+	void LoadCache(size_t FontFile)
+	{
+		char aPath[IO_MAX_PATH_LENGTH];
+		GlyphCachePath(m_vFontFiles[FontFile].m_Sha256, aPath, sizeof(aPath));
+		void *pFileData;
+		unsigned FileSize;
+		if(!m_pStorage->ReadFile(aPath, IStorage::TYPE_SAVE, &pFileData, &FileSize))
+			return;
+
+		const uint8_t *pData = (const uint8_t *)pFileData;
+		const uint8_t *pEnd = pData + FileSize;
+		SGlyphCacheHeader Header;
+		if(FileSize < SGlyphCacheHeader::SERIALIZED_SIZE ||
+			!Header.Unserialize(pData) ||
+			Header.m_Version != GLYPH_CACHE_VERSION ||
+			Header.m_FreetypeVersion != FreetypeVersion(m_pRasterizer->m_Library))
+		{
+			free(pFileData);
+			return;
+		}
+		pData += SGlyphCacheHeader::SERIALIZED_SIZE;
+
+		for(int i = 0; i < Header.m_NumGlyphs && !m_Abort; i++)
+		{
+			SGlyphCacheEntry Entry;
+			if((size_t)(pEnd - pData) < SGlyphCacheEntry::SERIALIZED_SIZE)
+				break;
+			Entry.Unserialize(pData);
+			pData += SGlyphCacheEntry::SERIALIZED_SIZE;
+			if(Entry.m_Width < 0 || Entry.m_Height < 0 || Entry.m_Width > 1024 || Entry.m_Height > 1024)
+				break;
+			const size_t DataSize = (size_t)Entry.m_Width * Entry.m_Height * 2;
+			if((size_t)(pEnd - pData) < DataSize)
+				break;
+
+			const auto Face = std::find_if(m_vFaceSources.begin(), m_vFaceSources.end(), [&](const SGlyphFaceSource &Source) {
+				return Source.m_FontFile == FontFile && Source.m_FaceIndex == Entry.m_FaceIndex;
+			});
+			if(Face != m_vFaceSources.end())
+			{
+				SResult &Result = m_vResults.emplace_back();
+				Result.m_Request = {(size_t)(Face - m_vFaceSources.begin()), Entry.m_Chr, Entry.m_GlyphIndex, Entry.m_FontSize};
+				Result.m_FromCache = true;
+				SRasterizedGlyph &Glyph = Result.m_Glyph;
+				Glyph.m_GlyphIndex = Entry.m_GlyphIndex;
+				Glyph.m_Width = Entry.m_Width;
+				Glyph.m_Height = Entry.m_Height;
+				Glyph.m_CharWidth = Entry.m_CharWidth;
+				Glyph.m_CharHeight = Entry.m_CharHeight;
+				Glyph.m_OffsetX = Entry.m_OffsetX;
+				Glyph.m_OffsetY = Entry.m_OffsetY;
+				Glyph.m_AdvanceX = Entry.m_AdvanceX;
+				Glyph.m_vData.assign(pData, pData + DataSize);
+			}
+			pData += DataSize;
+		}
+		free(pFileData);
+	}
+
+	void Run() override
+	{
+		FT_Library &Library = m_pRasterizer->m_Library;
+		std::vector<FT_Face> &vFaces = m_pRasterizer->m_vFaces;
+		if(Library == nullptr && FT_Init_FreeType(&Library))
+		{
+			Library = nullptr;
+			return;
+		}
+
+		if(m_LoadCache)
+		{
+			for(size_t FontFile = 0; FontFile < m_vFontFiles.size() && !m_Abort; FontFile++)
+			{
+				SGlyphFontFile &File = m_vFontFiles[FontFile];
+				File.m_Sha256 = sha256(File.m_pData, File.m_DataSize);
+				File.m_HashKnown = true;
+				LoadCache(FontFile);
+			}
+		}
+
+		for(size_t i = vFaces.size(); i < m_vFaceSources.size(); i++)
+		{
+			const SGlyphFontFile &File = m_vFontFiles[m_vFaceSources[i].m_FontFile];
+			FT_Face Face;
+			vFaces.push_back(FT_New_Memory_Face(Library, File.m_pData, File.m_DataSize, m_vFaceSources[i].m_FaceIndex, &Face) ? nullptr : Face);
+		}
+
+		for(const SGlyphRequest &Request : m_vRequests)
+		{
+			if(m_Abort)
+				break;
+			if(vFaces[Request.m_Face] == nullptr)
+				continue;
+			SResult Result;
+			Result.m_Request = Request;
+			Result.m_FromCache = false;
+			if(RasterizeGlyph(vFaces[Request.m_Face], Request.m_GlyphIndex, Request.m_FontSize, Result.m_Glyph))
+				m_vResults.push_back(std::move(Result));
+		}
+	}
+
+public:
+	struct SResult
+	{
+		SGlyphRequest m_Request;
+		SRasterizedGlyph m_Glyph;
+		bool m_FromCache;
+	};
+
+	std::shared_ptr<SGlyphRasterizer> m_pRasterizer;
+	IStorage *m_pStorage = nullptr;
+	std::vector<SGlyphFontFile> m_vFontFiles;
+	std::vector<SGlyphFaceSource> m_vFaceSources;
+	std::vector<SGlyphRequest> m_vRequests;
+	// computes the hashes of the font files and loads their glyph caches
+	bool m_LoadCache = false;
+	std::atomic<bool> m_Abort{false};
+
+	std::vector<SResult> m_vResults;
+};
+
 class CAtlas
 {
 	struct SSectionKeyHash
@@ -309,7 +692,25 @@ private:
 	 */
 	static constexpr int REPLACEMENT_CHARACTER = 0x25a1;
 
+	/**
+	 * Characters that are rasterised in the background for every font size that is used.
+	 */
+	static constexpr std::pair<int, int> PREWARM_RANGES[] = {{0x20, 0x7e}, {0xa0, 0xff}};
+
+	/**
+	 * Larger font sizes are rarely used for more than a few characters, so they are not prewarmed.
+	 */
+	static constexpr int PREWARM_MAX_FONT_SIZE = 48;
+
+	/**
+	 * Maximum number of characters from prewarmed texts, the oldest ones are dropped for new ones.
+	 */
+	static constexpr size_t MAX_PREWARM_CHARACTERS = 1024;
+
 	IGraphics *m_pGraphics;
+	IStorage *m_pStorage;
+	IEngine *m_pEngine;
+	FT_Library m_FTLibrary;
 	IGraphics *Graphics() { return m_pGraphics; }
 
 	// Atlas textures and data
@@ -321,6 +722,21 @@ private:
 	CAtlas m_TextureAtlas;
 	std::unordered_map<std::tuple<FT_Face, int, int>, SGlyph, SGlyphKeyHash, SGlyphKeyEquals> m_Glyphs;
 
+	// Glyphs rasterised in the background or loaded from the cache, which are not in the atlas yet
+	std::unordered_map<std::tuple<FT_Face, int, int>, SRasterizedGlyph, SGlyphKeyHash, SGlyphKeyEquals> m_RasterizedGlyphs;
+	std::unordered_set<std::tuple<FT_Face, int, int>, SGlyphKeyHash, SGlyphKeyEquals> m_QueuedGlyphs;
+	std::vector<SGlyphRequest> m_vQueuedRequests;
+	std::shared_ptr<SGlyphRasterizer> m_pRasterizer = std::make_shared<SGlyphRasterizer>();
+	std::shared_ptr<CGlyphRasterizeJob> m_pRasterizeJob;
+	bool m_aFontSizePrewarmed[MAX_FONT_SIZE + 1] = {};
+	std::deque<int> m_PrewarmCharacters;
+	std::unordered_set<int> m_PrewarmCharacterSet;
+	// whether glyphs were rasterised that are not in the cache files
+	bool m_CacheDirty = false;
+	std::vector<SGlyphFontFile> m_vFontFiles;
+	// source of each face in m_vFtFaces
+	std::vector<SGlyphFaceSource> m_vFaceSources;
+
 	// Data used for rendering glyphs
 	uint8_t m_aaGlyphData[NUM_FONT_TEXTURES][64 * 1024];
 
@@ -448,43 +864,6 @@ private:
 		return GlyphIndex;
 	}
 
-	void Grow(const unsigned char *pIn, unsigned char *pOut, int w, int h, int OutlineCount) const
-	{
-		for(int y = 0; y < h; y++)
-		{
-			for(int x = 0; x < w; x++)
-			{
-				int c = pIn[y * w + x];
-
-				for(int sy = -OutlineCount; sy <= OutlineCount; sy++)
-				{
-					for(int sx = -OutlineCount; sx <= OutlineCount; sx++)
-					{
-						int GetX = x + sx;
-						int GetY = y + sy;
-						if(GetX >= 0 && GetY >= 0 && GetX < w && GetY < h)
-						{
-							int Index = GetY * w + GetX;
-							if(pIn[Index] > c)
-								c = pIn[Index];
-						}
-					}
-				}
-
-				pOut[y * w + x] = c;
-			}
-		}
-	}
-
-	int AdjustOutlineThicknessToFontSize(int OutlineThickness, int FontSize) const
-	{
-		if(FontSize > 48)
-			OutlineThickness *= 4;
-		else if(FontSize >= 18)
-			OutlineThickness *= 2;
-		return OutlineThickness;
-	}
-
 	void UploadGlyph(int TextureIndex, int PosX, int PosY, size_t Width, size_t Height, const unsigned char *pData)
 	{
 		for(size_t y = 0; y < Height; ++y)
@@ -501,32 +880,30 @@ private:
 
 	bool RenderGlyph(SGlyph &Glyph)
 	{
-		FT_Set_Pixel_Sizes(Glyph.m_Face, 0, Glyph.m_FontSize);
-
-		if(FT_Load_Glyph(Glyph.m_Face, Glyph.m_GlyphIndex, FT_LOAD_RENDER | FT_LOAD_NO_BITMAP))
+		// use the bitmap that was rasterised in the background or loaded from the cache
+		const auto Key = std::make_tuple(Glyph.m_Face, Glyph.m_Chr, Glyph.m_FontSize);
+		auto RasterizedIt = m_RasterizedGlyphs.find(Key);
+		if(RasterizedIt == m_RasterizedGlyphs.end() || RasterizedIt->second.m_GlyphIndex != Glyph.m_GlyphIndex)
 		{
-			log_debug("textrender", "Error loading glyph. Chr=%d GlyphIndex=%u", Glyph.m_Chr, Glyph.m_GlyphIndex);
-			return false;
-		}
-
-		const FT_Bitmap *pBitmap = &Glyph.m_Face->glyph->bitmap;
-
-		const unsigned RealWidth = pBitmap->width;
-		const unsigned RealHeight = pBitmap->rows;
-
-		// adjust spacing
-		int OutlineThickness = 0;
-		int x = 0;
-		int y = 0;
-		if(RealWidth > 0)
-		{
-			OutlineThickness = AdjustOutlineThicknessToFontSize(1, Glyph.m_FontSize);
-			x += (OutlineThickness + 1);
-			y += (OutlineThickness + 1);
+			SRasterizedGlyph Rasterized;
+			if(!RasterizeGlyph(Glyph.m_Face, Glyph.m_GlyphIndex, Glyph.m_FontSize, Rasterized))
+			{
+				log_debug("textrender", "Error loading glyph. Chr=%d GlyphIndex=%u", Glyph.m_Chr, Glyph.m_GlyphIndex);
+				return false;
+			}
+			m_CacheDirty = true;
+			RasterizedIt = m_RasterizedGlyphs.insert_or_assign(Key, std::move(Rasterized)).first;
 		}
+		const bool Placed = PlaceGlyph(Glyph, RasterizedIt->second);
+		// the bitmap is kept in the atlas texture data from now on
+		m_RasterizedGlyphs.erase(RasterizedIt);
+		return Placed;
+	}
 
-		const unsigned Width = RealWidth + x * 2;
-		const unsigned Height = RealHeight + y * 2;
+	bool PlaceGlyph(SGlyph &Glyph, const SRasterizedGlyph &Rasterized)
+	{
+		const size_t Width = Rasterized.m_Width;
+		const size_t Height = Rasterized.m_Height;
 
 		int X = 0;
 		int Y = 0;
@@ -543,46 +920,239 @@ private:
 				}
 			}
 
-			// prepare glyph data
-			mem_zero(m_aaGlyphData[FONT_TEXTURE_FILL], (size_t)Width * Height * sizeof(uint8_t));
-			for(unsigned py = 0; py < pBitmap->rows; ++py)
+			// upload the glyph
+			UploadGlyph(FONT_TEXTURE_FILL, X, Y, Width, Height, Rasterized.m_vData.data());
+			UploadGlyph(FONT_TEXTURE_OUTLINE, X, Y, Width, Height, Rasterized.m_vData.data() + Width * Height);
+		}
+
+		// set glyph info
+		Glyph.m_Height = Height;
+		Glyph.m_Width = Width;
+		Glyph.m_CharHeight = Rasterized.m_CharHeight;
+		Glyph.m_CharWidth = Rasterized.m_CharWidth;
+		Glyph.m_OffsetX = Rasterized.m_OffsetX;
+		Glyph.m_OffsetY = Rasterized.m_OffsetY;
+		Glyph.m_AdvanceX = Rasterized.m_AdvanceX;
+
+		Glyph.m_aUVs[0] = X;
+		Glyph.m_aUVs[1] = Y;
+		Glyph.m_aUVs[2] = Glyph.m_aUVs[0] + Width;
+		Glyph.m_aUVs[3] = Glyph.m_aUVs[1] + Height;
+
+		Glyph.m_State = SGlyph::EState::RENDERED;
+		return true;
+	}
+
+	size_t FaceIndex(FT_Face Face) const
+	{
+		return std::find(m_vFtFaces.begin(), m_vFtFaces.end(), Face) - m_vFtFaces.begin();
+	}
+
+	void QueueGlyph(int Chr, int FontSize)
+	{
+		FT_Face Face;
+		const FT_UInt GlyphIndex = GetCharGlyph(Chr, &Face, false);
+		if(GlyphIndex == 0)
+			return;
+		const auto Key = std::make_tuple(Face, Chr, FontSize);
+		if(m_Glyphs.find(Key) != m_Glyphs.end() || m_RasterizedGlyphs.find(Key) != m_RasterizedGlyphs.end())
+			return;
+		if(!m_QueuedGlyphs.insert(Key).second)
+			return;
+		m_vQueuedRequests.push_back({FaceIndex(Face), Chr, GlyphIndex, FontSize});
+	}
+
+	// queues the common characters and the characters of the prewarmed texts
+	void PrewarmFontSize(int FontSize)
+	{
+		if(FontSize > PREWARM_MAX_FONT_SIZE || m_aFontSizePrewarmed[FontSize])
+			return;
+		m_aFontSizePrewarmed[FontSize] = true;
+
+		// the prewarmed glyphs are for the default font preset
+		const FT_Face SelectedFace = m_SelectedFace;
+		m_SelectedFace = nullptr;
+		for(const auto &[First, Last] : PREWARM_RANGES)
+		{
+			for(int Chr = First; Chr <= Last; Chr++)
+				QueueGlyph(Chr, FontSize);
+		}
+		for(const int Chr : m_PrewarmCharacters)
+			QueueGlyph(Chr, FontSize);
+		m_SelectedFace = SelectedFace;
+	}
+
+	void FinishRasterizeJob()
+	{
+		for(size_t i = 0; i < m_vFontFiles.size() && i < m_pRasterizeJob->m_vFontFiles.size(); i++)
+		{
+			if(!m_vFontFiles[i].m_HashKnown && m_pRasterizeJob->m_vFontFiles[i].m_HashKnown)
 			{
-				mem_copy(&m_aaGlyphData[FONT_TEXTURE_FILL][(py + y) * Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
+				m_vFontFiles[i].m_Sha256 = m_pRasterizeJob->m_vFontFiles[i].m_Sha256;
+				m_vFontFiles[i].m_HashKnown = true;
 			}
+		}
 
-			// upload the glyph
-			UploadGlyph(FONT_TEXTURE_FILL, X, Y, Width, Height, m_aaGlyphData[FONT_TEXTURE_FILL]);
-			Grow(m_aaGlyphData[FONT_TEXTURE_FILL], m_aaGlyphData[FONT_TEXTURE_OUTLINE], Width, Height, OutlineThickness);
-			UploadGlyph(FONT_TEXTURE_OUTLINE, X, Y, Width, Height, m_aaGlyphData[FONT_TEXTURE_OUTLINE]);
+		for(auto &Result : m_pRasterizeJob->m_vResults)
+		{
+			const auto Key = std::make_tuple(m_vFtFaces[Result.m_Request.m_Face], Result.m_Request.m_Chr, Result.m_Request.m_FontSize);
+			if(!Result.m_FromCache)
+				m_CacheDirty = true;
+			if(m_Glyphs.find(Key) == m_Glyphs.end())
+				m_RasterizedGlyphs.emplace(Key, std::move(Result.m_Glyph));
 		}
+		for(const auto &Request : m_pRasterizeJob->m_vRequests)
+			m_QueuedGlyphs.erase(std::make_tuple(m_vFtFaces[Request.m_Face], Request.m_Chr, Request.m_FontSize));
+		m_pRasterizeJob = nullptr;
+	}
 
-		// set glyph info
+	void UpdateRasterizeJob(bool LoadCache = false)
+	{
+		if(m_pRasterizeJob != nullptr)
+		{
+			if(m_pRasterizeJob->Status() != IJob::STATE_DONE)
+				return;
+			FinishRasterizeJob();
+		}
+		if(m_pEngine == nullptr || (m_vQueuedRequests.empty() && !LoadCache))
+			return;
+
+		m_pRasterizeJob = std::make_shared<CGlyphRasterizeJob>();
+		m_pRasterizeJob->m_pRasterizer = m_pRasterizer;
+		m_pRasterizeJob->m_pStorage = m_pStorage;
+		m_pRasterizeJob->m_vFontFiles = m_vFontFiles;
+		m_pRasterizeJob->m_vFaceSources = m_vFaceSources;
+		m_pRasterizeJob->m_vRequests = std::move(m_vQueuedRequests);
+		m_pRasterizeJob->m_LoadCache = LoadCache;
+		m_vQueuedRequests.clear();
+		m_pEngine->AddJob(m_pRasterizeJob);
+	}
+
+	void SaveCache()
+	{
+		if(!m_CacheDirty || m_pStorage == nullptr)
+			return;
+
+		struct SCachedGlyph
+		{
+			SGlyphCacheEntry m_Entry;
+			const SGlyph *m_pGlyph;
+			const SRasterizedGlyph *m_pRasterized;
+		};
+		std::vector<std::vector<SCachedGlyph>> vvGlyphs(m_vFontFiles.size());
+		const auto AddGlyph = [&](FT_Face Face, int Chr, int FontSize, FT_UInt GlyphIndex, const SGlyph *pGlyph, const SRasterizedGlyph *pRasterized) {
+			const size_t Index = FaceIndex(Face);
+			if(Index >= m_vFaceSources.size())
+				return;
+			const SGlyphFaceSource &Source = m_vFaceSources[Index];
+			SCachedGlyph &Cached = vvGlyphs[Source.m_FontFile].emplace_back();
+			Cached.m_Entry.m_FaceIndex = Source.m_FaceIndex;
+			Cached.m_Entry.m_Chr = Chr;
+			Cached.m_Entry.m_FontSize = FontSize;
+			Cached.m_Entry.m_GlyphIndex = GlyphIndex;
+			Cached.m_pGlyph = pGlyph;
+			Cached.m_pRasterized = pRasterized;
+		};
+		for(const auto &[Key, Glyph] : m_Glyphs)
 		{
-			const int BmpWidth = pBitmap->width + x * 2;
-			const int BmpHeight = pBitmap->rows + y * 2;
+			// skip failed glyphs that show the replacement character
+			if(Glyph.m_State == SGlyph::EState::RENDERED && Glyph.m_Face == std::get<0>(Key) && Glyph.m_Chr == std::get<1>(Key))
+				AddGlyph(Glyph.m_Face, Glyph.m_Chr, Glyph.m_FontSize, Glyph.m_GlyphIndex, &Glyph, nullptr);
+		}
+		for(const auto &[Key, Rasterized] : m_RasterizedGlyphs)
+			AddGlyph(std::get<0>(Key), std::get<1>(Key), std::get<2>(Key), Rasterized.m_GlyphIndex, nullptr, &Rasterized);
 
-			Glyph.m_Height = Height;
-			Glyph.m_Width = Width;
-			Glyph.m_CharHeight = RealHeight;
-			Glyph.m_CharWidth = RealWidth;
-			Glyph.m_OffsetX = (Glyph.m_Face->glyph->metrics.horiBearingX >> 6);
-			Glyph.m_OffsetY = -((Glyph.m_Face->glyph->metrics.height >> 6) - (Glyph.m_Face->glyph->metrics.horiBearingY >> 6));
-			Glyph.m_AdvanceX = (Glyph.m_Face->glyph->advance.x >> 6);
+		m_pStorage->CreateFolder("cache", IStorage::TYPE_SAVE);
+		m_pStorage->CreateFolder("cache/glyphs", IStorage::TYPE_SAVE);
+		std::vector<uint8_t> vData;
+		for(size_t FontFile = 0; FontFile < m_vFontFiles.size(); FontFile++)
+		{
+			if(!m_vFontFiles[FontFile].m_HashKnown || vvGlyphs[FontFile].empty())
+				continue;
 
-			Glyph.m_aUVs[0] = X;
-			Glyph.m_aUVs[1] = Y;
-			Glyph.m_aUVs[2] = Glyph.m_aUVs[0] + BmpWidth;
-			Glyph.m_aUVs[3] = Glyph.m_aUVs[1] + BmpHeight;
+			vData.resize(SGlyphCacheHeader::SERIALIZED_SIZE);
+			int NumGlyphs = 0;
+			for(SCachedGlyph &Cached : vvGlyphs[FontFile])
+			{
+				SGlyphCacheEntry &Entry = Cached.m_Entry;
+				if(Cached.m_pGlyph != nullptr)
+				{
+					const SGlyph &Glyph = *Cached.m_pGlyph;
+					Entry.m_Width = Glyph.m_Width;
+					Entry.m_Height = Glyph.m_Height;
+					Entry.m_CharWidth = Glyph.m_CharWidth;
+					Entry.m_CharHeight = Glyph.m_CharHeight;
+					Entry.m_OffsetX = Glyph.m_OffsetX;
+					Entry.m_OffsetY = Glyph.m_OffsetY;
+					Entry.m_AdvanceX = Glyph.m_AdvanceX;
+				}
+				else
+				{
+					const SRasterizedGlyph &Rasterized = *Cached.m_pRasterized;
+					Entry.m_Width = Rasterized.m_Width;
+					Entry.m_Height = Rasterized.m_Height;
+					Entry.m_CharWidth = Rasterized.m_CharWidth;
+					Entry.m_CharHeight = Rasterized.m_CharHeight;
+					Entry.m_OffsetX = Rasterized.m_OffsetX;
+					Entry.m_OffsetY = Rasterized.m_OffsetY;
+					Entry.m_AdvanceX = Rasterized.m_AdvanceX;
+				}
 
-			Glyph.m_State = SGlyph::EState::RENDERED;
+				const size_t Size = (size_t)Entry.m_Width * Entry.m_Height;
+				if(vData.size() + SGlyphCacheEntry::SERIALIZED_SIZE + Size * 2 > GLYPH_CACHE_MAX_SIZE)
+					break;
+				const size_t Offset = vData.size();
+				vData.resize(Offset + SGlyphCacheEntry::SERIALIZED_SIZE + Size * 2);
+				Entry.Serialize(&vData[Offset]);
+				uint8_t *pBitmaps = &vData[Offset + SGlyphCacheEntry::SERIALIZED_SIZE];
+				if(Cached.m_pGlyph != nullptr)
+				{
+					// copy the bitmaps back out of the atlas
+					const int X = Cached.m_pGlyph->m_aUVs[0];
+					const int Y = Cached.m_pGlyph->m_aUVs[1];
+					for(size_t TextureIndex = 0; TextureIndex < NUM_FONT_TEXTURES; ++TextureIndex)
+					{
+						for(int Row = 0; Row < Entry.m_Height; ++Row)
+						{
+							mem_copy(&pBitmaps[TextureIndex * Size + Row * Entry.m_Width], &m_apTextureData[TextureIndex][X + (Y + Row) * m_TextureDimension], Entry.m_Width);
+						}
+					}
+				}
+				else if(Size > 0)
+				{
+					mem_copy(pBitmaps, Cached.m_pRasterized->m_vData.data(), Size * 2);
+				}
+				NumGlyphs++;
+			}
+
+			SGlyphCacheHeader Header;
+			Header.m_Version = GLYPH_CACHE_VERSION;
+			Header.m_FreetypeVersion = FreetypeVersion(m_FTLibrary);
+			Header.m_NumGlyphs = NumGlyphs;
+			Header.Serialize(vData.data());
+
+			char aPath[IO_MAX_PATH_LENGTH];
+			GlyphCachePath(m_vFontFiles[FontFile].m_Sha256, aPath, sizeof(aPath));
+			char aBuf[IO_MAX_PATH_LENGTH];
+			char aTmpPath[IO_MAX_PATH_LENGTH];
+			str_copy(aTmpPath, IStorage::FormatTmpPath(aBuf, sizeof(aBuf), aPath));
+			IOHANDLE File = m_pStorage->OpenFile(aTmpPath, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+			if(!File)
+				continue;
+			const bool Written = io_write(File, vData.data(), vData.size()) == vData.size();
+			io_close(File);
+			if(!Written || !m_pStorage->RenameFile(aTmpPath, aPath, IStorage::TYPE_SAVE))
+				m_pStorage->RemoveFile(aTmpPath, IStorage::TYPE_SAVE);
 		}
-		return true;
 	}
 
 public:
-	CGlyphMap(IGraphics *pGraphics)
+	CGlyphMap(IGraphics *pGraphics, IStorage *pStorage, IEngine *pEngine, FT_Library FTLibrary)
 	{
 		m_pGraphics = pGraphics;
+		m_pStorage = pStorage;
+		m_pEngine = pEngine;
+		m_FTLibrary = FTLibrary;
 		for(auto &pTextureData : m_apTextureData)
 		{
 			pTextureData = new uint8_t[m_TextureDimension * m_TextureDimension];
@@ -595,6 +1165,16 @@ public:
 
 	~CGlyphMap()
 	{
+		if(m_pRasterizeJob != nullptr)
+		{
+			m_pRasterizeJob->m_Abort = true;
+			while(m_pRasterizeJob->Status() != IJob::STATE_DONE)
+				std::this_thread::sleep_for(1ms);
+			FinishRasterizeJob();
+		}
+		if(g_Config.m_ClTextGlyphCache)
+			SaveCache();
+
 		UnloadTextures();
 		for(auto &pTextureData : m_apTextureData)
 		{
@@ -612,13 +1192,54 @@ public:
 		return m_IconFace;
 	}
 
-	void AddFace(FT_Face Face)
+	size_t AddFontFile(const FT_Byte *pData, FT_Long DataSize)
+	{
+		m_vFontFiles.push_back({pData, DataSize, {}, false});
+		return m_vFontFiles.size() - 1;
+	}
+
+	void AddFace(FT_Face Face, size_t FontFile, FT_Long FaceIndex)
 	{
 		m_vFtFaces.push_back(Face);
+		m_vFaceSources.push_back({FontFile, FaceIndex});
 		if(!m_DefaultFace)
 			m_DefaultFace = Face;
 	}
 
+	void OnFontsLoaded()
+	{
+		// hash the font files and load their glyph caches in the background
+		UpdateRasterizeJob(g_Config.m_ClTextGlyphCache);
+	}
+
+	void PrewarmText(const char *pText)
+	{
+		const FT_Face SelectedFace = m_SelectedFace;
+		m_SelectedFace = nullptr;
+		while(*pText)
+		{
+			const int Chr = str_utf8_decode(&pText);
+			if(Chr <= 0 || std::any_of(std::begin(PREWARM_RANGES), std::end(PREWARM_RANGES), [Chr](const auto &Range) { return Chr >= Range.first && Chr <= Range.second; }))
+				continue;
+			if(!m_PrewarmCharacterSet.insert(Chr).second)
+				continue;
+			// glyphs that were already queued for the dropped character stay
+			if(m_PrewarmCharacters.size() == MAX_PREWARM_CHARACTERS)
+			{
+				m_PrewarmCharacterSet.erase(m_PrewarmCharacters.front());
+				m_PrewarmCharacters.pop_front();
+			}
+			m_PrewarmCharacters.push_back(Chr);
+			for(int FontSize = MIN_FONT_SIZE; FontSize <= PREWARM_MAX_FONT_SIZE; FontSize++)
+			{
+				if(m_aFontSizePrewarmed[FontSize])
+					QueueGlyph(Chr, FontSize);
+			}
+		}
+		m_SelectedFace = SelectedFace;
+		UpdateRasterizeJob();
+	}
+
 	void SetDefaultFaceByName(const char *pFamilyName)
 	{
 		m_DefaultFace = GetFaceByName(pFamilyName);
@@ -671,6 +1292,7 @@ public:
 
 		m_TextureAtlas.Clear(m_TextureDimension);
 		m_Glyphs.clear();
+		std::fill(std::begin(m_aFontSizePrewarmed), std::end(m_aFontSizePrewarmed), false);
 	}
 
 	const SGlyph *GetGlyph(int Chr, int FontSize)
@@ -694,7 +1316,10 @@ public:
 		else if(Glyph.m_State == SGlyph::EState::ERROR)
 			return nullptr;
 
-		// Else, render it.
+		// Else, render it. Take the glyphs that were rasterised in the
+		// background first and prewarm this font size for the next glyphs.
+		PrewarmFontSize(FontSize);
+		UpdateRasterizeJob();
 		Glyph.m_FontSize = FontSize;
 		Glyph.m_Face = Face;
 		Glyph.m_Chr = Chr;
@@ -901,6 +1526,61 @@ struct STextContainer
 	}
 };
 
+struct STextLayoutKey
+{
+	std::string m_Text;
+	float m_X;
+	float m_Y;
+	float m_FontSize;
+	float m_LineWidth;
+	int m_MaxLines;
+	int m_Flags;
+	unsigned m_RenderFlags;
+	EFontPreset m_FontPreset;
+	STextCharQuadVertexColor m_Color;
+	float m_aScreen[4];
+	int m_ScreenWidth;
+	int m_ScreenHeight;
+
+	bool operator==(const STextLayoutKey &Other) const
+	{
+		return m_X == Other.m_X && m_Y == Other.m_Y && m_FontSize == Other.m_FontSize && m_LineWidth == Other.m_LineWidth &&
+		       m_MaxLines == Other.m_MaxLines && m_Flags == Other.m_Flags && m_RenderFlags == Other.m_RenderFlags && m_FontPreset == Other.m_FontPreset &&
+		       m_Color == Other.m_Color && mem_comp(m_aScreen, Other.m_aScreen, sizeof(m_aScreen)) == 0 &&
+		       m_ScreenWidth == Other.m_ScreenWidth && m_ScreenHeight == Other.m_ScreenHeight && m_Text == Other.m_Text;
+	}
+};
+
+struct STextLayoutKeyHash
+{
+	size_t operator()(const STextLayoutKey &Key) const
+	{
+		size_t Hash = std::hash<std::string>()(Key.m_Text);
+		Hash = Hash * 31 + std::hash<float>()(Key.m_X);
+		Hash = Hash * 31 + std::hash<float>()(Key.m_Y);
+		Hash = Hash * 31 + std::hash<float>()(Key.m_FontSize);
+		Hash = Hash * 31 + std::hash<float>()(Key.m_LineWidth);
+		Hash = Hash * 31 + std::hash<int>()(Key.m_Flags);
+		Hash = Hash * 31 + std::hash<unsigned>()(Key.m_RenderFlags);
+		return Hash;
+	}
+};
+
+/**
+ * Result of a call to TextEx, reused when the same text is rendered again
+ * with the same cursor, colour and screen mapping.
+ */
+struct STextLayout
+{
+	// the layout is only kept when the text is rendered a second time,
+	// so text that changes every frame does not fill the cache
+	bool m_Admitted = false;
+	// only the results of the layout are set
+	CTextCursor m_Cursor;
+	STextContainerIndex m_TextContainerIndex;
+	std::list<const STextLayoutKey *>::iterator m_LruPosition;
+};
+
 struct SFontLanguageVariant
 {
 	char m_aLanguageFile[IO_MAX_PATH_LENGTH];
@@ -937,6 +1617,82 @@ class CTextRender : public IEngineTextRender
 
 	std::chrono::nanoseconds m_CursorRenderTime;
 
+	/**
+	 * Maximum number of text layouts that are cached, the least recently
+	 * used layout is evicted first.
+	 */
+	static constexpr size_t TEXT_LAYOUT_CACHE_SIZE = 1024;
+
+	/**
+	 * Longer texts are not cached.
+	 */
+	static constexpr int TEXT_LAYOUT_MAX_LENGTH = 1024;
+
+	EFontPreset m_FontPreset = EFontPreset::DEFAULT_FONT;
+	std::unordered_map<STextLayoutKey, STextLayout, STextLayoutKeyHash> m_TextLayouts;
+	// most recently used first
+	std::list<const STextLayoutKey *> m_TextLayoutLru;
+	STextLayoutCacheStats m_TextLayoutCacheStats;
+	// TextEx calls itself to measure words, those calls are not cached
+	int m_TextExDepth = 0;
+
+	bool TextLayoutKey(STextLayoutKey &Key, const CTextCursor *pCursor, const char *pText, int Length)
+	{
+		if(m_TextExDepth > 0 ||
+			pCursor->m_CalculateSelectionMode != TEXT_CURSOR_SELECTION_MODE_NONE || pCursor->m_CursorMode != TEXT_CURSOR_CURSOR_MODE_NONE ||
+			pCursor->m_LineCount != 1 || pCursor->m_GlyphCount != 0 || pCursor->m_CharCount != 0 ||
+			pCursor->m_X != pCursor->m_StartX || pCursor->m_Y != pCursor->m_StartY ||
+			pCursor->m_MaxCharacterHeight != 0.0f || pCursor->m_LongestLineWidth != 0.0f)
+			return false;
+
+		Length = Length < 0 ? str_length(pText) : minimum(Length, str_length(pText));
+		if(Length > TEXT_LAYOUT_MAX_LENGTH)
+			return false;
+
+		Key.m_Text.assign(pText, Length);
+		Key.m_X = pCursor->m_X;
+		Key.m_Y = pCursor->m_Y;
+		Key.m_FontSize = pCursor->m_FontSize;
+		Key.m_LineWidth = pCursor->m_LineWidth;
+		Key.m_MaxLines = pCursor->m_MaxLines;
+		Key.m_Flags = pCursor->m_Flags;
+		Key.m_RenderFlags = m_RenderFlags;
+		Key.m_FontPreset = m_FontPreset;
+		// same conversion as for the vertices
+		Key.m_Color = STextCharQuadVertexColor((unsigned char)(m_Color.r * 255.f), (unsigned char)(m_Color.g * 255.f), (unsigned char)(m_Color.b * 255.f), (unsigned char)(m_Color.a * 255.f));
+		Graphics()->GetScreen(&Key.m_aScreen[0], &Key.m_aScreen[1], &Key.m_aScreen[2], &Key.m_aScreen[3]);
+		Key.m_ScreenWidth = Graphics()->ScreenWidth();
+		Key.m_ScreenHeight = Graphics()->ScreenHeight();
+		return true;
+	}
+
+	void EvictTextLayout()
+	{
+		const auto It = m_TextLayouts.find(*m_TextLayoutLru.back());
+		DeleteTextContainer(It->second.m_TextContainerIndex);
+		m_TextLayouts.erase(It);
+		m_TextLayoutLru.pop_back();
+	}
+
+	static void CopyTextLayoutResult(CTextCursor *pDest, const CTextCursor &Source)
+	{
+		pDest->m_Flags = Source.m_Flags;
+		pDest->m_LineCount = Source.m_LineCount;
+		pDest->m_GlyphCount = Source.m_GlyphCount;
+		pDest->m_CharCount = Source.m_CharCount;
+		pDest->m_X = Source.m_X;
+		pDest->m_Y = Source.m_Y;
+		pDest->m_MaxCharacterHeight = Source.m_MaxCharacterHeight;
+		pDest->m_LongestLineWidth = Source.m_LongestLineWidth;
+		pDest->m_AlignedFontSize = Source.m_AlignedFontSize;
+	}
+
+	void ClearTextLayouts()
+	{
+		while(!m_TextLayoutLru.empty())
+			EvictTextLayout();
+	}
+
 	int GetFreeTextContainerIndex()
 	{
 		if(m_FirstFreeTextContainerIndex == -1)
@@ -1012,6 +1768,7 @@ class CTextRender : public IEngineTextRender
 		FT_Done_Face(FtFace);
 
 		bool LoadedAny = false;
+		size_t FontFile = 0;
 		for(FT_Long FaceIndex = 0; FaceIndex < NumFaces; ++FaceIndex)
 		{
 			FT_Error FaceLoadError = FT_New_Memory_Face(m_FTLibrary, pFontData, FontDataSize, FaceIndex, &FtFace);
@@ -1024,7 +1781,9 @@ class CTextRender : public IEngineTextRender
 				continue;
 			}
 
-			m_pGlyphMap->AddFace(FtFace);
+			if(!LoadedAny)
+				FontFile = m_pGlyphMap->AddFontFile(pFontData, FontDataSize);
+			m_pGlyphMap->AddFace(FtFace, FontFile, FaceIndex);
 
 			char aBuf[256];
 			str_format(aBuf, sizeof(aBuf), "Loaded font face %ld '%s %s' from font file '%s'", FaceIndex, FtFace->family_name, FtFace->style_name, pFontName);
@@ -1077,7 +1836,7 @@ public:
 		m_pGraphics = Kernel()->RequestInterface<IGraphics>();
 		m_pStorage = Kernel()->RequestInterface<IStorage>();
 		FT_Init_FreeType(&m_FTLibrary);
-		m_pGlyphMap = new CGlyphMap(m_pGraphics);
+		m_pGlyphMap = new CGlyphMap(m_pGraphics, m_pStorage, Kernel()->RequestInterface<IEngine>(), m_FTLibrary);
 
 		// print freetype version
 		{
@@ -1120,6 +1879,7 @@ public:
 
 	void Shutdown() override
 	{
+		ClearTextLayouts();
 		for(auto *pTextCont : m_vpTextContainers)
 			delete pTextCont;
 		m_vpTextContainers.clear();
@@ -1241,15 +2001,26 @@ public:
 		}
 
 		json_value_free(pJsonData);
+
+		ClearTextLayouts();
+		m_pGlyphMap->OnFontsLoaded();
+	}
+
+	void PrewarmText(const char *pText) override
+	{
+		m_pGlyphMap->PrewarmText(pText);
 	}
 
 	void SetFontPreset(EFontPreset FontPreset) override
 	{
+		m_FontPreset = FontPreset;
 		m_pGlyphMap->SetFontPreset(FontPreset);
 	}
 
 	void SetFontLanguageVariant(const char *pLanguageFile) override
 	{
+		// the atlas is rebuilt when the variant font changes
+		ClearTextLayouts();
 		for(const auto &Variant : m_vVariants)
 		{
 			if(str_comp(pLanguageFile, Variant.m_aLanguageFile) == 0)
@@ -1393,8 +2164,61 @@ public:
 		return m_SelectionColor;
 	}
 
+	STextLayoutCacheStats TextLayoutCacheStats() const override
+	{
+		STextLayoutCacheStats Stats = m_TextLayoutCacheStats;
+		Stats.m_Entries = m_TextLayouts.size();
+		return Stats;
+	}
+
 	void TextEx(CTextCursor *pCursor, const char *pText, int Length = -1) override
 	{
+		STextLayoutKey Key;
+		if(TextLayoutKey(Key, pCursor, pText, Length))
+		{
+			auto It = m_TextLayouts.find(Key);
+			const bool Seen = It != m_TextLayouts.end();
+			if(!Seen)
+			{
+				if(m_TextLayouts.size() >= TEXT_LAYOUT_CACHE_SIZE)
+					EvictTextLayout();
+				It = m_TextLayouts.emplace(std::move(Key), STextLayout()).first;
+				m_TextLayoutLru.push_front(&It->first);
+				It->second.m_LruPosition = m_TextLayoutLru.begin();
+			}
+			else
+			{
+				m_TextLayoutLru.splice(m_TextLayoutLru.begin(), m_TextLayoutLru, It->second.m_LruPosition);
+			}
+
+			STextLayout &Layout = It->second;
+			if(Layout.m_Admitted)
+			{
+				m_TextLayoutCacheStats.m_Hits++;
+				CopyTextLayoutResult(pCursor, Layout.m_Cursor);
+				if(Layout.m_TextContainerIndex.Valid())
+					RenderTextContainer(Layout.m_TextContainerIndex, DefaultTextColor(), DefaultTextOutlineColor());
+				return;
+			}
+
+			m_TextLayoutCacheStats.m_Misses++;
+			if(Seen)
+			{
+				// keep the layout when the text is rendered the second time
+				CreateTextContainer(Layout.m_TextContainerIndex, pCursor, pText, Length);
+				Layout.m_Admitted = true;
+				CopyTextLayoutResult(&Layout.m_Cursor, *pCursor);
+				if(Layout.m_TextContainerIndex.Valid())
+				{
+					if((pCursor->m_Flags & TEXTFLAG_RENDER) != 0)
+						RenderTextContainer(Layout.m_TextContainerIndex, DefaultTextColor(), DefaultTextOutlineColor());
+					else
+						DeleteTextContainer(Layout.m_TextContainerIndex);
+				}
+				return;
+			}
+		}
+
 		const unsigned OldRenderFlags = m_RenderFlags;
 		m_RenderFlags |= TEXT_RENDER_FLAG_ONE_TIME_USE;
 		STextContainerIndex TextCont;
@@ -1466,6 +2290,7 @@ public:
 
 	void AppendTextContainer(STextContainerIndex TextContainerIndex, CTextCursor *pCursor, const char *pText, int Length = -1) override
 	{
+		m_TextExDepth++;
 		STextContainer &TextContainer = GetTextContainer(TextContainerIndex);
 		str_append(TextContainer.m_aDebugText, pText);
 
@@ -1967,6 +2792,7 @@ public:
 			pCursor->m_Y = DrawY;
 
 		TextContainer.m_BoundingBox = pCursor->BoundingBox();
+		m_TextExDepth--;
 	}
 
 	bool CreateOrAppendTextContainer(STextContainerIndex &TextContainerIndex, CTextCursor *pCursor, const char *pText, int Length = -1) override
@@ -2225,6 +3051,7 @@ public:
 
 	void OnPreWindowResize() override
 	{
+		ClearTextLayouts();
 		for(auto *pTextContainer : m_vpTextContainers)
 		{
 			if(pTextContainer->m_ContainerIndex.Valid() && pTextContainer->m_ContainerIndex.m_UseCount.use_count() <= 1)
@@ -234,6 +234,14 @@ struct CDataSprite; // NOLINT(bugprone-forward-declaration-namespace)
 
 typedef std::function<bool(uint32_t &Width, uint32_t &Height, CImageInfo::EImageFormat &Format, std::vector<uint8_t> &vDstData)> TGLBackendReadPresentedImageData;
 
+struct SDrawCallStats
+{
+	// quads, triangles and lines drawn between Begin and End
+	int64_t m_Submitted = 0;
+	// render commands they were batched into
+	int64_t m_Drawn = 0;
+};
+
 class IGraphics : public IInterface
 {
 	MACRO_INTERFACE("graphics", 0)
@@ -323,6 +331,8 @@ public:
 	virtual uint64_t StreamedMemoryUsage() const = 0;
 	virtual uint64_t StagingMemoryUsage() const = 0;
 
+	virtual SDrawCallStats DrawCallStats() const = 0;
+
 	virtual const TTWGraphicsGPUList &GetGPUs() const = 0;
 
 	virtual int LoadPNG(CImageInfo *pImg, const char *pFilename, int StorageType) = 0;
@@ -414,6 +424,8 @@ public:
 	virtual void QuadsTex3DEnd() = 0;
 	virtual void TrianglesBegin() = 0;
 	virtual void TrianglesEnd() = 0;
+	// call FlushVertices() before QuadsBegin(), else the kept vertices can
+	// contain the ones of earlier draws with the same state
 	virtual void QuadsEndKeepVertices() = 0;
 	virtual void QuadsDrawCurrentVertices(bool KeepVertices = true) = 0;
 	virtual void QuadsSetRotation(float Angle) = 0;
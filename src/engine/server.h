@@ -17,6 +17,8 @@
 #include <game/generated/protocolglue.h>
 
 struct CAntibotRoundData;
+class CLoadShedder;
+class CTickProfiler;
 
 // When recording a demo on the server, the ClientID -1 is used
 enum
@@ -270,6 +272,9 @@ public:
 	virtual const char *GetMapName() const = 0;
 
 	virtual bool IsSixup(int ClientID) const = 0;
+
+	virtual CTickProfiler *TickProfiler() = 0;
+	virtual CLoadShedder *LoadShedder() = 0;
 };
 
 class IGameServer : public IInterface
@@ -318,6 +323,8 @@ public:
 
 	virtual bool IsClientReady(int ClientID) const = 0;
 	virtual bool IsClientPlayer(int ClientID) const = 0;
+	// neither spectating nor paused
+	virtual bool IsClientActivePlayer(int ClientID) const = 0;
 
 	virtual int PersistentDataSize() const = 0;
 	virtual int PersistentClientDataSize() const = 0;
@@ -326,6 +333,8 @@ public:
 	virtual const char *GameType() const = 0;
 	virtual const char *Version() const = 0;
 	virtual const char *NetVersion() const = 0;
+	virtual const char *NetObjName(int Type, bool Sixup) const = 0;
+	virtual const char *NetMsgName(int Type, bool Sixup) const = 0;
 
 	// DDRace
 
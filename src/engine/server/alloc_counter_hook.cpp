@@ -0,0 +1,34 @@
+// Replaces operator new to count allocations for CAllocCounter. Only linked
+// into the targets that report the counts, so the client and the tools keep
+// the default allocator.
+#include <engine/shared/alloc_counter.h>
+
+#if defined(CONF_DEBUG)
+#include <cstdlib>
+#include <new>
+
+// The array and nothrow forms of operator new and delete default to these,
+// so replacing them counts every allocation that doesn't request an
+// extended alignment. The server is built without exceptions, running out
+// of memory aborts.
+void *operator new(std::size_t Size)
+{
+	CAllocCounter::Count();
+	void *pData = malloc(Size ? Size : 1);
+	if(!pData)
+		abort();
+	return pData;
+}
+
+void operator delete(void *pData) noexcept
+{
+	free(pData);
+}
+
+void operator delete(void *pData, std::size_t Size) noexcept
+{
+	free(pData);
+}
+
+static const bool gs_AllocCounterEnabled = CAllocCounter::Enable();
+#endif
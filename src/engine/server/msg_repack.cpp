@@ -0,0 +1,67 @@
+#include "msg_repack.h"
+
+#include <base/system.h>
+#include <engine/message.h>
+#include <engine/shared/bandwidth_stats.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/protocol7.h>
+#include <engine/shared/uuid_manager.h>
+#include <game/generated/protocolglue.h>
+
+int RepackMsg(const CMsgPacker *pMsg, CPacker &Packer, bool Sixup)
+{
+	int MsgId = pMsg->m_MsgID;
+	Packer.Reset();
+
+	if(Sixup && !pMsg->m_NoTranslate)
+	{
+		if(pMsg->m_System)
+		{
+			if(MsgId >= OFFSET_UUID)
+				;
+			else if(MsgId >= NETMSG_MAP_CHANGE && MsgId <= NETMSG_MAP_DATA)
+				;
+			else if(MsgId >= NETMSG_CON_READY && MsgId <= NETMSG_INPUTTIMING)
+				MsgId += 1;
+			else if(MsgId == NETMSG_RCON_LINE)
+				MsgId = protocol7::NETMSG_RCON_LINE;
+			else if(MsgId >= NETMSG_PING && MsgId <= NETMSG_PING_REPLY)
+				MsgId += 4;
+			else if(MsgId >= NETMSG_RCON_CMD_ADD && MsgId <= NETMSG_RCON_CMD_REM)
+				MsgId -= 11;
+			else
+			{
+				dbg_msg("net", "DROP send sys %d", MsgId);
+				return -1;
+			}
+		}
+		else
+		{
+			if(MsgId >= 0 && MsgId < OFFSET_UUID)
+				MsgId = Msg_SixToSeven(MsgId);
+
+			if(MsgId < 0)
+				return -1;
+		}
+	}
+
+	if(MsgId < OFFSET_UUID)
+	{
+		Packer.AddInt((MsgId << 1) | (pMsg->m_System ? 1 : 0));
+	}
+	else
+	{
+		Packer.AddInt(pMsg->m_System ? 1 : 0); // NETMSG_EX, NETMSGTYPE_EX
+		g_UuidManager.PackUuid(MsgId, &Packer);
+	}
+	Packer.AddRaw(pMsg->Data(), pMsg->Size());
+
+	return MsgId;
+}
+
+void CountSentMsg(CBandwidthStats &Stats, const CMsgPacker *pMsg, int PackedMsgID, int Size, int Flags)
+{
+	Stats.Add(pMsg->m_System ? CBandwidthStats::CATEGORY_SYSTEM_MSG : CBandwidthStats::CATEGORY_GAME_MSG, PackedMsgID, Size);
+	if(Flags & MSGFLAG_VITAL)
+		Stats.AddVital(Size);
+}
@@ -0,0 +1,16 @@
+#ifndef ENGINE_SERVER_MSG_REPACK_H
+#define ENGINE_SERVER_MSG_REPACK_H
+
+class CBandwidthStats;
+class CMsgPacker;
+class CPacker;
+
+// packs the message for a 0.6 or a 0.7 client, returns the message ID that
+// was packed or -1 if the message can't be sent to this kind of client
+int RepackMsg(const CMsgPacker *pMsg, CPacker &Packer, bool Sixup);
+
+// counts a sent message under the ID returned by RepackMsg, so that the
+// counters of 0.7 clients only hold 0.7 IDs
+void CountSentMsg(CBandwidthStats &Stats, const CMsgPacker *pMsg, int PackedMsgID, int Size, int Flags);
+
+#endif // ENGINE_SERVER_MSG_REPACK_H
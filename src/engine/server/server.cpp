@@ -14,6 +14,7 @@
 #include <engine/server.h>
 #include <engine/storage.h>
 
+#include <engine/shared/alloc_counter.h>
 #include <engine/shared/compression.h>
 #include <engine/shared/config.h>
 #include <engine/shared/console.h>
@@ -23,6 +24,7 @@
 #include <engine/shared/filecollection.h>
 #include <engine/shared/http.h>
 #include <engine/shared/json.h>
+#include <engine/shared/jsonwriter.h>
 #include <engine/shared/masterserver.h>
 #include <engine/shared/netban.h>
 #include <engine/shared/network.h>
@@ -42,7 +44,9 @@
 
 #include "databases/connection.h"
 #include "databases/connection_pool.h"
+#include "msg_repack.h"
 #include "register.h"
+#include "server_logger.h"
 
 extern bool IsInterrupted();
 
@@ -321,6 +325,7 @@ CServer::CServer()
 	m_pGameServer = 0;
 
 	m_CurrentGameTick = MIN_TICK;
+	m_SnapshotCounter = 0;
 	m_RunServer = UNINITIALIZED;
 
 	m_aShutdownReason[0] = 0;
@@ -342,6 +347,12 @@ CServer::CServer()
 	m_ServerInfoNumRequests = 0;
 	m_ServerInfoNeedsUpdate = false;
 
+	m_TickProfilerLastPrint = 0;
+	m_aTickProfilerTraceFile[0] = '\0';
+	m_BandwidthStatsLastWrite = 0;
+	m_pServerLogger = nullptr;
+	m_LoadShedder.Init(SERVER_TICK_SPEED);
+
 #ifdef CONF_FAMILY_UNIX
 	m_ConnLoggingSocketCreated = false;
 #endif
@@ -770,57 +781,6 @@ int CServer::GetClientVersion(int ClientID) const
 	return VERSION_NONE;
 }
 
-static inline bool RepackMsg(const CMsgPacker *pMsg, CPacker &Packer, bool Sixup)
-{
-	int MsgId = pMsg->m_MsgID;
-	Packer.Reset();
-
-	if(Sixup && !pMsg->m_NoTranslate)
-	{
-		if(pMsg->m_System)
-		{
-			if(MsgId >= OFFSET_UUID)
-				;
-			else if(MsgId >= NETMSG_MAP_CHANGE && MsgId <= NETMSG_MAP_DATA)
-				;
-			else if(MsgId >= NETMSG_CON_READY && MsgId <= NETMSG_INPUTTIMING)
-				MsgId += 1;
-			else if(MsgId == NETMSG_RCON_LINE)
-				MsgId = protocol7::NETMSG_RCON_LINE;
-			else if(MsgId >= NETMSG_PING && MsgId <= NETMSG_PING_REPLY)
-				MsgId += 4;
-			else if(MsgId >= NETMSG_RCON_CMD_ADD && MsgId <= NETMSG_RCON_CMD_REM)
-				MsgId -= 11;
-			else
-			{
-				dbg_msg("net", "DROP send sys %d", MsgId);
-				return true;
-			}
-		}
-		else
-		{
-			if(MsgId >= 0 && MsgId < OFFSET_UUID)
-				MsgId = Msg_SixToSeven(MsgId);
-
-			if(MsgId < 0)
-				return true;
-		}
-	}
-
-	if(MsgId < OFFSET_UUID)
-	{
-		Packer.AddInt((MsgId << 1) | (pMsg->m_System ? 1 : 0));
-	}
-	else
-	{
-		Packer.AddInt(pMsg->m_System ? 1 : 0); // NETMSG_EX, NETMSGTYPE_EX
-		g_UuidManager.PackUuid(MsgId, &Packer);
-	}
-	Packer.AddRaw(pMsg->Data(), pMsg->Size());
-
-	return false;
-}
-
 int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID)
 {
 	CNetChunk Packet;
@@ -833,9 +793,11 @@ int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID)
 	if(ClientID < 0)
 	{
 		CPacker Pack6, Pack7;
-		if(RepackMsg(pMsg, Pack6, false))
+		const int MsgId6 = RepackMsg(pMsg, Pack6, false);
+		if(MsgId6 < 0)
 			return -1;
-		if(RepackMsg(pMsg, Pack7, true))
+		const int MsgId7 = RepackMsg(pMsg, Pack7, true);
+		if(MsgId7 < 0)
 			return -1;
 
 		// write message to demo recorders
@@ -860,6 +822,8 @@ int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID)
 					{
 						continue;
 					}
+					if(Config()->m_SvBandwidthStats)
+						CountSentMsg(m_aClients[i].m_BandwidthStats, pMsg, m_aClients[i].m_Sixup ? MsgId7 : MsgId6, Packet.m_DataSize, Flags);
 					m_NetServer.Send(&Packet);
 				}
 			}
@@ -868,7 +832,8 @@ int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID)
 	else
 	{
 		CPacker Pack;
-		if(RepackMsg(pMsg, Pack, m_aClients[ClientID].m_Sixup))
+		const int MsgId = RepackMsg(pMsg, Pack, m_aClients[ClientID].m_Sixup);
+		if(MsgId < 0)
 			return -1;
 
 		Packet.m_ClientID = ClientID;
@@ -890,12 +855,21 @@ int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID)
 		}
 
 		if(!(Flags & MSGFLAG_NOSEND))
+		{
+			if(Config()->m_SvBandwidthStats)
+				CountSentMsg(m_aClients[ClientID].m_BandwidthStats, pMsg, MsgId, Packet.m_DataSize, Flags);
 			m_NetServer.Send(&Packet);
+		}
 	}
 
 	return 0;
 }
 
+static void CountSnapItemBytes(int Type, int Bytes, void *pUser)
+{
+	((CBandwidthStats *)pUser)->Add(CBandwidthStats::CATEGORY_SNAP, Type, Bytes);
+}
+
 void CServer::SendMsgRaw(int ClientID, const void *pData, int Size, int Flags)
 {
 	CNetChunk Packet;
@@ -919,17 +893,32 @@ void CServer::DoSnapshot()
 {
 	GameServer()->OnPreSnap();
 
+	// count snapshot rounds, they only run on every other tick without sv_high_bandwidth
+	const int SnapshotCounter = m_SnapshotCounter++;
+
+	// record demo snapshots at half rate while shedding load
+	const bool SkipDemoSnap = m_LoadShedder.Active(CLoadShedder::LEVEL_DEMO) && (SnapshotCounter % 2) != 0;
+
 	// create snapshot for demo recording
-	if(m_aDemoRecorder[MAX_CLIENTS].IsRecording())
+	if(m_aDemoRecorder[MAX_CLIENTS].IsRecording() && SkipDemoSnap)
+	{
+		m_LoadShedder.Count(CLoadShedder::COUNTER_DEMO_SNAPS);
+	}
+	else if(m_aDemoRecorder[MAX_CLIENTS].IsRecording())
 	{
 		char aData[CSnapshot::MAX_SIZE];
 
 		// build snap and possibly add some messages
-		m_SnapshotBuilder.Init();
-		GameServer()->OnSnap(-1);
-		int SnapshotSize = m_SnapshotBuilder.Finish(aData);
+		int SnapshotSize;
+		{
+			CTickProfileScope ProfileScope(&m_TickProfiler, CTickProfiler::PHASE_SNAP_BUILD);
+			m_SnapshotBuilder.Init();
+			GameServer()->OnSnap(-1);
+			SnapshotSize = m_SnapshotBuilder.Finish(aData);
+		}
 
 		// write snapshot
+		CTickProfileScope ProfileScope(&m_TickProfiler, CTickProfiler::PHASE_DEMO);
 		m_aDemoRecorder[MAX_CLIENTS].RecordSnapshot(Tick(), aData, SnapshotSize);
 	}
 
@@ -948,22 +937,39 @@ void CServer::DoSnapshot()
 		if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_INIT && (Tick() % 10) != 0)
 			continue;
 
+		// the server is overloaded, spectators and paused players get a quarter of the snapshots
+		if(m_LoadShedder.Active(CLoadShedder::LEVEL_SPECTATOR_SNAPS) && (SnapshotCounter % 4) != 0 && !GameServer()->IsClientActivePlayer(i))
 		{
-			m_SnapshotBuilder.Init(m_aClients[i].m_Sixup);
-
-			GameServer()->OnSnap(i);
+			m_LoadShedder.Count(CLoadShedder::COUNTER_SPECTATOR_SNAPS);
+			continue;
+		}
 
-			// finish snapshot
+		{
 			char aData[CSnapshot::MAX_SIZE];
 			CSnapshot *pData = (CSnapshot *)aData; // Fix compiler warning for strict-aliasing
-			int SnapshotSize = m_SnapshotBuilder.Finish(pData);
+			int SnapshotSize;
+			{
+				CTickProfileScope ProfileScope(&m_TickProfiler, CTickProfiler::PHASE_SNAP_BUILD);
+				m_SnapshotBuilder.Init(m_aClients[i].m_Sixup);
+
+				GameServer()->OnSnap(i);
 
-			if(m_aDemoRecorder[i].IsRecording())
+				// finish snapshot
+				SnapshotSize = m_SnapshotBuilder.Finish(pData);
+			}
+
+			if(m_aDemoRecorder[i].IsRecording() && SkipDemoSnap)
+			{
+				m_LoadShedder.Count(CLoadShedder::COUNTER_DEMO_SNAPS);
+			}
+			else if(m_aDemoRecorder[i].IsRecording())
 			{
 				// write snapshot
+				CTickProfileScope ProfileScope(&m_TickProfiler, CTickProfiler::PHASE_DEMO);
 				m_aDemoRecorder[i].RecordSnapshot(Tick(), aData, SnapshotSize);
 			}
 
+			CTickProfileScope DeltaProfileScope(&m_TickProfiler, CTickProfiler::PHASE_SNAP_DELTA);
 			int Crc = pData->Crc();
 
 			// remove old snapshots
@@ -995,7 +1001,11 @@ void CServer::DoSnapshot()
 			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, m_aClients[i].m_Sixup);
 			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, m_aClients[i].m_Sixup);
 			char aDeltaData[CSnapshot::MAX_SIZE];
-			int DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData);
+			int DeltaSize;
+			if(Config()->m_SvBandwidthStats)
+				DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData, CountSnapItemBytes, &m_aClients[i].m_BandwidthStats);
+			else
+				DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData);
 
 			if(DeltaSize)
 			{
@@ -1006,6 +1016,8 @@ void CServer::DoSnapshot()
 				SnapshotSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
 				int NumPackets = (SnapshotSize + MaxSize - 1) / MaxSize;
 
+				DeltaProfileScope.End();
+				CTickProfileScope SendProfileScope(&m_TickProfiler, CTickProfiler::PHASE_SNAP_SEND);
 				for(int n = 0, Left = SnapshotSize; Left > 0; n++)
 				{
 					int Chunk = Left < MaxSize ? Left : MaxSize;
@@ -1037,6 +1049,8 @@ void CServer::DoSnapshot()
 			}
 			else
 			{
+				DeltaProfileScope.End();
+				CTickProfileScope SendProfileScope(&m_TickProfiler, CTickProfiler::PHASE_SNAP_SEND);
 				CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
 				Msg.AddInt(m_CurrentGameTick);
 				Msg.AddInt(m_CurrentGameTick - DeltaTick);
@@ -1084,6 +1098,7 @@ int CServer::NewClientNoAuthCallback(int ClientID, void *pUser)
 	pThis->m_aClients[ClientID].m_AuthKey = -1;
 	pThis->m_aClients[ClientID].m_AuthTries = 0;
 	pThis->m_aClients[ClientID].m_pRconCmdToSend = 0;
+	pThis->m_aClients[ClientID].m_BandwidthStats.Reset();
 	pThis->m_aClients[ClientID].m_ShowIps = false;
 	pThis->m_aClients[ClientID].m_DDNetVersion = VERSION_NONE;
 	pThis->m_aClients[ClientID].m_GotDDNetVersionPacket = false;
@@ -1115,6 +1130,7 @@ int CServer::NewClientCallback(int ClientID, void *pUser, bool Sixup)
 	pThis->m_aClients[ClientID].m_pRconCmdToSend = 0;
 	pThis->m_aClients[ClientID].m_Traffic = 0;
 	pThis->m_aClients[ClientID].m_TrafficSince = 0;
+	pThis->m_aClients[ClientID].m_BandwidthStats.Reset();
 	pThis->m_aClients[ClientID].m_ShowIps = false;
 	pThis->m_aClients[ClientID].m_DDNetVersion = VERSION_NONE;
 	pThis->m_aClients[ClientID].m_GotDDNetVersionPacket = false;
@@ -1863,10 +1879,18 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 
 bool CServer::RateLimitServerInfoConnless()
 {
+	int Limit = Config()->m_SvServerInfoPerSecond;
+	const bool Shedding = m_LoadShedder.Active(CLoadShedder::LEVEL_SERVERINFO);
+	if(Shedding)
+	{
+		// send only a quarter of the complete responses while overloaded
+		Limit = maximum((Limit ? Limit : 50) / 4, 1);
+	}
+
 	bool SendClients = true;
-	if(Config()->m_SvServerInfoPerSecond)
+	if(Limit)
 	{
-		SendClients = m_ServerInfoNumRequests <= Config()->m_SvServerInfoPerSecond;
+		SendClients = m_ServerInfoNumRequests <= Limit;
 		const int64_t Now = Tick();
 
 		if(Now <= m_ServerInfoFirstRequest + TickSpeed())
@@ -1880,6 +1904,8 @@ bool CServer::RateLimitServerInfoConnless()
 		}
 	}
 
+	if(Shedding && !SendClients)
+		m_LoadShedder.Count(CLoadShedder::COUNTER_SERVERINFO);
 	return SendClients;
 }
 
@@ -2408,6 +2434,8 @@ void CServer::UpdateServerInfo(bool Resend)
 
 void CServer::PumpNetwork(bool PacketWaiting)
 {
+	CTickProfileScope ProfileScope(&m_TickProfiler, CTickProfiler::PHASE_NETWORK);
+
 	CNetChunk Packet;
 	SECURITY_TOKEN ResponseToken;
 
@@ -2739,6 +2767,9 @@ int CServer::Run()
 		UpdateServerInfo();
 		while(m_RunServer < STOPPING)
 		{
+			const int64_t LoopStart = time_get_nanoseconds().count();
+			m_TickProfiler.BeginLoop(m_CurrentGameTick);
+
 			if(NonActive)
 				PumpNetwork(PacketWaiting);
 
@@ -2892,7 +2923,10 @@ int CServer::Run()
 						GameServer()->OnClientPredictedInput(c, nullptr);
 				}
 
-				GameServer()->OnTick();
+				{
+					CTickProfileScope ProfileScope(&m_TickProfiler, CTickProfiler::PHASE_GAME_TICK);
+					GameServer()->OnTick();
+				}
 				if(ErrorShutdown())
 				{
 					break;
@@ -2935,6 +2969,18 @@ int CServer::Run()
 				}
 			}
 
+			// forward log messages of the other threads to rcon and econ
+			if(m_pServerLogger)
+				m_pServerLogger->Flush();
+
+			m_TickProfiler.EndLoop(NewTicks > 0);
+			if(NewTicks)
+			{
+				UpdateTickProfiler();
+				UpdateBandwidthStats();
+			}
+			UpdateLoadShedder(time_get_nanoseconds().count() - LoopStart, NewTicks);
+
 			// wait for incoming data
 			if(NonActive)
 			{
@@ -3493,6 +3539,331 @@ void CServer::ConShowIps(IConsole::IResult *pResult, void *pUser)
 	}
 }
 
+void CServer::PrintTickProfile(int Phase)
+{
+	char aBuf[256];
+	if(Phase >= 0)
+	{
+		int aBuckets[CTickProfiler::NUM_HISTOGRAM_BUCKETS];
+		m_TickProfiler.GetHistogram(Phase, aBuckets);
+		str_format(aBuf, sizeof(aBuf), "histogram of '%s' over the last %d ticks:", CTickProfiler::PhaseName(Phase), m_TickProfiler.HistorySize());
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tick_profiler", aBuf);
+		for(int i = 0; i < CTickProfiler::NUM_HISTOGRAM_BUCKETS; i++)
+		{
+			if(i < CTickProfiler::NUM_HISTOGRAM_BUCKETS - 1)
+				str_format(aBuf, sizeof(aBuf), "  < %6dus: %d", 16 << i, aBuckets[i]);
+			else
+				str_format(aBuf, sizeof(aBuf), "  >= %5dus: %d", 16 << (i - 1), aBuckets[i]);
+			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tick_profiler", aBuf);
+		}
+		return;
+	}
+
+	str_format(aBuf, sizeof(aBuf), "%-16s %8s %8s %8s %8s (us, last %d ticks)", "phase", "avg", "p50", "p95", "max", m_TickProfiler.HistorySize());
+	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tick_profiler", aBuf);
+	for(int i = 0; i <= CTickProfiler::NUM_PHASES; i++)
+	{
+		CTickProfiler::CStats Stats;
+		m_TickProfiler.GetStats(i, &Stats);
+		str_format(aBuf, sizeof(aBuf), "%-16s %8d %8d %8d %8d", CTickProfiler::PhaseName(i),
+			(int)(Stats.m_Avg / 1000), (int)(Stats.m_P50 / 1000), (int)(Stats.m_P95 / 1000), (int)(Stats.m_Max / 1000));
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tick_profiler", aBuf);
+	}
+
+	if(CAllocCounter::Enabled())
+	{
+		CTickProfiler::CStats Stats;
+		m_TickProfiler.GetAllocationStats(&Stats);
+		str_format(aBuf, sizeof(aBuf), "%-16s %8d %8d %8d %8d (heap allocations)", "allocations",
+			(int)Stats.m_Avg, (int)Stats.m_P50, (int)Stats.m_P95, (int)Stats.m_Max);
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tick_profiler", aBuf);
+	}
+}
+
+void CServer::UpdateTickProfiler()
+{
+	m_TickProfiler.SetEnabled(Config()->m_SvTickProfiler);
+
+	if(m_TickProfiler.TraceFinished())
+	{
+		char aBuf[IO_MAX_PATH_LENGTH + 64];
+		IOHANDLE File = Storage()->OpenFile(m_aTickProfilerTraceFile, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+		if(File)
+		{
+			CJsonFileWriter Writer(File);
+			m_TickProfiler.WriteTrace(&Writer);
+			str_format(aBuf, sizeof(aBuf), "wrote tick trace to '%s'", m_aTickProfilerTraceFile);
+		}
+		else
+		{
+			m_TickProfiler.StartTrace(0);
+			str_format(aBuf, sizeof(aBuf), "failed to open '%s' for writing", m_aTickProfilerTraceFile);
+		}
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tick_profiler", aBuf);
+	}
+
+	if(m_TickProfiler.Enabled() && Config()->m_SvTickProfilerInterval &&
+		time_get() > m_TickProfilerLastPrint + Config()->m_SvTickProfilerInterval * time_freq())
+	{
+		m_TickProfilerLastPrint = time_get();
+		PrintTickProfile(-1);
+	}
+}
+
+void CServer::UpdateBandwidthStats()
+{
+	if(!Config()->m_SvBandwidthStats)
+		return;
+
+	const int64_t Now = time_get();
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(m_aClients[i].m_State == CClient::STATE_EMPTY)
+			continue;
+		m_aClients[i].m_BandwidthStats.Update(Now, m_NetServer.ResendChunks(i), m_NetServer.ResendBytes(i));
+	}
+
+	if(Config()->m_SvBandwidthStatsFile[0] && Now > m_BandwidthStatsLastWrite + time_freq())
+	{
+		m_BandwidthStatsLastWrite = Now;
+		WriteBandwidthStatsFile(Config()->m_SvBandwidthStatsFile);
+	}
+}
+
+static void WriteBandwidthCounters(CJsonWriter *pWriter, IGameServer *pGameServer, bool Sixup, const CBandwidthStats &Stats, int Category, const char *pAttribute)
+{
+	pWriter->WriteAttribute(pAttribute);
+	pWriter->BeginArray();
+	for(int i = 0; i <= CBandwidthStats::NUM_TYPES; i++)
+	{
+		const CBandwidthStats::CCounter &Counter = Stats.LastSecond(Category, i);
+		if(!Counter.m_Bytes && !Stats.TotalBytes(Category, i))
+			continue;
+		const int Type = CBandwidthStats::TypeByIndex(i);
+		pWriter->BeginObject();
+		pWriter->WriteAttribute("type");
+		if(Type >= 0)
+			pWriter->WriteIntValue(Type);
+		else
+			pWriter->WriteStrValue("other");
+		if(Type >= 0 && Category != CBandwidthStats::CATEGORY_SYSTEM_MSG)
+		{
+			pWriter->WriteAttribute("name");
+			pWriter->WriteStrValue(Category == CBandwidthStats::CATEGORY_SNAP ? pGameServer->NetObjName(Type, Sixup) : pGameServer->NetMsgName(Type, Sixup));
+		}
+		pWriter->WriteAttribute("bytes_per_second");
+		pWriter->WriteIntValue(Counter.m_Bytes);
+		pWriter->WriteAttribute("count_per_second");
+		pWriter->WriteIntValue(Counter.m_Num);
+		pWriter->WriteAttribute("total_bytes");
+		pWriter->WriteIntValue(Stats.TotalBytes(Category, i));
+		pWriter->EndObject();
+	}
+	pWriter->EndArray();
+}
+
+void CServer::WriteBandwidthStats(CJsonWriter *pWriter)
+{
+	pWriter->BeginObject();
+	pWriter->WriteAttribute("tick");
+	pWriter->WriteIntValue(m_CurrentGameTick);
+	pWriter->WriteAttribute("clients");
+	pWriter->BeginArray();
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(m_aClients[i].m_State == CClient::STATE_EMPTY)
+			continue;
+
+		const CBandwidthStats &Stats = m_aClients[i].m_BandwidthStats;
+		const bool Sixup = m_aClients[i].m_Sixup;
+		pWriter->BeginObject();
+		pWriter->WriteAttribute("id");
+		pWriter->WriteIntValue(i);
+		pWriter->WriteAttribute("name");
+		pWriter->WriteStrValue(ClientName(i));
+		pWriter->WriteAttribute("sixup");
+		pWriter->WriteBoolValue(Sixup);
+		pWriter->WriteAttribute("snap_bytes_per_second");
+		pWriter->WriteIntValue(Stats.LastSecondBytes(CBandwidthStats::CATEGORY_SNAP));
+		pWriter->WriteAttribute("vital_bytes_per_second");
+		pWriter->WriteIntValue(Stats.LastSecondVital().m_Bytes);
+		pWriter->WriteAttribute("vital_count_per_second");
+		pWriter->WriteIntValue(Stats.LastSecondVital().m_Num);
+		pWriter->WriteAttribute("resend_bytes_per_second");
+		pWriter->WriteIntValue(Stats.LastSecondResend().m_Bytes);
+		pWriter->WriteAttribute("resend_count_per_second");
+		pWriter->WriteIntValue(Stats.LastSecondResend().m_Num);
+		pWriter->WriteAttribute("resend_total_bytes");
+		pWriter->WriteIntValue(Stats.TotalResendBytes());
+		WriteBandwidthCounters(pWriter, GameServer(), Sixup, Stats, CBandwidthStats::CATEGORY_SNAP, "snap_items");
+		WriteBandwidthCounters(pWriter, GameServer(), Sixup, Stats, CBandwidthStats::CATEGORY_SYSTEM_MSG, "system_msgs");
+		WriteBandwidthCounters(pWriter, GameServer(), Sixup, Stats, CBandwidthStats::CATEGORY_GAME_MSG, "game_msgs");
+		pWriter->EndObject();
+	}
+	pWriter->EndArray();
+	pWriter->EndObject();
+}
+
+bool CServer::WriteBandwidthStatsFile(const char *pFilename)
+{
+	IOHANDLE File = Storage()->OpenFile(pFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
+		return false;
+	CJsonFileWriter Writer(File);
+	WriteBandwidthStats(&Writer);
+	return true;
+}
+
+void CServer::ConBandwidthStats(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	if(!pThis->Config()->m_SvBandwidthStats)
+	{
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "bandwidth", "bandwidth accounting is disabled, enable it with sv_bandwidth_stats 1");
+		return;
+	}
+
+	const int ClientID = pResult->NumArguments() ? pResult->GetInteger(0) : -1;
+	if(pResult->NumArguments() && (ClientID < 0 || ClientID >= MAX_CLIENTS || pThis->m_aClients[ClientID].m_State == CClient::STATE_EMPTY))
+	{
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "bandwidth", "invalid client id");
+		return;
+	}
+
+	char aBuf[256];
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(pThis->m_aClients[i].m_State == CClient::STATE_EMPTY || (ClientID >= 0 && i != ClientID))
+			continue;
+
+		const CBandwidthStats &Stats = pThis->m_aClients[i].m_BandwidthStats;
+		str_format(aBuf, sizeof(aBuf), "id=%d name='%s' snap=%dB/s system=%dB/s game=%dB/s vital=%dB/s resend=%dB/s", i, pThis->ClientName(i),
+			Stats.LastSecondBytes(CBandwidthStats::CATEGORY_SNAP), Stats.LastSecondBytes(CBandwidthStats::CATEGORY_SYSTEM_MSG),
+			Stats.LastSecondBytes(CBandwidthStats::CATEGORY_GAME_MSG), Stats.LastSecondVital().m_Bytes, Stats.LastSecondResend().m_Bytes);
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "bandwidth", aBuf);
+		if(ClientID < 0)
+			continue;
+
+		for(int Index = 0; Index <= CBandwidthStats::NUM_TYPES; Index++)
+		{
+			const CBandwidthStats::CCounter &Counter = Stats.LastSecond(CBandwidthStats::CATEGORY_SNAP, Index);
+			if(!Counter.m_Bytes)
+				continue;
+			const int Type = CBandwidthStats::TypeByIndex(Index);
+			str_format(aBuf, sizeof(aBuf), "  %-24s %8dB/s %6d items/s", Type >= 0 ? pThis->GameServer()->NetObjName(Type, pThis->m_aClients[i].m_Sixup) : "other", Counter.m_Bytes, Counter.m_Num);
+			pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "bandwidth", aBuf);
+		}
+	}
+}
+
+void CServer::ConBandwidthStatsDump(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	const char *pFilename = pResult->NumArguments() ? pResult->GetString(0) : "bandwidth_stats.json";
+	char aBuf[IO_MAX_PATH_LENGTH + 64];
+	if(pThis->WriteBandwidthStatsFile(pFilename))
+		str_format(aBuf, sizeof(aBuf), "wrote bandwidth stats to '%s'", pFilename);
+	else
+		str_format(aBuf, sizeof(aBuf), "failed to open '%s' for writing", pFilename);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "bandwidth", aBuf);
+}
+
+void CServer::UpdateLoadShedder(int64_t LoopTime, int NewTicks)
+{
+	m_LoadShedder.SetMaxLevel(Config()->m_SvLoadShedding);
+	const int OldLevel = m_LoadShedder.Level();
+	if(!m_LoadShedder.Update(LoopTime, NewTicks))
+		return;
+
+	char aBuf[256];
+	const int Level = m_LoadShedder.Level();
+	if(Level > OldLevel)
+		str_format(aBuf, sizeof(aBuf), "average tick took %.2fms (budget %.2fms), raised load shedding to level %d, started: %s",
+			m_LoadShedder.AvgCost() / 1000000.0f, m_LoadShedder.Budget() / 1000000.0f, Level, CLoadShedder::LevelDescription(Level));
+	else
+		str_format(aBuf, sizeof(aBuf), "average tick took %.2fms (budget %.2fms), lowered load shedding to level %d, stopped: %s",
+			m_LoadShedder.AvgCost() / 1000000.0f, m_LoadShedder.Budget() / 1000000.0f, Level, CLoadShedder::LevelDescription(OldLevel));
+	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "load", aBuf);
+}
+
+void CServer::ConLoadStatus(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	const CLoadShedder &LoadShedder = pThis->m_LoadShedder;
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "load shedding level %d of %d, average tick %.2fms (budget %.2fms)",
+		LoadShedder.Level(), pThis->Config()->m_SvLoadShedding,
+		LoadShedder.AvgCost() / 1000000.0f, LoadShedder.Budget() / 1000000.0f);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "load", aBuf);
+	for(int i = CLoadShedder::LEVEL_NONE + 1; i <= LoadShedder.Level(); i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "active: %s", CLoadShedder::LevelDescription(i));
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "load", aBuf);
+	}
+	for(int i = 0; i < CLoadShedder::NUM_COUNTERS; i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "%s: %lld", CLoadShedder::CounterName(i), (long long)LoadShedder.Counter(i));
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "load", aBuf);
+	}
+}
+
+void CServer::ConNetRecvStats(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	char aBuf[256];
+	for(int i = 0; i < CNetServer::NUM_RECV_COUNTERS; i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "%s: %lld", CNetServer::RecvCounterName(i), (long long)pThis->m_NetServer.RecvCounter(i));
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_recv", aBuf);
+	}
+}
+
+void CServer::ConTickProfile(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	if(!pThis->m_TickProfiler.Enabled() && !pThis->m_TickProfiler.HistorySize())
+	{
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tick_profiler", "the tick profiler is disabled, enable it with sv_tick_profiler 1");
+		return;
+	}
+
+	int Phase = -1;
+	if(pResult->NumArguments())
+	{
+		Phase = CTickProfiler::PhaseByName(pResult->GetString(0));
+		if(Phase < 0)
+		{
+			char aBuf[128];
+			str_format(aBuf, sizeof(aBuf), "unknown phase '%s'", pResult->GetString(0));
+			pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tick_profiler", aBuf);
+			return;
+		}
+	}
+	pThis->PrintTickProfile(Phase);
+}
+
+void CServer::ConTickProfileTrace(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	if(pThis->m_TickProfiler.TraceRunning())
+	{
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tick_profiler", "a trace is already being recorded");
+		return;
+	}
+
+	int NumTicks = clamp(pResult->GetInteger(0), 1, SERVER_TICK_SPEED * 60);
+	if(pResult->NumArguments() > 1)
+		str_copy(pThis->m_aTickProfilerTraceFile, pResult->GetString(1));
+	else
+		str_copy(pThis->m_aTickProfilerTraceFile, "tick_trace.json");
+	pThis->m_TickProfiler.StartTrace(NumTicks);
+
+	char aBuf[IO_MAX_PATH_LENGTH + 64];
+	str_format(aBuf, sizeof(aBuf), "recording %d ticks to '%s'", NumTicks, pThis->m_aTickProfilerTraceFile);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tick_profiler", aBuf);
+}
+
 void CServer::ConAddSqlServer(IConsole::IResult *pResult, void *pUserData)
 {
 	CServer *pSelf = (CServer *)pUserData;
@@ -3790,6 +4161,12 @@ void CServer::RegisterCommands()
 	Console()->Register("shutdown", "?r[reason]", CFGFLAG_SERVER, ConShutdown, this, "Shut down");
 	Console()->Register("logout", "", CFGFLAG_SERVER, ConLogout, this, "Logout of rcon");
 	Console()->Register("show_ips", "?i[show]", CFGFLAG_SERVER, ConShowIps, this, "Show IP addresses in rcon commands (1 = on, 0 = off)");
+	Console()->Register("tick_profile", "?s[phase]", CFGFLAG_SERVER, ConTickProfile, this, "Show the tick profile summary or the histogram of a single phase");
+	Console()->Register("tick_profile_trace", "i[ticks] ?s[file]", CFGFLAG_SERVER, ConTickProfileTrace, this, "Record the tick profile of the next ticks to a Chrome trace file");
+	Console()->Register("load_status", "", CFGFLAG_SERVER, ConLoadStatus, this, "Show the load shedding level and the work it has skipped");
+	Console()->Register("net_recv_stats", "", CFGFLAG_SERVER, ConNetRecvStats, this, "Show how many received packets were admitted and at which stage the others were dropped");
+	Console()->Register("bandwidth_stats", "?i[id]", CFGFLAG_SERVER, ConBandwidthStats, this, "Show the bandwidth used by all clients or the snapshot items of one client in the last second");
+	Console()->Register("bandwidth_stats_dump", "?s[file]", CFGFLAG_SERVER, ConBandwidthStatsDump, this, "Write the per-client bandwidth stats as JSON");
 
 	Console()->Register("record", "?s[file]", CFGFLAG_SERVER | CFGFLAG_STORE, ConRecord, this, "Record to a file");
 	Console()->Register("stoprecord", "", CFGFLAG_SERVER, ConStopRecord, this, "Stop recording");
@@ -7,14 +7,17 @@
 
 #include <engine/console.h>
 #include <engine/server.h>
+#include <engine/shared/bandwidth_stats.h>
 
 #include <engine/shared/demo.h>
 #include <engine/shared/econ.h>
 #include <engine/shared/fifo.h>
+#include <engine/shared/load_shedder.h>
 #include <engine/shared/netban.h>
 #include <engine/shared/network.h>
 #include <engine/shared/protocol.h>
 #include <engine/shared/snapshot.h>
+#include <engine/shared/tick_profiler.h>
 #include <engine/shared/uuid_manager.h>
 
 #include <list>
@@ -32,6 +35,7 @@
 
 class CConfig;
 class CHostLookup;
+class CJsonWriter;
 class CLogMessage;
 class CMsgPacker;
 class CPacker;
@@ -121,6 +125,7 @@ class CServer : public IServer
 #endif
 
 	class CDbConnectionPool *m_pConnectionPool;
+	class CServerLogger *m_pServerLogger;
 
 public:
 	class IGameServer *GameServer() { return m_pGameServer; }
@@ -173,6 +178,7 @@ public:
 
 		double m_Traffic;
 		int64_t m_TrafficSince;
+		CBandwidthStats m_BandwidthStats;
 
 		int m_LastAckedSnapshot;
 		int m_LastInputTick;
@@ -228,6 +234,13 @@ public:
 	CFifo m_Fifo;
 	CServerBan m_ServerBan;
 
+	CTickProfiler m_TickProfiler;
+	int64_t m_TickProfilerLastPrint;
+	char m_aTickProfilerTraceFile[IO_MAX_PATH_LENGTH];
+	int64_t m_BandwidthStatsLastWrite;
+	CLoadShedder m_LoadShedder;
+	int m_SnapshotCounter;
+
 	IEngineMap *m_pMap;
 
 	int64_t m_GameStartTime;
@@ -389,6 +402,15 @@ public:
 
 	void PumpNetwork(bool PacketWaiting);
 
+	void PrintTickProfile(int Phase);
+	void UpdateTickProfiler();
+
+	void UpdateBandwidthStats();
+	void WriteBandwidthStats(CJsonWriter *pWriter);
+	bool WriteBandwidthStatsFile(const char *pFilename);
+	// LoopTime is the busy time of the main loop iteration in nanoseconds
+	void UpdateLoadShedder(int64_t LoopTime, int NewTicks);
+
 	void ChangeMap(const char *pMap) override;
 	const char *GetMapName() const override;
 	int LoadMap(const char *pMapName);
@@ -410,6 +432,12 @@ public:
 	static void ConMapReload(IConsole::IResult *pResult, void *pUser);
 	static void ConLogout(IConsole::IResult *pResult, void *pUser);
 	static void ConShowIps(IConsole::IResult *pResult, void *pUser);
+	static void ConTickProfile(IConsole::IResult *pResult, void *pUser);
+	static void ConTickProfileTrace(IConsole::IResult *pResult, void *pUser);
+	static void ConLoadStatus(IConsole::IResult *pResult, void *pUser);
+	static void ConNetRecvStats(IConsole::IResult *pResult, void *pUser);
+	static void ConBandwidthStats(IConsole::IResult *pResult, void *pUser);
+	static void ConBandwidthStatsDump(IConsole::IResult *pResult, void *pUser);
 
 	static void ConAuthAdd(IConsole::IResult *pResult, void *pUser);
 	static void ConAuthAddHashed(IConsole::IResult *pResult, void *pUser);
@@ -490,6 +518,9 @@ public:
 
 	bool IsSixup(int ClientID) const override { return ClientID != SERVER_DEMO_CLIENT && m_aClients[ClientID].m_Sixup; }
 
+	CTickProfiler *TickProfiler() override { return &m_TickProfiler; }
+	CLoadShedder *LoadShedder() override { return &m_LoadShedder; }
+
 	void SetLoggers(std::shared_ptr<ILogger> &&pFileLogger, std::shared_ptr<ILogger> &&pStdoutLogger);
 
 #ifdef CONF_FAMILY_UNIX
@@ -7,6 +7,7 @@ CServerLogger::CServerLogger(CServer *pServer) :
 	m_MainThread(std::this_thread::get_id())
 {
 	dbg_assert(pServer != nullptr, "server pointer must not be null");
+	m_pServer->m_pServerLogger = this;
 }
 
 void CServerLogger::Log(const CLogMessage *pMessage)
@@ -15,33 +16,34 @@ void CServerLogger::Log(const CLogMessage *pMessage)
 	{
 		return;
 	}
-	m_PendingLock.lock();
 	if(m_MainThread == std::this_thread::get_id())
 	{
-		if(!m_vPending.empty())
-		{
-			if(m_pServer)
-			{
-				for(const auto &Message : m_vPending)
-				{
-					m_pServer->SendLogLine(&Message);
-				}
-			}
-			m_vPending.clear();
-		}
-		m_PendingLock.unlock();
+		Flush();
 		if(m_pServer)
 			m_pServer->SendLogLine(pMessage);
 	}
 	else
 	{
-		m_vPending.push_back(*pMessage);
-		m_PendingLock.unlock();
+		m_Pending.Push(pMessage);
+	}
+}
+
+void CServerLogger::Flush()
+{
+	dbg_assert(m_MainThread == std::this_thread::get_id(), "CServerLogger::Flush not called from the main thread");
+	CLogMessage Message;
+	while(m_Pending.Pop(&Message))
+	{
+		if(m_pServer)
+			m_pServer->SendLogLine(&Message);
 	}
 }
 
 void CServerLogger::OnServerDeletion()
 {
 	dbg_assert(m_MainThread == std::this_thread::get_id(), "CServerLogger::OnServerDeletion not called from the main thread");
+	Flush();
+	if(m_pServer)
+		m_pServer->m_pServerLogger = nullptr;
 	m_pServer = nullptr;
 }
@@ -9,13 +9,15 @@ class CServer;
 class CServerLogger : public ILogger
 {
 	CServer *m_pServer = nullptr;
-	std::mutex m_PendingLock;
-	std::vector<CLogMessage> m_vPending;
+	CLogMessageQueue m_Pending;
 	std::thread::id m_MainThread;
 
 public:
 	CServerLogger(CServer *pServer);
 	void Log(const CLogMessage *pMessage) override;
+	// Forwards the messages logged by other threads, must be called from
+	// the main thread!
+	void Flush();
 	// Must be called from the main thread!
 	void OnServerDeletion();
 };
@@ -0,0 +1,55 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+
+bool CAllocCounter::ms_Enabled = false;
+
+#if defined(CONF_DEBUG)
+static thread_local int64_t gs_ThreadAllocations = 0;
+
+int64_t CAllocCounter::ThreadAllocations()
+{
+	return gs_ThreadAllocations;
+}
+
+void CAllocCounter::Count()
+{
+	gs_ThreadAllocations++;
+}
+
+bool CAllocCounter::Enable()
+{
+	ms_Enabled = true;
+	return true;
+}
+
+void *CAllocCounter::Malloc(size_t Size)
+{
+	gs_ThreadAllocations++;
+	return malloc(Size);
+}
+#else
+int64_t CAllocCounter::ThreadAllocations()
+{
+	return 0;
+}
+
+void CAllocCounter::Count()
+{
+}
+
+bool CAllocCounter::Enable()
+{
+	return false;
+}
+
+void *CAllocCounter::Malloc(size_t Size)
+{
+	return malloc(Size);
+}
+#endif
+
+void CAllocCounter::Free(void *pData)
+{
+	free(pData);
+}
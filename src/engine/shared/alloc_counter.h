@@ -0,0 +1,37 @@
+#ifndef ENGINE_SHARED_ALLOC_COUNTER_H
+#define ENGINE_SHARED_ALLOC_COUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Counts heap allocations in debug builds, to find allocations in code that
+ * runs every tick. Allocations through operator new are counted by
+ * alloc_counter_hook.cpp, which only the targets that report the counts link
+ * (the server and the test runner). Code that uses malloc directly in those
+ * paths goes through Malloc and Free instead. The counter is per thread, so
+ * allocations of the worker threads don't show up in the numbers of the
+ * main thread.
+ */
+class CAllocCounter
+{
+	static bool ms_Enabled;
+
+public:
+	// false in release builds and in targets without the hook, the counts
+	// are always 0 then
+	static bool Enabled() { return ms_Enabled; }
+	// number of allocations made by the calling thread since it was started
+	static int64_t ThreadAllocations();
+
+	// counts an allocation of the calling thread
+	static void Count();
+	// called once by the hook when it is linked
+	static bool Enable();
+
+	// malloc and free that are counted like operator new
+	static void *Malloc(size_t Size);
+	static void Free(void *pData);
+};
+
+#endif
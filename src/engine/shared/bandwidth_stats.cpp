@@ -0,0 +1,99 @@
+#include "bandwidth_stats.h"
+
+#include "uuid_manager.h"
+
+#include <base/system.h>
+
+CBandwidthStats::CBandwidthStats()
+{
+	Reset();
+}
+
+void CBandwidthStats::Reset()
+{
+	mem_zero(m_aaCurrent, sizeof(m_aaCurrent));
+	mem_zero(m_aaLastSecond, sizeof(m_aaLastSecond));
+	mem_zero(m_aaTotalBytes, sizeof(m_aaTotalBytes));
+	m_CurrentVital = {0, 0};
+	m_LastSecondVital = {0, 0};
+	m_LastSecondResend = {0, 0};
+	m_TotalResendBytes = 0;
+	m_LastResendChunks = -1;
+	m_LastResendBytes = -1;
+	m_SecondStart = 0;
+}
+
+int CBandwidthStats::TypeIndex(int Type)
+{
+	if(Type >= 0 && Type < NUM_TYPES / 2)
+		return Type;
+	if(Type >= OFFSET_UUID && Type < OFFSET_UUID + NUM_TYPES / 2)
+		return Type - OFFSET_UUID + NUM_TYPES / 2;
+	return TYPE_OTHER;
+}
+
+int CBandwidthStats::TypeByIndex(int Index)
+{
+	if(Index < 0 || Index >= NUM_TYPES)
+		return -1;
+	if(Index < NUM_TYPES / 2)
+		return Index;
+	return Index - NUM_TYPES / 2 + OFFSET_UUID;
+}
+
+void CBandwidthStats::Add(int Category, int Type, int Bytes)
+{
+	CCounter &Counter = m_aaCurrent[Category][TypeIndex(Type)];
+	Counter.m_Bytes += Bytes;
+	Counter.m_Num++;
+}
+
+void CBandwidthStats::AddVital(int Bytes)
+{
+	m_CurrentVital.m_Bytes += Bytes;
+	m_CurrentVital.m_Num++;
+}
+
+bool CBandwidthStats::Update(int64_t Now, int64_t ResendChunks, int64_t ResendBytes)
+{
+	if(m_SecondStart == 0)
+	{
+		m_SecondStart = Now;
+		m_LastResendChunks = ResendChunks;
+		m_LastResendBytes = ResendBytes;
+		return false;
+	}
+	if(Now < m_SecondStart + time_freq())
+		return false;
+	m_SecondStart = Now;
+
+	for(int c = 0; c < NUM_CATEGORIES; c++)
+	{
+		for(int i = 0; i <= NUM_TYPES; i++)
+		{
+			m_aaLastSecond[c][i] = m_aaCurrent[c][i];
+			m_aaTotalBytes[c][i] += m_aaCurrent[c][i].m_Bytes;
+		}
+	}
+	mem_zero(m_aaCurrent, sizeof(m_aaCurrent));
+	m_LastSecondVital = m_CurrentVital;
+	m_CurrentVital = {0, 0};
+
+	// the connection counters start over when the slot is reused
+	if(ResendBytes < m_LastResendBytes)
+		m_LastResendChunks = m_LastResendBytes = 0;
+	m_LastSecondResend.m_Num = ResendChunks - m_LastResendChunks;
+	m_LastSecondResend.m_Bytes = ResendBytes - m_LastResendBytes;
+	m_TotalResendBytes += m_LastSecondResend.m_Bytes;
+	m_LastResendChunks = ResendChunks;
+	m_LastResendBytes = ResendBytes;
+	return true;
+}
+
+int CBandwidthStats::LastSecondBytes(int Category) const
+{
+	int Bytes = 0;
+	for(int i = 0; i <= NUM_TYPES; i++)
+		Bytes += m_aaLastSecond[Category][i].m_Bytes;
+	return Bytes;
+}
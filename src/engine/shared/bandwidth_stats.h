@@ -0,0 +1,79 @@
+#ifndef ENGINE_SHARED_BANDWIDTH_STATS_H
+#define ENGINE_SHARED_BANDWIDTH_STATS_H
+
+#include <cstdint>
+
+/**
+ * Byte counters of the traffic sent to one client.
+ *
+ * Snapshot bytes are counted per netobj type with the size the items take in
+ * the compressed delta, messages are counted per message ID with the size of
+ * the packed message. Types are folded into NUM_TYPES buckets: the first half
+ * holds the plain types, the second half the first UUID types, everything else
+ * goes into the TYPE_OTHER bucket. The counters of the running second are
+ * moved to the last second once per second by Update().
+ */
+class CBandwidthStats
+{
+public:
+	enum ECategory
+	{
+		CATEGORY_SNAP = 0,
+		CATEGORY_SYSTEM_MSG,
+		CATEGORY_GAME_MSG,
+		NUM_CATEGORIES,
+	};
+
+	enum
+	{
+		NUM_TYPES = 128,
+		TYPE_OTHER = NUM_TYPES,
+	};
+
+	class CCounter
+	{
+	public:
+		int m_Bytes;
+		int m_Num;
+	};
+
+private:
+	CCounter m_aaCurrent[NUM_CATEGORIES][NUM_TYPES + 1];
+	CCounter m_aaLastSecond[NUM_CATEGORIES][NUM_TYPES + 1];
+	int64_t m_aaTotalBytes[NUM_CATEGORIES][NUM_TYPES + 1];
+
+	CCounter m_CurrentVital;
+	CCounter m_LastSecondVital;
+	CCounter m_LastSecondResend;
+	int64_t m_TotalResendBytes;
+	int64_t m_LastResendChunks;
+	int64_t m_LastResendBytes;
+
+	int64_t m_SecondStart;
+
+public:
+	CBandwidthStats();
+
+	void Reset();
+
+	// maps a snapshot item type or message ID to its bucket and back,
+	// TypeByIndex returns -1 for TYPE_OTHER
+	static int TypeIndex(int Type);
+	static int TypeByIndex(int Index);
+
+	void Add(int Category, int Type, int Bytes);
+	void AddVital(int Bytes);
+
+	// ResendChunks and ResendBytes are the running totals of the connection,
+	// returns true if a new second was started
+	bool Update(int64_t Now, int64_t ResendChunks, int64_t ResendBytes);
+
+	const CCounter &LastSecond(int Category, int Index) const { return m_aaLastSecond[Category][Index]; }
+	int64_t TotalBytes(int Category, int Index) const { return m_aaTotalBytes[Category][Index]; }
+	const CCounter &LastSecondVital() const { return m_LastSecondVital; }
+	const CCounter &LastSecondResend() const { return m_LastSecondResend; }
+	int64_t TotalResendBytes() const { return m_TotalResendBytes; }
+	int LastSecondBytes(int Category) const;
+};
+
+#endif
@@ -412,8 +412,6 @@ void CConsole::ExecuteLineStroked(int Stroke, const char *pStr, int ClientID, bo
 	}
 	while(pStr && *pStr)
 	{
-		CResult Result;
-		Result.m_ClientID = ClientID;
 		const char *pEnd = pStr;
 		const char *pNextPart = 0;
 		int InString = 0;
@@ -441,6 +439,22 @@ void CConsole::ExecuteLineStroked(int Stroke, const char *pStr, int ClientID, bo
 			pEnd++;
 		}
 
+		// releasing only affects stroke commands, so skip parsing and
+		// looking up everything else (e.g. every line of an exec'd file)
+		if(!Stroke)
+		{
+			const char *pCommandStart = str_skip_whitespaces_const(pStr);
+			if(pCommandStart == pEnd)
+				return;
+			if(*pCommandStart != '+')
+			{
+				pStr = pNextPart;
+				continue;
+			}
+		}
+
+		CResult Result;
+		Result.m_ClientID = ClientID;
 		if(ParseStart(&Result, pStr, (pEnd - pStr) + 1) != 0)
 			return;
 
@@ -570,9 +584,23 @@ int CConsole::PossibleCommands(const char *pStr, int FlagMask, bool Temp, FPossi
 	return Index;
 }
 
+unsigned CConsole::CommandHash(const char *pName)
+{
+	// same as str_quickhash, but case-folded like str_comp_nocase
+	unsigned Hash = 5381;
+	for(; *pName; pName++)
+	{
+		char c = *pName;
+		if(c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		Hash = ((Hash << 5) + Hash) + c;
+	}
+	return Hash % COMMAND_HASH_SIZE;
+}
+
 CConsole::CCommand *CConsole::FindCommand(const char *pName, int FlagMask)
 {
-	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+	for(CCommand *pCommand = m_apCommandHash[CommandHash(pName)]; pCommand; pCommand = pCommand->m_pNextHash)
 	{
 		if(pCommand->m_Flags & FlagMask)
 		{
@@ -968,6 +996,7 @@ CConsole::CConsole(int FlagMask)
 	m_apStrokeStr[1] = "1";
 	m_ExecutionQueue.Reset();
 	m_pFirstCommand = 0;
+	mem_zero(m_apCommandHash, sizeof(m_apCommandHash));
 	m_pFirstExec = 0;
 	m_pfnTeeHistorianCommandCallback = 0;
 	m_pTeeHistorianCommandUserdata = 0;
@@ -1079,10 +1108,7 @@ void CConsole::AddCommandSorted(CCommand *pCommand)
 {
 	if(!m_pFirstCommand || str_comp(pCommand->m_pName, m_pFirstCommand->m_pName) <= 0)
 	{
-		if(m_pFirstCommand && m_pFirstCommand->m_pNext)
-			pCommand->m_pNext = m_pFirstCommand;
-		else
-			pCommand->m_pNext = 0;
+		pCommand->m_pNext = m_pFirstCommand;
 		m_pFirstCommand = pCommand;
 	}
 	else
@@ -1097,6 +1123,32 @@ void CConsole::AddCommandSorted(CCommand *pCommand)
 			}
 		}
 	}
+
+	AddCommandHash(pCommand);
+}
+
+void CConsole::AddCommandHash(CCommand *pCommand)
+{
+	// insert at the same relative position as in the sorted list,
+	// so lookups resolve duplicate names exactly like a list walk
+	CCommand **ppSlot = &m_apCommandHash[CommandHash(pCommand->m_pName)];
+	while(*ppSlot && str_comp(pCommand->m_pName, (*ppSlot)->m_pName) > 0)
+		ppSlot = &(*ppSlot)->m_pNextHash;
+	pCommand->m_pNextHash = *ppSlot;
+	*ppSlot = pCommand;
+}
+
+void CConsole::RemoveCommandHash(CCommand *pCommand)
+{
+	for(CCommand **ppSlot = &m_apCommandHash[CommandHash(pCommand->m_pName)]; *ppSlot; ppSlot = &(*ppSlot)->m_pNextHash)
+	{
+		if(*ppSlot == pCommand)
+		{
+			*ppSlot = pCommand->m_pNextHash;
+			pCommand->m_pNextHash = 0;
+			return;
+		}
+	}
 }
 
 void CConsole::Register(const char *pName, const char *pParams,
@@ -1187,6 +1239,7 @@ void CConsole::DeregisterTemp(const char *pName)
 	// add to recycle list
 	if(pRemoved)
 	{
+		RemoveCommandHash(pRemoved);
 		pRemoved->m_pNext = m_pRecycleList;
 		m_pRecycleList = pRemoved;
 	}
@@ -1210,6 +1263,18 @@ void CConsole::DeregisterTempAll()
 		}
 	}
 
+	// remove temp entries from the command index
+	for(CCommand *&pBucket : m_apCommandHash)
+	{
+		for(CCommand **ppSlot = &pBucket; *ppSlot;)
+		{
+			if((*ppSlot)->m_Temp)
+				*ppSlot = (*ppSlot)->m_pNextHash;
+			else
+				ppSlot = &(*ppSlot)->m_pNextHash;
+		}
+	}
+
 	m_TempCommands.Reset();
 	m_pRecycleList = 0;
 }
@@ -1258,7 +1323,7 @@ void CConsole::StoreCommands(bool Store)
 
 const IConsole::CCommandInfo *CConsole::GetCommandInfo(const char *pName, int FlagMask, bool Temp)
 {
-	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+	for(CCommand *pCommand = m_apCommandHash[CommandHash(pName)]; pCommand; pCommand = pCommand->m_pNextHash)
 	{
 		if(pCommand->m_Flags & FlagMask && pCommand->m_Temp == Temp)
 		{
@@ -315,7 +315,12 @@ size_t CHttpRequest::OnData(char *pData, size_t DataSize)
 	{
 		return 0;
 	}
-	if(!m_WriteToFile)
+	if(m_StreamResponse)
+	{
+		m_ResponseLength += DataSize;
+		return OnStreamData(pData, DataSize) ? DataSize : 0;
+	}
+	else if(!m_WriteToFile)
 	{
 		if(DataSize == 0)
 		{
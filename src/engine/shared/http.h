@@ -59,6 +59,9 @@ class CHttpRequest : public IJob
 	REQUEST m_Type = REQUEST::GET;
 
 	bool m_WriteToFile = false;
+	// If true, the response is passed to `OnStreamData()` as it arrives
+	// instead of being buffered.
+	bool m_StreamResponse = false;
 
 	uint64_t m_ResponseLength = 0;
 
@@ -95,6 +98,8 @@ class CHttpRequest : public IJob
 protected:
 	virtual void OnProgress() {}
 	virtual int OnCompletion(int State);
+	// Abort the request with an error if `OnStreamData()` returns false.
+	virtual bool OnStreamData(const char *pData, size_t DataSize) { return true; }
 
 public:
 	CHttpRequest(const char *pUrl);
@@ -105,6 +110,7 @@ public:
 	void LogProgress(HTTPLOG LogProgress) { m_LogProgress = LogProgress; }
 	void IpResolve(IPRESOLVE IpResolve) { m_IpResolve = IpResolve; }
 	void WriteToFile(IStorage *pStorage, const char *pDest, int StorageType);
+	void StreamResponse() { m_StreamResponse = true; }
 	void Head() { m_Type = REQUEST::HEAD; }
 	void Post(const unsigned char *pData, size_t DataLength)
 	{
@@ -0,0 +1,88 @@
+#include "load_shedder.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+static const char *const gs_apLevelDescriptions[CLoadShedder::NUM_LEVELS] = {
+	"no load shedding",
+	"fewer snapshots for spectators and paused players",
+	"demo snapshots at half rate",
+	"throttled server info replies",
+	"deferred score results",
+};
+
+static const char *const gs_apCounterNames[CLoadShedder::NUM_COUNTERS] = {
+	"spectator_snaps_skipped",
+	"demo_snaps_skipped",
+	"serverinfo_replies_skipped",
+	"score_result_deferrals",
+};
+
+CLoadShedder::CLoadShedder()
+{
+	m_MaxLevel = NUM_LEVELS - 1;
+	Init(50);
+}
+
+void CLoadShedder::Init(int TickSpeed)
+{
+	m_TickSpeed = TickSpeed;
+	m_Level = LEVEL_NONE;
+	m_WindowCost = 0;
+	m_WindowTicks = 0;
+	m_CalmWindows = 0;
+	m_LastAvgCost = 0;
+	mem_zero(m_aCounters, sizeof(m_aCounters));
+}
+
+void CLoadShedder::SetMaxLevel(int Level)
+{
+	m_MaxLevel = clamp(Level, (int)LEVEL_NONE, NUM_LEVELS - 1);
+	m_Level = minimum(m_Level, m_MaxLevel);
+}
+
+bool CLoadShedder::Update(int64_t Cost, int NumTicks)
+{
+	m_WindowCost += Cost;
+	m_WindowTicks += NumTicks;
+	if(m_WindowTicks < m_TickSpeed)
+		return false;
+
+	m_LastAvgCost = m_WindowCost / m_WindowTicks;
+	m_WindowCost = 0;
+	m_WindowTicks = 0;
+
+	const int OldLevel = m_Level;
+	if(m_LastAvgCost * 100 > Budget() * HIGH_LOAD_PERCENT)
+	{
+		m_CalmWindows = 0;
+		m_Level = minimum(m_Level + 1, m_MaxLevel);
+	}
+	else if(m_LastAvgCost * 100 < Budget() * LOW_LOAD_PERCENT)
+	{
+		if(m_Level > LEVEL_NONE && ++m_CalmWindows >= CALM_SECONDS)
+		{
+			m_CalmWindows = 0;
+			m_Level--;
+		}
+	}
+	else
+	{
+		m_CalmWindows = 0;
+	}
+	return m_Level != OldLevel;
+}
+
+const char *CLoadShedder::LevelDescription(int Level)
+{
+	if(Level < 0 || Level >= NUM_LEVELS)
+		return "unknown";
+	return gs_apLevelDescriptions[Level];
+}
+
+const char *CLoadShedder::CounterName(int Counter)
+{
+	if(Counter < 0 || Counter >= NUM_COUNTERS)
+		return "unknown";
+	return gs_apCounterNames[Counter];
+}
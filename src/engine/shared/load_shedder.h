@@ -0,0 +1,85 @@
+#ifndef ENGINE_SHARED_LOAD_SHEDDER_H
+#define ENGINE_SHARED_LOAD_SHEDDER_H
+
+#include <cstdint>
+
+/**
+ * Reduces non-critical work while the server ticks take longer than their
+ * time budget.
+ *
+ * The average cost of a tick is evaluated once per second. If it exceeds
+ * HIGH_LOAD_PERCENT of the budget, the shedding level is raised by one, each
+ * level enables one more action in addition to the ones of the lower levels.
+ * The level is lowered again after CALM_SECONDS consecutive seconds below
+ * LOW_LOAD_PERCENT of the budget.
+ */
+class CLoadShedder
+{
+public:
+	enum ELevel
+	{
+		LEVEL_NONE = 0,
+		// send fewer snapshots to spectators and paused players
+		LEVEL_SPECTATOR_SNAPS,
+		// record demo snapshots at half the rate
+		LEVEL_DEMO,
+		// answer fewer server info requests
+		LEVEL_SERVERINFO,
+		// spread the processing of finished score queries over several ticks
+		LEVEL_SCORE,
+		NUM_LEVELS,
+	};
+
+	enum ECounter
+	{
+		COUNTER_SPECTATOR_SNAPS = 0,
+		COUNTER_DEMO_SNAPS,
+		COUNTER_SERVERINFO,
+		COUNTER_SCORE,
+		NUM_COUNTERS,
+	};
+
+	enum
+	{
+		HIGH_LOAD_PERCENT = 90,
+		LOW_LOAD_PERCENT = 50,
+		CALM_SECONDS = 5,
+	};
+
+private:
+	int m_MaxLevel;
+	int m_Level;
+	int m_TickSpeed;
+
+	int64_t m_WindowCost;
+	int m_WindowTicks;
+	int m_CalmWindows;
+	int64_t m_LastAvgCost;
+
+	int64_t m_aCounters[NUM_COUNTERS];
+
+public:
+	CLoadShedder();
+
+	void Init(int TickSpeed);
+	// Level 0 disables load shedding
+	void SetMaxLevel(int Level);
+
+	// Cost is the time in nanoseconds spent on NumTicks ticks, returns true
+	// if the level changed
+	bool Update(int64_t Cost, int NumTicks);
+
+	int Level() const { return m_Level; }
+	bool Active(int Level) const { return m_Level >= Level; }
+	int64_t Budget() const { return 1000000000 / m_TickSpeed; }
+	// average tick cost in nanoseconds during the last evaluated second
+	int64_t AvgCost() const { return m_LastAvgCost; }
+
+	void Count(int Counter) { m_aCounters[Counter]++; }
+	int64_t Counter(int Counter) const { return m_aCounters[Counter]; }
+
+	static const char *LevelDescription(int Level);
+	static const char *CounterName(int Counter);
+};
+
+#endif
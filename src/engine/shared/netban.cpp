@@ -2,47 +2,92 @@
 
 #include <engine/console.h>
 #include <engine/shared/config.h>
+#include <engine/shared/linereader.h>
 #include <engine/storage.h>
 
 #include "netban.h"
 
+// FNV-1a over the prefix, started from the address length so that IPv4 and
+// IPv6 prefixes don't share chains
+static unsigned HashStart(int Length)
+{
+	return 2166136261u ^ Length;
+}
+
+static unsigned HashStep(unsigned Hash, unsigned char Byte)
+{
+	return (Hash ^ Byte) * 16777619u;
+}
+
 CNetBan::CNetHash::CNetHash(const NETADDR *pAddr)
 {
-	if(pAddr->type == NETTYPE_IPV4)
-		m_Hash = (pAddr->ip[0] + pAddr->ip[1] + pAddr->ip[2] + pAddr->ip[3]) & 0xFF;
-	else
-		m_Hash = (pAddr->ip[0] + pAddr->ip[1] + pAddr->ip[2] + pAddr->ip[3] + pAddr->ip[4] + pAddr->ip[5] + pAddr->ip[6] + pAddr->ip[7] +
-				 pAddr->ip[8] + pAddr->ip[9] + pAddr->ip[10] + pAddr->ip[11] + pAddr->ip[12] + pAddr->ip[13] + pAddr->ip[14] + pAddr->ip[15]) &
-			 0xFF;
+	int Length = pAddr->type == NETTYPE_IPV4 ? 4 : 16;
+	m_Hash = HashStart(Length);
+	for(int i = 0; i < Length; ++i)
+		m_Hash = HashStep(m_Hash, pAddr->ip[i]);
 	m_HashIndex = 0;
 }
 
 CNetBan::CNetHash::CNetHash(const CNetRange *pRange)
 {
-	m_Hash = 0;
+	m_Hash = HashStart(pRange->m_LB.type == NETTYPE_IPV4 ? 4 : 16);
 	m_HashIndex = 0;
 	for(int i = 0; pRange->m_LB.ip[i] == pRange->m_UB.ip[i]; ++i)
 	{
-		m_Hash += pRange->m_LB.ip[i];
+		m_Hash = HashStep(m_Hash, pRange->m_LB.ip[i]);
 		++m_HashIndex;
 	}
-	m_Hash &= 0xFF;
 }
 
 int CNetBan::CNetHash::MakeHashArray(const NETADDR *pAddr, CNetHash aHash[17])
 {
 	int Length = pAddr->type == NETTYPE_IPV4 ? 4 : 16;
-	aHash[0].m_Hash = 0;
+	aHash[0].m_Hash = HashStart(Length);
 	aHash[0].m_HashIndex = 0;
-	for(int i = 1, Sum = 0; i <= Length; ++i)
+	for(int i = 1; i <= Length; ++i)
 	{
-		Sum += pAddr->ip[i - 1];
-		aHash[i].m_Hash = Sum & 0xFF;
+		aHash[i].m_Hash = HashStep(aHash[i - 1].m_Hash, pAddr->ip[i - 1]);
 		aHash[i].m_HashIndex = i % Length;
 	}
 	return Length;
 }
 
+template<class T, int HashCount>
+void CNetBan::CBanPool<T, HashCount>::Rehash(int HashIndex, size_t NumBuckets)
+{
+	std::vector<CBan<T> *> vpOld(NumBuckets, nullptr);
+	std::swap(vpOld, m_avpHashList[HashIndex]);
+	for(CBan<T> *pBan : vpOld)
+	{
+		while(pBan)
+		{
+			CBan<T> *pNext = pBan->m_pHashNext;
+			CBan<T> *&pHashFirst = Bucket(HashIndex, pBan->m_NetHash.m_Hash);
+			if(pHashFirst)
+				pHashFirst->m_pHashPrev = pBan;
+			pBan->m_pHashPrev = 0;
+			pBan->m_pHashNext = pHashFirst;
+			pHashFirst = pBan;
+			pBan = pNext;
+		}
+	}
+}
+
+template<class T, int HashCount>
+void CNetBan::CBanPool<T, HashCount>::AddChunk()
+{
+	CBan<T> *pChunk = new CBan<T>[BANS_PER_CHUNK];
+	m_vpChunks.emplace_back(pChunk);
+	for(int i = 0; i < BANS_PER_CHUNK; ++i)
+	{
+		pChunk[i].m_pPrev = i > 0 ? &pChunk[i - 1] : 0;
+		pChunk[i].m_pNext = i < BANS_PER_CHUNK - 1 ? &pChunk[i + 1] : m_pFirstFree;
+	}
+	if(m_pFirstFree)
+		m_pFirstFree->m_pPrev = &pChunk[BANS_PER_CHUNK - 1];
+	m_pFirstFree = &pChunk[0];
+}
+
 template<class T, int HashCount>
 void CNetBan::CBanPool<T, HashCount>::InsertUsed(CBan<T> *pBan)
 {
@@ -84,7 +129,7 @@ template<class T, int HashCount>
 typename CNetBan::CBan<T> *CNetBan::CBanPool<T, HashCount>::Add(const T *pData, const CBanInfo *pInfo, const CNetHash *pNetHash)
 {
 	if(!m_pFirstFree)
-		return 0;
+		AddChunk();
 
 	// create new ban
 	CBan<T> *pBan = m_pFirstFree;
@@ -98,12 +143,17 @@ typename CNetBan::CBan<T> *CNetBan::CBanPool<T, HashCount>::Add(const T *pData,
 	else
 		m_pFirstFree = pBan->m_pNext;
 
-	// add it to the hash list
-	if(m_aapHashList[pNetHash->m_HashIndex][pNetHash->m_Hash])
-		m_aapHashList[pNetHash->m_HashIndex][pNetHash->m_Hash]->m_pHashPrev = pBan;
+	// add it to the hash list, with about one ban per bucket
+	const size_t NumBuckets = m_avpHashList[pNetHash->m_HashIndex].size();
+	if((size_t)m_aNumHashed[pNetHash->m_HashIndex] >= NumBuckets)
+		Rehash(pNetHash->m_HashIndex, maximum<size_t>(NumBuckets * 2, 256));
+	CBan<T> *&pHashFirst = Bucket(pNetHash->m_HashIndex, pNetHash->m_Hash);
+	if(pHashFirst)
+		pHashFirst->m_pHashPrev = pBan;
 	pBan->m_pHashPrev = 0;
-	pBan->m_pHashNext = m_aapHashList[pNetHash->m_HashIndex][pNetHash->m_Hash];
-	m_aapHashList[pNetHash->m_HashIndex][pNetHash->m_Hash] = pBan;
+	pBan->m_pHashNext = pHashFirst;
+	pHashFirst = pBan;
+	++m_aNumHashed[pNetHash->m_HashIndex];
 
 	// insert it into the used list
 	InsertUsed(pBan);
@@ -126,8 +176,9 @@ int CNetBan::CBanPool<T, HashCount>::Remove(CBan<T> *pBan)
 	if(pBan->m_pHashPrev)
 		pBan->m_pHashPrev->m_pHashNext = pBan->m_pHashNext;
 	else
-		m_aapHashList[pBan->m_NetHash.m_HashIndex][pBan->m_NetHash.m_Hash] = pBan->m_pHashNext;
+		Bucket(pBan->m_NetHash.m_HashIndex, pBan->m_NetHash.m_Hash) = pBan->m_pHashNext;
 	pBan->m_pHashNext = pBan->m_pHashPrev = 0;
+	--m_aNumHashed[pBan->m_NetHash.m_HashIndex];
 
 	// remove from used list
 	if(pBan->m_pNext)
@@ -171,25 +222,19 @@ void CNetBan::UnbanAll()
 {
 	m_BanAddrPool.Reset();
 	m_BanRangePool.Reset();
+	AppendToBansFile("unban_all");
 }
 
 template<class T, int HashCount>
 void CNetBan::CBanPool<T, HashCount>::Reset()
 {
-	mem_zero(m_aapHashList, sizeof(m_aapHashList));
-	mem_zero(m_aBans, sizeof(m_aBans));
+	for(auto &vpHashList : m_avpHashList)
+		vpHashList.clear();
+	mem_zero(m_aNumHashed, sizeof(m_aNumHashed));
+	m_vpChunks.clear();
+	m_pFirstFree = 0;
 	m_pFirstUsed = 0;
 	m_CountUsed = 0;
-
-	for(int i = 1; i < MAX_BANS - 1; ++i)
-	{
-		m_aBans[i].m_pNext = &m_aBans[i + 1];
-		m_aBans[i].m_pPrev = &m_aBans[i - 1];
-	}
-
-	m_aBans[0].m_pNext = &m_aBans[1];
-	m_aBans[MAX_BANS - 1].m_pPrev = &m_aBans[MAX_BANS - 2];
-	m_pFirstFree = &m_aBans[0];
 }
 
 template<class T, int HashCount>
@@ -231,24 +276,22 @@ int CNetBan::Ban(T *pBanPool, const typename T::CDataType *pData, int Seconds, c
 	{
 		// adjust the ban
 		pBanPool->Update(pBan, &Info);
-		char aBuf[128];
+		char aBuf[256];
 		MakeBanInfo(pBan, aBuf, sizeof(aBuf), MSGTYPE_LIST);
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		MakeBanUntilCommand(pBan, aBuf, sizeof(aBuf));
+		AppendToBansFile(aBuf);
 		return 1;
 	}
 
 	// add ban and print result
 	pBan = pBanPool->Add(pData, &Info, &NetHash);
-	if(pBan)
-	{
-		char aBuf[128];
-		MakeBanInfo(pBan, aBuf, sizeof(aBuf), MSGTYPE_BANADD);
-		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
-		return 0;
-	}
-	else
-		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", "ban failed (full banlist)");
-	return -1;
+	char aBuf[256];
+	MakeBanInfo(pBan, aBuf, sizeof(aBuf), MSGTYPE_BANADD);
+	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+	MakeBanUntilCommand(pBan, aBuf, sizeof(aBuf));
+	AppendToBansFile(aBuf);
+	return 0;
 }
 
 template<class T>
@@ -262,6 +305,8 @@ int CNetBan::Unban(T *pBanPool, const typename T::CDataType *pData)
 		MakeBanInfo(pBan, aBuf, sizeof(aBuf), MSGTYPE_BANREM);
 		pBanPool->Remove(pBan);
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		MakeUnbanCommand(pData, aBuf, sizeof(aBuf));
+		AppendToBansFile(aBuf);
 		return 0;
 	}
 	else
@@ -269,6 +314,150 @@ int CNetBan::Unban(T *pBanPool, const typename T::CDataType *pData)
 	return -1;
 }
 
+void CNetBan::MakeBanCommand(const CBanAddr *pBan, int Now, char *pBuf, unsigned BufferSize) const
+{
+	// 0 minutes would be a permanent ban
+	int Min = pBan->m_Info.m_Expires > -1 ? maximum((pBan->m_Info.m_Expires - Now + 59) / 60, 1) : -1;
+	char aAddrStr[NETADDR_MAXSTRSIZE];
+	net_addr_str(&pBan->m_Data, aAddrStr, sizeof(aAddrStr), false);
+	str_format(pBuf, BufferSize, "ban %s %i %s", aAddrStr, Min, pBan->m_Info.m_aReason);
+}
+
+void CNetBan::MakeBanCommand(const CBanRange *pBan, int Now, char *pBuf, unsigned BufferSize) const
+{
+	// 0 minutes would be a permanent ban
+	int Min = pBan->m_Info.m_Expires > -1 ? maximum((pBan->m_Info.m_Expires - Now + 59) / 60, 1) : -1;
+	char aAddrStr1[NETADDR_MAXSTRSIZE], aAddrStr2[NETADDR_MAXSTRSIZE];
+	net_addr_str(&pBan->m_Data.m_LB, aAddrStr1, sizeof(aAddrStr1), false);
+	net_addr_str(&pBan->m_Data.m_UB, aAddrStr2, sizeof(aAddrStr2), false);
+	str_format(pBuf, BufferSize, "ban_range %s %s %i %s", aAddrStr1, aAddrStr2, Min, pBan->m_Info.m_aReason);
+}
+
+void CNetBan::MakeBanUntilCommand(const CBanAddr *pBan, char *pBuf, unsigned BufferSize) const
+{
+	char aAddrStr[NETADDR_MAXSTRSIZE];
+	net_addr_str(&pBan->m_Data, aAddrStr, sizeof(aAddrStr), false);
+	str_format(pBuf, BufferSize, "ban_until %s %i %s", aAddrStr, pBan->m_Info.m_Expires, pBan->m_Info.m_aReason);
+}
+
+void CNetBan::MakeBanUntilCommand(const CBanRange *pBan, char *pBuf, unsigned BufferSize) const
+{
+	char aAddrStr1[NETADDR_MAXSTRSIZE], aAddrStr2[NETADDR_MAXSTRSIZE];
+	net_addr_str(&pBan->m_Data.m_LB, aAddrStr1, sizeof(aAddrStr1), false);
+	net_addr_str(&pBan->m_Data.m_UB, aAddrStr2, sizeof(aAddrStr2), false);
+	str_format(pBuf, BufferSize, "ban_range_until %s %s %i %s", aAddrStr1, aAddrStr2, pBan->m_Info.m_Expires, pBan->m_Info.m_aReason);
+}
+
+void CNetBan::MakeUnbanCommand(const NETADDR *pData, char *pBuf, unsigned BufferSize) const
+{
+	char aAddrStr[NETADDR_MAXSTRSIZE];
+	net_addr_str(pData, aAddrStr, sizeof(aAddrStr), false);
+	str_format(pBuf, BufferSize, "unban %s", aAddrStr);
+}
+
+void CNetBan::MakeUnbanCommand(const CNetRange *pData, char *pBuf, unsigned BufferSize) const
+{
+	char aAddrStr1[NETADDR_MAXSTRSIZE], aAddrStr2[NETADDR_MAXSTRSIZE];
+	net_addr_str(&pData->m_LB, aAddrStr1, sizeof(aAddrStr1), false);
+	net_addr_str(&pData->m_UB, aAddrStr2, sizeof(aAddrStr2), false);
+	str_format(pBuf, BufferSize, "unban_range %s %s", aAddrStr1, aAddrStr2);
+}
+
+void CNetBan::WriteBans(ASYNCIO *pFile, bool Until) const
+{
+	int Now = time_timestamp();
+	char aBuf[256];
+	aio_lock(pFile);
+	for(CBanAddr *pBan = m_BanAddrPool.First(); pBan; pBan = pBan->m_pNext)
+	{
+		if(Until)
+			MakeBanUntilCommand(pBan, aBuf, sizeof(aBuf));
+		else
+			MakeBanCommand(pBan, Now, aBuf, sizeof(aBuf));
+		aio_write_unlocked(pFile, aBuf, str_length(aBuf));
+		aio_write_newline_unlocked(pFile);
+	}
+	for(CBanRange *pBan = m_BanRangePool.First(); pBan; pBan = pBan->m_pNext)
+	{
+		if(Until)
+			MakeBanUntilCommand(pBan, aBuf, sizeof(aBuf));
+		else
+			MakeBanCommand(pBan, Now, aBuf, sizeof(aBuf));
+		aio_write_unlocked(pFile, aBuf, str_length(aBuf));
+		aio_write_newline_unlocked(pFile);
+	}
+	aio_unlock(pFile);
+}
+
+void CNetBan::OpenBansFile(const char *pFilename)
+{
+	CloseBansFile();
+	str_copy(m_aBansFile, pFilename);
+	if(!pFilename[0])
+		return;
+
+	// restore the bans without appending them again
+	IOHANDLE File = Storage()->OpenFile(pFilename, IOFLAG_READ | IOFLAG_SKIP_BOM, IStorage::TYPE_SAVE);
+	if(File)
+	{
+		m_LoadingBansFile = true;
+		CLineReader Reader;
+		Reader.Init(File);
+		char *pLine;
+		while((pLine = Reader.Get()))
+			Console()->ExecuteLine(pLine, -1, false);
+		io_close(File);
+		m_LoadingBansFile = false;
+	}
+
+	// start with the current bans, so that the file doesn't keep growing
+	// with bans that were removed before
+	File = Storage()->OpenFile(pFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
+	{
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "failed to open bans file '%s'", pFilename);
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		return;
+	}
+	m_pBansFile = aio_new(File);
+	WriteBans(m_pBansFile, true);
+}
+
+void CNetBan::CloseBansFile()
+{
+	if(!m_pBansFile)
+		return;
+
+	aio_close(m_pBansFile);
+	aio_wait(m_pBansFile);
+	if(aio_error(m_pBansFile))
+	{
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "failed to write bans file '%s'", m_aBansFile);
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+	}
+	aio_free(m_pBansFile);
+	m_pBansFile = nullptr;
+}
+
+void CNetBan::AppendToBansFile(const char *pCommand)
+{
+	if(!m_pBansFile || m_LoadingBansFile)
+		return;
+
+	// only queued here, the thread of the file writes the queue in batches
+	aio_lock(m_pBansFile);
+	aio_write_unlocked(m_pBansFile, pCommand, str_length(pCommand));
+	aio_write_newline_unlocked(m_pBansFile);
+	aio_unlock(m_pBansFile);
+}
+
+CNetBan::~CNetBan()
+{
+	CloseBansFile();
+}
+
 void CNetBan::Init(IConsole *pConsole, IStorage *pStorage)
 {
 	m_pConsole = pConsole;
@@ -281,6 +470,8 @@ void CNetBan::Init(IConsole *pConsole, IStorage *pStorage)
 
 	Console()->Register("ban", "s[ip|id] ?i[minutes] r[reason]", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConBan, this, "Ban ip for x minutes for any reason");
 	Console()->Register("ban_range", "s[first ip] s[last ip] ?i[minutes] r[reason]", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConBanRange, this, "Ban ip range for x minutes for any reason");
+	Console()->Register("ban_until", "s[ip] i[timestamp] r[reason]", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConBanUntil, this, "Ban ip until a unix timestamp (-1 = forever), used by sv_bans_file");
+	Console()->Register("ban_range_until", "s[first ip] s[last ip] i[timestamp] r[reason]", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConBanRangeUntil, this, "Ban ip range until a unix timestamp (-1 = forever), used by sv_bans_file");
 	Console()->Register("unban", "s[ip|entry]", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConUnban, this, "Unban ip/banlist entry");
 	Console()->Register("unban_range", "s[first ip] s[last ip]", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConUnbanRange, this, "Unban ip range");
 	Console()->Register("unban_all", "", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConUnbanAll, this, "Unban all entries");
@@ -290,6 +481,9 @@ void CNetBan::Init(IConsole *pConsole, IStorage *pStorage)
 
 void CNetBan::Update()
 {
+	if(str_comp(g_Config.m_SvBansFile, m_aBansFile) != 0)
+		OpenBansFile(g_Config.m_SvBansFile);
+
 	int Now = time_timestamp();
 
 	// remove expired bans
@@ -298,12 +492,16 @@ void CNetBan::Update()
 	{
 		str_format(aBuf, sizeof(aBuf), "ban %s expired", NetToString(&m_BanAddrPool.First()->m_Data, aNetStr, sizeof(aNetStr)));
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		MakeUnbanCommand(&m_BanAddrPool.First()->m_Data, aBuf, sizeof(aBuf));
+		AppendToBansFile(aBuf);
 		m_BanAddrPool.Remove(m_BanAddrPool.First());
 	}
 	while(m_BanRangePool.First() && m_BanRangePool.First()->m_Info.m_Expires != CBanInfo::EXPIRES_NEVER && m_BanRangePool.First()->m_Info.m_Expires < Now)
 	{
 		str_format(aBuf, sizeof(aBuf), "ban %s expired", NetToString(&m_BanRangePool.First()->m_Data, aNetStr, sizeof(aNetStr)));
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		MakeUnbanCommand(&m_BanRangePool.First()->m_Data, aBuf, sizeof(aBuf));
+		AppendToBansFile(aBuf);
 		m_BanRangePool.Remove(m_BanRangePool.First());
 	}
 }
@@ -341,9 +539,11 @@ int CNetBan::UnbanByIndex(int Index)
 	int Result;
 	char aBuf[256];
 	CBanAddr *pBan = m_BanAddrPool.Get(Index);
+	char aCommand[256];
 	if(pBan)
 	{
 		NetToString(&pBan->m_Data, aBuf, sizeof(aBuf));
+		MakeUnbanCommand(&pBan->m_Data, aCommand, sizeof(aCommand));
 		Result = m_BanAddrPool.Remove(pBan);
 	}
 	else
@@ -352,6 +552,7 @@ int CNetBan::UnbanByIndex(int Index)
 		if(pBanRange)
 		{
 			NetToString(&pBanRange->m_Data, aBuf, sizeof(aBuf));
+			MakeUnbanCommand(&pBanRange->m_Data, aCommand, sizeof(aCommand));
 			Result = m_BanRangePool.Remove(pBanRange);
 		}
 		else
@@ -364,6 +565,7 @@ int CNetBan::UnbanByIndex(int Index)
 	char aMsg[256];
 	str_format(aMsg, sizeof(aMsg), "unbanned index %i (%s)", Index, aBuf);
 	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aMsg);
+	AppendToBansFile(aCommand);
 	return Result;
 }
 
@@ -435,6 +637,45 @@ void CNetBan::ConBanRange(IConsole::IResult *pResult, void *pUser)
 		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", "ban error (invalid range)");
 }
 
+int CNetBan::SecondsUntil(int Expires)
+{
+	if(Expires == CBanInfo::EXPIRES_NEVER)
+		return 0;
+	const int Now = time_timestamp();
+	return Expires > Now ? Expires - Now : -1;
+}
+
+void CNetBan::ConBanUntil(IConsole::IResult *pResult, void *pUser)
+{
+	CNetBan *pThis = static_cast<CNetBan *>(pUser);
+
+	const char *pStr = pResult->GetString(0);
+	const int Seconds = SecondsUntil(pResult->GetInteger(1));
+	const char *pReason = pResult->GetString(2);
+
+	NETADDR Addr;
+	if(net_addr_from_str(&Addr, pStr) != 0)
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", "ban error (invalid network address)");
+	else if(Seconds >= 0)
+		pThis->BanAddr(&Addr, Seconds, pReason);
+}
+
+void CNetBan::ConBanRangeUntil(IConsole::IResult *pResult, void *pUser)
+{
+	CNetBan *pThis = static_cast<CNetBan *>(pUser);
+
+	const char *pStr1 = pResult->GetString(0);
+	const char *pStr2 = pResult->GetString(1);
+	const int Seconds = SecondsUntil(pResult->GetInteger(2));
+	const char *pReason = pResult->GetString(3);
+
+	CNetRange Range;
+	if(net_addr_from_str(&Range.m_LB, pStr1) != 0 || net_addr_from_str(&Range.m_UB, pStr2) != 0)
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", "ban error (invalid range)");
+	else if(Seconds >= 0)
+		pThis->BanRange(&Range, Seconds, pReason);
+}
+
 void CNetBan::ConUnban(IConsole::IResult *pResult, void *pUser)
 {
 	CNetBan *pThis = static_cast<CNetBan *>(pUser);
@@ -522,27 +763,11 @@ void CNetBan::ConBansSave(IConsole::IResult *pResult, void *pUser)
 		return;
 	}
 
-	int Now = time_timestamp();
-	char aAddrStr1[NETADDR_MAXSTRSIZE], aAddrStr2[NETADDR_MAXSTRSIZE];
-	for(CBanAddr *pBan = pThis->m_BanAddrPool.First(); pBan; pBan = pBan->m_pNext)
-	{
-		int Min = pBan->m_Info.m_Expires > -1 ? (pBan->m_Info.m_Expires - Now + 59) / 60 : -1;
-		net_addr_str(&pBan->m_Data, aAddrStr1, sizeof(aAddrStr1), false);
-		str_format(aBuf, sizeof(aBuf), "ban %s %i %s", aAddrStr1, Min, pBan->m_Info.m_aReason);
-		io_write(File, aBuf, str_length(aBuf));
-		io_write_newline(File);
-	}
-	for(CBanRange *pBan = pThis->m_BanRangePool.First(); pBan; pBan = pBan->m_pNext)
-	{
-		int Min = pBan->m_Info.m_Expires > -1 ? (pBan->m_Info.m_Expires - Now + 59) / 60 : -1;
-		net_addr_str(&pBan->m_Data.m_LB, aAddrStr1, sizeof(aAddrStr1), false);
-		net_addr_str(&pBan->m_Data.m_UB, aAddrStr2, sizeof(aAddrStr2), false);
-		str_format(aBuf, sizeof(aBuf), "ban_range %s %s %i %s", aAddrStr1, aAddrStr2, Min, pBan->m_Info.m_aReason);
-		io_write(File, aBuf, str_length(aBuf));
-		io_write_newline(File);
-	}
-
-	io_close(File);
+	// the file is written in the background, big banlists don't stall the server
+	ASYNCIO *pFile = aio_new(File);
+	pThis->WriteBans(pFile, false);
+	aio_close(pFile);
+	aio_free(pFile);
 	str_format(aBuf, sizeof(aBuf), "saved banlist to '%s'", pResult->GetString(0));
 	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
 }
@@ -5,6 +5,9 @@
 
 #include <base/system.h>
 
+#include <memory>
+#include <vector>
+
 inline int NetComp(const NETADDR *pAddr1, const NETADDR *pAddr2)
 {
 	return mem_comp(pAddr1, pAddr2, pAddr1->type == NETTYPE_IPV4 ? 8 : 20);
@@ -60,10 +63,13 @@ protected:
 		return pBuffer;
 	}
 
+	// identifies the common prefix of a range (or a whole address), so that
+	// the ranges containing an address are found with one lookup per prefix
+	// length instead of scanning them
 	class CNetHash
 	{
 	public:
-		int m_Hash;
+		unsigned m_Hash;
 		int m_HashIndex; // matching parts for ranges, 0 for addr
 
 		CNetHash() {}
@@ -112,13 +118,18 @@ protected:
 		void Reset();
 
 		int Num() const { return m_CountUsed; }
-		bool IsFull() const { return m_CountUsed == MAX_BANS; }
 
 		CBan<CDataType> *First() const { return m_pFirstUsed; }
-		CBan<CDataType> *First(const CNetHash *pNetHash) const { return m_aapHashList[pNetHash->m_HashIndex][pNetHash->m_Hash]; }
+		CBan<CDataType> *First(const CNetHash *pNetHash) const
+		{
+			// most prefix lengths are not used by any ban
+			if(m_aNumHashed[pNetHash->m_HashIndex] == 0)
+				return 0;
+			return Bucket(pNetHash->m_HashIndex, pNetHash->m_Hash);
+		}
 		CBan<CDataType> *Find(const CDataType *pData, const CNetHash *pNetHash) const
 		{
-			for(CBan<CDataType> *pBan = m_aapHashList[pNetHash->m_HashIndex][pNetHash->m_Hash]; pBan; pBan = pBan->m_pHashNext)
+			for(CBan<CDataType> *pBan = First(pNetHash); pBan; pBan = pBan->m_pHashNext)
 			{
 				if(NetComp(&pBan->m_Data, pData) == 0)
 					return pBan;
@@ -131,15 +142,22 @@ protected:
 	private:
 		enum
 		{
-			MAX_BANS = 1024,
+			// bans are allocated in chunks, so that their addresses stay valid
+			BANS_PER_CHUNK = 1024,
 		};
 
-		CBan<CDataType> *m_aapHashList[HashCount][256];
-		CBan<CDataType> m_aBans[MAX_BANS];
+		// a power of two of buckets per prefix length, growing with the bans
+		std::vector<CBan<CDataType> *> m_avpHashList[HashCount];
+		int m_aNumHashed[HashCount];
+		std::vector<std::unique_ptr<CBan<CDataType>[]>> m_vpChunks;
 		CBan<CDataType> *m_pFirstFree;
 		CBan<CDataType> *m_pFirstUsed;
 		int m_CountUsed;
 
+		CBan<CDataType> *const &Bucket(int HashIndex, unsigned Hash) const { return m_avpHashList[HashIndex][Hash & (m_avpHashList[HashIndex].size() - 1)]; }
+		CBan<CDataType> *&Bucket(int HashIndex, unsigned Hash) { return m_avpHashList[HashIndex][Hash & (m_avpHashList[HashIndex].size() - 1)]; }
+		void Rehash(int HashIndex, size_t NumBuckets);
+		void AddChunk();
 		void InsertUsed(CBan<CDataType> *pBan);
 	};
 
@@ -155,6 +173,27 @@ protected:
 	template<class T>
 	int Unban(T *pBanPool, const typename T::CDataType *pData);
 
+	// console commands that restore a ban or remove it
+	void MakeBanCommand(const CBanAddr *pBan, int Now, char *pBuf, unsigned BufferSize) const;
+	void MakeBanCommand(const CBanRange *pBan, int Now, char *pBuf, unsigned BufferSize) const;
+	// same with the absolute expiry, so that a restart doesn't extend the ban
+	void MakeBanUntilCommand(const CBanAddr *pBan, char *pBuf, unsigned BufferSize) const;
+	void MakeBanUntilCommand(const CBanRange *pBan, char *pBuf, unsigned BufferSize) const;
+	void MakeUnbanCommand(const NETADDR *pData, char *pBuf, unsigned BufferSize) const;
+	void MakeUnbanCommand(const CNetRange *pData, char *pBuf, unsigned BufferSize) const;
+	void WriteBans(ASYNCIO *pFile, bool Until) const;
+	// the seconds left until the expiry, 0 for a ban that never expires
+	// and -1 for one that expired already
+	static int SecondsUntil(int Expires);
+
+	// sv_bans_file, changes are appended by a background thread
+	void OpenBansFile(const char *pFilename);
+	void CloseBansFile();
+	void AppendToBansFile(const char *pCommand);
+	char m_aBansFile[IO_MAX_PATH_LENGTH] = "";
+	ASYNCIO *m_pBansFile = nullptr;
+	bool m_LoadingBansFile = false;
+
 	class IConsole *m_pConsole;
 	class IStorage *m_pStorage;
 	CBanAddrPool m_BanAddrPool;
@@ -173,7 +212,7 @@ public:
 	class IConsole *Console() const { return m_pConsole; }
 	class IStorage *Storage() const { return m_pStorage; }
 
-	virtual ~CNetBan() {}
+	virtual ~CNetBan();
 	void Init(class IConsole *pConsole, class IStorage *pStorage);
 	void Update();
 
@@ -187,6 +226,8 @@ public:
 
 	static void ConBan(class IConsole::IResult *pResult, void *pUser);
 	static void ConBanRange(class IConsole::IResult *pResult, void *pUser);
+	static void ConBanUntil(class IConsole::IResult *pResult, void *pUser);
+	static void ConBanRangeUntil(class IConsole::IResult *pResult, void *pUser);
 	static void ConUnban(class IConsole::IResult *pResult, void *pUser);
 	static void ConUnbanRange(class IConsole::IResult *pResult, void *pUser);
 	static void ConUnbanAll(class IConsole::IResult *pResult, void *pUser);
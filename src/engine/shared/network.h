@@ -236,6 +236,8 @@ private:
 	NETADDR m_PeerAddr;
 	NETSOCKET m_Socket;
 	NETSTATS m_Stats;
+	int64_t m_ResendChunks;
+	int64_t m_ResendBytes;
 
 	//
 	void ResetStats();
@@ -282,6 +284,8 @@ public:
 
 	int AckSequence() const { return m_Ack; }
 	int SeqSequence() const { return m_Sequence; }
+	int64_t ResendChunks() const { return m_ResendChunks; }
+	int64_t ResendBytes() const { return m_ResendBytes; }
 	int SecurityToken() const { return m_SecurityToken; }
 	CStaticRingBuffer<CNetChunkResend, NET_CONN_BUFFERSIZE> *ResendBuffer() { return &m_Buffer; }
 
@@ -347,10 +351,31 @@ public:
 // server side
 class CNetServer
 {
+public:
+	// the stages at which Recv drops packets, and the packets it admits
+	enum
+	{
+		RECV_BANNED = 0,
+		RECV_MALFORMED,
+		RECV_RATE_LIMITED,
+		RECV_BAD_TOKEN,
+		RECV_UNDECODABLE,
+		RECV_ADMITTED,
+		NUM_RECV_COUNTERS,
+	};
+
+private:
 	struct CSlot
 	{
 	public:
 		CNetConnection m_Connection;
+
+		// position in the address index, see IndexSlot
+		bool m_Indexed;
+		int m_AddrBucket;
+		int m_IpBucket;
+		int m_NextByAddr;
+		int m_NextByIp;
 	};
 
 	struct CSpamConn
@@ -360,6 +385,21 @@ class CNetServer
 		int m_Conns;
 	};
 
+	// token bucket of the packets from one network without a slot
+	struct CPrefixBucket
+	{
+		unsigned m_Type;
+		unsigned char m_aPrefix[8];
+		int m_Tokens;
+		int64_t m_LastRefill;
+	};
+
+	enum
+	{
+		NUM_PREFIX_BUCKETS = 4096,
+		NUM_SLOT_BUCKETS = 256,
+	};
+
 	NETADDR m_Address;
 	NETSOCKET m_Socket;
 	CNetBan *m_pNetBan;
@@ -367,6 +407,11 @@ class CNetServer
 	int m_MaxClients;
 	int m_MaxClientsPerIP;
 
+	// the slots by their address with and without port, as chains in
+	// buckets, -1 ends a chain
+	int m_aFirstSlotByAddr[NUM_SLOT_BUCKETS];
+	int m_aFirstSlotByIp[NUM_SLOT_BUCKETS];
+
 	NETFUNC_NEWCLIENT m_pfnNewClient;
 	NETFUNC_NEWCLIENT_NOAUTH m_pfnNewClientNoAuth;
 	NETFUNC_DELCLIENT m_pfnDelClient;
@@ -383,12 +428,19 @@ class CNetServer
 
 	CSpamConn m_aSpamConns[NET_CONNLIMIT_IPS];
 
+	CPrefixBucket m_aPrefixBuckets[NUM_PREFIX_BUCKETS];
+	int64_t m_aRecvCounters[NUM_RECV_COUNTERS];
+
 	CNetRecvUnpacker m_RecvUnpacker;
 
+	bool AdmitPrefix(const NETADDR &Addr);
+	int AdmitPacket(const unsigned char *pData, int Size, const NETADDR &Addr, int Slot);
 	void OnTokenCtrlMsg(NETADDR &Addr, int ControlMsg, const CNetPacketConstruct &Packet);
 	int OnSixupCtrlMsg(NETADDR &Addr, CNetChunk *pChunk, int ControlMsg, const CNetPacketConstruct &Packet, SECURITY_TOKEN &ResponseToken, SECURITY_TOKEN Token);
 	void OnPreConnMsg(NETADDR &Addr, CNetPacketConstruct &Packet);
 	void OnConnCtrlMsg(NETADDR &Addr, int ClientID, int ControlMsg, const CNetPacketConstruct &Packet);
+	void IndexSlot(int Slot);
+	void UnindexSlot(int Slot);
 	bool ClientExists(const NETADDR &Addr) { return GetClientSlot(Addr) != -1; }
 	int GetClientSlot(const NETADDR &Addr);
 	void SendControl(NETADDR &Addr, int ControlMsg, const void *pExtra, int ExtraSize, SECURITY_TOKEN SecurityToken);
@@ -416,12 +468,16 @@ public:
 
 	// status requests
 	const NETADDR *ClientAddr(int ClientID) const { return m_aSlots[ClientID].m_Connection.PeerAddress(); }
+	int64_t ResendChunks(int ClientID) const { return m_aSlots[ClientID].m_Connection.ResendChunks(); }
+	int64_t ResendBytes(int ClientID) const { return m_aSlots[ClientID].m_Connection.ResendBytes(); }
 	bool HasSecurityToken(int ClientID) const { return m_aSlots[ClientID].m_Connection.SecurityToken() != NET_SECURITY_TOKEN_UNSUPPORTED; }
 	NETADDR Address() const { return m_Address; }
 	NETSOCKET Socket() const { return m_Socket; }
 	CNetBan *NetBan() const { return m_pNetBan; }
 	int NetType() const { return net_socket_type(m_Socket); }
 	int MaxClients() const { return m_MaxClients; }
+	int64_t RecvCounter(int Counter) const { return m_aRecvCounters[Counter]; }
+	static const char *RecvCounterName(int Counter);
 
 	void SendTokenSixup(NETADDR &Addr, SECURITY_TOKEN Token);
 	int SendConnlessSixup(CNetChunk *pChunk, SECURITY_TOKEN ResponseToken);
@@ -12,6 +12,8 @@ SECURITY_TOKEN ToSecurityToken(unsigned char *pData)
 void CNetConnection::ResetStats()
 {
 	mem_zero(&m_Stats, sizeof(m_Stats));
+	m_ResendChunks = 0;
+	m_ResendBytes = 0;
 	mem_zero(&m_PeerAddr, sizeof(m_PeerAddr));
 	m_LastUpdateTime = 0;
 }
@@ -185,6 +187,8 @@ void CNetConnection::ResendChunk(CNetChunkResend *pResend)
 {
 	QueueChunkEx(pResend->m_Flags | NET_CHUNKFLAG_RESEND, pResend->m_DataSize, pResend->m_pData, pResend->m_Sequence);
 	pResend->m_LastSendTime = time_get();
+	m_ResendChunks++;
+	m_ResendBytes += pResend->m_DataSize;
 }
 
 void CNetConnection::Resend()
@@ -41,6 +41,15 @@ static SECURITY_TOKEN ToSecurityToken(const unsigned char *pData)
 	return (int)pData[0] | (pData[1] << 8) | (pData[2] << 16) | (pData[3] << 24);
 }
 
+static const char *const gs_apRecvCounterNames[CNetServer::NUM_RECV_COUNTERS] = {
+	"banned",
+	"malformed",
+	"rate_limited",
+	"bad_token",
+	"undecodable",
+	"admitted",
+};
+
 bool CNetServer::Open(NETADDR BindAddr, CNetBan *pNetBan, int MaxClients, int MaxClientsPerIP)
 {
 	// zero out the whole structure
@@ -67,6 +76,11 @@ bool CNetServer::Open(NETADDR BindAddr, CNetBan *pNetBan, int MaxClients, int Ma
 
 	for(auto &Slot : m_aSlots)
 		Slot.m_Connection.Init(m_Socket, true);
+	for(int i = 0; i < NUM_SLOT_BUCKETS; i++)
+	{
+		m_aFirstSlotByAddr[i] = -1;
+		m_aFirstSlotByIp[i] = -1;
+	}
 
 	return true;
 }
@@ -104,6 +118,7 @@ int CNetServer::Drop(int ClientID, const char *pReason)
 		m_pfnDelClient(ClientID, pReason, m_pUser);
 
 	m_aSlots[ClientID].m_Connection.Disconnect(pReason);
+	UnindexSlot(ClientID);
 
 	return 0;
 }
@@ -150,10 +165,59 @@ void CNetServer::SendControl(NETADDR &Addr, int ControlMsg, const void *pExtra,
 	CNetBase::SendControlMsg(m_Socket, &Addr, 0, ControlMsg, pExtra, ExtraSize, SecurityToken);
 }
 
+static int SlotBucket(const NETADDR &Addr, bool WithPort, int NumBuckets)
+{
+	unsigned Hash = 2166136261u;
+	Hash = (Hash ^ (unsigned)Addr.type) * 16777619u;
+	for(int i = 0; i < ((Addr.type & NETTYPE_IPV4) ? 4 : 16); i++)
+		Hash = (Hash ^ Addr.ip[i]) * 16777619u;
+	if(WithPort)
+	{
+		Hash = (Hash ^ (Addr.port & 0xff)) * 16777619u;
+		Hash = (Hash ^ (Addr.port >> 8)) * 16777619u;
+	}
+	return Hash % NumBuckets;
+}
+
+// must be called whenever the peer address of a slot is set, the lookups
+// still check the state and address of the slots in a chain
+void CNetServer::IndexSlot(int Slot)
+{
+	UnindexSlot(Slot);
+
+	CSlot &IndexedSlot = m_aSlots[Slot];
+	const NETADDR *pAddr = IndexedSlot.m_Connection.PeerAddress();
+	IndexedSlot.m_Indexed = true;
+	IndexedSlot.m_AddrBucket = SlotBucket(*pAddr, true, NUM_SLOT_BUCKETS);
+	IndexedSlot.m_IpBucket = SlotBucket(*pAddr, false, NUM_SLOT_BUCKETS);
+	IndexedSlot.m_NextByAddr = m_aFirstSlotByAddr[IndexedSlot.m_AddrBucket];
+	IndexedSlot.m_NextByIp = m_aFirstSlotByIp[IndexedSlot.m_IpBucket];
+	m_aFirstSlotByAddr[IndexedSlot.m_AddrBucket] = Slot;
+	m_aFirstSlotByIp[IndexedSlot.m_IpBucket] = Slot;
+}
+
+void CNetServer::UnindexSlot(int Slot)
+{
+	CSlot &IndexedSlot = m_aSlots[Slot];
+	if(!IndexedSlot.m_Indexed)
+		return;
+	IndexedSlot.m_Indexed = false;
+
+	int *pNext = &m_aFirstSlotByAddr[IndexedSlot.m_AddrBucket];
+	while(*pNext != Slot)
+		pNext = &m_aSlots[*pNext].m_NextByAddr;
+	*pNext = IndexedSlot.m_NextByAddr;
+
+	pNext = &m_aFirstSlotByIp[IndexedSlot.m_IpBucket];
+	while(*pNext != Slot)
+		pNext = &m_aSlots[*pNext].m_NextByIp;
+	*pNext = IndexedSlot.m_NextByIp;
+}
+
 int CNetServer::NumClientsWithAddr(NETADDR Addr)
 {
 	int FoundAddr = 0;
-	for(int i = 0; i < MaxClients(); ++i)
+	for(int i = m_aFirstSlotByIp[SlotBucket(Addr, false, NUM_SLOT_BUCKETS)]; i != -1; i = m_aSlots[i].m_NextByIp)
 	{
 		if(m_aSlots[i].m_Connection.State() == NET_CONNSTATE_OFFLINE ||
 			(m_aSlots[i].m_Connection.State() == NET_CONNSTATE_ERROR &&
@@ -246,6 +310,7 @@ int CNetServer::TryAcceptClient(NETADDR &Addr, SECURITY_TOKEN SecurityToken, boo
 
 	// init connection slot
 	m_aSlots[Slot].m_Connection.DirectInit(Addr, SecurityToken, Token, Sixup);
+	IndexSlot(Slot);
 
 	if(VanillaAuth)
 	{
@@ -575,16 +640,158 @@ int CNetServer::OnSixupCtrlMsg(NETADDR &Addr, CNetChunk *pChunk, int ControlMsg,
 	return 0;
 }
 
+const char *CNetServer::RecvCounterName(int Counter)
+{
+	if(Counter < 0 || Counter >= NUM_RECV_COUNTERS)
+		return "unknown";
+	return gs_apRecvCounterNames[Counter];
+}
+
+bool CNetServer::AdmitPrefix(const NETADDR &Addr)
+{
+	const int PerSecond = g_Config.m_SvPrefixPacketsPerSecond;
+	if(PerSecond == 0)
+		return true;
+
+	// one bucket per /24 (IPv4) or /64 (IPv6), the hash is seeded so that
+	// networks can't be picked to share the bucket of another one
+	unsigned char aPrefix[sizeof(CPrefixBucket::m_aPrefix)] = {0};
+	mem_copy(aPrefix, Addr.ip, (Addr.type & NETTYPE_IPV4) ? 3 : 8);
+	unsigned Hash = 2166136261u ^ ToSecurityToken(m_aSecurityTokenSeed);
+	Hash = (Hash ^ (unsigned)Addr.type) * 16777619u;
+	for(unsigned char Byte : aPrefix)
+		Hash = (Hash ^ Byte) * 16777619u;
+
+	// each network has two possible buckets, a bucket is only taken over
+	// once it is idle and full anyway, colliding networks share the tokens
+	// of a busy one instead of refilling it
+	const int64_t Now = time_get();
+	CPrefixBucket *apBuckets[2] = {
+		&m_aPrefixBuckets[Hash % NUM_PREFIX_BUCKETS],
+		&m_aPrefixBuckets[(Hash / NUM_PREFIX_BUCKETS) % NUM_PREFIX_BUCKETS]};
+	CPrefixBucket *pBucket = nullptr;
+	for(CPrefixBucket *pCandidate : apBuckets)
+	{
+		if(pCandidate->m_LastRefill != 0 && pCandidate->m_Type == Addr.type && mem_comp(pCandidate->m_aPrefix, aPrefix, sizeof(aPrefix)) == 0)
+		{
+			pBucket = pCandidate;
+			break;
+		}
+	}
+	if(!pBucket)
+	{
+		pBucket = apBuckets[0];
+		for(CPrefixBucket *pCandidate : apBuckets)
+		{
+			if(pCandidate->m_LastRefill == 0 || Now - pCandidate->m_LastRefill >= time_freq())
+			{
+				pCandidate->m_Type = Addr.type;
+				mem_copy(pCandidate->m_aPrefix, aPrefix, sizeof(aPrefix));
+				pCandidate->m_LastRefill = 0;
+				pBucket = pCandidate;
+				break;
+			}
+		}
+	}
+
+	CPrefixBucket &Bucket = *pBucket;
+	if(Bucket.m_LastRefill == 0 || Now - Bucket.m_LastRefill >= time_freq())
+	{
+		Bucket.m_Tokens = PerSecond;
+		Bucket.m_LastRefill = Now;
+	}
+	else
+	{
+		const int64_t Refill = (Now - Bucket.m_LastRefill) * PerSecond / time_freq();
+		if(Refill > 0)
+		{
+			Bucket.m_Tokens = (int)minimum<int64_t>(PerSecond, Bucket.m_Tokens + Refill);
+			Bucket.m_LastRefill += Refill * time_freq() / PerSecond;
+		}
+	}
+
+	if(Bucket.m_Tokens <= 0)
+		return false;
+	Bucket.m_Tokens--;
+	return true;
+}
+
+// checks everything that is visible on the raw bytes of a packet, so that
+// decompression and chunk parsing are only done for admitted packets
+int CNetServer::AdmitPacket(const unsigned char *pData, int Size, const NETADDR &Addr, int Slot)
+{
+	if(Size < NET_PACKETHEADERSIZE || Size > NET_MAX_PACKETSIZE)
+		return RECV_MALFORMED;
+
+	const int Flags = pData[0] >> 2;
+	bool Sixup;
+	bool Control;
+	bool Compressed;
+	int DataStart;
+	if(Flags & NET_PACKETFLAG_CONNLESS)
+	{
+		Sixup = (pData[0] & 0x3) == 1;
+		Control = false;
+		Compressed = false;
+		DataStart = Sixup ? 9 : 6;
+	}
+	else
+	{
+		Sixup = (Flags & NET_PACKETFLAG_UNUSED) || (Slot != -1 && m_aSlots[Slot].m_Connection.m_Sixup);
+		Control = Sixup ? (Flags & 1) : (Flags & NET_PACKETFLAG_CONTROL);
+		Compressed = Sixup ? (Flags & 4) : (Flags & NET_PACKETFLAG_COMPRESSION);
+		DataStart = Sixup ? 7 : NET_PACKETHEADERSIZE;
+	}
+	if(Size < DataStart)
+		return RECV_MALFORMED;
+	// compressed and empty control packets are never handled
+	if(Control && (Compressed || Size == DataStart))
+		return RECV_MALFORMED;
+
+	if(Slot == -1 && !AdmitPrefix(Addr))
+		return RECV_RATE_LIMITED;
+
+	if(Flags & NET_PACKETFLAG_CONNLESS)
+	{
+		if(Sixup && ToSecurityToken(&pData[1]) != GetToken(Addr) && ToSecurityToken(&pData[1]) != GetGlobalToken())
+			return RECV_BAD_TOKEN;
+	}
+	else if(Slot != -1 && !Control)
+	{
+		// the same checks as in CNetConnection::Feed, control packets are
+		// handled before those
+		const CNetConnection &Connection = m_aSlots[Slot].m_Connection;
+		if(Connection.m_Sixup)
+		{
+			if(ToSecurityToken(&pData[3]) != Connection.m_Token)
+				return RECV_BAD_TOKEN;
+		}
+		else if(Connection.State() != NET_CONNSTATE_OFFLINE &&
+			Connection.SecurityToken() != NET_SECURITY_TOKEN_UNKNOWN &&
+			Connection.SecurityToken() != NET_SECURITY_TOKEN_UNSUPPORTED &&
+			!Compressed)
+		{
+			// the token of compressed packets is only known after decompression
+			if(Size - DataStart < (int)sizeof(SECURITY_TOKEN) ||
+				ToSecurityToken(&pData[Size - sizeof(SECURITY_TOKEN)]) != Connection.SecurityToken())
+				return RECV_BAD_TOKEN;
+		}
+	}
+
+	return RECV_ADMITTED;
+}
+
 int CNetServer::GetClientSlot(const NETADDR &Addr)
 {
 	int Slot = -1;
 
-	for(int i = 0; i < MaxClients(); i++)
+	// the highest matching slot, like a scan over all slots
+	for(int i = m_aFirstSlotByAddr[SlotBucket(Addr, true, NUM_SLOT_BUCKETS)]; i != -1; i = m_aSlots[i].m_NextByAddr)
 	{
-		if(m_aSlots[i].m_Connection.State() != NET_CONNSTATE_OFFLINE &&
+		if(i > Slot &&
+			m_aSlots[i].m_Connection.State() != NET_CONNSTATE_OFFLINE &&
 			m_aSlots[i].m_Connection.State() != NET_CONNSTATE_ERROR &&
 			net_addr_comp(m_aSlots[i].m_Connection.PeerAddress(), &Addr) == 0)
-
 		{
 			Slot = i;
 		}
@@ -638,84 +845,77 @@ int CNetServer::Recv(CNetChunk *pChunk, SECURITY_TOKEN *pResponseToken)
 		if(NetBan() && NetBan()->IsBanned(&Addr, aBuf, sizeof(aBuf)))
 		{
 			// banned, reply with a message
+			m_aRecvCounters[RECV_BANNED]++;
 			CNetBase::SendControlMsg(m_Socket, &Addr, 0, NET_CTRLMSG_CLOSE, aBuf, str_length(aBuf) + 1, NET_SECURITY_TOKEN_UNSUPPORTED);
 			continue;
 		}
 
+		const int Slot = GetClientSlot(Addr);
+		const int Stage = AdmitPacket(pData, Bytes, Addr, Slot);
+		if(Stage != RECV_ADMITTED)
+		{
+			m_aRecvCounters[Stage]++;
+			continue;
+		}
+
 		SECURITY_TOKEN Token;
-		bool Sixup = false;
+		// connected packets of 0.7 clients don't always carry the flag
+		bool Sixup = Slot != -1 && m_aSlots[Slot].m_Connection.m_Sixup;
 		*pResponseToken = NET_SECURITY_TOKEN_UNKNOWN;
-		if(CNetBase::UnpackPacket(pData, Bytes, &m_RecvUnpacker.m_Data, Sixup, &Token, pResponseToken) == 0)
+		if(CNetBase::UnpackPacket(pData, Bytes, &m_RecvUnpacker.m_Data, Sixup, &Token, pResponseToken) != 0)
 		{
-			if(m_RecvUnpacker.m_Data.m_Flags & NET_PACKETFLAG_CONNLESS)
+			m_aRecvCounters[RECV_UNDECODABLE]++;
+			continue;
+		}
+		m_aRecvCounters[RECV_ADMITTED]++;
+
+		if(m_RecvUnpacker.m_Data.m_Flags & NET_PACKETFLAG_CONNLESS)
+		{
+			pChunk->m_Flags = NETSENDFLAG_CONNLESS;
+			pChunk->m_ClientID = -1;
+			pChunk->m_Address = Addr;
+			pChunk->m_DataSize = m_RecvUnpacker.m_Data.m_DataSize;
+			pChunk->m_pData = m_RecvUnpacker.m_Data.m_aChunkData;
+			if(m_RecvUnpacker.m_Data.m_Flags & NET_PACKETFLAG_EXTENDED)
 			{
-				if(Sixup && Token != GetToken(Addr) && Token != GetGlobalToken())
-					continue;
-
-				pChunk->m_Flags = NETSENDFLAG_CONNLESS;
-				pChunk->m_ClientID = -1;
-				pChunk->m_Address = Addr;
-				pChunk->m_DataSize = m_RecvUnpacker.m_Data.m_DataSize;
-				pChunk->m_pData = m_RecvUnpacker.m_Data.m_aChunkData;
-				if(m_RecvUnpacker.m_Data.m_Flags & NET_PACKETFLAG_EXTENDED)
-				{
-					pChunk->m_Flags |= NETSENDFLAG_EXTENDED;
-					mem_copy(pChunk->m_aExtraData, m_RecvUnpacker.m_Data.m_aExtraData, sizeof(pChunk->m_aExtraData));
-				}
-				return 1;
+				pChunk->m_Flags |= NETSENDFLAG_EXTENDED;
+				mem_copy(pChunk->m_aExtraData, m_RecvUnpacker.m_Data.m_aExtraData, sizeof(pChunk->m_aExtraData));
 			}
-			else
-			{
-				// drop invalid ctrl packets
-				if(m_RecvUnpacker.m_Data.m_Flags & NET_PACKETFLAG_CONTROL &&
-					m_RecvUnpacker.m_Data.m_DataSize == 0)
-					continue;
-
-				// normal packet, find matching slot
-				int Slot = GetClientSlot(Addr);
-
-				if(!Sixup && Slot != -1 && m_aSlots[Slot].m_Connection.m_Sixup)
-				{
-					Sixup = true;
-					if(CNetBase::UnpackPacket(pData, Bytes, &m_RecvUnpacker.m_Data, Sixup, &Token))
-						continue;
-				}
+			return 1;
+		}
+		else if(Slot != -1)
+		{
+			// normal packet of a client
 
-				if(Slot != -1)
-				{
-					// found
+			// control
+			if(m_RecvUnpacker.m_Data.m_Flags & NET_PACKETFLAG_CONTROL)
+				OnConnCtrlMsg(Addr, Slot, m_RecvUnpacker.m_Data.m_aChunkData[0], m_RecvUnpacker.m_Data);
 
-					// control
-					if(m_RecvUnpacker.m_Data.m_Flags & NET_PACKETFLAG_CONTROL)
-						OnConnCtrlMsg(Addr, Slot, m_RecvUnpacker.m_Data.m_aChunkData[0], m_RecvUnpacker.m_Data);
+			if(m_aSlots[Slot].m_Connection.Feed(&m_RecvUnpacker.m_Data, &Addr, Token))
+			{
+				if(m_RecvUnpacker.m_Data.m_DataSize)
+					m_RecvUnpacker.Start(&Addr, &m_aSlots[Slot].m_Connection, Slot);
+			}
+		}
+		else
+		{
+			// not found, client that wants to connect
 
-					if(m_aSlots[Slot].m_Connection.Feed(&m_RecvUnpacker.m_Data, &Addr, Token))
-					{
-						if(m_RecvUnpacker.m_Data.m_DataSize)
-							m_RecvUnpacker.Start(&Addr, &m_aSlots[Slot].m_Connection, Slot);
-					}
-				}
-				else
-				{
-					// not found, client that wants to connect
-
-					if(Sixup)
-					{
-						// got 0.7 control msg
-						if(OnSixupCtrlMsg(Addr, pChunk, m_RecvUnpacker.m_Data.m_aChunkData[0], m_RecvUnpacker.m_Data, *pResponseToken, Token) == 1)
-							return 1;
-					}
-					else if(IsDDNetControlMsg(&m_RecvUnpacker.m_Data))
-					{
-						// got ddnet control msg
-						OnTokenCtrlMsg(Addr, m_RecvUnpacker.m_Data.m_aChunkData[0], m_RecvUnpacker.m_Data);
-					}
-					else
-					{
-						// got connection-less ctrl or sys msg
-						OnPreConnMsg(Addr, m_RecvUnpacker.m_Data);
-					}
-				}
+			if(Sixup)
+			{
+				// got 0.7 control msg
+				if(OnSixupCtrlMsg(Addr, pChunk, m_RecvUnpacker.m_Data.m_aChunkData[0], m_RecvUnpacker.m_Data, *pResponseToken, Token) == 1)
+					return 1;
+			}
+			else if(IsDDNetControlMsg(&m_RecvUnpacker.m_Data))
+			{
+				// got ddnet control msg
+				OnTokenCtrlMsg(Addr, m_RecvUnpacker.m_Data.m_aChunkData[0], m_RecvUnpacker.m_Data);
+			}
+			else
+			{
+				// got connection-less ctrl or sys msg
+				OnPreConnMsg(Addr, m_RecvUnpacker.m_Data);
 			}
 		}
 	}
@@ -801,6 +1001,8 @@ bool CNetServer::SetTimedOut(int ClientID, int OrigID)
 
 	m_aSlots[ClientID].m_Connection.SetTimedOut(ClientAddr(OrigID), m_aSlots[OrigID].m_Connection.SeqSequence(), m_aSlots[OrigID].m_Connection.AckSequence(), m_aSlots[OrigID].m_Connection.SecurityToken(), m_aSlots[OrigID].m_Connection.ResendBuffer(), m_aSlots[OrigID].m_Connection.m_Sixup);
 	m_aSlots[OrigID].m_Connection.Reset();
+	IndexSlot(ClientID);
+	UnindexSlot(OrigID);
 	return true;
 }
 
@@ -0,0 +1,84 @@
+#include "parallel.h"
+
+#include <base/system.h>
+
+CParallelRunner::~CParallelRunner()
+{
+	Shutdown();
+}
+
+void CParallelRunner::Init(int NumThreads)
+{
+	dbg_assert(m_vThreads.empty(), "parallel runner already initialized");
+	m_Stop = false;
+	for(int i = 0; i < NumThreads; i++)
+		m_vThreads.emplace_back([this]() { RunThread(); });
+}
+
+void CParallelRunner::Shutdown()
+{
+	{
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		m_Stop = true;
+		m_WorkCond.notify_all();
+	}
+	for(auto &Thread : m_vThreads)
+		Thread.join();
+	m_vThreads.clear();
+}
+
+void CParallelRunner::Run(int NumTasks, const std::function<void(int)> &Task)
+{
+	if(NumTasks <= 0)
+		return;
+
+	m_pTask = &Task;
+	m_NumTasks = NumTasks;
+	m_NextTask.store(0, std::memory_order_relaxed);
+	// a single task is not worth waking the threads for
+	if(!m_vThreads.empty() && NumTasks > 1)
+	{
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		m_NumBusyThreads = m_vThreads.size();
+		m_Generation++;
+		m_WorkCond.notify_all();
+	}
+
+	RunTasks();
+
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+	m_DoneCond.wait(Lock, [this]() { return m_NumBusyThreads == 0; });
+	m_pTask = nullptr;
+}
+
+void CParallelRunner::RunThread()
+{
+	uint64_t Generation = 0;
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+			m_WorkCond.wait(Lock, [this, Generation]() { return m_Stop || m_Generation != Generation; });
+			if(m_Stop)
+				return;
+			Generation = m_Generation;
+		}
+
+		RunTasks();
+
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		if(--m_NumBusyThreads == 0)
+			m_DoneCond.notify_all();
+	}
+}
+
+void CParallelRunner::RunTasks()
+{
+	while(true)
+	{
+		const int Task = m_NextTask.fetch_add(1, std::memory_order_relaxed);
+		if(Task >= m_NumTasks)
+			break;
+		(*m_pTask)(Task);
+	}
+}
@@ -0,0 +1,47 @@
+#ifndef ENGINE_SHARED_PARALLEL_H
+#define ENGINE_SHARED_PARALLEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs a batch of independent tasks on a fixed set of threads and waits for
+ * all of them, for work that has to be finished within a tick.
+ *
+ * The calling thread runs tasks as well, so a runner without threads runs
+ * every task serially.
+ */
+class CParallelRunner
+{
+	std::vector<std::thread> m_vThreads;
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkCond;
+	std::condition_variable m_DoneCond;
+	uint64_t m_Generation = 0;
+	int m_NumBusyThreads = 0;
+	bool m_Stop = false;
+
+	const std::function<void(int)> *m_pTask = nullptr;
+	std::atomic<int> m_NextTask{0};
+	int m_NumTasks = 0;
+
+	void RunThread();
+	void RunTasks();
+
+public:
+	~CParallelRunner();
+
+	// starts NumThreads threads in addition to the one that calls Run()
+	void Init(int NumThreads);
+	void Shutdown();
+	int NumThreads() const { return m_vThreads.size(); }
+
+	// calls Task(i) for every i in [0, NumTasks), in no particular order
+	void Run(int NumTasks, const std::function<void(int)> &Task);
+};
+
+#endif
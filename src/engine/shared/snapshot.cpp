@@ -1,6 +1,7 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include "snapshot.h"
+#include "alloc_counter.h"
 #include "compression.h"
 #include "uuid_manager.h"
 
@@ -266,8 +267,49 @@ const CSnapshotDelta::CData *CSnapshotDelta::EmptyDelta() const
 	return &m_Empty;
 }
 
+static int PackedSize(const int *pData, int Num)
+{
+	unsigned char aBuf[CVariableInt::MAX_BYTES_PACKED];
+	int Size = 0;
+	for(int i = 0; i < Num; i++)
+		Size += CVariableInt::Pack(aBuf, pData[i], sizeof(aBuf)) - aBuf;
+	return Size;
+}
+
+// maps the internal types of the extended items to their external types,
+// each type is looked up only once per delta
+class CExternalTypeCache
+{
+	enum
+	{
+		NUM_CACHED_TYPES = 64
+	};
+	const CSnapshot *m_pSnap;
+	int m_aTypes[NUM_CACHED_TYPES];
+
+public:
+	CExternalTypeCache(const CSnapshot *pSnap) :
+		m_pSnap(pSnap)
+	{
+		for(int &Type : m_aTypes)
+			Type = -1;
+	}
+
+	int Get(int InternalType)
+	{
+		if(InternalType < CSnapshot::OFFSET_UUID_TYPE)
+			return InternalType;
+		const int Index = CSnapshot::MAX_TYPE - InternalType;
+		if(Index >= NUM_CACHED_TYPES)
+			return m_pSnap->GetExternalItemType(InternalType);
+		if(m_aTypes[Index] == -1)
+			m_aTypes[Index] = m_pSnap->GetExternalItemType(InternalType);
+		return m_aTypes[Index];
+	}
+};
+
 // TODO: OPT: this should be made much faster
-int CSnapshotDelta::CreateDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pDstData)
+int CSnapshotDelta::CreateDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pDstData, FItemSizeCallback pfnItemSize, void *pUser)
 {
 	CData *pDelta = (CData *)pDstData;
 	int *pData = (int *)pDelta->m_aData;
@@ -279,6 +321,10 @@ int CSnapshotDelta::CreateDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pDstData
 	CItemList aHashlist[HASHLIST_SIZE];
 	GenerateHash(aHashlist, pTo);
 
+	// the internal types of extended items are allocated per snapshot
+	CExternalTypeCache FromExternalTypes(pFrom);
+	CExternalTypeCache ExternalTypes(pTo);
+
 	// pack deleted stuff
 	for(int i = 0; i < pFrom->NumItems(); i++)
 	{
@@ -288,6 +334,8 @@ int CSnapshotDelta::CreateDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pDstData
 			// deleted
 			pDelta->m_NumDeletedItems++;
 			*pData = pFromItem->Key();
+			if(pfnItemSize)
+				pfnItemSize(FromExternalTypes.Get(pFromItem->Type()), PackedSize(pData, 1), pUser);
 			pData++;
 		}
 	}
@@ -323,16 +371,20 @@ int CSnapshotDelta::CreateDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pDstData
 
 			if(DiffItem(pPastItem->Data(), pCurItem->Data(), pItemDataDst, ItemSize / sizeof(int32_t)))
 			{
+				const int *pItemStart = pData;
 				*pData++ = pCurItem->Type();
 				*pData++ = pCurItem->ID();
 				if(IncludeSize)
 					*pData++ = ItemSize / sizeof(int32_t);
 				pData += ItemSize / sizeof(int32_t);
 				pDelta->m_NumUpdateItems++;
+				if(pfnItemSize)
+					pfnItemSize(ExternalTypes.Get(pCurItem->Type()), PackedSize(pItemStart, pData - pItemStart), pUser);
 			}
 		}
 		else
 		{
+			const int *pItemStart = pData;
 			*pData++ = pCurItem->Type();
 			*pData++ = pCurItem->ID();
 			if(IncludeSize)
@@ -341,6 +393,8 @@ int CSnapshotDelta::CreateDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pDstData
 			mem_copy(pData, pCurItem->Data(), ItemSize);
 			pData += ItemSize / sizeof(int32_t);
 			pDelta->m_NumUpdateItems++;
+			if(pfnItemSize)
+				pfnItemSize(ExternalTypes.Get(pCurItem->Type()), PackedSize(pItemStart, pData - pItemStart), pUser);
 		}
 	}
 
@@ -465,6 +519,20 @@ void CSnapshotStorage::Init()
 {
 	m_pFirst = 0;
 	m_pLast = 0;
+	m_pFree = 0;
+	m_NumFree = 0;
+}
+
+void CSnapshotStorage::FreeHolder(CHolder *pHolder)
+{
+	if(m_NumFree >= MAX_FREE_HOLDERS)
+	{
+		CAllocCounter::Free(pHolder);
+		return;
+	}
+	pHolder->m_pNext = m_pFree;
+	m_pFree = pHolder;
+	m_NumFree++;
 }
 
 void CSnapshotStorage::PurgeAll()
@@ -474,13 +542,23 @@ void CSnapshotStorage::PurgeAll()
 	while(pHolder)
 	{
 		CHolder *pNext = pHolder->m_pNext;
-		free(pHolder);
+		CAllocCounter::Free(pHolder);
+		pHolder = pNext;
+	}
+
+	pHolder = m_pFree;
+	while(pHolder)
+	{
+		CHolder *pNext = pHolder->m_pNext;
+		CAllocCounter::Free(pHolder);
 		pHolder = pNext;
 	}
 
 	// no more snapshots in storage
 	m_pFirst = 0;
 	m_pLast = 0;
+	m_pFree = 0;
+	m_NumFree = 0;
 }
 
 void CSnapshotStorage::PurgeUntil(int Tick)
@@ -492,7 +570,7 @@ void CSnapshotStorage::PurgeUntil(int Tick)
 		CHolder *pNext = pHolder->m_pNext;
 		if(pHolder->m_Tick >= Tick)
 			return; // no more to remove
-		free(pHolder);
+		FreeHolder(pHolder);
 
 		// did we come to the end of the list?
 		if(!pNext)
@@ -519,7 +597,34 @@ void CSnapshotStorage::Add(int Tick, int64_t Tagtime, int DataSize, void *pData,
 		TotalSize += AltDataSize;
 	}
 
-	CHolder *pHolder = (CHolder *)malloc(TotalSize);
+	// reuse a purged holder if one is large enough
+	CHolder *pHolder = 0;
+	for(CHolder **ppFree = &m_pFree; *ppFree; ppFree = &(*ppFree)->m_pNext)
+	{
+		if((*ppFree)->m_Capacity >= TotalSize)
+		{
+			pHolder = *ppFree;
+			*ppFree = pHolder->m_pNext;
+			m_NumFree--;
+			break;
+		}
+	}
+	if(!pHolder)
+	{
+		// the purged holders are too small for the snapshots now, drop one
+		if(m_pFree)
+		{
+			CHolder *pNext = m_pFree->m_pNext;
+			CAllocCounter::Free(m_pFree);
+			m_pFree = pNext;
+			m_NumFree--;
+		}
+
+		// leave some room for the following snapshots to grow
+		const int Capacity = TotalSize + TotalSize / 8;
+		pHolder = (CHolder *)CAllocCounter::Malloc(Capacity);
+		pHolder->m_Capacity = Capacity;
+	}
 
 	// set data
 	pHolder->m_Tick = Tick;
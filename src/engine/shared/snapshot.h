@@ -98,7 +98,11 @@ public:
 	int GetDataUpdates(int Index) const { return m_aSnapshotDataUpdates[Index]; }
 	void SetStaticsize(int ItemType, int Size);
 	const CData *EmptyDelta() const;
-	int CreateDelta(class CSnapshot *pFrom, class CSnapshot *pTo, void *pDstData);
+	// pfnItemSize is called for every deleted and updated item with the
+	// external item type and the number of bytes the item takes in the delta
+	// after CVariableInt compression
+	typedef void (*FItemSizeCallback)(int Type, int Bytes, void *pUser);
+	int CreateDelta(class CSnapshot *pFrom, class CSnapshot *pTo, void *pDstData, FItemSizeCallback pfnItemSize = nullptr, void *pUser = nullptr);
 	int UnpackDelta(class CSnapshot *pFrom, class CSnapshot *pTo, const void *pSrcData, int DataSize);
 };
 
@@ -121,11 +125,26 @@ public:
 
 		CSnapshot *m_pSnap;
 		CSnapshot *m_pAltSnap;
+
+		// size of the allocation including the holder
+		int m_Capacity;
+	};
+
+	enum
+	{
+		MAX_FREE_HOLDERS = 8,
 	};
 
 	CHolder *m_pFirst;
 	CHolder *m_pLast;
 
+	// purged holders, reused by Add() instead of allocating a new one for
+	// every snapshot
+	CHolder *m_pFree;
+	int m_NumFree;
+
+	void FreeHolder(CHolder *pHolder);
+
 	CSnapshotStorage() { Init(); }
 	~CSnapshotStorage() { PurgeAll(); }
 	void Init();
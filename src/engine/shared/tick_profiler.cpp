@@ -0,0 +1,213 @@
+#include "tick_profiler.h"
+
+#include "alloc_counter.h"
+#include "jsonwriter.h"
+
+#include <base/math.h>
+
+#include <algorithm>
+
+static const char *const gs_apPhaseNames[CTickProfiler::NUM_PHASES + 1] = {
+	"network",
+	"game_tick",
+	"world_projectile",
+	"world_laser",
+	"world_pickup",
+	"world_flag",
+	"world_character",
+	"snap_build",
+	"snap_delta",
+	"snap_send",
+	"score",
+	"teehistorian",
+	"demo",
+	"total",
+};
+
+CTickProfiler::CTickProfiler()
+{
+	m_Enabled = false;
+	Reset();
+}
+
+void CTickProfiler::Reset()
+{
+	ResetHistory();
+	m_TraceTicksLeft = 0;
+	m_TraceStart = 0;
+	m_vTraceEvents.clear();
+}
+
+void CTickProfiler::ResetHistory()
+{
+	m_Tick = 0;
+	m_LoopStart = 0;
+	mem_zero(m_aCurrent, sizeof(m_aCurrent));
+	mem_zero(m_aaHistory, sizeof(m_aaHistory));
+	m_LoopStartAllocations = 0;
+	m_CurrentAllocations = 0;
+	mem_zero(m_aAllocationHistory, sizeof(m_aAllocationHistory));
+	m_HistoryPos = 0;
+	m_HistoryNum = 0;
+}
+
+void CTickProfiler::SetEnabled(bool Enabled)
+{
+	if(m_Enabled == Enabled)
+		return;
+	m_Enabled = Enabled;
+	// disabling only stops the sampling, the history and a trace that is
+	// being recorded are kept until they are printed or written
+	if(m_Enabled)
+		ResetHistory();
+}
+
+void CTickProfiler::BeginLoop(int Tick)
+{
+	if(!Enabled())
+		return;
+	m_Tick = Tick;
+	m_LoopStart = time_get_nanoseconds().count();
+	m_LoopStartAllocations = CAllocCounter::ThreadAllocations();
+}
+
+void CTickProfiler::EndLoop(bool NewTicks)
+{
+	if(!Enabled() || m_LoopStart == 0)
+		return;
+
+	int64_t Duration = time_get_nanoseconds().count() - m_LoopStart;
+	m_aCurrent[NUM_PHASES] += Duration;
+	m_CurrentAllocations += CAllocCounter::ThreadAllocations() - m_LoopStartAllocations;
+	if(TraceRunning())
+		Add(NUM_PHASES, m_LoopStart, Duration);
+	m_LoopStart = 0;
+
+	if(!NewTicks)
+		return;
+
+	for(int i = 0; i <= NUM_PHASES; i++)
+		m_aaHistory[i][m_HistoryPos] = m_aCurrent[i];
+	m_aAllocationHistory[m_HistoryPos] = m_CurrentAllocations;
+	m_CurrentAllocations = 0;
+	m_HistoryPos = (m_HistoryPos + 1) % HISTORY_SIZE;
+	m_HistoryNum = minimum(m_HistoryNum + 1, (int)HISTORY_SIZE);
+	mem_zero(m_aCurrent, sizeof(m_aCurrent));
+
+	if(TraceRunning())
+		m_TraceTicksLeft--;
+}
+
+void CTickProfiler::Add(int Phase, int64_t Start, int64_t Duration)
+{
+	if(Phase < NUM_PHASES)
+		m_aCurrent[Phase] += Duration;
+
+	if(TraceRunning() && m_vTraceEvents.size() < MAX_TRACE_EVENTS)
+		m_vTraceEvents.push_back({Phase, m_Tick, Start, Duration});
+}
+
+const char *CTickProfiler::PhaseName(int Phase)
+{
+	if(Phase < 0 || Phase > NUM_PHASES)
+		return "unknown";
+	return gs_apPhaseNames[Phase];
+}
+
+int CTickProfiler::PhaseByName(const char *pName)
+{
+	for(int i = 0; i <= NUM_PHASES; i++)
+		if(str_comp_nocase(gs_apPhaseNames[i], pName) == 0)
+			return i;
+	return -1;
+}
+
+void CTickProfiler::Stats(const int64_t *pHistory, CStats *pStats) const
+{
+	int64_t aSorted[HISTORY_SIZE];
+	int64_t Sum = 0;
+	for(int i = 0; i < m_HistoryNum; i++)
+	{
+		aSorted[i] = pHistory[i];
+		Sum += pHistory[i];
+	}
+	std::sort(aSorted, aSorted + m_HistoryNum);
+
+	pStats->m_NumSamples = m_HistoryNum;
+	if(m_HistoryNum == 0)
+	{
+		pStats->m_Avg = pStats->m_P50 = pStats->m_P95 = pStats->m_Max = 0;
+		return;
+	}
+	pStats->m_Avg = Sum / m_HistoryNum;
+	pStats->m_P50 = aSorted[(m_HistoryNum - 1) * 50 / 100];
+	pStats->m_P95 = aSorted[(m_HistoryNum - 1) * 95 / 100];
+	pStats->m_Max = aSorted[m_HistoryNum - 1];
+}
+
+void CTickProfiler::GetStats(int Phase, CStats *pStats) const
+{
+	dbg_assert(Phase >= 0 && Phase <= NUM_PHASES, "invalid profiler phase");
+	Stats(m_aaHistory[Phase], pStats);
+}
+
+void CTickProfiler::GetAllocationStats(CStats *pStats) const
+{
+	Stats(m_aAllocationHistory, pStats);
+}
+
+void CTickProfiler::GetHistogram(int Phase, int *pBuckets) const
+{
+	dbg_assert(Phase >= 0 && Phase <= NUM_PHASES, "invalid profiler phase");
+	for(int i = 0; i < NUM_HISTOGRAM_BUCKETS; i++)
+		pBuckets[i] = 0;
+	for(int i = 0; i < m_HistoryNum; i++)
+	{
+		int Bucket = 0;
+		while(Bucket < NUM_HISTOGRAM_BUCKETS - 1 && m_aaHistory[Phase][i] >= (int64_t)16000 << Bucket)
+			Bucket++;
+		pBuckets[Bucket]++;
+	}
+}
+
+void CTickProfiler::StartTrace(int NumTicks)
+{
+	m_vTraceEvents.clear();
+	m_TraceTicksLeft = NumTicks;
+	m_TraceStart = time_get_nanoseconds().count();
+}
+
+void CTickProfiler::WriteTrace(CJsonWriter *pWriter)
+{
+	pWriter->BeginObject();
+	pWriter->WriteAttribute("displayTimeUnit");
+	pWriter->WriteStrValue("ms");
+	pWriter->WriteAttribute("traceEvents");
+	pWriter->BeginArray();
+	for(const CTraceEvent &Event : m_vTraceEvents)
+	{
+		pWriter->BeginObject();
+		pWriter->WriteAttribute("name");
+		pWriter->WriteStrValue(PhaseName(Event.m_Phase));
+		pWriter->WriteAttribute("ph");
+		pWriter->WriteStrValue("X");
+		pWriter->WriteAttribute("pid");
+		pWriter->WriteIntValue(0);
+		pWriter->WriteAttribute("tid");
+		pWriter->WriteIntValue(0);
+		pWriter->WriteAttribute("ts");
+		pWriter->WriteIntValue((Event.m_Start - m_TraceStart) / 1000);
+		pWriter->WriteAttribute("dur");
+		pWriter->WriteIntValue(Event.m_Duration / 1000);
+		pWriter->WriteAttribute("args");
+		pWriter->BeginObject();
+		pWriter->WriteAttribute("tick");
+		pWriter->WriteIntValue(Event.m_Tick);
+		pWriter->EndObject();
+		pWriter->EndObject();
+	}
+	pWriter->EndArray();
+	pWriter->EndObject();
+
+	m_vTraceEvents.clear();
+}
@@ -0,0 +1,147 @@
+#ifndef ENGINE_SHARED_TICK_PROFILER_H
+#define ENGINE_SHARED_TICK_PROFILER_H
+
+#include <base/system.h>
+
+#include <cstdint>
+#include <vector>
+
+class CJsonWriter;
+
+/**
+ * Collects the time spent in the phases of the server tick.
+ *
+ * The server main loop is wrapped in BeginLoop()/EndLoop(). Every phase
+ * accumulates its time until a loop iteration that ran at least one tick
+ * ends, which moves the accumulated values into a rolling history of the last
+ * HISTORY_SIZE ticks. Iterations that only handled network traffic are added
+ * to the following tick. The total is the busy time of the main loop, waiting
+ * for packets is not included. Phases may be nested (e.g. the world passes
+ * are part of the game tick), so the per-phase times don't add up to the
+ * total. In debug builds the heap allocations of the main loop are recorded
+ * per tick as well.
+ */
+class CTickProfiler
+{
+public:
+	enum EPhase
+	{
+		PHASE_NETWORK = 0,
+		PHASE_GAME_TICK,
+		PHASE_WORLD_PROJECTILE,
+		PHASE_WORLD_LASER,
+		PHASE_WORLD_PICKUP,
+		PHASE_WORLD_FLAG,
+		PHASE_WORLD_CHARACTER,
+		PHASE_SNAP_BUILD,
+		PHASE_SNAP_DELTA,
+		PHASE_SNAP_SEND,
+		PHASE_SCORE,
+		PHASE_TEEHISTORIAN,
+		PHASE_DEMO,
+		NUM_PHASES,
+	};
+
+	enum
+	{
+		HISTORY_SIZE = 50 * 10,
+		NUM_HISTOGRAM_BUCKETS = 12,
+		MAX_TRACE_EVENTS = 1024 * 1024,
+	};
+
+	class CStats
+	{
+	public:
+		int64_t m_Avg;
+		int64_t m_P50;
+		int64_t m_P95;
+		int64_t m_Max;
+		int m_NumSamples;
+	};
+
+private:
+	class CTraceEvent
+	{
+	public:
+		int m_Phase;
+		int m_Tick;
+		int64_t m_Start;
+		int64_t m_Duration;
+	};
+
+	bool m_Enabled;
+	int m_Tick;
+	int64_t m_LoopStart;
+	int64_t m_aCurrent[NUM_PHASES + 1];
+
+	// index NUM_PHASES holds the total tick time
+	int64_t m_aaHistory[NUM_PHASES + 1][HISTORY_SIZE];
+	int64_t m_LoopStartAllocations;
+	int64_t m_CurrentAllocations;
+	int64_t m_aAllocationHistory[HISTORY_SIZE];
+	int m_HistoryPos;
+	int m_HistoryNum;
+
+	int m_TraceTicksLeft;
+	int64_t m_TraceStart;
+	std::vector<CTraceEvent> m_vTraceEvents;
+
+	void Stats(const int64_t *pHistory, CStats *pStats) const;
+	void ResetHistory();
+
+public:
+	CTickProfiler();
+
+	void Reset();
+	void SetEnabled(bool Enabled);
+	bool Enabled() const { return m_Enabled || m_TraceTicksLeft > 0; }
+
+	void BeginLoop(int Tick);
+	void EndLoop(bool NewTicks);
+
+	void Add(int Phase, int64_t Start, int64_t Duration);
+
+	static const char *PhaseName(int Phase);
+	// returns -1 for unknown phase names, "total" is NUM_PHASES
+	static int PhaseByName(const char *pName);
+
+	// times are in nanoseconds, Phase == NUM_PHASES gives the total tick time
+	int HistorySize() const { return m_HistoryNum; }
+	void GetStats(int Phase, CStats *pStats) const;
+	// bucket i counts the ticks that took less than 2^i * 16 microseconds,
+	// the last bucket contains all remaining ticks
+	void GetHistogram(int Phase, int *pBuckets) const;
+	// number of heap allocations per tick, see CAllocCounter
+	void GetAllocationStats(CStats *pStats) const;
+
+	void StartTrace(int NumTicks);
+	bool TraceRunning() const { return m_TraceTicksLeft > 0; }
+	bool TraceFinished() const { return m_TraceTicksLeft == 0 && !m_vTraceEvents.empty(); }
+	// writes the recorded trace in the Chrome trace event format and discards it
+	void WriteTrace(CJsonWriter *pWriter);
+};
+
+class CTickProfileScope
+{
+	CTickProfiler *m_pProfiler;
+	int m_Phase;
+	int64_t m_Start;
+
+public:
+	CTickProfileScope(CTickProfiler *pProfiler, int Phase) :
+		m_pProfiler(pProfiler->Enabled() ? pProfiler : nullptr), m_Phase(Phase)
+	{
+		m_Start = m_pProfiler ? time_get_nanoseconds().count() : 0;
+	}
+	~CTickProfileScope() { End(); }
+
+	// ends the measurement before the scope is left
+	void End()
+	{
+		if(m_pProfiler)
+			m_pProfiler->Add(m_Phase, m_Start, time_get_nanoseconds().count() - m_Start);
+		m_pProfiler = nullptr;
+	}
+};
+
+#endif
@@ -250,6 +250,13 @@ struct STextSizeProperties
 	int *m_pLineCount = nullptr;
 };
 
+struct STextLayoutCacheStats
+{
+	int64_t m_Hits = 0;
+	int64_t m_Misses = 0;
+	int m_Entries = 0;
+};
+
 class ITextRender : public IInterface
 {
 	MACRO_INTERFACE("textrender", 0)
@@ -261,6 +268,8 @@ public:
 	virtual void LoadFonts() = 0;
 	virtual void SetFontPreset(EFontPreset FontPreset) = 0;
 	virtual void SetFontLanguageVariant(const char *pLanguageFile) = 0;
+	// rasterises the glyphs of the text in the background, for the font sizes that are in use
+	virtual void PrewarmText(const char *pText) = 0;
 
 	virtual void SetRenderFlags(unsigned Flags) = 0;
 	virtual unsigned GetRenderFlags() const = 0;
@@ -307,6 +316,9 @@ public:
 	virtual ColorRGBA GetTextOutlineColor() const = 0;
 	virtual ColorRGBA GetTextSelectionColor() const = 0;
 
+	// layouts of TextEx that are reused while the text, cursor and screen mapping do not change
+	virtual STextLayoutCacheStats TextLayoutCacheStats() const = 0;
+
 	virtual void OnPreWindowResize() = 0;
 	virtual void OnWindowResize() = 0;
 };
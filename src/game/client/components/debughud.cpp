@@ -251,9 +251,58 @@ void CDebugHud::RenderHint()
 	TextRender()->Text(Spacing, Height - FontSize - Spacing, FontSize, Localize("Debug mode enabled. Press Ctrl+Shift+D to disable debug mode."));
 }
 
+void CDebugHud::RenderTextLayoutCache()
+{
+	if(!g_Config.m_Debug)
+		return;
+
+	const float Height = 300.0f;
+	const float Width = Height * Graphics()->ScreenAspect();
+	Graphics()->MapScreen(0.0f, 0.0f, Width, Height);
+
+	const float FontSize = 5.0f;
+	const float Spacing = 5.0f;
+
+	const STextLayoutCacheStats Stats = TextRender()->TextLayoutCacheStats();
+	const int64_t Hits = Stats.m_Hits - m_LastTextLayoutCacheStats.m_Hits;
+	const int64_t Misses = Stats.m_Misses - m_LastTextLayoutCacheStats.m_Misses;
+	m_LastTextLayoutCacheStats = Stats;
+
+	// counted before this text is rendered, so it does not count itself
+	char aBuf[128];
+	str_format(aBuf, sizeof(aBuf), "Text layout cache: %d entries, %d hits, %d misses (%.1f%% hit rate)", Stats.m_Entries, (int)Hits, (int)Misses, Hits + Misses > 0 ? Hits * 100.0f / (Hits + Misses) : 0.0f);
+	TextRender()->TextColor(TextRender()->DefaultTextColor());
+	TextRender()->Text(Spacing, Height - 2 * (FontSize + Spacing), FontSize, aBuf);
+}
+
+void CDebugHud::RenderDrawCalls()
+{
+	if(!g_Config.m_Debug)
+		return;
+
+	const float Height = 300.0f;
+	const float Width = Height * Graphics()->ScreenAspect();
+	Graphics()->MapScreen(0.0f, 0.0f, Width, Height);
+
+	const float FontSize = 5.0f;
+	const float Spacing = 5.0f;
+
+	const SDrawCallStats Stats = Graphics()->DrawCallStats();
+	const int64_t Submitted = Stats.m_Submitted - m_LastDrawCallStats.m_Submitted;
+	const int64_t Drawn = Stats.m_Drawn - m_LastDrawCallStats.m_Drawn;
+	m_LastDrawCallStats = Stats;
+
+	char aBuf[128];
+	str_format(aBuf, sizeof(aBuf), "Streamed draws: %d submitted, %d after batching", (int)Submitted, (int)Drawn);
+	TextRender()->TextColor(TextRender()->DefaultTextColor());
+	TextRender()->Text(Spacing, Height - 3 * (FontSize + Spacing), FontSize, aBuf);
+}
+
 void CDebugHud::OnRender()
 {
 	RenderTuning();
 	RenderNetCorrections();
+	RenderTextLayoutCache();
+	RenderDrawCalls();
 	RenderHint();
 }
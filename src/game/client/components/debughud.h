@@ -11,6 +11,9 @@ class CDebugHud : public CComponent
 	void RenderNetCorrections();
 	void RenderTuning();
 	void RenderHint();
+	// hits and misses since the last frame
+	void RenderTextLayoutCache();
+	void RenderDrawCalls();
 
 	CGraph m_RampGraph;
 	CGraph m_ZoomedInGraph;
@@ -20,6 +23,9 @@ class CDebugHud : public CComponent
 	float m_OldVelrampRange;
 	float m_OldVelrampCurvature;
 
+	STextLayoutCacheStats m_LastTextLayoutCacheStats;
+	SDrawCallStats m_LastDrawCallStats;
+
 public:
 	virtual int Sizeof() const override { return sizeof(*this); }
 	virtual void OnRender() override;
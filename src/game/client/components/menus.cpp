@@ -1923,6 +1923,7 @@ void CMenus::OnReset()
 void CMenus::OnShutdown()
 {
 	KillServer();
+	StopDemoScan();
 }
 
 bool CMenus::OnCursorMove(float x, float y, IInput::ECursorType CursorType)
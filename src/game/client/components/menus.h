@@ -7,6 +7,7 @@
 #include <base/vmath.h>
 
 #include <chrono>
+#include <memory>
 #include <unordered_set>
 #include <vector>
 
@@ -252,6 +253,7 @@ protected:
 		SORT_MARKERS,
 		SORT_LENGTH,
 		SORT_DATE,
+		SORT_MAP,
 	};
 
 	struct CDemoItem
@@ -262,6 +264,9 @@ protected:
 		bool m_IsLink;
 		int m_StorageType;
 		time_t m_Date;
+		int64_t m_Size = 0;
+		// index into the demos of the current scan job, -1 if not scanned
+		int m_ScanIndex = -1;
 
 		bool m_InfosLoaded;
 		bool m_Valid;
@@ -312,6 +317,8 @@ protected:
 				return Left.NumMarkers() < Right.NumMarkers();
 			if(g_Config.m_BrDemoSort == SORT_LENGTH)
 				return Left.Length() < Right.Length();
+			if(g_Config.m_BrDemoSort == SORT_MAP)
+				return str_comp_nocase(Left.m_Info.m_aMapName, Right.m_Info.m_aMapName) < 0;
 
 			// Unknown sort
 			return true;
@@ -338,6 +345,14 @@ protected:
 	void DemolistOnUpdate(bool Reset);
 	static int DemolistFetchCallback(const CFsFileInfo *pInfo, int IsDir, int StorageType, void *pUser);
 
+	// the demo infos are read from the index by a job
+	std::shared_ptr<class CDemoIndex> m_pDemoIndex;
+	std::shared_ptr<class CDemoScanJob> m_pDemoScanJob;
+	int m_NumDemosScanned = 0;
+	void StartDemoScan();
+	void StopDemoScan();
+	void UpdateDemoScan();
+
 	// friends
 	class CFriendItem
 	{
@@ -429,7 +444,6 @@ protected:
 	float m_LastSpeedChange = -1.0f;
 	static bool DemoFilterChat(const void *pData, int Size, void *pUser);
 	bool FetchHeader(CDemoItem &Item);
-	void FetchAllHeaders();
 	void HandleDemoSeeking(float PositionToSeek, float TimeToSeek);
 	void RenderDemoPlayer(CUIRect MainView);
 	void RenderDemoPlayerSliceSavePopup(CUIRect MainView);
@@ -5,6 +5,7 @@
 #include <base/math.h>
 #include <base/system.h>
 
+#include <engine/client/demoindex.h>
 #include <engine/demo.h>
 #include <engine/graphics.h>
 #include <engine/keys.h>
@@ -908,6 +909,7 @@ int CMenus::DemolistFetchCallback(const CFsFileInfo *pInfo, int IsDir, int Stora
 		str_truncate(Item.m_aName, sizeof(Item.m_aName), pInfo->m_pName, str_length(pInfo->m_pName) - str_length(".demo"));
 		Item.m_InfosLoaded = false;
 		Item.m_Date = pInfo->m_TimeModified;
+		Item.m_Size = pInfo->m_Size;
 	}
 	Item.m_IsDir = IsDir != 0;
 	Item.m_IsLink = false;
@@ -924,6 +926,7 @@ int CMenus::DemolistFetchCallback(const CFsFileInfo *pInfo, int IsDir, int Stora
 
 void CMenus::DemolistPopulate()
 {
+	StopDemoScan();
 	m_vDemos.clear();
 
 	int NumStoragesWithDemos = 0;
@@ -974,20 +977,91 @@ void CMenus::DemolistPopulate()
 		m_DemoPopulateStartTime = time_get_nanoseconds();
 		Storage()->ListDirectoryInfo(m_DemolistStorageType, m_aCurrentDemoFolder, DemolistFetchCallback, this);
 
-		if(g_Config.m_BrDemoFetchInfo)
-			FetchAllHeaders();
-
 		std::stable_sort(m_vDemos.begin(), m_vDemos.end());
+		StartDemoScan();
 	}
 	RefreshFilteredDemos();
 }
 
+void CMenus::StartDemoScan()
+{
+	if(!m_pDemoIndex)
+		m_pDemoIndex = std::make_shared<CDemoIndex>(Console(), Storage());
+
+	std::vector<CDemoScanJob::CDemo> vDemos;
+	for(auto &Item : m_vDemos)
+	{
+		if(Item.m_IsDir)
+			continue;
+		Item.m_ScanIndex = vDemos.size();
+		CDemoScanJob::CDemo &Demo = vDemos.emplace_back();
+		str_format(Demo.m_aFilename, sizeof(Demo.m_aFilename), "%s/%s", m_aCurrentDemoFolder, Item.m_aFilename);
+		Demo.m_StorageType = Item.m_StorageType;
+		Demo.m_Entry.m_Size = Item.m_Size;
+		Demo.m_Entry.m_Date = Item.m_Date;
+	}
+	if(vDemos.empty())
+		return;
+
+	// only cached infos are loaded unless fetching them is enabled
+	m_NumDemosScanned = 0;
+	m_pDemoScanJob = std::make_shared<CDemoScanJob>(m_pDemoIndex, Storage(), DemoPlayer(), std::move(vDemos), g_Config.m_BrDemoFetchInfo);
+	Engine()->AddJob(m_pDemoScanJob);
+}
+
+void CMenus::StopDemoScan()
+{
+	if(!m_pDemoScanJob)
+		return;
+	m_pDemoScanJob->Abort();
+	m_pDemoScanJob = nullptr;
+	for(auto &Item : m_vDemos)
+		Item.m_ScanIndex = -1;
+}
+
+void CMenus::UpdateDemoScan()
+{
+	if(!m_pDemoScanJob)
+		return;
+
+	// the job is done after it published its last demo
+	const bool Done = m_pDemoScanJob->Status() == IJob::STATE_DONE;
+	const int NumDone = m_pDemoScanJob->NumDone();
+	if(NumDone > m_NumDemosScanned)
+	{
+		for(auto &Item : m_vDemos)
+		{
+			if(Item.m_ScanIndex < m_NumDemosScanned || Item.m_ScanIndex >= NumDone || Item.m_InfosLoaded)
+				continue;
+			const CDemoScanJob::CDemo &Demo = m_pDemoScanJob->Demo(Item.m_ScanIndex);
+			if(!Demo.m_InfosLoaded)
+				continue;
+			Item.m_Valid = Demo.m_Entry.m_Valid;
+			Item.m_Info = Demo.m_Entry.m_Info;
+			Item.m_TimelineMarkers = Demo.m_Entry.m_TimelineMarkers;
+			Item.m_MapInfo = Demo.m_Entry.m_MapInfo;
+			Item.m_InfosLoaded = true;
+		}
+		m_NumDemosScanned = NumDone;
+	}
+
+	if(Done)
+	{
+		StopDemoScan();
+		// sort and filter by the complete infos
+		if(g_Config.m_BrDemoSort != SORT_DEMONAME && g_Config.m_BrDemoSort != SORT_DATE)
+			std::stable_sort(m_vDemos.begin(), m_vDemos.end());
+		DemolistOnUpdate(false);
+	}
+}
+
 void CMenus::RefreshFilteredDemos()
 {
 	m_vpFilteredDemos.clear();
 	for(auto &Demo : m_vDemos)
 	{
-		if(str_find_nocase(Demo.m_aFilename, m_DemoSearchInput.GetString()))
+		if(str_find_nocase(Demo.m_aFilename, m_DemoSearchInput.GetString()) ||
+			(Demo.m_InfosLoaded && Demo.m_Valid && str_find_nocase(Demo.m_Info.m_aMapName, m_DemoSearchInput.GetString())))
 		{
 			m_vpFilteredDemos.push_back(&Demo);
 		}
@@ -1037,15 +1111,6 @@ bool CMenus::FetchHeader(CDemoItem &Item)
 	return Item.m_Valid;
 }
 
-void CMenus::FetchAllHeaders()
-{
-	for(auto &Item : m_vDemos)
-	{
-		FetchHeader(Item);
-	}
-	std::stable_sort(m_vDemos.begin(), m_vDemos.end());
-}
-
 void CMenus::RenderDemoList(CUIRect MainView)
 {
 	static int s_Inited = 0;
@@ -1055,6 +1120,7 @@ void CMenus::RenderDemoList(CUIRect MainView)
 		DemolistOnUpdate(true);
 		s_Inited = 1;
 	}
+	UpdateDemoScan();
 
 	char aFooterLabel[128] = {0};
 	if(m_DemolistSelectedIndex >= 0)
@@ -1212,6 +1278,7 @@ void CMenus::RenderDemoList(CUIRect MainView)
 	{
 		COL_ICON = 0,
 		COL_DEMONAME,
+		COL_MAP,
 		COL_MARKERS,
 		COL_LENGTH,
 		COL_DATE,
@@ -1224,6 +1291,8 @@ void CMenus::RenderDemoList(CUIRect MainView)
 		{-1, -1, "", -1, 2.0f, {0}},
 		{COL_DEMONAME, SORT_DEMONAME, Localizable("Demo"), 0, 0.0f, {0}},
 		{-1, -1, "", 1, 2.0f, {0}},
+		{COL_MAP, SORT_MAP, Localizable("Map"), 1, 120.0f, {0}},
+		{-1, -1, "", 1, 2.0f, {0}},
 		{COL_MARKERS, SORT_MARKERS, Localizable("Markers"), 1, 75.0f, {0}},
 		{-1, -1, "", 1, 2.0f, {0}},
 		{COL_LENGTH, SORT_LENGTH, Localizable("Length"), 1, 75.0f, {0}},
@@ -1338,6 +1407,14 @@ void CMenus::RenderDemoList(CUIRect MainView)
 				Props.m_EnableWidthCheck = false;
 				UI()->DoLabel(&Button, Item->m_aName, 12.0f, TEXTALIGN_ML, Props);
 			}
+			else if(ID == COL_MAP && !Item->m_IsDir && Item->m_InfosLoaded && Item->m_Valid)
+			{
+				SLabelProperties Props;
+				Props.m_MaxWidth = Button.w;
+				Props.m_EllipsisAtEnd = true;
+				Props.m_EnableWidthCheck = false;
+				UI()->DoLabel(&Button, Item->m_Info.m_aMapName, 12.0f, TEXTALIGN_ML, Props);
+			}
 			else if(ID == COL_MARKERS && !Item->m_IsDir && Item->m_InfosLoaded && Item->m_Valid)
 			{
 				char aBuf[3];
@@ -1382,7 +1459,10 @@ void CMenus::RenderDemoList(CUIRect MainView)
 	{
 		g_Config.m_BrDemoFetchInfo ^= 1;
 		if(g_Config.m_BrDemoFetchInfo)
-			FetchAllHeaders();
+		{
+			StopDemoScan();
+			StartDemoScan();
+		}
 	}
 
 	static CButtonContainer s_PlayButton;
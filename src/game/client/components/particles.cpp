@@ -10,6 +10,186 @@
 
 #include <game/client/gameclient.h>
 
+#if defined(CONF_ARCH_IA32) || defined(CONF_ARCH_AMD64)
+#include <emmintrin.h>
+#define PARTICLES_SIMD
+typedef __m128 CFloat4;
+static inline CFloat4 Load4(const float *pData) { return _mm_loadu_ps(pData); }
+static inline void Store4(float *pData, CFloat4 Value) { _mm_storeu_ps(pData, Value); }
+static inline CFloat4 Splat4(float Value) { return _mm_set1_ps(Value); }
+static inline CFloat4 Add4(CFloat4 a, CFloat4 b) { return _mm_add_ps(a, b); }
+static inline CFloat4 Mul4(CFloat4 a, CFloat4 b) { return _mm_mul_ps(a, b); }
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PARTICLES_SIMD
+typedef float32x4_t CFloat4;
+static inline CFloat4 Load4(const float *pData) { return vld1q_f32(pData); }
+static inline void Store4(float *pData, CFloat4 Value) { vst1q_f32(pData, Value); }
+static inline CFloat4 Splat4(float Value) { return vdupq_n_f32(Value); }
+static inline CFloat4 Add4(CFloat4 a, CFloat4 b) { return vaddq_f32(a, b); }
+static inline CFloat4 Mul4(CFloat4 a, CFloat4 b) { return vmulq_f32(a, b); }
+#endif
+
+// applies gravity and friction, then turns the velocity into the movement of this update
+static void IntegrateVelocity(float *pVelX, float *pVelY, const float *pGravity, const float *pFriction, size_t Num, float TimePassed, int FrictionCount)
+{
+	size_t i = 0;
+#if defined(PARTICLES_SIMD)
+	const CFloat4 Time = Splat4(TimePassed);
+	for(; i + 4 <= Num; i += 4)
+	{
+		CFloat4 VelX = Load4(pVelX + i);
+		CFloat4 VelY = Add4(Load4(pVelY + i), Mul4(Load4(pGravity + i), Time));
+		const CFloat4 Friction = Load4(pFriction + i);
+		for(int f = 0; f < FrictionCount; f++)
+		{
+			VelX = Mul4(VelX, Friction);
+			VelY = Mul4(VelY, Friction);
+		}
+		Store4(pVelX + i, Mul4(VelX, Time));
+		Store4(pVelY + i, Mul4(VelY, Time));
+	}
+#endif
+	for(; i < Num; i++)
+	{
+		float VelX = pVelX[i];
+		float VelY = pVelY[i] + pGravity[i] * TimePassed;
+		for(int f = 0; f < FrictionCount; f++)
+		{
+			VelX *= pFriction[i];
+			VelY *= pFriction[i];
+		}
+		pVelX[i] = VelX * TimePassed;
+		pVelY[i] = VelY * TimePassed;
+	}
+}
+
+// moves the particles that don't collide and turns the movement back into the velocity
+static void IntegratePosition(float *pPosX, float *pPosY, float *pVelX, float *pVelY, const float *pFreeMove, size_t Num, float TimePassed)
+{
+	const float InvTime = 1.0f / TimePassed;
+	size_t i = 0;
+#if defined(PARTICLES_SIMD)
+	const CFloat4 Inv = Splat4(InvTime);
+	for(; i + 4 <= Num; i += 4)
+	{
+		const CFloat4 VelX = Load4(pVelX + i);
+		const CFloat4 VelY = Load4(pVelY + i);
+		const CFloat4 FreeMove = Load4(pFreeMove + i);
+		Store4(pPosX + i, Add4(Load4(pPosX + i), Mul4(VelX, FreeMove)));
+		Store4(pPosY + i, Add4(Load4(pPosY + i), Mul4(VelY, FreeMove)));
+		Store4(pVelX + i, Mul4(VelX, Inv));
+		Store4(pVelY + i, Mul4(VelY, Inv));
+	}
+#endif
+	for(; i < Num; i++)
+	{
+		pPosX[i] += pVelX[i] * pFreeMove[i];
+		pPosY[i] += pVelY[i] * pFreeMove[i];
+		pVelX[i] *= InvTime;
+		pVelY[i] *= InvTime;
+	}
+}
+
+static void IntegrateLife(float *pLife, float *pRot, const float *pRotspeed, size_t Num, float TimePassed)
+{
+	size_t i = 0;
+#if defined(PARTICLES_SIMD)
+	const CFloat4 Time = Splat4(TimePassed);
+	for(; i + 4 <= Num; i += 4)
+	{
+		Store4(pLife + i, Add4(Load4(pLife + i), Time));
+		Store4(pRot + i, Add4(Load4(pRot + i), Mul4(Time, Load4(pRotspeed + i))));
+	}
+#endif
+	for(; i < Num; i++)
+	{
+		pLife[i] += TimePassed;
+		pRot[i] += TimePassed * pRotspeed[i];
+	}
+}
+
+void CParticleStore::Add(const CParticle &Part, float Life)
+{
+	m_vPosX.push_back(Part.m_Pos.x);
+	m_vPosY.push_back(Part.m_Pos.y);
+	m_vVelX.push_back(Part.m_Vel.x);
+	m_vVelY.push_back(Part.m_Vel.y);
+	m_vRot.push_back(Part.m_Rot);
+	m_vRotspeed.push_back(Part.m_Rotspeed);
+	m_vLife.push_back(Life);
+	m_vLifeSpan.push_back(Part.m_LifeSpan);
+	m_vGravity.push_back(Part.m_Gravity);
+	m_vFriction.push_back(Part.m_Friction);
+	m_vStartSize.push_back(Part.m_StartSize);
+	m_vEndSize.push_back(Part.m_EndSize);
+	m_vStartAlpha.push_back(Part.m_UseAlphaFading ? Part.m_StartAlpha : Part.m_Color.a);
+	m_vEndAlpha.push_back(Part.m_UseAlphaFading ? Part.m_EndAlpha : Part.m_Color.a);
+	m_vColor.push_back(Part.m_Color);
+	m_vSpr.push_back(Part.m_Spr);
+	m_vFreeMove.push_back(Part.m_Collides ? 0.0f : 1.0f);
+}
+
+template<typename T>
+static void KeepAt(std::vector<T> &vValues, size_t To, size_t From)
+{
+	vValues[To] = vValues[From];
+}
+
+void CParticleStore::RemoveDead()
+{
+	const size_t Num = Size();
+	size_t Alive = 0;
+	for(size_t i = 0; i < Num; i++)
+	{
+		if(m_vLife[i] > m_vLifeSpan[i])
+			continue;
+		if(Alive != i)
+		{
+			KeepAt(m_vPosX, Alive, i);
+			KeepAt(m_vPosY, Alive, i);
+			KeepAt(m_vVelX, Alive, i);
+			KeepAt(m_vVelY, Alive, i);
+			KeepAt(m_vRot, Alive, i);
+			KeepAt(m_vRotspeed, Alive, i);
+			KeepAt(m_vLife, Alive, i);
+			KeepAt(m_vLifeSpan, Alive, i);
+			KeepAt(m_vGravity, Alive, i);
+			KeepAt(m_vFriction, Alive, i);
+			KeepAt(m_vStartSize, Alive, i);
+			KeepAt(m_vEndSize, Alive, i);
+			KeepAt(m_vStartAlpha, Alive, i);
+			KeepAt(m_vEndAlpha, Alive, i);
+			KeepAt(m_vColor, Alive, i);
+			KeepAt(m_vSpr, Alive, i);
+			KeepAt(m_vFreeMove, Alive, i);
+		}
+		Alive++;
+	}
+	Resize(Alive);
+}
+
+void CParticleStore::Resize(size_t Num)
+{
+	m_vPosX.resize(Num);
+	m_vPosY.resize(Num);
+	m_vVelX.resize(Num);
+	m_vVelY.resize(Num);
+	m_vRot.resize(Num);
+	m_vRotspeed.resize(Num);
+	m_vLife.resize(Num);
+	m_vLifeSpan.resize(Num);
+	m_vGravity.resize(Num);
+	m_vFriction.resize(Num);
+	m_vStartSize.resize(Num);
+	m_vEndSize.resize(Num);
+	m_vStartAlpha.resize(Num);
+	m_vEndAlpha.resize(Num);
+	m_vColor.resize(Num);
+	m_vSpr.resize(Num);
+	m_vFreeMove.resize(Num);
+}
+
 CParticles::CParticles()
 {
 	OnReset();
@@ -21,19 +201,16 @@ CParticles::CParticles()
 
 void CParticles::OnReset()
 {
-	// reset particles
-	for(int i = 0; i < MAX_PARTICLES; i++)
-	{
-		m_aParticles[i].m_PrevPart = i - 1;
-		m_aParticles[i].m_NextPart = i + 1;
-	}
-
-	m_aParticles[0].m_PrevPart = 0;
-	m_aParticles[MAX_PARTICLES - 1].m_NextPart = -1;
-	m_FirstFree = 0;
+	for(auto &Group : m_aGroups)
+		Group.Resize(0);
+}
 
-	for(int &FirstPart : m_aFirstPart)
-		FirstPart = -1;
+size_t CParticles::NumParticles() const
+{
+	size_t Num = 0;
+	for(const auto &Group : m_aGroups)
+		Num += Group.Size();
+	return Num;
 }
 
 void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
@@ -50,27 +227,10 @@ void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
 			return;
 	}
 
-	if(m_FirstFree == -1)
+	if(NumParticles() >= (size_t)g_Config.m_ClParticlesMax)
 		return;
 
-	// remove from the free list
-	int Id = m_FirstFree;
-	m_FirstFree = m_aParticles[Id].m_NextPart;
-	if(m_FirstFree != -1)
-		m_aParticles[m_FirstFree].m_PrevPart = -1;
-
-	// copy data
-	m_aParticles[Id] = *pPart;
-
-	// insert to the group list
-	m_aParticles[Id].m_PrevPart = -1;
-	m_aParticles[Id].m_NextPart = m_aFirstPart[Group];
-	if(m_aFirstPart[Group] != -1)
-		m_aParticles[m_aFirstPart[Group]].m_PrevPart = Id;
-	m_aFirstPart[Group] = Id;
-
-	// set some parameters
-	m_aParticles[Id].m_Life = TimePassed;
+	m_aGroups[Group].Add(*pPart, TimePassed);
 }
 
 void CParticles::Update(float TimePassed)
@@ -91,55 +251,32 @@ void CParticles::Update(float TimePassed)
 		FrictionFraction -= 0.05f;
 	}
 
-	for(int &FirstPart : m_aFirstPart)
+	for(auto &Group : m_aGroups)
 	{
-		int i = FirstPart;
-		while(i != -1)
-		{
-			int Next = m_aParticles[i].m_NextPart;
-			//m_aParticles[i].vel += flow_get(m_aParticles[i].pos)*time_passed * m_aParticles[i].flow_affected;
-			m_aParticles[i].m_Vel.y += m_aParticles[i].m_Gravity * TimePassed;
+		const size_t Num = Group.Size();
+		if(Num == 0)
+			continue;
 
-			for(int f = 0; f < FrictionCount; f++) // apply friction
-				m_aParticles[i].m_Vel *= m_aParticles[i].m_Friction;
+		IntegrateVelocity(Group.m_vVelX.data(), Group.m_vVelY.data(), Group.m_vGravity.data(), Group.m_vFriction.data(), Num, TimePassed, FrictionCount);
 
-			// move the point
-			vec2 Vel = m_aParticles[i].m_Vel * TimePassed;
-			if(m_aParticles[i].m_Collides)
-			{
-				Collision()->MovePoint(&m_aParticles[i].m_Pos, &Vel, random_float(0.1f, 1.0f), NULL);
-			}
-			else
-			{
-				m_aParticles[i].m_Pos += Vel;
-			}
-			m_aParticles[i].m_Vel = Vel * (1.0f / TimePassed);
-
-			m_aParticles[i].m_Life += TimePassed;
-			m_aParticles[i].m_Rot += TimePassed * m_aParticles[i].m_Rotspeed;
+		// the velocity is the movement of this update now
+		for(size_t i = 0; i < Num; i++)
+		{
+			if(Group.m_vFreeMove[i] != 0.0f)
+				continue;
+			vec2 Pos(Group.m_vPosX[i], Group.m_vPosY[i]);
+			vec2 Vel(Group.m_vVelX[i], Group.m_vVelY[i]);
+			Collision()->MovePoint(&Pos, &Vel, random_float(0.1f, 1.0f), NULL);
+			Group.m_vPosX[i] = Pos.x;
+			Group.m_vPosY[i] = Pos.y;
+			Group.m_vVelX[i] = Vel.x;
+			Group.m_vVelY[i] = Vel.y;
+		}
 
-			// check particle death
-			if(m_aParticles[i].m_Life > m_aParticles[i].m_LifeSpan)
-			{
-				// remove it from the group list
-				if(m_aParticles[i].m_PrevPart != -1)
-					m_aParticles[m_aParticles[i].m_PrevPart].m_NextPart = m_aParticles[i].m_NextPart;
-				else
-					FirstPart = m_aParticles[i].m_NextPart;
-
-				if(m_aParticles[i].m_NextPart != -1)
-					m_aParticles[m_aParticles[i].m_NextPart].m_PrevPart = m_aParticles[i].m_PrevPart;
-
-				// insert to the free list
-				if(m_FirstFree != -1)
-					m_aParticles[m_FirstFree].m_PrevPart = i;
-				m_aParticles[i].m_PrevPart = -1;
-				m_aParticles[i].m_NextPart = m_FirstFree;
-				m_FirstFree = i;
-			}
+		IntegratePosition(Group.m_vPosX.data(), Group.m_vPosY.data(), Group.m_vVelX.data(), Group.m_vVelY.data(), Group.m_vFreeMove.data(), Num, TimePassed);
+		IntegrateLife(Group.m_vLife.data(), Group.m_vRot.data(), Group.m_vRotspeed.data(), Num, TimePassed);
 
-			i = Next;
-		}
+		Group.RemoveDead();
 	}
 }
 
@@ -216,127 +353,90 @@ void CParticles::RenderGroup(int Group)
 		ParticleQuadContainerIndex = m_ExtraParticleQuadContainerIndex;
 	}
 
+	const CParticleStore &Store = m_aGroups[Group];
+	const size_t Num = Store.Size();
+
 	// don't use the buffer methods here, else the old renderer gets many draw calls
 	if(Graphics()->IsQuadContainerBufferingEnabled())
 	{
-		int i = m_aFirstPart[Group];
+		m_vRenderInfo.resize(Num);
 
-		static IGraphics::SRenderSpriteInfo s_aParticleRenderInfo[MAX_PARTICLES];
+		size_t CurParticleRenderCount = 0;
 
-		int CurParticleRenderCount = 0;
-
-		// batching makes sense for stuff like ninja particles
-		ColorRGBA LastColor;
+		// batching makes sense for stuff like ninja particles, colors are
+		// compared the way the graphics store them
+		unsigned LastColor = 0;
 		int LastQuadOffset = 0;
 
-		if(i != -1)
+		// newest particles first
+		for(size_t i = Num; i-- > 0;)
 		{
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
-			{
-				float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
-			}
-			LastColor.r = m_aParticles[i].m_Color.r;
-			LastColor.g = m_aParticles[i].m_Color.g;
-			LastColor.b = m_aParticles[i].m_Color.b;
-			LastColor.a = Alpha;
-
-			Graphics()->SetColor(
-				m_aParticles[i].m_Color.r,
-				m_aParticles[i].m_Color.g,
-				m_aParticles[i].m_Color.b,
-				Alpha);
-
-			LastQuadOffset = m_aParticles[i].m_Spr;
-		}
+			const float a = Store.m_vLife[i] / Store.m_vLifeSpan[i];
+			const vec2 p(Store.m_vPosX[i], Store.m_vPosY[i]);
+			const float Size = mix(Store.m_vStartSize[i], Store.m_vEndSize[i], a);
 
-		while(i != -1)
-		{
-			int QuadOffset = m_aParticles[i].m_Spr;
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
+			// the current position, respecting the size, is inside the viewport, render it, else ignore
+			if(!ParticleIsVisibleOnScreen(p, Size))
+				continue;
+
+			ColorRGBA Color = Store.m_vColor[i];
+			Color.a = mix(Store.m_vStartAlpha[i], Store.m_vEndAlpha[i], a);
+			const unsigned PackedColor = ColorRGBA(clamp(Color.r, 0.0f, 1.0f), clamp(Color.g, 0.0f, 1.0f), clamp(Color.b, 0.0f, 1.0f), clamp(Color.a, 0.0f, 1.0f)).Pack(true);
+			const int QuadOffset = Store.m_vSpr[i];
+
+			if(CurParticleRenderCount > 0 && (LastColor != PackedColor || LastQuadOffset != QuadOffset))
 			{
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
+				Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
+				Graphics()->RenderQuadContainerAsSpriteMultiple(ParticleQuadContainerIndex, LastQuadOffset - FirstParticleOffset, CurParticleRenderCount, m_vRenderInfo.data());
+				CurParticleRenderCount = 0;
 			}
 
-			// the current position, respecting the size, is inside the viewport, render it, else ignore
-			if(ParticleIsVisibleOnScreen(p, Size))
+			if(CurParticleRenderCount == 0)
 			{
-				if((size_t)CurParticleRenderCount == gs_GraphicsMaxParticlesRenderCount || LastColor.r != m_aParticles[i].m_Color.r || LastColor.g != m_aParticles[i].m_Color.g || LastColor.b != m_aParticles[i].m_Color.b || LastColor.a != Alpha || LastQuadOffset != QuadOffset)
-				{
-					Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
-					Graphics()->RenderQuadContainerAsSpriteMultiple(ParticleQuadContainerIndex, LastQuadOffset - FirstParticleOffset, CurParticleRenderCount, s_aParticleRenderInfo);
-					CurParticleRenderCount = 0;
-					LastQuadOffset = QuadOffset;
-
-					Graphics()->SetColor(
-						m_aParticles[i].m_Color.r,
-						m_aParticles[i].m_Color.g,
-						m_aParticles[i].m_Color.b,
-						Alpha);
-
-					LastColor.r = m_aParticles[i].m_Color.r;
-					LastColor.g = m_aParticles[i].m_Color.g;
-					LastColor.b = m_aParticles[i].m_Color.b;
-					LastColor.a = Alpha;
-				}
-
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[0] = p.x;
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[1] = p.y;
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Scale = Size;
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Rotation = m_aParticles[i].m_Rot;
-
-				++CurParticleRenderCount;
+				Graphics()->SetColor(Color);
+				LastColor = PackedColor;
+				LastQuadOffset = QuadOffset;
 			}
 
-			i = m_aParticles[i].m_NextPart;
+			IGraphics::SRenderSpriteInfo &RenderInfo = m_vRenderInfo[CurParticleRenderCount++];
+			RenderInfo.m_Pos[0] = p.x;
+			RenderInfo.m_Pos[1] = p.y;
+			RenderInfo.m_Scale = Size;
+			RenderInfo.m_Rotation = Store.m_vRot[i];
 		}
 
-		Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
-		Graphics()->RenderQuadContainerAsSpriteMultiple(ParticleQuadContainerIndex, LastQuadOffset - FirstParticleOffset, CurParticleRenderCount, s_aParticleRenderInfo);
+		if(CurParticleRenderCount > 0)
+		{
+			Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
+			Graphics()->RenderQuadContainerAsSpriteMultiple(ParticleQuadContainerIndex, LastQuadOffset - FirstParticleOffset, CurParticleRenderCount, m_vRenderInfo.data());
+		}
 	}
 	else
 	{
-		int i = m_aFirstPart[Group];
-
 		Graphics()->BlendNormal();
 		Graphics()->WrapClamp();
 
-		while(i != -1)
+		for(size_t i = Num; i-- > 0;)
 		{
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
-			{
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
-			}
+			const float a = Store.m_vLife[i] / Store.m_vLifeSpan[i];
+			const vec2 p(Store.m_vPosX[i], Store.m_vPosY[i]);
+			const float Size = mix(Store.m_vStartSize[i], Store.m_vEndSize[i], a);
 
 			// the current position, respecting the size, is inside the viewport, render it, else ignore
 			if(ParticleIsVisibleOnScreen(p, Size))
 			{
-				Graphics()->TextureSet(aParticles[m_aParticles[i].m_Spr - FirstParticleOffset]);
+				Graphics()->TextureSet(aParticles[Store.m_vSpr[i] - FirstParticleOffset]);
 				Graphics()->QuadsBegin();
 
-				Graphics()->QuadsSetRotation(m_aParticles[i].m_Rot);
+				Graphics()->QuadsSetRotation(Store.m_vRot[i]);
 
-				Graphics()->SetColor(
-					m_aParticles[i].m_Color.r,
-					m_aParticles[i].m_Color.g,
-					m_aParticles[i].m_Color.b,
-					Alpha);
+				const ColorRGBA &Color = Store.m_vColor[i];
+				Graphics()->SetColor(Color.r, Color.g, Color.b, mix(Store.m_vStartAlpha[i], Store.m_vEndAlpha[i], a));
 
 				IGraphics::CQuadItem QuadItem(p.x, p.y, Size, Size);
 				Graphics()->QuadsDraw(&QuadItem, 1);
 				Graphics()->QuadsEnd();
 			}
-
-			i = m_aParticles[i].m_NextPart;
 		}
 		Graphics()->WrapNormal();
 		Graphics()->BlendNormal();
@@ -2,9 +2,13 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #ifndef GAME_CLIENT_COMPONENTS_PARTICLES_H
 #define GAME_CLIENT_COMPONENTS_PARTICLES_H
+#include <base/color.h>
 #include <base/vmath.h>
+#include <engine/graphics.h>
 #include <game/client/component.h>
 
+#include <vector>
+
 // particles
 struct CParticle
 {
@@ -51,11 +55,43 @@ struct CParticle
 	ColorRGBA m_Color;
 
 	bool m_Collides;
+};
 
-	// set by the particle system
-	float m_Life;
-	int m_PrevPart;
-	int m_NextPart;
+/**
+ * Particles of one group as a structure of arrays, so the integration
+ * can process several particles at once.
+ *
+ * The particles are ordered by the time they were added, removing
+ * particles keeps the order.
+ */
+class CParticleStore
+{
+public:
+	std::vector<float> m_vPosX;
+	std::vector<float> m_vPosY;
+	std::vector<float> m_vVelX;
+	std::vector<float> m_vVelY;
+	std::vector<float> m_vRot;
+	std::vector<float> m_vRotspeed;
+	std::vector<float> m_vLife;
+	std::vector<float> m_vLifeSpan;
+	std::vector<float> m_vGravity;
+	std::vector<float> m_vFriction;
+	std::vector<float> m_vStartSize;
+	std::vector<float> m_vEndSize;
+	// equal to the alpha of the color if the particle does not fade
+	std::vector<float> m_vStartAlpha;
+	std::vector<float> m_vEndAlpha;
+	std::vector<ColorRGBA> m_vColor;
+	std::vector<int> m_vSpr;
+	// 1 for particles that move without collision, 0 for the others
+	std::vector<float> m_vFreeMove;
+
+	size_t Size() const { return m_vPosX.size(); }
+	void Add(const CParticle &Part, float Life);
+	// removes the particles whose life span is over
+	void RemoveDead();
+	void Resize(size_t Num);
 };
 
 class CParticles : public CComponent
@@ -81,18 +117,16 @@ public:
 	virtual void OnRender() override;
 	virtual void OnInit() override;
 
+	// total number of particles of all groups
+	size_t NumParticles() const;
+
 private:
 	int m_ParticleQuadContainerIndex;
 	int m_ExtraParticleQuadContainerIndex;
 
-	enum
-	{
-		MAX_PARTICLES = 1024 * 8,
-	};
-
-	CParticle m_aParticles[MAX_PARTICLES];
-	int m_FirstFree;
-	int m_aFirstPart[NUM_GROUPS];
+	CParticleStore m_aGroups[NUM_GROUPS];
+	// reused for rendering every group
+	std::vector<IGraphics::SRenderSpriteInfo> m_vRenderInfo;
 
 	void RenderGroup(int Group);
 	void Update(float TimePassed);
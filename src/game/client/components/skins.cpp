@@ -6,6 +6,7 @@
 #include <ctime>
 
 #include <engine/engine.h>
+#include <engine/gfx/image_loader.h>
 #include <engine/graphics.h>
 #include <engine/shared/config.h>
 #include <engine/storage.h>
@@ -13,10 +14,13 @@
 #include <game/generated/client_data.h>
 
 #include <game/client/gameclient.h>
+#include <game/client/skin_cache.h>
 #include <game/localization.h>
 
 #include "skins.h"
 
+using namespace std::chrono_literals;
+
 bool CSkins::IsVanillaSkin(const char *pName)
 {
 	return std::any_of(std::begin(VANILLA_SKINS), std::end(VANILLA_SKINS), [pName](const char *pVanillaSkin) { return str_comp(pName, pVanillaSkin) == 0; });
@@ -42,6 +46,141 @@ CSkins::CGetPngFile::CGetPngFile(CSkins *pSkins, const char *pUrl, IStorage *pSt
 	LogProgress(HTTPLOG::NONE);
 }
 
+CSkins::CSkinLoadJob::CSkinLoadJob(IStorage *pStorage, const char *pName, const char *pPath, int DirType, bool UseCache) :
+	m_pStorage(pStorage),
+	m_DirType(DirType),
+	m_UseCache(UseCache)
+{
+	str_copy(m_aName, pName);
+	str_copy(m_aPath, pPath);
+	str_format(m_aCachePath, sizeof(m_aCachePath), "cache/skins/%s.bin", pName);
+}
+
+CSkins::CSkinLoadJob::~CSkinLoadJob()
+{
+	free(m_Info.m_pData);
+	free(m_ColorableInfo.m_pData);
+}
+
+void CSkins::CSkinLoadJob::Run()
+{
+	if(m_Aborted.load(std::memory_order_relaxed))
+		return;
+
+	IOHANDLE File = m_pStorage->OpenFile(m_aPath, IOFLAG_READ, m_DirType);
+	if(!File)
+		return;
+	void *pFileData;
+	unsigned FileSize;
+	io_read_all(File, &pFileData, &FileSize);
+	io_close(File);
+
+	const SHA256_DIGEST Sha256 = sha256(pFileData, FileSize);
+	if(m_UseCache && LoadCache(Sha256))
+	{
+		free(pFileData);
+		m_Loaded = true;
+		m_Prepared = true;
+		return;
+	}
+
+	TImageByteBuffer ByteBuffer((uint8_t *)pFileData, (uint8_t *)pFileData + FileSize);
+	free(pFileData);
+	SImageByteBuffer ImageByteBuffer(&ByteBuffer);
+	uint8_t *pImgBuffer = nullptr;
+	EImageFormat ImageFormat;
+	int PngliteIncompatible;
+	if(!::LoadPNG(ImageByteBuffer, m_aPath, PngliteIncompatible, m_Info.m_Width, m_Info.m_Height, pImgBuffer, ImageFormat))
+		return;
+	if(ImageFormat != IMAGE_FORMAT_RGB && ImageFormat != IMAGE_FORMAT_RGBA)
+	{
+		free(pImgBuffer);
+		return;
+	}
+	m_Info.m_Format = ImageFormat == IMAGE_FORMAT_RGBA ? CImageInfo::FORMAT_RGBA : CImageInfo::FORMAT_RGB;
+	m_Info.m_pData = pImgBuffer;
+	m_Loaded = true;
+
+	// images that need to be resized or are not RGBA are left to the main
+	// thread, which warns about them
+	const CDataSpriteset *pSet = g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet;
+	if(m_Info.m_Format != CImageInfo::FORMAT_RGBA || m_Info.m_Width == 0 || m_Info.m_Height == 0 || m_Info.m_Width % pSet->m_Gridx != 0 || m_Info.m_Height % pSet->m_Gridy != 0)
+		return;
+
+	m_Prepared = PrepareSkin(m_Info, &m_ColorableInfo, &m_BloodColor, &m_Metrics);
+	if(m_Prepared && m_UseCache)
+		SaveCache(Sha256);
+}
+
+bool CSkins::CSkinLoadJob::LoadCache(const SHA256_DIGEST &Sha256)
+{
+	IOHANDLE File = m_pStorage->OpenFile(m_aCachePath, IOFLAG_READ, IStorage::TYPE_SAVE);
+	if(!File)
+		return false;
+
+	unsigned char aHeader[CSkinCacheHeader::SERIALIZED_SIZE];
+	CSkinCacheHeader Header;
+	bool Valid = io_read(File, aHeader, sizeof(aHeader)) == sizeof(aHeader) &&
+		     Header.Unserialize(aHeader) &&
+		     Header.m_Sha256 == Sha256;
+	if(Valid)
+	{
+		const size_t DataSize = Header.ImageSize();
+		m_Info.m_Width = m_ColorableInfo.m_Width = Header.m_Width;
+		m_Info.m_Height = m_ColorableInfo.m_Height = Header.m_Height;
+		m_Info.m_Format = m_ColorableInfo.m_Format = CImageInfo::FORMAT_RGBA;
+		m_Info.m_pData = malloc(DataSize);
+		m_ColorableInfo.m_pData = malloc(DataSize);
+		Valid = io_read(File, m_Info.m_pData, DataSize) == DataSize && io_read(File, m_ColorableInfo.m_pData, DataSize) == DataSize;
+		if(!Valid)
+		{
+			free(m_Info.m_pData);
+			free(m_ColorableInfo.m_pData);
+			m_Info = CImageInfo();
+			m_ColorableInfo = CImageInfo();
+		}
+	}
+	io_close(File);
+
+	if(Valid)
+	{
+		m_BloodColor = Header.m_BloodColor;
+		m_Metrics = Header.m_Metrics;
+	}
+	return Valid;
+}
+
+void CSkins::CSkinLoadJob::SaveCache(const SHA256_DIGEST &Sha256)
+{
+	// write to a temporary file first, so that a skin loaded at the same
+	// time never reads a partially written cache file
+	char aBuf[IO_MAX_PATH_LENGTH];
+	char aTmpPath[IO_MAX_PATH_LENGTH];
+	str_copy(aTmpPath, IStorage::FormatTmpPath(aBuf, sizeof(aBuf), m_aCachePath));
+	IOHANDLE File = m_pStorage->OpenFile(aTmpPath, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
+		return;
+
+	CSkinCacheHeader Header;
+	Header.m_Sha256 = Sha256;
+	Header.m_Width = m_Info.m_Width;
+	Header.m_Height = m_Info.m_Height;
+	Header.m_BloodColor = m_BloodColor;
+	Header.m_Metrics = m_Metrics;
+	unsigned char aHeader[CSkinCacheHeader::SERIALIZED_SIZE];
+	Header.Serialize(aHeader);
+
+	const size_t DataSize = Header.ImageSize();
+	const bool Written = io_write(File, aHeader, sizeof(aHeader)) == sizeof(aHeader) &&
+			     io_write(File, m_Info.m_pData, DataSize) == DataSize &&
+			     io_write(File, m_ColorableInfo.m_pData, DataSize) == DataSize;
+	io_close(File);
+	// the skins were refreshed in the meantime, the cache may have been
+	// turned off or the skin replaced
+	if(!Written || m_Aborted.load(std::memory_order_relaxed) || !m_pStorage->RenameFile(aTmpPath, m_aCachePath, IStorage::TYPE_SAVE))
+		m_pStorage->RemoveFile(aTmpPath, IStorage::TYPE_SAVE);
+}
+
 struct SSkinScanUser
 {
 	CSkins *m_pThis;
@@ -65,13 +204,26 @@ int CSkins::SkinScan(const char *pName, int IsDir, int DirType, void *pUser)
 
 	// Don't add duplicate skins (one from user's config directory, other from
 	// client itself)
-	if(pSelf->m_Skins.find(aNameWithoutPng) != pSelf->m_Skins.end())
+	if(pSelf->m_Skins.find(aNameWithoutPng) != pSelf->m_Skins.end() || pSelf->m_LoadingSkinNames.find(aNameWithoutPng) != pSelf->m_LoadingSkinNames.end())
 		return 0;
 
 	char aBuf[IO_MAX_PATH_LENGTH];
 	str_format(aBuf, sizeof(aBuf), "skins/%s", pName);
-	pSelf->LoadSkin(aNameWithoutPng, aBuf, DirType);
-	pUserReal->m_SkinLoadedFunc((int)pSelf->m_Skins.size());
+	auto pJob = std::make_shared<CSkinLoadJob>(pSelf->Storage(), aNameWithoutPng, aBuf, DirType, g_Config.m_ClSkinsCache != 0);
+	if(str_comp(pJob->m_aName, "default") == 0)
+	{
+		// the default skin is the placeholder for the skins that are still
+		// being loaded, so it is available right away
+		CJobPool::RunBlocking(pJob.get());
+		pSelf->FinishLoadJob(pJob.get());
+	}
+	else
+	{
+		pSelf->m_pClient->Engine()->AddJob(pJob);
+		pSelf->m_LoadingSkinNames.emplace(pJob->m_aName, pJob.get());
+		pSelf->m_vpLoadingSkins.push_back(std::move(pJob));
+	}
+	pUserReal->m_SkinLoadedFunc((int)(pSelf->m_Skins.size() + pSelf->m_vpLoadingSkins.size()));
 	return 0;
 }
 
@@ -110,14 +262,6 @@ static void CheckMetrics(CSkin::SSkinMetricVariable &Metrics, const uint8_t *pIm
 	Metrics.m_MaxHeight = CheckHeight;
 }
 
-const CSkin *CSkins::LoadSkin(const char *pName, const char *pPath, int DirType)
-{
-	CImageInfo Info;
-	if(!LoadSkinPNG(Info, pName, pPath, DirType))
-		return 0;
-	return LoadSkin(pName, Info);
-}
-
 bool CSkins::LoadSkinPNG(CImageInfo &Info, const char *pName, const char *pPath, int DirType)
 {
 	char aBuf[512];
@@ -147,17 +291,22 @@ const CSkin *CSkins::LoadSkin(const char *pName, CImageInfo &Info)
 		return nullptr;
 	}
 
-	CSkin Skin{pName};
-	Skin.m_OriginalSkin.m_Body = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_BODY]);
-	Skin.m_OriginalSkin.m_BodyOutline = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_BODY_OUTLINE]);
-	Skin.m_OriginalSkin.m_Feet = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_FOOT]);
-	Skin.m_OriginalSkin.m_FeetOutline = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_FOOT_OUTLINE]);
-	Skin.m_OriginalSkin.m_Hands = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_HAND]);
-	Skin.m_OriginalSkin.m_HandsOutline = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_HAND_OUTLINE]);
-
-	for(int i = 0; i < 6; ++i)
-		Skin.m_OriginalSkin.m_aEyes[i] = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_EYE_NORMAL + i]);
+	CImageInfo ColorableInfo;
+	ColorRGBA BloodColor;
+	CSkin::SSkinMetrics Metrics;
+	if(!PrepareSkin(Info, &ColorableInfo, &BloodColor, &Metrics))
+	{
+		Graphics()->FreePNG(&Info);
+		return nullptr;
+	}
+	const CSkin *pSkin = UploadSkin(pName, Info, ColorableInfo, BloodColor, Metrics);
+	Graphics()->FreePNG(&Info);
+	free(ColorableInfo.m_pData);
+	return pSkin;
+}
 
+bool CSkins::PrepareSkin(const CImageInfo &Info, CImageInfo *pColorableInfo, ColorRGBA *pBloodColor, CSkin::SSkinMetrics *pMetrics)
+{
 	int FeetGridPixelsWidth = (Info.m_Width / g_pData->m_aSprites[SPRITE_TEE_FOOT].m_pSet->m_Gridx);
 	int FeetGridPixelsHeight = (Info.m_Height / g_pData->m_aSprites[SPRITE_TEE_FOOT].m_pSet->m_Gridy);
 	int FeetWidth = g_pData->m_aSprites[SPRITE_TEE_FOOT].m_W * FeetGridPixelsWidth;
@@ -185,8 +334,8 @@ const CSkin *CSkins::LoadSkin(const char *pName, CImageInfo &Info)
 	int BodyWidth = g_pData->m_aSprites[SPRITE_TEE_BODY].m_W * (Info.m_Width / g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet->m_Gridx); // body width
 	int BodyHeight = g_pData->m_aSprites[SPRITE_TEE_BODY].m_H * (Info.m_Height / g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet->m_Gridy); // body height
 	if(BodyWidth > Info.m_Width || BodyHeight > Info.m_Height)
-		return nullptr;
-	unsigned char *pData = (unsigned char *)Info.m_pData;
+		return false;
+	const unsigned char *pOrgData = (const unsigned char *)Info.m_pData;
 	const int PixelStep = 4;
 	int Pitch = Info.m_Width * PixelStep;
 
@@ -196,32 +345,36 @@ const CSkin *CSkins::LoadSkin(const char *pName, CImageInfo &Info)
 		for(int y = 0; y < BodyHeight; y++)
 			for(int x = 0; x < BodyWidth; x++)
 			{
-				uint8_t AlphaValue = pData[y * Pitch + x * PixelStep + 3];
+				uint8_t AlphaValue = pOrgData[y * Pitch + x * PixelStep + 3];
 				if(AlphaValue > 128)
 				{
-					aColors[0] += pData[y * Pitch + x * PixelStep + 0];
-					aColors[1] += pData[y * Pitch + x * PixelStep + 1];
-					aColors[2] += pData[y * Pitch + x * PixelStep + 2];
+					aColors[0] += pOrgData[y * Pitch + x * PixelStep + 0];
+					aColors[1] += pOrgData[y * Pitch + x * PixelStep + 1];
+					aColors[2] += pOrgData[y * Pitch + x * PixelStep + 2];
 				}
 			}
 		if(aColors[0] != 0 && aColors[1] != 0 && aColors[2] != 0)
-			Skin.m_BloodColor = ColorRGBA(normalize(vec3(aColors[0], aColors[1], aColors[2])));
+			*pBloodColor = ColorRGBA(normalize(vec3(aColors[0], aColors[1], aColors[2])));
 		else
-			Skin.m_BloodColor = ColorRGBA(0, 0, 0, 1);
+			*pBloodColor = ColorRGBA(0, 0, 0, 1);
 	}
 
-	CheckMetrics(Skin.m_Metrics.m_Body, pData, Pitch, 0, 0, BodyWidth, BodyHeight);
+	CheckMetrics(pMetrics->m_Body, pOrgData, Pitch, 0, 0, BodyWidth, BodyHeight);
 
 	// body outline metrics
-	CheckMetrics(Skin.m_Metrics.m_Body, pData, Pitch, BodyOutlineOffsetX, BodyOutlineOffsetY, BodyOutlineWidth, BodyOutlineHeight);
+	CheckMetrics(pMetrics->m_Body, pOrgData, Pitch, BodyOutlineOffsetX, BodyOutlineOffsetY, BodyOutlineWidth, BodyOutlineHeight);
 
 	// get feet size
-	CheckMetrics(Skin.m_Metrics.m_Feet, pData, Pitch, FeetOffsetX, FeetOffsetY, FeetWidth, FeetHeight);
+	CheckMetrics(pMetrics->m_Feet, pOrgData, Pitch, FeetOffsetX, FeetOffsetY, FeetWidth, FeetHeight);
 
 	// get feet outline size
-	CheckMetrics(Skin.m_Metrics.m_Feet, pData, Pitch, FeetOutlineOffsetX, FeetOutlineOffsetY, FeetOutlineWidth, FeetOutlineHeight);
+	CheckMetrics(pMetrics->m_Feet, pOrgData, Pitch, FeetOutlineOffsetX, FeetOutlineOffsetY, FeetOutlineWidth, FeetOutlineHeight);
 
-	// make the texture gray scale
+	// make a gray scale copy of the texture
+	*pColorableInfo = Info;
+	pColorableInfo->m_pData = malloc((size_t)Info.m_Width * Info.m_Height * PixelStep);
+	unsigned char *pData = (unsigned char *)pColorableInfo->m_pData;
+	mem_copy(pData, pOrgData, (size_t)Info.m_Width * Info.m_Height * PixelStep);
 	for(int i = 0; i < Info.m_Width * Info.m_Height; i++)
 	{
 		int v = (pData[i * PixelStep] + pData[i * PixelStep + 1] + pData[i * PixelStep + 2]) / 3;
@@ -268,17 +421,36 @@ const CSkin *CSkins::LoadSkin(const char *pName, CImageInfo &Info)
 			pData[y * Pitch + x * PixelStep + 2] = v;
 		}
 
-	Skin.m_ColorableSkin.m_Body = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_BODY]);
-	Skin.m_ColorableSkin.m_BodyOutline = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_BODY_OUTLINE]);
-	Skin.m_ColorableSkin.m_Feet = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_FOOT]);
-	Skin.m_ColorableSkin.m_FeetOutline = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_FOOT_OUTLINE]);
-	Skin.m_ColorableSkin.m_Hands = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_HAND]);
-	Skin.m_ColorableSkin.m_HandsOutline = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_HAND_OUTLINE]);
+	return true;
+}
+
+const CSkin *CSkins::UploadSkin(const char *pName, CImageInfo &Info, CImageInfo &ColorableInfo, const ColorRGBA &BloodColor, const CSkin::SSkinMetrics &Metrics)
+{
+	char aBuf[512];
+
+	CSkin Skin{pName};
+	Skin.m_OriginalSkin.m_Body = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_BODY]);
+	Skin.m_OriginalSkin.m_BodyOutline = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_BODY_OUTLINE]);
+	Skin.m_OriginalSkin.m_Feet = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_FOOT]);
+	Skin.m_OriginalSkin.m_FeetOutline = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_FOOT_OUTLINE]);
+	Skin.m_OriginalSkin.m_Hands = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_HAND]);
+	Skin.m_OriginalSkin.m_HandsOutline = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_HAND_OUTLINE]);
 
 	for(int i = 0; i < 6; ++i)
-		Skin.m_ColorableSkin.m_aEyes[i] = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_EYE_NORMAL + i]);
+		Skin.m_OriginalSkin.m_aEyes[i] = Graphics()->LoadSpriteTexture(Info, &g_pData->m_aSprites[SPRITE_TEE_EYE_NORMAL + i]);
 
-	Graphics()->FreePNG(&Info);
+	Skin.m_ColorableSkin.m_Body = Graphics()->LoadSpriteTexture(ColorableInfo, &g_pData->m_aSprites[SPRITE_TEE_BODY]);
+	Skin.m_ColorableSkin.m_BodyOutline = Graphics()->LoadSpriteTexture(ColorableInfo, &g_pData->m_aSprites[SPRITE_TEE_BODY_OUTLINE]);
+	Skin.m_ColorableSkin.m_Feet = Graphics()->LoadSpriteTexture(ColorableInfo, &g_pData->m_aSprites[SPRITE_TEE_FOOT]);
+	Skin.m_ColorableSkin.m_FeetOutline = Graphics()->LoadSpriteTexture(ColorableInfo, &g_pData->m_aSprites[SPRITE_TEE_FOOT_OUTLINE]);
+	Skin.m_ColorableSkin.m_Hands = Graphics()->LoadSpriteTexture(ColorableInfo, &g_pData->m_aSprites[SPRITE_TEE_HAND]);
+	Skin.m_ColorableSkin.m_HandsOutline = Graphics()->LoadSpriteTexture(ColorableInfo, &g_pData->m_aSprites[SPRITE_TEE_HAND_OUTLINE]);
+
+	for(int i = 0; i < 6; ++i)
+		Skin.m_ColorableSkin.m_aEyes[i] = Graphics()->LoadSpriteTexture(ColorableInfo, &g_pData->m_aSprites[SPRITE_TEE_EYE_NORMAL + i]);
+
+	Skin.m_BloodColor = BloodColor;
+	Skin.m_Metrics = Metrics;
 
 	// set skin data
 	if(g_Config.m_Debug)
@@ -309,12 +481,66 @@ void CSkins::OnInit()
 		}
 	}
 
+	Storage()->CreateFolder("cache", IStorage::TYPE_SAVE);
+	Storage()->CreateFolder("cache/skins", IStorage::TYPE_SAVE);
+
 	// load skins;
 	Refresh([this](int SkinCounter) {
 		GameClient()->m_Menus.RenderLoading(Localize("Loading DDNet Client"), Localize("Loading skin files"), 0);
 	});
 }
 
+void CSkins::OnRender()
+{
+	UploadLoadedSkins();
+}
+
+void CSkins::FinishLoadJob(CSkinLoadJob *pJob)
+{
+	if(!pJob->m_Loaded)
+	{
+		char aBuf[512];
+		str_format(aBuf, sizeof(aBuf), "failed to load skin from %s", pJob->m_aPath);
+		Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "game", aBuf);
+	}
+	else if(pJob->m_Prepared)
+	{
+		UploadSkin(pJob->m_aName, pJob->m_Info, pJob->m_ColorableInfo, pJob->m_BloodColor, pJob->m_Metrics);
+	}
+	else
+	{
+		LoadSkin(pJob->m_aName, pJob->m_Info);
+	}
+}
+
+void CSkins::UploadLoadedSkins()
+{
+	if(m_vpLoadingSkins.empty())
+		return;
+
+	// spread the texture uploads over several frames
+	const auto StartTime = time_get_nanoseconds();
+	bool Uploaded = false;
+	auto It = m_vpLoadingSkins.begin();
+	while(It != m_vpLoadingSkins.end() && time_get_nanoseconds() - StartTime < std::chrono::microseconds(SKIN_UPLOAD_BUDGET_US))
+	{
+		CSkinLoadJob *pJob = It->get();
+		if(pJob->Status() != IJob::STATE_DONE)
+		{
+			++It;
+			continue;
+		}
+		m_LoadingSkinNames.erase(pJob->m_aName);
+		FinishLoadJob(pJob);
+		It = m_vpLoadingSkins.erase(It);
+		Uploaded = true;
+	}
+
+	// players that use the uploaded skins still render the placeholder
+	if(Uploaded && Client()->State() >= IClient::STATE_ONLINE)
+		GameClient()->RefindSkins();
+}
+
 void CSkins::Refresh(TSkinLoadedCBFunc &&SkinLoadedFunc)
 {
 	for(const auto &SkinIt : m_Skins)
@@ -342,13 +568,20 @@ void CSkins::Refresh(TSkinLoadedCBFunc &&SkinLoadedFunc)
 	m_Skins.clear();
 	m_DownloadSkins.clear();
 	m_DownloadingSkins = 0;
+	// skins that are still being loaded finish in the background and are
+	// discarded
+	for(const auto &pJob : m_vpLoadingSkins)
+		pJob->Abort();
+	m_LoadingSkinNames.clear();
+	m_vpLoadingSkins.clear();
 	SSkinScanUser SkinScanUser;
 	SkinScanUser.m_pThis = this;
 	SkinScanUser.m_SkinLoadedFunc = SkinLoadedFunc;
 	Storage()->ListDirectory(IStorage::TYPE_ALL, "skins", SkinScan, &SkinScanUser);
 	if(m_Skins.empty())
 	{
-		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "gameclient", "failed to load skins. folder='skins/'");
+		if(m_vpLoadingSkins.empty())
+			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "gameclient", "failed to load skins. folder='skins/'");
 		CSkin DummySkin{"dummy"};
 		DummySkin.m_BloodColor = ColorRGBA(1.0f, 1.0f, 1.0f);
 		auto &&pDummySkin = std::make_unique<CSkin>(std::move(DummySkin));
@@ -405,6 +638,10 @@ const CSkin *CSkins::FindImpl(const char *pName)
 	if(SkinIt != m_Skins.end())
 		return SkinIt->second.get();
 
+	// still being loaded, the placeholder is used until then
+	if(m_LoadingSkinNames.find(pName) != m_LoadingSkinNames.end())
+		return nullptr;
+
 	if(str_comp(pName, "default") == 0)
 		return nullptr;
 
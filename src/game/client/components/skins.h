@@ -3,10 +3,13 @@
 #ifndef GAME_CLIENT_COMPONENTS_SKINS_H
 #define GAME_CLIENT_COMPONENTS_SKINS_H
 
+#include <base/hash.h>
 #include <base/system.h>
 #include <engine/shared/http.h>
+#include <engine/shared/jobs.h>
 #include <game/client/component.h>
 #include <game/client/skin.h>
+#include <atomic>
 #include <string_view>
 #include <unordered_map>
 
@@ -56,10 +59,45 @@ public:
 		const char *GetName() const { return m_aName; }
 	};
 
+	// Decodes a skin and computes its colorable variant on a worker thread,
+	// the textures are uploaded by the main thread once it is done.
+	class CSkinLoadJob : public IJob
+	{
+		IStorage *m_pStorage;
+		int m_DirType;
+		bool m_UseCache;
+		// set when the skins are refreshed while the job is still running
+		std::atomic_bool m_Aborted{false};
+		// named after the full file name, the skin name may be truncated
+		char m_aCachePath[IO_MAX_PATH_LENGTH];
+
+		void Run() override;
+		bool LoadCache(const SHA256_DIGEST &Sha256);
+		void SaveCache(const SHA256_DIGEST &Sha256);
+
+	public:
+		char m_aName[24];
+		char m_aPath[IO_MAX_PATH_LENGTH];
+		// false if the file could not be decoded
+		bool m_Loaded = false;
+		// false if the image has to be checked and prepared on the main thread
+		bool m_Prepared = false;
+		CImageInfo m_Info;
+		CImageInfo m_ColorableInfo;
+		ColorRGBA m_BloodColor;
+		CSkin::SSkinMetrics m_Metrics;
+
+		CSkinLoadJob(IStorage *pStorage, const char *pName, const char *pPath, int DirType, bool UseCache);
+		~CSkinLoadJob();
+		// the result is discarded, don't write the cache for it anymore
+		void Abort() { m_Aborted.store(true, std::memory_order_relaxed); }
+	};
+
 	typedef std::function<void(int)> TSkinLoadedCBFunc;
 
 	virtual int Sizeof() const override { return sizeof(*this); }
 	void OnInit() override;
+	void OnRender() override;
 
 	void Refresh(TSkinLoadedCBFunc &&SkinLoadedFunc);
 	int Num();
@@ -67,7 +105,8 @@ public:
 	const CSkin *FindOrNullptr(const char *pName);
 	const CSkin *Find(const char *pName);
 
-	bool IsDownloadingSkins() { return m_DownloadingSkins; }
+	bool IsDownloadingSkins() { return m_DownloadingSkins || !m_vpLoadingSkins.empty(); }
+	bool IsLoadingSkins() const { return !m_vpLoadingSkins.empty(); }
 
 	static bool IsVanillaSkin(const char *pName);
 
@@ -77,14 +116,28 @@ public:
 		"twinbop", "twintri", "warpaint", "x_ninja", "x_spec"};
 
 private:
+	enum
+	{
+		// time the textures of loaded skins may take to be uploaded per frame
+		SKIN_UPLOAD_BUDGET_US = 3000,
+	};
+
 	std::unordered_map<std::string_view, std::unique_ptr<CSkin>> m_Skins;
+	// skins that are being loaded by the job pool, in the order they were found
+	std::vector<std::shared_ptr<CSkinLoadJob>> m_vpLoadingSkins;
+	std::unordered_map<std::string_view, CSkinLoadJob *> m_LoadingSkinNames;
 	std::unordered_map<std::string_view, std::unique_ptr<CDownloadSkin>> m_DownloadSkins;
 	size_t m_DownloadingSkins = 0;
 	char m_aEventSkinPrefix[24];
 
 	bool LoadSkinPNG(CImageInfo &Info, const char *pName, const char *pPath, int DirType);
-	const CSkin *LoadSkin(const char *pName, const char *pPath, int DirType);
 	const CSkin *LoadSkin(const char *pName, CImageInfo &Info);
+	const CSkin *UploadSkin(const char *pName, CImageInfo &Info, CImageInfo &ColorableInfo, const ColorRGBA &BloodColor, const CSkin::SSkinMetrics &Metrics);
+	void FinishLoadJob(CSkinLoadJob *pJob);
+	void UploadLoadedSkins();
+	// computes the metrics, the blood color and the grayscale variant of an
+	// RGBA skin image, returns false if the image is too small
+	static bool PrepareSkin(const CImageInfo &Info, CImageInfo *pColorableInfo, ColorRGBA *pBloodColor, CSkin::SSkinMetrics *pMetrics);
 	const CSkin *FindImpl(const char *pName);
 	static int SkinScan(const char *pName, int IsDir, int DirType, void *pUser);
 };
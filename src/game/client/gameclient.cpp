@@ -1341,8 +1341,21 @@ void CGameClient::OnNewSnapshot()
 				{
 					CClientData *pClient = &m_aClients[ClientID];
 
-					IntsToStr(&pInfo->m_Name0, 4, pClient->m_aName);
-					IntsToStr(&pInfo->m_Clan0, 3, pClient->m_aClan);
+					char aName[sizeof(pClient->m_aName)];
+					char aClan[sizeof(pClient->m_aClan)];
+					IntsToStr(&pInfo->m_Name0, 4, aName);
+					IntsToStr(&pInfo->m_Clan0, 3, aClan);
+					// rasterise the glyphs of new names in the background
+					if(str_comp(aName, pClient->m_aName) != 0)
+					{
+						str_copy(pClient->m_aName, aName);
+						TextRender()->PrewarmText(aName);
+					}
+					if(str_comp(aClan, pClient->m_aClan) != 0)
+					{
+						str_copy(pClient->m_aClan, aClan);
+						TextRender()->PrewarmText(aClan);
+					}
 					pClient->m_Country = pInfo->m_Country;
 					IntsToStr(&pInfo->m_Skin0, 6, pClient->m_aSkinName);
 
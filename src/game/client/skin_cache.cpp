@@ -0,0 +1,101 @@
+#include "skin_cache.h"
+
+#include <base/system.h>
+
+#include <engine/graphics.h>
+
+static const unsigned char SKIN_CACHE_MAGIC[4] = {'D', 'S', 'K', 'C'};
+
+static unsigned char *WriteInt(unsigned char *pOut, int Value)
+{
+	uint_to_bytes_be(pOut, Value);
+	return pOut + 4;
+}
+
+static unsigned char *WriteFloat(unsigned char *pOut, float Value)
+{
+	unsigned Bits;
+	static_assert(sizeof(Bits) == sizeof(Value), "float must be 32 bits");
+	mem_copy(&Bits, &Value, sizeof(Bits));
+	uint_to_bytes_be(pOut, Bits);
+	return pOut + 4;
+}
+
+static const unsigned char *ReadInt(const unsigned char *pData, int *pValue)
+{
+	*pValue = bytes_be_to_uint(pData);
+	return pData + 4;
+}
+
+static const unsigned char *ReadFloat(const unsigned char *pData, float *pValue)
+{
+	const unsigned Bits = bytes_be_to_uint(pData);
+	mem_copy(pValue, &Bits, sizeof(*pValue));
+	return pData + 4;
+}
+
+static unsigned char *WriteMetric(unsigned char *pOut, const CSkin::SSkinMetricVariable &Metric)
+{
+	pOut = WriteInt(pOut, Metric.m_Width);
+	pOut = WriteInt(pOut, Metric.m_Height);
+	pOut = WriteInt(pOut, Metric.m_OffsetX);
+	pOut = WriteInt(pOut, Metric.m_OffsetY);
+	pOut = WriteInt(pOut, Metric.m_MaxWidth);
+	return WriteInt(pOut, Metric.m_MaxHeight);
+}
+
+static const unsigned char *ReadMetric(const unsigned char *pData, CSkin::SSkinMetricVariable &Metric)
+{
+	pData = ReadInt(pData, &Metric.m_Width.m_Value);
+	pData = ReadInt(pData, &Metric.m_Height.m_Value);
+	pData = ReadInt(pData, &Metric.m_OffsetX.m_Value);
+	pData = ReadInt(pData, &Metric.m_OffsetY.m_Value);
+	pData = ReadInt(pData, &Metric.m_MaxWidth.m_Value);
+	return ReadInt(pData, &Metric.m_MaxHeight.m_Value);
+}
+
+void CSkinCacheHeader::Serialize(unsigned char *pOut) const
+{
+	unsigned char *pStart = pOut;
+	mem_copy(pOut, SKIN_CACHE_MAGIC, sizeof(SKIN_CACHE_MAGIC));
+	pOut += sizeof(SKIN_CACHE_MAGIC);
+	pOut = WriteInt(pOut, VERSION);
+	mem_copy(pOut, m_Sha256.data, sizeof(m_Sha256.data));
+	pOut += sizeof(m_Sha256.data);
+	pOut = WriteInt(pOut, m_Width);
+	pOut = WriteInt(pOut, m_Height);
+	pOut = WriteFloat(pOut, m_BloodColor.r);
+	pOut = WriteFloat(pOut, m_BloodColor.g);
+	pOut = WriteFloat(pOut, m_BloodColor.b);
+	pOut = WriteFloat(pOut, m_BloodColor.a);
+	pOut = WriteMetric(pOut, m_Metrics.m_Body);
+	pOut = WriteMetric(pOut, m_Metrics.m_Feet);
+	dbg_assert(pOut - pStart == SERIALIZED_SIZE, "skin cache header size mismatch");
+}
+
+bool CSkinCacheHeader::Unserialize(const unsigned char *pData)
+{
+	if(mem_comp(pData, SKIN_CACHE_MAGIC, sizeof(SKIN_CACHE_MAGIC)) != 0)
+		return false;
+	pData += sizeof(SKIN_CACHE_MAGIC);
+	int Version;
+	pData = ReadInt(pData, &Version);
+	if(Version != VERSION)
+		return false;
+	mem_copy(m_Sha256.data, pData, sizeof(m_Sha256.data));
+	pData += sizeof(m_Sha256.data);
+	pData = ReadInt(pData, &m_Width);
+	pData = ReadInt(pData, &m_Height);
+	pData = ReadFloat(pData, &m_BloodColor.r);
+	pData = ReadFloat(pData, &m_BloodColor.g);
+	pData = ReadFloat(pData, &m_BloodColor.b);
+	pData = ReadFloat(pData, &m_BloodColor.a);
+	pData = ReadMetric(pData, m_Metrics.m_Body);
+	ReadMetric(pData, m_Metrics.m_Feet);
+	return m_Width > 0 && m_Height > 0 && m_Width <= MAX_SIZE && m_Height <= MAX_SIZE;
+}
+
+size_t CSkinCacheHeader::ImageSize() const
+{
+	return (size_t)m_Width * m_Height * CImageInfo::PixelSize(CImageInfo::FORMAT_RGBA);
+}
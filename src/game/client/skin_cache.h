@@ -0,0 +1,37 @@
+#ifndef GAME_CLIENT_SKIN_CACHE_H
+#define GAME_CLIENT_SKIN_CACHE_H
+
+#include <base/color.h>
+#include <base/hash.h>
+
+#include <game/client/skin.h>
+
+// Header of a prepared skin in cache/skins, it is followed by the RGBA
+// pixels of the original and of the colorable image. All fields are stored
+// big-endian in the order they are declared in.
+class CSkinCacheHeader
+{
+public:
+	enum
+	{
+		VERSION = 2,
+		// magic, version, SHA256, size, blood color and two sets of metrics
+		SERIALIZED_SIZE = 4 + 4 + SHA256_DIGEST_LENGTH + 2 * 4 + 4 * 4 + 2 * 6 * 4,
+		MAX_SIZE = 4096,
+	};
+
+	SHA256_DIGEST m_Sha256;
+	int m_Width;
+	int m_Height;
+	ColorRGBA m_BloodColor;
+	CSkin::SSkinMetrics m_Metrics;
+
+	void Serialize(unsigned char *pOut) const;
+	// returns false if the data is not a header of this version or the
+	// image size is invalid
+	bool Unserialize(const unsigned char *pData);
+	// size of one of the images following the header
+	size_t ImageSize() const;
+};
+
+#endif
@@ -887,9 +887,9 @@ int CCollision::GetMapIndex(vec2 Pos) const
 		return -1;
 }
 
-std::vector<int> CCollision::GetMapIndices(vec2 PrevPos, vec2 Pos, unsigned MaxIndices) const
+void CCollision::GetMapIndices(vec2 PrevPos, vec2 Pos, std::vector<int> *pvIndices, unsigned MaxIndices) const
 {
-	std::vector<int> vIndices;
+	pvIndices->clear();
 	float d = distance(PrevPos, Pos);
 	int End(d + 1);
 	if(!d)
@@ -899,12 +899,7 @@ std::vector<int> CCollision::GetMapIndices(vec2 PrevPos, vec2 Pos, unsigned MaxI
 		int Index = Ny * m_Width + Nx;
 
 		if(TileExists(Index))
-		{
-			vIndices.push_back(Index);
-			return vIndices;
-		}
-		else
-			return vIndices;
+			pvIndices->push_back(Index);
 	}
 	else
 	{
@@ -918,14 +913,12 @@ std::vector<int> CCollision::GetMapIndices(vec2 PrevPos, vec2 Pos, unsigned MaxI
 			int Index = Ny * m_Width + Nx;
 			if(TileExists(Index) && LastIndex != Index)
 			{
-				if(MaxIndices && vIndices.size() > MaxIndices)
-					return vIndices;
-				vIndices.push_back(Index);
+				if(MaxIndices && pvIndices->size() > MaxIndices)
+					return;
+				pvIndices->push_back(Index);
 				LastIndex = Index;
 			}
 		}
-
-		return vIndices;
 	}
 }
 
@@ -1086,12 +1079,16 @@ void CCollision::SetDCollisionAt(float x, float y, int Type, int Flags, int Numb
 {
 	if(!m_pDoor)
 		return;
-	int Nx = clamp(round_to_int(x) / 32, 0, m_Width - 1);
-	int Ny = clamp(round_to_int(y) / 32, 0, m_Height - 1);
+	SetDCollisionAt(GetPureMapIndex(x, y), Type, Flags, Number);
+}
 
-	m_pDoor[Ny * m_Width + Nx].m_Index = Type;
-	m_pDoor[Ny * m_Width + Nx].m_Flags = Flags;
-	m_pDoor[Ny * m_Width + Nx].m_Number = Number;
+void CCollision::SetDCollisionAt(int Index, int Type, int Flags, int Number)
+{
+	if(!m_pDoor)
+		return;
+	m_pDoor[Index].m_Index = Type;
+	m_pDoor[Index].m_Flags = Flags;
+	m_pDoor[Index].m_Number = Number;
 }
 
 int CCollision::GetDTileIndex(int Index) const
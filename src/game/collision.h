@@ -51,6 +51,7 @@ public:
 	void SetCollisionAt(float x, float y, int id);
 	void SetDTile(float x, float y, bool State);
 	void SetDCollisionAt(float x, float y, int Type, int Flags, int Number);
+	void SetDCollisionAt(int Index, int Type, int Flags, int Number);
 	int GetDTileIndex(int Index) const;
 	int GetDTileFlags(int Index) const;
 	int GetDTileNumber(int Index) const;
@@ -73,7 +74,14 @@ public:
 	int Entity(int x, int y, int Layer) const;
 	int GetPureMapIndex(float x, float y) const;
 	int GetPureMapIndex(vec2 Pos) const { return GetPureMapIndex(Pos.x, Pos.y); }
-	std::vector<int> GetMapIndices(vec2 PrevPos, vec2 Pos, unsigned MaxIndices = 0) const;
+	// clears pvIndices and fills it with the indices of the tiles between PrevPos and Pos
+	void GetMapIndices(vec2 PrevPos, vec2 Pos, std::vector<int> *pvIndices, unsigned MaxIndices = 0) const;
+	std::vector<int> GetMapIndices(vec2 PrevPos, vec2 Pos, unsigned MaxIndices = 0) const
+	{
+		std::vector<int> vIndices;
+		GetMapIndices(PrevPos, Pos, &vIndices, MaxIndices);
+		return vIndices;
+	}
 	int GetMapIndex(vec2 Pos) const;
 	bool TileExists(int Index) const;
 	bool TileExistsNext(int Index) const;
@@ -0,0 +1,583 @@
+#include <cinttypes>
+#include <cstdio> // sscanf
+
+#include <engine/engine.h>
+#include <engine/shared/jobs.h>
+#include <engine/shared/linereader.h>
+
+#include <game/mapitems.h>
+
+#include "auto_map_rules.h"
+
+#include <atomic>
+#include <memory>
+
+// Based on triple32inc from https://github.com/skeeto/hash-prospector/tree/79a6074062a84907df6e45b756134b74e2956760
+static uint32_t HashUInt32(uint32_t Num)
+{
+	Num++;
+	Num ^= Num >> 17;
+	Num *= 0xed5ad4bbu;
+	Num ^= Num >> 11;
+	Num *= 0xac4c1b51u;
+	Num ^= Num >> 15;
+	Num *= 0x31848babu;
+	Num ^= Num >> 14;
+	return Num;
+}
+
+#define HASH_MAX 65536
+
+static int HashLocation(uint32_t Seed, uint32_t Run, uint32_t Rule, uint32_t X, uint32_t Y)
+{
+	const uint32_t Prime = 31;
+	uint32_t Hash = 1;
+	Hash = Hash * Prime + HashUInt32(Seed);
+	Hash = Hash * Prime + HashUInt32(Run);
+	Hash = Hash * Prime + HashUInt32(Rule);
+	Hash = Hash * Prime + HashUInt32(X);
+	Hash = Hash * Prime + HashUInt32(Y);
+	Hash = HashUInt32(Hash * Prime); // Just to double-check that values are well-distributed
+	return Hash % HASH_MAX;
+}
+
+int CAutoMapRules::FlagBits(int Flags)
+{
+	return (Flags & (TILEFLAG_XFLIP | TILEFLAG_YFLIP)) | ((Flags & TILEFLAG_ROTATE) >> 1);
+}
+
+void CAutoMapRules::CompileRule(CPosRule *pRule)
+{
+	mem_zero(pRule->m_aMatch, sizeof(pRule->m_aMatch));
+	for(const auto &Index : pRule->m_vIndexList)
+	{
+		if(Index.m_ID < -1 || Index.m_ID > 255)
+			continue;
+		if(Index.m_TestFlag)
+			pRule->m_aMatch[Index.m_ID + 1] |= 1 << FlagBits(Index.m_Flag);
+		else
+			pRule->m_aMatch[Index.m_ID + 1] = 0xff;
+	}
+	if(pRule->m_Value == CPosRule::NOTINDEX)
+	{
+		for(auto &Match : pRule->m_aMatch)
+			Match = ~Match;
+	}
+}
+
+void CAutoMapRules::Load(IOHANDLE File)
+{
+	CLineReader LineReader;
+	LineReader.Init(File);
+
+	CConfiguration *pCurrentConf = nullptr;
+	CRun *pCurrentRun = nullptr;
+	CIndexRule *pCurrentIndex = nullptr;
+
+	// read each line
+	while(char *pLine = LineReader.Get())
+	{
+		// skip blank/empty lines as well as comments
+		if(str_length(pLine) > 0 && pLine[0] != '#' && pLine[0] != '\n' && pLine[0] != '\r' && pLine[0] != '\t' && pLine[0] != '\v' && pLine[0] != ' ')
+		{
+			if(pLine[0] == '[')
+			{
+				// new configuration, get the name
+				pLine++;
+				CConfiguration NewConf;
+				NewConf.m_aName[0] = '\0';
+				NewConf.m_StartX = 0;
+				NewConf.m_StartY = 0;
+				NewConf.m_EndX = 0;
+				NewConf.m_EndY = 0;
+				m_vConfigs.push_back(NewConf);
+				int ConfigurationID = m_vConfigs.size() - 1;
+				pCurrentConf = &m_vConfigs[ConfigurationID];
+				str_copy(pCurrentConf->m_aName, pLine, minimum<int>(sizeof(pCurrentConf->m_aName), str_length(pLine)));
+
+				// add start run
+				CRun NewRun;
+				NewRun.m_AutomapCopy = true;
+				pCurrentConf->m_vRuns.push_back(NewRun);
+				int RunID = pCurrentConf->m_vRuns.size() - 1;
+				pCurrentRun = &pCurrentConf->m_vRuns[RunID];
+			}
+			else if(str_startswith(pLine, "NewRun") && pCurrentConf)
+			{
+				// add new run
+				CRun NewRun;
+				NewRun.m_AutomapCopy = true;
+				pCurrentConf->m_vRuns.push_back(NewRun);
+				int RunID = pCurrentConf->m_vRuns.size() - 1;
+				pCurrentRun = &pCurrentConf->m_vRuns[RunID];
+			}
+			else if(str_startswith(pLine, "Index") && pCurrentRun)
+			{
+				// new index
+				int ID = 0;
+				char aOrientation1[128] = "";
+				char aOrientation2[128] = "";
+				char aOrientation3[128] = "";
+
+				sscanf(pLine, "Index %d %127s %127s %127s", &ID, aOrientation1, aOrientation2, aOrientation3);
+
+				CIndexRule NewIndexRule;
+				NewIndexRule.m_ID = ID;
+				NewIndexRule.m_Flag = 0;
+				NewIndexRule.m_RandomProbability = 1.0f;
+				NewIndexRule.m_DefaultRule = true;
+				NewIndexRule.m_SkipEmpty = false;
+				NewIndexRule.m_SkipFull = false;
+
+				if(str_length(aOrientation1) > 0)
+				{
+					if(!str_comp(aOrientation1, "XFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_XFLIP;
+					else if(!str_comp(aOrientation1, "YFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_YFLIP;
+					else if(!str_comp(aOrientation1, "ROTATE"))
+						NewIndexRule.m_Flag |= TILEFLAG_ROTATE;
+				}
+
+				if(str_length(aOrientation2) > 0)
+				{
+					if(!str_comp(aOrientation2, "XFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_XFLIP;
+					else if(!str_comp(aOrientation2, "YFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_YFLIP;
+					else if(!str_comp(aOrientation2, "ROTATE"))
+						NewIndexRule.m_Flag |= TILEFLAG_ROTATE;
+				}
+
+				if(str_length(aOrientation3) > 0)
+				{
+					if(!str_comp(aOrientation3, "XFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_XFLIP;
+					else if(!str_comp(aOrientation3, "YFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_YFLIP;
+					else if(!str_comp(aOrientation3, "ROTATE"))
+						NewIndexRule.m_Flag |= TILEFLAG_ROTATE;
+				}
+
+				// add the index rule object and make it current
+				pCurrentRun->m_vIndexRules.push_back(NewIndexRule);
+				int IndexRuleID = pCurrentRun->m_vIndexRules.size() - 1;
+				pCurrentIndex = &pCurrentRun->m_vIndexRules[IndexRuleID];
+			}
+			else if(str_startswith(pLine, "Pos") && pCurrentIndex)
+			{
+				int x = 0, y = 0;
+				char aValue[128];
+				int Value = CPosRule::NORULE;
+				std::vector<CIndexInfo> vNewIndexList;
+
+				sscanf(pLine, "Pos %d %d %127s", &x, &y, aValue);
+
+				if(!str_comp(aValue, "EMPTY"))
+				{
+					Value = CPosRule::INDEX;
+					CIndexInfo NewIndexInfo = {0, 0, false};
+					vNewIndexList.push_back(NewIndexInfo);
+				}
+				else if(!str_comp(aValue, "FULL"))
+				{
+					Value = CPosRule::NOTINDEX;
+					CIndexInfo NewIndexInfo1 = {0, 0, false};
+					//CIndexInfo NewIndexInfo2 = {-1, 0};
+					vNewIndexList.push_back(NewIndexInfo1);
+					//vNewIndexList.push_back(NewIndexInfo2);
+				}
+				else if(!str_comp(aValue, "INDEX") || !str_comp(aValue, "NOTINDEX"))
+				{
+					if(!str_comp(aValue, "INDEX"))
+						Value = CPosRule::INDEX;
+					else
+						Value = CPosRule::NOTINDEX;
+
+					int pWord = 4;
+					while(true)
+					{
+						int ID = 0;
+						char aOrientation1[128] = "";
+						char aOrientation2[128] = "";
+						char aOrientation3[128] = "";
+						char aOrientation4[128] = "";
+						sscanf(str_trim_words(pLine, pWord), "%d %127s %127s %127s %127s", &ID, aOrientation1, aOrientation2, aOrientation3, aOrientation4);
+
+						CIndexInfo NewIndexInfo;
+						NewIndexInfo.m_ID = ID;
+						NewIndexInfo.m_Flag = 0;
+						NewIndexInfo.m_TestFlag = false;
+
+						if(!str_comp(aOrientation1, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 2;
+							continue;
+						}
+						else if(str_length(aOrientation1) > 0)
+						{
+							NewIndexInfo.m_TestFlag = true;
+							if(!str_comp(aOrientation1, "XFLIP"))
+								NewIndexInfo.m_Flag = TILEFLAG_XFLIP;
+							else if(!str_comp(aOrientation1, "YFLIP"))
+								NewIndexInfo.m_Flag = TILEFLAG_YFLIP;
+							else if(!str_comp(aOrientation1, "ROTATE"))
+								NewIndexInfo.m_Flag = TILEFLAG_ROTATE;
+							else if(!str_comp(aOrientation1, "NONE"))
+								NewIndexInfo.m_Flag = 0;
+							else
+								NewIndexInfo.m_TestFlag = false;
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+
+						if(!str_comp(aOrientation2, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 3;
+							continue;
+						}
+						else if(str_length(aOrientation2) > 0 && NewIndexInfo.m_Flag != 0)
+						{
+							if(!str_comp(aOrientation2, "XFLIP"))
+								NewIndexInfo.m_Flag |= TILEFLAG_XFLIP;
+							else if(!str_comp(aOrientation2, "YFLIP"))
+								NewIndexInfo.m_Flag |= TILEFLAG_YFLIP;
+							else if(!str_comp(aOrientation2, "ROTATE"))
+								NewIndexInfo.m_Flag |= TILEFLAG_ROTATE;
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+
+						if(!str_comp(aOrientation3, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 4;
+							continue;
+						}
+						else if(str_length(aOrientation3) > 0 && NewIndexInfo.m_Flag != 0)
+						{
+							if(!str_comp(aOrientation3, "XFLIP"))
+								NewIndexInfo.m_Flag |= TILEFLAG_XFLIP;
+							else if(!str_comp(aOrientation3, "YFLIP"))
+								NewIndexInfo.m_Flag |= TILEFLAG_YFLIP;
+							else if(!str_comp(aOrientation3, "ROTATE"))
+								NewIndexInfo.m_Flag |= TILEFLAG_ROTATE;
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+
+						if(!str_comp(aOrientation4, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 5;
+							continue;
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+					}
+				}
+
+				if(Value != CPosRule::NORULE)
+				{
+					CPosRule NewPosRule = {x, y, Value, vNewIndexList, {0}};
+					pCurrentIndex->m_vRules.push_back(NewPosRule);
+
+					pCurrentConf->m_StartX = minimum(pCurrentConf->m_StartX, NewPosRule.m_X);
+					pCurrentConf->m_StartY = minimum(pCurrentConf->m_StartY, NewPosRule.m_Y);
+					pCurrentConf->m_EndX = maximum(pCurrentConf->m_EndX, NewPosRule.m_X);
+					pCurrentConf->m_EndY = maximum(pCurrentConf->m_EndY, NewPosRule.m_Y);
+
+					if(x == 0 && y == 0)
+					{
+						for(const auto &Index : vNewIndexList)
+						{
+							if(Value == CPosRule::INDEX && Index.m_ID == 0)
+								pCurrentIndex->m_SkipFull = true;
+							else
+								pCurrentIndex->m_SkipEmpty = true;
+						}
+					}
+				}
+			}
+			else if(str_startswith(pLine, "Random") && pCurrentIndex)
+			{
+				float Value;
+				char Specifier = ' ';
+				sscanf(pLine, "Random %f%c", &Value, &Specifier);
+				if(Specifier == '%')
+				{
+					pCurrentIndex->m_RandomProbability = Value / 100.0f;
+				}
+				else
+				{
+					pCurrentIndex->m_RandomProbability = 1.0f / Value;
+				}
+			}
+			else if(str_startswith(pLine, "NoDefaultRule") && pCurrentIndex)
+			{
+				pCurrentIndex->m_DefaultRule = false;
+			}
+			else if(str_startswith(pLine, "NoLayerCopy") && pCurrentRun)
+			{
+				pCurrentRun->m_AutomapCopy = false;
+			}
+		}
+	}
+
+	// add default rule for Pos 0 0 if there is none
+	for(auto &Config : m_vConfigs)
+	{
+		for(auto &Run : Config.m_vRuns)
+		{
+			for(auto &IndexRule : Run.m_vIndexRules)
+			{
+				bool Found = false;
+				for(const auto &Rule : IndexRule.m_vRules)
+				{
+					if(Rule.m_X == 0 && Rule.m_Y == 0)
+					{
+						Found = true;
+						break;
+					}
+				}
+				if(!Found && IndexRule.m_DefaultRule)
+				{
+					std::vector<CIndexInfo> vNewIndexList;
+					CIndexInfo NewIndexInfo = {0, 0, false};
+					vNewIndexList.push_back(NewIndexInfo);
+					CPosRule NewPosRule = {0, 0, CPosRule::NOTINDEX, vNewIndexList, {0}};
+					IndexRule.m_vRules.push_back(NewPosRule);
+
+					IndexRule.m_SkipEmpty = true;
+					IndexRule.m_SkipFull = false;
+				}
+				if(IndexRule.m_SkipEmpty && IndexRule.m_SkipFull)
+				{
+					IndexRule.m_SkipEmpty = false;
+					IndexRule.m_SkipFull = false;
+				}
+				for(auto &Rule : IndexRule.m_vRules)
+					CompileRule(&Rule);
+			}
+		}
+	}
+
+	m_FileLoaded = true;
+}
+
+const char *CAutoMapRules::GetConfigName(int Index) const
+{
+	if(Index < 0 || Index >= (int)m_vConfigs.size())
+		return "";
+
+	return m_vConfigs[Index].m_aName;
+}
+
+int CAutoMapRules::FindConfig(const char *pName) const
+{
+	for(size_t i = 0; i < m_vConfigs.size(); i++)
+	{
+		if(!str_comp(m_vConfigs[i].m_aName, pName))
+			return i;
+	}
+	return -1;
+}
+
+void CAutoMapRules::ProceedLocalized(CTile *pTiles, int Width, int Height, int ConfigID, int Seed, int X, int Y, int RegionWidth, int RegionHeight, IEngine *pEngine)
+{
+	if(!m_FileLoaded || ConfigID < 0 || ConfigID >= (int)m_vConfigs.size())
+		return;
+
+	if(RegionWidth < 0)
+		RegionWidth = Width;
+
+	if(RegionHeight < 0)
+		RegionHeight = Height;
+
+	const CConfiguration *pConf = &m_vConfigs[ConfigID];
+
+	int CommitFromX = clamp(X + pConf->m_StartX, 0, Width);
+	int CommitFromY = clamp(Y + pConf->m_StartY, 0, Height);
+	int CommitToX = clamp(X + RegionWidth + pConf->m_EndX, 0, Width);
+	int CommitToY = clamp(Y + RegionHeight + pConf->m_EndY, 0, Height);
+
+	int UpdateFromX = clamp(X + 3 * pConf->m_StartX, 0, Width);
+	int UpdateFromY = clamp(Y + 3 * pConf->m_StartY, 0, Height);
+	int UpdateToX = clamp(X + RegionWidth + 3 * pConf->m_EndX, 0, Width);
+	int UpdateToY = clamp(Y + RegionHeight + 3 * pConf->m_EndY, 0, Height);
+
+	const int UpdateWidth = UpdateToX - UpdateFromX;
+	const int UpdateHeight = UpdateToY - UpdateFromY;
+	std::vector<CTile> vUpdateTiles((size_t)UpdateWidth * UpdateHeight);
+
+	for(int y = UpdateFromY; y < UpdateToY; y++)
+		mem_copy(&vUpdateTiles[(size_t)(y - UpdateFromY) * UpdateWidth], &pTiles[(size_t)y * Width + UpdateFromX], UpdateWidth * sizeof(CTile));
+
+	Proceed(vUpdateTiles.data(), UpdateWidth, UpdateHeight, ConfigID, Seed, UpdateFromX, UpdateFromY, pEngine);
+
+	for(int y = CommitFromY; y < CommitToY; y++)
+	{
+		for(int x = CommitFromX; x < CommitToX; x++)
+		{
+			const CTile *pIn = &vUpdateTiles[(size_t)(y - UpdateFromY) * UpdateWidth + x - UpdateFromX];
+			CTile *pOut = &pTiles[(size_t)y * Width + x];
+			pOut->m_Index = pIn->m_Index;
+			pOut->m_Flags = pIn->m_Flags;
+		}
+	}
+}
+
+void CAutoMapRules::ProceedRows(const CRun *pRun, int RunID, CTile *pTiles, const CTile *pReadTiles, int Width, int Height, int Seed, int SeedOffsetX, int SeedOffsetY, int FromY, int ToY)
+{
+	for(int y = FromY; y < ToY; y++)
+	{
+		for(int x = 0; x < Width; x++)
+		{
+			CTile *pTile = &pTiles[(size_t)y * Width + x];
+
+			for(size_t i = 0; i < pRun->m_vIndexRules.size(); ++i)
+			{
+				const CIndexRule *pIndexRule = &pRun->m_vIndexRules[i];
+				if(pIndexRule->m_SkipEmpty && pTile->m_Index == 0) // skip empty tiles
+					continue;
+				if(pIndexRule->m_SkipFull && pTile->m_Index != 0) // skip full tiles
+					continue;
+
+				bool RespectRules = true;
+				for(size_t j = 0; j < pIndexRule->m_vRules.size() && RespectRules; ++j)
+				{
+					const CPosRule *pRule = &pIndexRule->m_vRules[j];
+
+					int CheckX = x + pRule->m_X;
+					int CheckY = y + pRule->m_Y;
+					if(CheckX >= 0 && CheckX < Width && CheckY >= 0 && CheckY < Height)
+					{
+						const CTile *pCheckTile = &pReadTiles[(size_t)CheckY * Width + CheckX];
+						RespectRules = (pRule->m_aMatch[pCheckTile->m_Index + 1] >> FlagBits(pCheckTile->m_Flags)) & 1;
+					}
+					else
+					{
+						RespectRules = pRule->m_aMatch[0] & 1;
+					}
+				}
+
+				if(RespectRules &&
+					(pIndexRule->m_RandomProbability >= 1.0f || HashLocation(Seed, RunID, i, x + SeedOffsetX, y + SeedOffsetY) < HASH_MAX * pIndexRule->m_RandomProbability))
+				{
+					pTile->m_Index = pIndexRule->m_ID;
+					pTile->m_Flags = pIndexRule->m_Flag;
+				}
+			}
+		}
+	}
+}
+
+class CAutoMapRules::CRowsJob : public IJob
+{
+public:
+	struct CState
+	{
+		const CRun *m_pRun;
+		int m_RunID;
+		CTile *m_pTiles;
+		const CTile *m_pReadTiles;
+		int m_Width;
+		int m_Height;
+		int m_Seed;
+		int m_SeedOffsetX;
+		int m_SeedOffsetY;
+		std::atomic<int> m_NextRow{0};
+		std::atomic<int> m_DoneRows{0};
+
+		void Work()
+		{
+			while(true)
+			{
+				// the state is only accessed after a row was claimed, jobs
+				// that start after all rows are done return immediately
+				const int FromY = m_NextRow.fetch_add(ROWS_PER_CHUNK);
+				if(FromY >= m_Height)
+					return;
+				const int ToY = minimum(FromY + (int)ROWS_PER_CHUNK, m_Height);
+				ProceedRows(m_pRun, m_RunID, m_pTiles, m_pReadTiles, m_Width, m_Height, m_Seed, m_SeedOffsetX, m_SeedOffsetY, FromY, ToY);
+				m_DoneRows.fetch_add(ToY - FromY);
+			}
+		}
+	};
+
+private:
+	std::shared_ptr<CState> m_pState;
+	void Run() override { m_pState->Work(); }
+
+public:
+	CRowsJob(std::shared_ptr<CState> pState) :
+		m_pState(std::move(pState)) {}
+};
+
+void CAutoMapRules::Proceed(CTile *pTiles, int Width, int Height, int ConfigID, int Seed, int SeedOffsetX, int SeedOffsetY, IEngine *pEngine)
+{
+	if(!m_FileLoaded || ConfigID < 0 || ConfigID >= (int)m_vConfigs.size())
+		return;
+
+	if(Seed == 0)
+		Seed = rand();
+
+	const CConfiguration *pConf = &m_vConfigs[ConfigID];
+	std::vector<CTile> vReadTiles;
+
+	// for every run: copy tiles, automap, overwrite tiles
+	for(size_t h = 0; h < pConf->m_vRuns.size(); ++h)
+	{
+		const CRun *pRun = &pConf->m_vRuns[h];
+
+		// don't make copy if it's requested
+		const CTile *pReadTiles = pTiles;
+		if(pRun->m_AutomapCopy)
+		{
+			vReadTiles.assign(pTiles, pTiles + (size_t)Width * Height);
+			pReadTiles = vReadTiles.data();
+		}
+
+		// without a copy every tile depends on the ones before it
+		const int NumChunks = (Height + ROWS_PER_CHUNK - 1) / ROWS_PER_CHUNK;
+		if(!pEngine || !pRun->m_AutomapCopy || NumChunks < 2)
+		{
+			ProceedRows(pRun, h, pTiles, pReadTiles, Width, Height, Seed, SeedOffsetX, SeedOffsetY, 0, Height);
+			continue;
+		}
+
+		std::shared_ptr<CRowsJob::CState> pState = std::make_shared<CRowsJob::CState>();
+		pState->m_pRun = pRun;
+		pState->m_RunID = h;
+		pState->m_pTiles = pTiles;
+		pState->m_pReadTiles = pReadTiles;
+		pState->m_Width = Width;
+		pState->m_Height = Height;
+		pState->m_Seed = Seed;
+		pState->m_SeedOffsetX = SeedOffsetX;
+		pState->m_SeedOffsetY = SeedOffsetY;
+
+		const int NumJobs = minimum(NumChunks - 1, (int)MAX_JOBS);
+		for(int i = 0; i < NumJobs; i++)
+			pEngine->AddJob(std::make_shared<CRowsJob>(pState));
+
+		// work on the rows as well and wait for the chunks claimed by the jobs
+		pState->Work();
+		while(pState->m_DoneRows.load() < Height)
+			thread_yield();
+	}
+}
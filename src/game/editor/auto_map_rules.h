@@ -0,0 +1,108 @@
+#ifndef GAME_EDITOR_AUTO_MAP_RULES_H
+#define GAME_EDITOR_AUTO_MAP_RULES_H
+
+#include <base/system.h>
+
+#include <cstdint>
+#include <vector>
+
+class CTile;
+class IEngine;
+
+/**
+ * Automapper rules of one tileset, independent of the editor so that the
+ * map_automap tool can use them as well.
+ *
+ * The index lists of the pos rules are compiled into lookup tables while
+ * loading: for every tile index (and -1 for outside of the layer) a table
+ * holds a bitmask of the tile flag combinations that satisfy the rule.
+ */
+class CAutoMapRules
+{
+	struct CIndexInfo
+	{
+		int m_ID;
+		int m_Flag;
+		bool m_TestFlag;
+	};
+
+	struct CPosRule
+	{
+		int m_X;
+		int m_Y;
+		int m_Value;
+		std::vector<CIndexInfo> m_vIndexList;
+
+		enum
+		{
+			NORULE = 0,
+			INDEX,
+			NOTINDEX
+		};
+
+		// bit FlagBits(Flags) of m_aMatch[Index + 1] is set if a tile with
+		// this index and these flags satisfies the rule
+		uint8_t m_aMatch[257];
+	};
+
+	struct CIndexRule
+	{
+		int m_ID;
+		std::vector<CPosRule> m_vRules;
+		int m_Flag;
+		float m_RandomProbability;
+		bool m_DefaultRule;
+		bool m_SkipEmpty;
+		bool m_SkipFull;
+	};
+
+	struct CRun
+	{
+		std::vector<CIndexRule> m_vIndexRules;
+		bool m_AutomapCopy;
+	};
+
+	struct CConfiguration
+	{
+		std::vector<CRun> m_vRuns;
+		char m_aName[128];
+		int m_StartX;
+		int m_StartY;
+		int m_EndX;
+		int m_EndY;
+	};
+
+	class CRowsJob;
+
+	enum
+	{
+		// rows are handed out to the job pool in chunks of this size, layers
+		// with fewer rows than two chunks are automapped on the calling thread
+		ROWS_PER_CHUNK = 16,
+		MAX_JOBS = 8,
+	};
+
+	static int FlagBits(int Flags);
+	static void CompileRule(CPosRule *pRule);
+	static void ProceedRows(const CRun *pRun, int RunID, CTile *pTiles, const CTile *pReadTiles, int Width, int Height, int Seed, int SeedOffsetX, int SeedOffsetY, int FromY, int ToY);
+
+	std::vector<CConfiguration> m_vConfigs = {};
+	bool m_FileLoaded = false;
+
+public:
+	// the file stays open, the caller has to close it
+	void Load(IOHANDLE File);
+
+	// pEngine is optional, without it all rows are automapped on the calling thread
+	void ProceedLocalized(CTile *pTiles, int Width, int Height, int ConfigID, int Seed = 0, int X = 0, int Y = 0, int RegionWidth = -1, int RegionHeight = -1, IEngine *pEngine = nullptr);
+	void Proceed(CTile *pTiles, int Width, int Height, int ConfigID, int Seed = 0, int SeedOffsetX = 0, int SeedOffsetY = 0, IEngine *pEngine = nullptr);
+
+	int ConfigNamesNum() const { return m_vConfigs.size(); }
+	const char *GetConfigName(int Index) const;
+	// returns -1 if there is no configuration with this name
+	int FindConfig(const char *pName) const;
+
+	bool IsLoaded() const { return m_FileLoaded; }
+};
+
+#endif
@@ -844,8 +844,8 @@ void CGameContext::ConDrySave(IConsole::IResult *pResult, void *pUserData)
 	if(!File)
 		return;
 
-	int Len = str_length(SavedTeam.GetString());
-	io_write(File, SavedTeam.GetString(), Len);
+	const char *pSaveString = SavedTeam.GetString();
+	io_write(File, pSaveString, str_length(pSaveString));
 	io_close(File);
 }
 
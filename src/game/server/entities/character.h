@@ -36,6 +36,9 @@ public:
 	void PreTick();
 	void Tick() override;
 	void TickDeferred() override;
+	// the movement part of TickDeferred(), only touches this character and
+	// the ones it can collide with, so different teams can move in parallel
+	void MoveDeferred();
 	void TickPaused() override;
 	void Snap(int SnappingClient) override;
 	void SwapClients(int Client1, int Client2) override;
@@ -143,6 +146,14 @@ private:
 	CCharacterCore m_SendCore; // core that we should send
 	CCharacterCore m_ReckoningCore; // the dead reckoning core
 
+	// state of MoveDeferred() for the rest of TickDeferred()
+	bool m_MovedDeferred = false;
+	vec2 m_DeferredStartPos;
+	vec2 m_DeferredStartVel;
+	bool m_StuckBefore;
+	bool m_StuckAfterMove;
+	bool m_StuckAfterQuant;
+
 	// DDRace
 
 	void SnapCharacter(int SnappingClient, int ID);
@@ -191,6 +202,8 @@ public:
 	int m_LastMove;
 	int m_StartTime;
 	vec2 m_PrevPos;
+	// tiles passed in the last tick, kept to reuse the memory
+	std::vector<int> m_vTileIndices;
 	int m_TeleCheckpoint;
 
 	int m_TimeCpBroadcastEndTick;
@@ -9,6 +9,8 @@
 #include <game/server/gamecontext.h>
 #include <game/server/player.h>
 
+#include <vector>
+
 CDoor::CDoor(CGameWorld *pGameWorld, vec2 Pos, float Rotation, int Length,
 	int Number) :
 	CEntity(pGameWorld, CGameWorld::ENTTYPE_LASER)
@@ -21,23 +23,32 @@ CDoor::CDoor(CGameWorld *pGameWorld, vec2 Pos, float Rotation, int Length,
 
 	GameServer()->Collision()->IntersectNoLaser(Pos, To, &this->m_To, 0);
 	ResetCollision();
+	SubscribeSwitch();
 	GameWorld()->InsertEntity(this);
 }
 
 void CDoor::ResetCollision()
 {
+	CCollision *pCollision = GameServer()->Collision();
+	if(pCollision->GetTile(m_Pos.x, m_Pos.y) || pCollision->GetFTile(m_Pos.x, m_Pos.y))
+		return;
+
+	// the door is sampled every unit, collect the tiles it covers once
+	std::vector<int> vTiles;
 	for(int i = 0; i < m_Length - 1; i++)
 	{
 		vec2 CurrentPos(m_Pos.x + (m_Direction.x * i),
 			m_Pos.y + (m_Direction.y * i));
-		if(GameServer()->Collision()->CheckPoint(CurrentPos) || GameServer()->Collision()->GetTile(m_Pos.x, m_Pos.y) || GameServer()->Collision()->GetFTile(m_Pos.x, m_Pos.y))
+		int Index = pCollision->GetPureMapIndex(CurrentPos);
+		if(!vTiles.empty() && vTiles.back() == Index)
+			continue;
+		if(pCollision->CheckPoint(CurrentPos))
 			break;
-		else
-			GameServer()->Collision()->SetDCollisionAt(
-				m_Pos.x + (m_Direction.x * i),
-				m_Pos.y + (m_Direction.y * i), TILE_STOPA, 0 /*Flags*/,
-				m_Number);
+		vTiles.push_back(Index);
 	}
+
+	for(int Index : vTiles)
+		pCollision->SetDCollisionAt(Index, TILE_STOPA, 0 /*Flags*/, m_Number);
 }
 
 void CDoor::Reset()
@@ -67,7 +78,7 @@ void CDoor::Snap(int SnappingClient)
 		if(SnappingClient != SERVER_DEMO_CLIENT && (GameServer()->m_apPlayers[SnappingClient]->GetTeam() == TEAM_SPECTATORS || GameServer()->m_apPlayers[SnappingClient]->IsPaused()) && GameServer()->m_apPlayers[SnappingClient]->m_SpectatorID != SPEC_FREEVIEW)
 			pChr = GameServer()->GetPlayerChar(GameServer()->m_apPlayers[SnappingClient]->m_SpectatorID);
 
-		if(pChr && pChr->Team() != TEAM_SUPER && pChr->IsAlive() && !Switchers().empty() && Switchers()[m_Number].m_aStatus[pChr->Team()])
+		if(pChr && pChr->Team() != TEAM_SUPER && pChr->IsAlive() && SwitchActive(pChr->Team()))
 		{
 			From = m_To;
 		}
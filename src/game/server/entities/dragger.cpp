@@ -28,6 +28,8 @@ CDragger::CDragger(CGameWorld *pGameWorld, vec2 Pos, float Strength, bool Ignore
 		TargetId = -1;
 	}
 	mem_zero(m_apDraggerBeam, sizeof(m_apDraggerBeam));
+	if(m_Layer == LAYER_SWITCH)
+		SubscribeSwitch();
 	GameWorld()->InsertEntity(this);
 }
 
@@ -92,7 +94,7 @@ void CDragger::LookForPlayersToDrag()
 		}
 		// If the dragger is disabled for the target's team, no dragger beam will be generated
 		if(m_Layer == LAYER_SWITCH && m_Number > 0 &&
-			!Switchers()[m_Number].m_aStatus[TargetTeam])
+			!SwitchActive(TargetTeam))
 		{
 			continue;
 		}
@@ -226,7 +228,7 @@ void CDragger::Snap(int SnappingClient)
 
 		int Tick = (Server()->Tick() % Server()->TickSpeed()) % 11;
 		if(pChar && m_Layer == LAYER_SWITCH && m_Number > 0 &&
-			!Switchers()[m_Number].m_aStatus[pChar->Team()] && !Tick)
+			!SwitchActive(pChar->Team()) && !Tick)
 			return;
 
 		StartTick = m_EvalTick;
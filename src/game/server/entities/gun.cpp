@@ -25,6 +25,8 @@ CGun::CGun(CGameWorld *pGameWorld, vec2 Pos, bool Freeze, bool Explosive, int La
 
 	mem_zero(m_aLastFireTeam, sizeof(m_aLastFireTeam));
 	mem_zero(m_aLastFireSolo, sizeof(m_aLastFireSolo));
+	if(m_Layer == LAYER_SWITCH)
+		SubscribeSwitch();
 	GameWorld()->InsertEntity(this);
 }
 
@@ -41,7 +43,8 @@ void CGun::Tick()
 		}
 		m_Pos += m_Core;
 	}
-	if(g_Config.m_SvPlasmaPerSec > 0)
+	// a turret that is switched off for every team has no targets
+	if(g_Config.m_SvPlasmaPerSec > 0 && (m_Layer != LAYER_SWITCH || m_Number <= 0 || SwitchActiveForAnyTeam()))
 	{
 		Fire();
 	}
@@ -78,7 +81,7 @@ void CGun::Fire()
 		}
 		// If the turret is disabled for the target's team, the turret will not fire
 		if(m_Layer == LAYER_SWITCH && m_Number > 0 &&
-			!Switchers()[m_Number].m_aStatus[TargetTeam])
+			!SwitchActive(TargetTeam))
 		{
 			continue;
 		}
@@ -169,7 +172,7 @@ void CGun::Snap(int SnappingClient)
 
 		int Tick = (Server()->Tick() % Server()->TickSpeed()) % 11;
 		if(pChar && m_Layer == LAYER_SWITCH && m_Number > 0 &&
-			!Switchers()[m_Number].m_aStatus[pChar->Team()] && (!Tick))
+			!SwitchActive(pChar->Team()) && (!Tick))
 			return;
 
 		StartTick = m_EvalTick;
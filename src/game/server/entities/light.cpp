@@ -22,18 +22,22 @@ CLight::CLight(CGameWorld *pGameWorld, vec2 Pos, float Rotation, int Length,
 	m_Rotation = Rotation;
 	m_Length = Length;
 	m_EvalTick = Server()->Tick();
+	if(m_Layer == LAYER_SWITCH)
+		SubscribeSwitch();
 	GameWorld()->InsertEntity(this);
 	Step();
 }
 
 bool CLight::HitCharacter()
 {
-	std::vector<CCharacter *> vpHitCharacters = GameServer()->m_World.IntersectedCharacters(m_Pos, m_To, 0.0f, 0);
-	if(vpHitCharacters.empty())
+	CCharacter *apHitCharacters[MAX_CLIENTS];
+	const int NumHit = GameServer()->m_World.IntersectedCharacters(m_Pos, m_To, 0.0f, apHitCharacters, MAX_CLIENTS);
+	if(NumHit == 0)
 		return false;
-	for(auto *pChar : vpHitCharacters)
+	for(int i = 0; i < NumHit; i++)
 	{
-		if(m_Layer == LAYER_SWITCH && m_Number > 0 && !Switchers()[m_Number].m_aStatus[pChar->Team()])
+		CCharacter *pChar = apHitCharacters[i];
+		if(m_Layer == LAYER_SWITCH && m_Number > 0 && !SwitchActive(pChar->Team()))
 			continue;
 		pChar->Freeze();
 	}
@@ -118,7 +122,7 @@ void CLight::Snap(int SnappingClient)
 	{
 		From = m_Pos;
 	}
-	else if(pChr && m_Layer == LAYER_SWITCH && Switchers()[m_Number].m_aStatus[pChr->Team()])
+	else if(pChr && m_Layer == LAYER_SWITCH && SwitchActive(pChr->Team()))
 	{
 		From = m_To;
 	}
@@ -130,7 +134,7 @@ void CLight::Snap(int SnappingClient)
 	if(SnappingClientVersion < VERSION_DDNET_ENTITY_NETOBJS)
 	{
 		int Tick = (Server()->Tick() % Server()->TickSpeed()) % 6;
-		if(pChr && pChr->IsAlive() && m_Layer == LAYER_SWITCH && m_Number > 0 && !Switchers()[m_Number].m_aStatus[pChr->Team()] && Tick)
+		if(pChr && pChr->IsAlive() && m_Layer == LAYER_SWITCH && m_Number > 0 && !SwitchActive(pChr->Team()) && Tick)
 			return;
 
 		StartTick = m_EvalTick;
@@ -26,10 +26,28 @@ CEntity::CEntity(CGameWorld *pGameWorld, int ObjType, vec2 Pos, int ProximityRad
 
 CEntity::~CEntity()
 {
+	if(m_SwitchSubscribed)
+		GameWorld()->UnsubscribeSwitch(this);
 	GameWorld()->RemoveEntity(this);
 	Server()->SnapFreeID(m_ID);
 }
 
+void CEntity::SubscribeSwitch()
+{
+	dbg_assert(!m_SwitchSubscribed, "entity already subscribed to a switch");
+	GameWorld()->SubscribeSwitch(this);
+}
+
+bool CEntity::SwitchActive(int Team) const
+{
+	if(Team >= 0 && Team < MAX_CLIENTS)
+		return m_SwitchActive[Team];
+
+	// the super team has no switch state of its own and sees the default
+	const std::vector<SSwitchers> &vSwitchers = m_pGameWorld->m_Core.m_vSwitchers;
+	return m_Number >= 0 && m_Number < (int)vSwitchers.size() && vSwitchers[m_Number].m_Initial;
+}
+
 bool CEntity::NetworkClipped(int SnappingClient) const
 {
 	return ::NetworkClipped(m_pGameWorld->GameServer(), SnappingClient, m_Pos);
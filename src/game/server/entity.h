@@ -5,10 +5,14 @@
 
 #include <base/vmath.h>
 
+#include <engine/shared/protocol.h>
+
 #include <game/alloc.h>
 
 #include "gameworld.h"
 
+#include <bitset>
+
 class CCollision;
 class CGameContext;
 
@@ -38,10 +42,29 @@ private:
 	*/
 	float m_ProximityRadius;
 
+	/* Switch */
+	bool m_SwitchSubscribed = false;
+	std::bitset<MAX_CLIENTS> m_SwitchActive;
+
 protected:
 	/* State */
 	bool m_MarkedForDestroy;
 
+	/*
+		Function: SubscribeSwitch
+			Caches the status of the switch m_Number for all teams
+			and keeps it up to date, see SwitchActive.
+	*/
+	void SubscribeSwitch();
+
+	/*
+		Function: SwitchActive
+			Returns the cached status of the switch m_Number for a
+			team. Only valid after SubscribeSwitch.
+	*/
+	bool SwitchActive(int Team) const;
+	bool SwitchActiveForAnyTeam() const { return m_SwitchActive.any(); }
+
 public: // TODO: Maybe make protected
 	/*
 		Variable: m_Pos
@@ -18,6 +18,7 @@
 #include <engine/shared/json.h>
 #include <engine/shared/linereader.h>
 #include <engine/shared/memheap.h>
+#include <engine/shared/tick_profiler.h>
 #include <engine/storage.h>
 
 #include <game/collision.h>
@@ -87,9 +88,6 @@ void CGameContext::Construct(int Resetting)
 	m_aVoteCommand[0] = 0;
 	m_VoteType = VOTE_TYPE_UNKNOWN;
 	m_VoteCloseTime = 0;
-	m_pVoteOptionFirst = 0;
-	m_pVoteOptionLast = 0;
-	m_NumVoteOptions = 0;
 	m_LastMapVote = 0;
 
 	m_SqlRandomMapResult = nullptr;
@@ -104,7 +102,7 @@ void CGameContext::Construct(int Resetting)
 	if(Resetting == NO_RESET)
 	{
 		m_NonEmptySince = 0;
-		m_pVoteOptionHeap = new CHeap();
+		m_pVoteOptions = new CVoteOptions();
 	}
 
 	m_aDeleteTempfile[0] = 0;
@@ -117,7 +115,7 @@ void CGameContext::Destruct(int Resetting)
 		delete pPlayer;
 
 	if(Resetting == NO_RESET)
-		delete m_pVoteOptionHeap;
+		delete m_pVoteOptions;
 
 	if(m_pScore)
 	{
@@ -143,20 +141,14 @@ CGameContext::~CGameContext()
 
 void CGameContext::Clear()
 {
-	CHeap *pVoteOptionHeap = m_pVoteOptionHeap;
-	CVoteOptionServer *pVoteOptionFirst = m_pVoteOptionFirst;
-	CVoteOptionServer *pVoteOptionLast = m_pVoteOptionLast;
-	int NumVoteOptions = m_NumVoteOptions;
+	CVoteOptions *pVoteOptions = m_pVoteOptions;
 	CTuningParams Tuning = m_Tuning;
 
 	m_Resetting = true;
 	this->~CGameContext();
 	new(this) CGameContext(RESET);
 
-	m_pVoteOptionHeap = pVoteOptionHeap;
-	m_pVoteOptionFirst = pVoteOptionFirst;
-	m_pVoteOptionLast = pVoteOptionLast;
-	m_NumVoteOptions = NumVoteOptions;
+	m_pVoteOptions = pVoteOptions;
 	m_Tuning = Tuning;
 }
 
@@ -907,6 +899,8 @@ void CGameContext::OnPreTickTeehistorian()
 	if(!m_TeeHistorianActive)
 		return;
 
+	CTickProfileScope ProfileScope(Server()->TickProfiler(), CTickProfiler::PHASE_TEEHISTORIAN);
+
 	auto *pController = ((CGameControllerDDRace *)m_pController);
 	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
@@ -928,6 +922,7 @@ void CGameContext::OnTick()
 
 	if(m_TeeHistorianActive)
 	{
+		CTickProfileScope ProfileScope(Server()->TickProfiler(), CTickProfiler::PHASE_TEEHISTORIAN);
 		int Error = aio_error(m_pTeeHistorianFile);
 		if(Error)
 		{
@@ -1162,27 +1157,11 @@ void CGameContext::OnTick()
 			SendChat(-1, CGameContext::CHAT_ALL, pLine);
 	}
 
-	for(auto &Switcher : Switchers())
-	{
-		for(int j = 0; j < MAX_CLIENTS; ++j)
-		{
-			if(Switcher.m_aEndTick[j] <= Server()->Tick() && Switcher.m_aType[j] == TILE_SWITCHTIMEDOPEN)
-			{
-				Switcher.m_aStatus[j] = false;
-				Switcher.m_aEndTick[j] = 0;
-				Switcher.m_aType[j] = TILE_SWITCHCLOSE;
-			}
-			else if(Switcher.m_aEndTick[j] <= Server()->Tick() && Switcher.m_aType[j] == TILE_SWITCHTIMEDCLOSE)
-			{
-				Switcher.m_aStatus[j] = true;
-				Switcher.m_aEndTick[j] = 0;
-				Switcher.m_aType[j] = TILE_SWITCHOPEN;
-			}
-		}
-	}
+	m_World.UpdateTimedSwitches();
 
 	if(m_SqlRandomMapResult != nullptr && m_SqlRandomMapResult->m_Completed)
 	{
+		CTickProfileScope ProfileScope(Server()->TickProfiler(), CTickProfiler::PHASE_SCORE);
 		if(m_SqlRandomMapResult->m_Success)
 		{
 			if(PlayerExists(m_SqlRandomMapResult->m_ClientID) && m_SqlRandomMapResult->m_aMessage[0] != '\0')
@@ -1312,19 +1291,6 @@ void CGameContext::OnClientPredictedEarlyInput(int ClientID, void *pInput)
 	}
 }
 
-struct CVoteOptionServer *CGameContext::GetVoteOption(int Index)
-{
-	CVoteOptionServer *pCurrent;
-	for(pCurrent = m_pVoteOptionFirst;
-		Index > 0 && pCurrent;
-		Index--, pCurrent = pCurrent->m_pNext)
-		;
-
-	if(Index > 0)
-		return 0;
-	return pCurrent;
-}
-
 void CGameContext::ProgressVoteOptions(int ClientID)
 {
 	CPlayer *pPl = m_apPlayers[ClientID];
@@ -1332,71 +1298,21 @@ void CGameContext::ProgressVoteOptions(int ClientID)
 	if(pPl->m_SendVoteIndex == -1)
 		return; // we didn't start sending options yet
 
-	if(pPl->m_SendVoteIndex > m_NumVoteOptions)
+	if(pPl->m_SendVoteIndex > m_pVoteOptions->Num())
 		return; // shouldn't happen / fail silently
 
-	int VotesLeft = m_NumVoteOptions - pPl->m_SendVoteIndex;
-	int NumVotesToSend = minimum(g_Config.m_SvSendVotesPerTick, VotesLeft);
-
-	if(!VotesLeft)
+	if(pPl->m_SendVoteIndex == m_pVoteOptions->Num())
 	{
 		// player has up to date vote option list
 		return;
 	}
 
-	// build vote option list msg
-	int CurIndex = 0;
-
-	CNetMsg_Sv_VoteOptionListAdd OptionMsg;
-	OptionMsg.m_pDescription0 = "";
-	OptionMsg.m_pDescription1 = "";
-	OptionMsg.m_pDescription2 = "";
-	OptionMsg.m_pDescription3 = "";
-	OptionMsg.m_pDescription4 = "";
-	OptionMsg.m_pDescription5 = "";
-	OptionMsg.m_pDescription6 = "";
-	OptionMsg.m_pDescription7 = "";
-	OptionMsg.m_pDescription8 = "";
-	OptionMsg.m_pDescription9 = "";
-	OptionMsg.m_pDescription10 = "";
-	OptionMsg.m_pDescription11 = "";
-	OptionMsg.m_pDescription12 = "";
-	OptionMsg.m_pDescription13 = "";
-	OptionMsg.m_pDescription14 = "";
-
-	// get current vote option by index
-	CVoteOptionServer *pCurrent = GetVoteOption(pPl->m_SendVoteIndex);
-
-	while(CurIndex < NumVotesToSend && pCurrent != NULL)
-	{
-		switch(CurIndex)
-		{
-		case 0: OptionMsg.m_pDescription0 = pCurrent->m_aDescription; break;
-		case 1: OptionMsg.m_pDescription1 = pCurrent->m_aDescription; break;
-		case 2: OptionMsg.m_pDescription2 = pCurrent->m_aDescription; break;
-		case 3: OptionMsg.m_pDescription3 = pCurrent->m_aDescription; break;
-		case 4: OptionMsg.m_pDescription4 = pCurrent->m_aDescription; break;
-		case 5: OptionMsg.m_pDescription5 = pCurrent->m_aDescription; break;
-		case 6: OptionMsg.m_pDescription6 = pCurrent->m_aDescription; break;
-		case 7: OptionMsg.m_pDescription7 = pCurrent->m_aDescription; break;
-		case 8: OptionMsg.m_pDescription8 = pCurrent->m_aDescription; break;
-		case 9: OptionMsg.m_pDescription9 = pCurrent->m_aDescription; break;
-		case 10: OptionMsg.m_pDescription10 = pCurrent->m_aDescription; break;
-		case 11: OptionMsg.m_pDescription11 = pCurrent->m_aDescription; break;
-		case 12: OptionMsg.m_pDescription12 = pCurrent->m_aDescription; break;
-		case 13: OptionMsg.m_pDescription13 = pCurrent->m_aDescription; break;
-		case 14: OptionMsg.m_pDescription14 = pCurrent->m_aDescription; break;
-		}
-
-		CurIndex++;
-		pCurrent = pCurrent->m_pNext;
-	}
-
-	// send msg
-	OptionMsg.m_NumOptions = NumVotesToSend;
-	Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL, ClientID);
+	// the messages are usually packed already
+	CMsgPacker Msg(NETMSGTYPE_SV_VOTEOPTIONLISTADD, false);
+	const int NumVotesSent = m_pVoteOptions->PackOptions(pPl->m_SendVoteIndex, g_Config.m_SvSendVotesPerTick, &Msg);
+	Server()->SendMsg(&Msg, MSGFLAG_VITAL, ClientID);
 
-	pPl->m_SendVoteIndex += NumVotesToSend;
+	pPl->m_SendVoteIndex += NumVotesSent;
 }
 
 void CGameContext::OnClientEnter(int ClientID)
@@ -2130,43 +2046,36 @@ void CGameContext::OnCallVoteNetMessage(const CNetMsg_Cl_CallVote *pMsg, int Cli
 	if(str_comp_nocase(pMsg->m_pType, "option") == 0)
 	{
 		int Authed = Server()->GetAuthedState(ClientID);
-		CVoteOptionServer *pOption = m_pVoteOptionFirst;
-		while(pOption)
+		const CVoteOptionServer *pOption = m_pVoteOptions->Find(pMsg->m_pValue);
+		if(pOption)
 		{
-			if(str_comp_nocase(pMsg->m_pValue, pOption->m_aDescription) == 0)
+			if(!Console()->LineIsValid(pOption->m_aCommand))
 			{
-				if(!Console()->LineIsValid(pOption->m_aCommand))
-				{
-					SendChatTarget(ClientID, "Invalid option");
-					return;
-				}
-				if((str_find(pOption->m_aCommand, "sv_map ") != 0 || str_find(pOption->m_aCommand, "change_map ") != 0 || str_find(pOption->m_aCommand, "random_map") != 0 || str_find(pOption->m_aCommand, "random_unfinished_map") != 0) && RateLimitPlayerMapVote(ClientID))
-				{
-					return;
-				}
-
-				str_format(aChatmsg, sizeof(aChatmsg), "'%s' called vote to change server option '%s' (%s)", Server()->ClientName(ClientID),
-					pOption->m_aDescription, aReason);
-				str_copy(aDesc, pOption->m_aDescription);
+				SendChatTarget(ClientID, "Invalid option");
+				return;
+			}
+			if((str_find(pOption->m_aCommand, "sv_map ") != 0 || str_find(pOption->m_aCommand, "change_map ") != 0 || str_find(pOption->m_aCommand, "random_map") != 0 || str_find(pOption->m_aCommand, "random_unfinished_map") != 0) && RateLimitPlayerMapVote(ClientID))
+			{
+				return;
+			}
 
-				if((str_endswith(pOption->m_aCommand, "random_map") || str_endswith(pOption->m_aCommand, "random_unfinished_map")) && str_length(aReason) == 1 && aReason[0] >= '0' && aReason[0] <= '5')
-				{
-					int Stars = aReason[0] - '0';
-					str_format(aCmd, sizeof(aCmd), "%s %d", pOption->m_aCommand, Stars);
-				}
-				else
-				{
-					str_copy(aCmd, pOption->m_aCommand);
-				}
+			str_format(aChatmsg, sizeof(aChatmsg), "'%s' called vote to change server option '%s' (%s)", Server()->ClientName(ClientID),
+				pOption->m_aDescription, aReason);
+			str_copy(aDesc, pOption->m_aDescription);
 
-				m_LastMapVote = time_get();
-				break;
+			if((str_endswith(pOption->m_aCommand, "random_map") || str_endswith(pOption->m_aCommand, "random_unfinished_map")) && str_length(aReason) == 1 && aReason[0] >= '0' && aReason[0] <= '5')
+			{
+				int Stars = aReason[0] - '0';
+				str_format(aCmd, sizeof(aCmd), "%s %d", pOption->m_aCommand, Stars);
+			}
+			else
+			{
+				str_copy(aCmd, pOption->m_aCommand);
 			}
 
-			pOption = pOption->m_pNext;
+			m_LastMapVote = time_get();
 		}
-
-		if(!pOption)
+		else
 		{
 			if(Authed != AUTHED_ADMIN) // allow admins to call any vote they want
 			{
@@ -3122,7 +3031,7 @@ void CGameContext::ConAddVote(IConsole::IResult *pResult, void *pUserData)
 
 void CGameContext::AddVote(const char *pDescription, const char *pCommand)
 {
-	if(m_NumVoteOptions == MAX_VOTE_OPTIONS)
+	if(m_pVoteOptions->Num() == MAX_VOTE_OPTIONS)
 	{
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", "maximum number of vote options reached");
 		return;
@@ -3146,35 +3055,13 @@ void CGameContext::AddVote(const char *pDescription, const char *pCommand)
 		return;
 	}
 
-	// check for duplicate entry
-	CVoteOptionServer *pOption = m_pVoteOptionFirst;
-	while(pOption)
+	// add the option, unless there is one with this description
+	if(!m_pVoteOptions->Add(pDescription, pCommand))
 	{
-		if(str_comp_nocase(pDescription, pOption->m_aDescription) == 0)
-		{
-			char aBuf[256];
-			str_format(aBuf, sizeof(aBuf), "option '%s' already exists", pDescription);
-			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
-			return;
-		}
-		pOption = pOption->m_pNext;
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "option '%s' already exists", pDescription);
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 	}
-
-	// add the option
-	++m_NumVoteOptions;
-	int Len = str_length(pCommand);
-
-	pOption = (CVoteOptionServer *)m_pVoteOptionHeap->Allocate(sizeof(CVoteOptionServer) + Len, alignof(CVoteOptionServer));
-	pOption->m_pNext = 0;
-	pOption->m_pPrev = m_pVoteOptionLast;
-	if(pOption->m_pPrev)
-		pOption->m_pPrev->m_pNext = pOption;
-	m_pVoteOptionLast = pOption;
-	if(!m_pVoteOptionFirst)
-		m_pVoteOptionFirst = pOption;
-
-	str_copy(pOption->m_aDescription, pDescription, sizeof(pOption->m_aDescription));
-	mem_copy(pOption->m_aCommand, pCommand, Len + 1);
 }
 
 void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
@@ -3182,15 +3069,8 @@ void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
 	CGameContext *pSelf = (CGameContext *)pUserData;
 	const char *pDescription = pResult->GetString(0);
 
-	// check for valid option
-	CVoteOptionServer *pOption = pSelf->m_pVoteOptionFirst;
-	while(pOption)
-	{
-		if(str_comp_nocase(pDescription, pOption->m_aDescription) == 0)
-			break;
-		pOption = pOption->m_pNext;
-	}
-	if(!pOption)
+	// remove the option
+	if(!pSelf->m_pVoteOptions->Remove(pDescription))
 	{
 		char aBuf[256];
 		str_format(aBuf, sizeof(aBuf), "option '%s' does not exist", pDescription);
@@ -3209,41 +3089,6 @@ void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
 		if(pPlayer)
 			pPlayer->m_SendVoteIndex = 0;
 	}
-
-	// TODO: improve this
-	// remove the option
-	--pSelf->m_NumVoteOptions;
-
-	CHeap *pVoteOptionHeap = new CHeap();
-	CVoteOptionServer *pVoteOptionFirst = 0;
-	CVoteOptionServer *pVoteOptionLast = 0;
-	int NumVoteOptions = pSelf->m_NumVoteOptions;
-	for(CVoteOptionServer *pSrc = pSelf->m_pVoteOptionFirst; pSrc; pSrc = pSrc->m_pNext)
-	{
-		if(pSrc == pOption)
-			continue;
-
-		// copy option
-		int Len = str_length(pSrc->m_aCommand);
-		CVoteOptionServer *pDst = (CVoteOptionServer *)pVoteOptionHeap->Allocate(sizeof(CVoteOptionServer) + Len);
-		pDst->m_pNext = 0;
-		pDst->m_pPrev = pVoteOptionLast;
-		if(pDst->m_pPrev)
-			pDst->m_pPrev->m_pNext = pDst;
-		pVoteOptionLast = pDst;
-		if(!pVoteOptionFirst)
-			pVoteOptionFirst = pDst;
-
-		str_copy(pDst->m_aDescription, pSrc->m_aDescription, sizeof(pDst->m_aDescription));
-		mem_copy(pDst->m_aCommand, pSrc->m_aCommand, Len + 1);
-	}
-
-	// clean up
-	delete pSelf->m_pVoteOptionHeap;
-	pSelf->m_pVoteOptionHeap = pVoteOptionHeap;
-	pSelf->m_pVoteOptionFirst = pVoteOptionFirst;
-	pSelf->m_pVoteOptionLast = pVoteOptionLast;
-	pSelf->m_NumVoteOptions = NumVoteOptions;
 }
 
 void CGameContext::ConForceVote(IConsole::IResult *pResult, void *pUserData)
@@ -3256,26 +3101,17 @@ void CGameContext::ConForceVote(IConsole::IResult *pResult, void *pUserData)
 
 	if(str_comp_nocase(pType, "option") == 0)
 	{
-		CVoteOptionServer *pOption = pSelf->m_pVoteOptionFirst;
-		while(pOption)
-		{
-			if(str_comp_nocase(pValue, pOption->m_aDescription) == 0)
-			{
-				str_format(aBuf, sizeof(aBuf), "authorized player forced server option '%s' (%s)", pValue, pReason);
-				pSelf->SendChatTarget(-1, aBuf, CHAT_SIX);
-				pSelf->Console()->ExecuteLine(pOption->m_aCommand);
-				break;
-			}
-
-			pOption = pOption->m_pNext;
-		}
-
+		const CVoteOptionServer *pOption = pSelf->m_pVoteOptions->Find(pValue);
 		if(!pOption)
 		{
 			str_format(aBuf, sizeof(aBuf), "'%s' isn't an option on this server", pValue);
 			pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 			return;
 		}
+
+		str_format(aBuf, sizeof(aBuf), "authorized player forced server option '%s' (%s)", pValue, pReason);
+		pSelf->SendChatTarget(-1, aBuf, CHAT_SIX);
+		pSelf->Console()->ExecuteLine(pOption->m_aCommand);
 	}
 	else if(str_comp_nocase(pType, "kick") == 0)
 	{
@@ -3321,10 +3157,7 @@ void CGameContext::ConClearVotes(IConsole::IResult *pResult, void *pUserData)
 
 	CNetMsg_Sv_VoteClearOptions VoteClearOptionsMsg;
 	pSelf->Server()->SendPackMsg(&VoteClearOptionsMsg, MSGFLAG_VITAL, -1);
-	pSelf->m_pVoteOptionHeap->Reset();
-	pSelf->m_pVoteOptionFirst = 0;
-	pSelf->m_pVoteOptionLast = 0;
-	pSelf->m_NumVoteOptions = 0;
+	pSelf->m_pVoteOptions->Clear();
 
 	// reset sending of vote options
 	for(auto &pPlayer : pSelf->m_apPlayers)
@@ -4091,10 +3924,17 @@ bool CGameContext::IsClientPlayer(int ClientID) const
 	return m_apPlayers[ClientID] && m_apPlayers[ClientID]->GetTeam() != TEAM_SPECTATORS;
 }
 
+bool CGameContext::IsClientActivePlayer(int ClientID) const
+{
+	return IsClientPlayer(ClientID) && !m_apPlayers[ClientID]->IsPaused();
+}
+
 CUuid CGameContext::GameUuid() const { return m_GameUuid; }
 const char *CGameContext::GameType() const { return m_pController && m_pController->m_pGameType ? m_pController->m_pGameType : ""; }
 const char *CGameContext::Version() const { return GAME_VERSION; }
 const char *CGameContext::NetVersion() const { return GAME_NETVERSION; }
+const char *CGameContext::NetObjName(int Type, bool Sixup) const { return Sixup ? m_NetObjHandler7.GetObjName(Type) : m_NetObjHandler.GetObjName(Type); }
+const char *CGameContext::NetMsgName(int Type, bool Sixup) const { return Sixup ? m_NetObjHandler7.GetMsgName(Type) : m_NetObjHandler.GetMsgName(Type); }
 
 IGameServer *CreateGameServer() { return new CGameContext; }
 
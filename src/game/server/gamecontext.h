@@ -15,6 +15,7 @@
 #include "eventhandler.h"
 #include "gameworld.h"
 #include "teehistorian.h"
+#include "voteoptions.h"
 
 #include <memory>
 #include <string>
@@ -204,7 +205,6 @@ public:
 	char m_aSixupVoteDescription[VOTE_DESC_LENGTH];
 	char m_aVoteCommand[VOTE_CMD_LENGTH];
 	char m_aVoteReason[VOTE_REASON_LENGTH];
-	int m_NumVoteOptions;
 	int m_VoteEnforce;
 	char m_aaZoneEnterMsg[NUM_TUNEZONES][256]; // 0 is used for switching from or to area without tunings
 	char m_aaZoneLeaveMsg[NUM_TUNEZONES][256];
@@ -221,9 +221,7 @@ public:
 		VOTE_ENFORCE_YES,
 		VOTE_ENFORCE_ABORT,
 	};
-	CHeap *m_pVoteOptionHeap;
-	CVoteOptionServer *m_pVoteOptionFirst;
-	CVoteOptionServer *m_pVoteOptionLast;
+	CVoteOptions *m_pVoteOptions;
 
 	// helper functions
 	void CreateDamageInd(vec2 Pos, float AngleMod, int Amount, CClientMask Mask = CClientMask().set());
@@ -268,7 +266,6 @@ public:
 	void CheckPureTuning();
 	void SendTuningParams(int ClientID, int Zone = 0);
 
-	struct CVoteOptionServer *GetVoteOption(int Index);
 	void ProgressVoteOptions(int ClientID);
 
 	//
@@ -320,6 +317,7 @@ public:
 
 	bool IsClientReady(int ClientID) const override;
 	bool IsClientPlayer(int ClientID) const override;
+	bool IsClientActivePlayer(int ClientID) const override;
 	int PersistentDataSize() const override { return sizeof(CPersistentData); }
 	int PersistentClientDataSize() const override { return sizeof(CPersistentClientData); }
 
@@ -327,6 +325,8 @@ public:
 	const char *GameType() const override;
 	const char *Version() const override;
 	const char *NetVersion() const override;
+	const char *NetObjName(int Type, bool Sixup) const override;
+	const char *NetMsgName(int Type, bool Sixup) const override;
 
 	// DDRace
 	void OnPreTickTeehistorian() override;
@@ -4,6 +4,7 @@
 
 #include <engine/server.h>
 #include <engine/shared/config.h>
+#include <engine/shared/tick_profiler.h>
 #include <game/mapitems.h>
 #include <game/server/entities/character.h>
 #include <game/server/gamecontext.h>
@@ -167,11 +168,15 @@ void CGameControllerDDRace::OnReset()
 void CGameControllerDDRace::Tick()
 {
 	IGameController::Tick();
-	m_Teams.ProcessSaveTeam();
+	{
+		CTickProfileScope ProfileScope(Server()->TickProfiler(), CTickProfiler::PHASE_SCORE);
+		m_Teams.ProcessSaveTeam();
+	}
 	m_Teams.Tick();
 
 	if(m_pLoadBestTimeResult != nullptr && m_pLoadBestTimeResult->m_Completed)
 	{
+		CTickProfileScope ProfileScope(Server()->TickProfiler(), CTickProfiler::PHASE_SCORE);
 		if(m_pLoadBestTimeResult->m_Success)
 		{
 			m_CurrentRecord = m_pLoadBestTimeResult->m_CurrentRecord;
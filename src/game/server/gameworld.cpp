@@ -6,8 +6,13 @@
 #include "entity.h"
 #include "gamecontext.h"
 #include "gamecontroller.h"
+#include "player.h"
+#include "teams.h"
 
 #include <engine/shared/config.h>
+#include <engine/shared/tick_profiler.h>
+
+#include <game/mapitems.h>
 
 #include <algorithm>
 #include <utility>
@@ -175,6 +180,84 @@ void CGameWorld::RemoveEntitiesFromPlayers(int PlayerIds[], int NumPlayers)
 	}
 }
 
+void CGameWorld::SetSwitch(int Number, int Team, bool Status, int EndTick, int Type)
+{
+	SSwitchers &Switcher = m_Core.m_vSwitchers[Number];
+	const bool Changed = Switcher.m_aStatus[Team] != Status;
+	Switcher.m_aStatus[Team] = Status;
+	Switcher.m_aEndTick[Team] = EndTick;
+	Switcher.m_aType[Team] = Type;
+	Switcher.m_aLastUpdateTick[Team] = Server()->Tick();
+
+	if(Type == TILE_SWITCHTIMEDOPEN || Type == TILE_SWITCHTIMEDCLOSE)
+	{
+		const size_t QueueIndex = (size_t)Number * MAX_CLIENTS + Team;
+		if(QueueIndex >= m_vTimedSwitchQueued.size())
+			m_vTimedSwitchQueued.resize(m_Core.m_vSwitchers.size() * MAX_CLIENTS);
+		if(!m_vTimedSwitchQueued[QueueIndex])
+		{
+			m_vTimedSwitchQueued[QueueIndex] = true;
+			m_vTimedSwitches.emplace_back(Number, Team);
+		}
+	}
+
+	if(Changed && Number < (int)m_vvSwitchSubscribers.size())
+	{
+		for(CEntity *pEnt : m_vvSwitchSubscribers[Number])
+			pEnt->m_SwitchActive[Team] = Status;
+	}
+}
+
+void CGameWorld::UpdateTimedSwitches()
+{
+	for(size_t i = 0; i < m_vTimedSwitches.size();)
+	{
+		const auto [Number, Team] = m_vTimedSwitches[i];
+		const SSwitchers &Switcher = m_Core.m_vSwitchers[Number];
+		const int Type = Switcher.m_aType[Team];
+		if((Type == TILE_SWITCHTIMEDOPEN || Type == TILE_SWITCHTIMEDCLOSE) && Switcher.m_aEndTick[Team] > Server()->Tick())
+		{
+			i++;
+			continue;
+		}
+
+		// also drops switches that were set to an untimed type in the meantime
+		m_vTimedSwitchQueued[(size_t)Number * MAX_CLIENTS + Team] = false;
+		m_vTimedSwitches[i] = m_vTimedSwitches.back();
+		m_vTimedSwitches.pop_back();
+		if(Type == TILE_SWITCHTIMEDOPEN)
+			SetSwitch(Number, Team, false, 0, TILE_SWITCHCLOSE);
+		else if(Type == TILE_SWITCHTIMEDCLOSE)
+			SetSwitch(Number, Team, true, 0, TILE_SWITCHOPEN);
+	}
+}
+
+void CGameWorld::SubscribeSwitch(CEntity *pEnt)
+{
+	pEnt->m_SwitchSubscribed = true;
+	pEnt->m_SwitchActive.reset();
+	if(pEnt->m_Number < 0 || pEnt->m_Number >= (int)m_Core.m_vSwitchers.size())
+		return;
+
+	if(pEnt->m_Number >= (int)m_vvSwitchSubscribers.size())
+		m_vvSwitchSubscribers.resize(m_Core.m_vSwitchers.size());
+	m_vvSwitchSubscribers[pEnt->m_Number].push_back(pEnt);
+
+	const SSwitchers &Switcher = m_Core.m_vSwitchers[pEnt->m_Number];
+	for(int Team = 0; Team < MAX_CLIENTS; Team++)
+		pEnt->m_SwitchActive[Team] = Switcher.m_aStatus[Team];
+}
+
+void CGameWorld::UnsubscribeSwitch(CEntity *pEnt)
+{
+	pEnt->m_SwitchSubscribed = false;
+	if(pEnt->m_Number < 0 || pEnt->m_Number >= (int)m_vvSwitchSubscribers.size())
+		return;
+
+	std::vector<CEntity *> &vSubscribers = m_vvSwitchSubscribers[pEnt->m_Number];
+	vSubscribers.erase(std::remove(vSubscribers.begin(), vSubscribers.end(), pEnt), vSubscribers.end());
+}
+
 void CGameWorld::RemoveEntities()
 {
 	// destroy objects marked for destruction
@@ -202,8 +285,11 @@ void CGameWorld::Tick()
 			GameServer()->SendChat(-1, CGameContext::CHAT_ALL, "Teams have been balanced");
 
 		// update all objects
+		static_assert(CTickProfiler::PHASE_WORLD_PROJECTILE + NUM_ENTTYPES - 1 == CTickProfiler::PHASE_WORLD_CHARACTER, "tick profiler phases must match the entity types");
 		for(int i = 0; i < NUM_ENTTYPES; i++)
 		{
+			CTickProfileScope ProfileScope(Server()->TickProfiler(), CTickProfiler::PHASE_WORLD_PROJECTILE + i);
+
 			// It's important to call PreTick() and Tick() after each other.
 			// If we call PreTick() before, and Tick() after other entities have been processed, it causes physics changes such as a stronger shotgun or grenade.
 			if(g_Config.m_SvNoWeakHook && i == ENTTYPE_CHARACTER)
@@ -226,6 +312,9 @@ void CGameWorld::Tick()
 			}
 		}
 
+		if(Config()->m_SvTickThreads > 0)
+			MoveCharactersParallel();
+
 		for(auto *pEnt : m_apFirstEntityTypes)
 			for(; pEnt;)
 			{
@@ -257,6 +346,45 @@ void CGameWorld::Tick()
 	}
 }
 
+void CGameWorld::MoveCharactersParallel()
+{
+	if(m_MoveRunner.NumThreads() != Config()->m_SvTickThreads)
+	{
+		m_MoveRunner.Shutdown();
+		m_MoveRunner.Init(Config()->m_SvTickThreads);
+	}
+
+	// characters only collide with characters of their own team, unless one
+	// of them is super. keep the order of the list within every team, so that
+	// the result is the same as moving them one after another
+	int aPartition[TEAM_SUPER + 1];
+	for(int &Partition : aPartition)
+		Partition = -1;
+	int NumPartitions = 0;
+	for(CCharacter *pChr = (CCharacter *)FindFirst(ENTTYPE_CHARACTER); pChr; pChr = (CCharacter *)pChr->TypeNext())
+	{
+		const int Team = pChr->Teams()->m_Core.MoveTeam(pChr->GetPlayer()->GetCID(), pChr->IsSuper());
+		if(Team < 0)
+			return;
+		if(aPartition[Team] == -1)
+		{
+			aPartition[Team] = NumPartitions++;
+			if((int)m_vvMovePartitions.size() < NumPartitions)
+				m_vvMovePartitions.resize(NumPartitions);
+			m_vvMovePartitions[aPartition[Team]].clear();
+		}
+		m_vvMovePartitions[aPartition[Team]].push_back(pChr);
+	}
+	if(NumPartitions < 2)
+		return;
+
+	// TickDeferred() does the rest of the work in the order of the list
+	m_MoveRunner.Run(NumPartitions, [this](int Partition) {
+		for(CCharacter *pChr : m_vvMovePartitions[Partition])
+			pChr->MoveDeferred();
+	});
+}
+
 void CGameWorld::SwapClients(int Client1, int Client2)
 {
 	// update all objects
@@ -334,11 +462,11 @@ CCharacter *CGameWorld::ClosestCharacter(vec2 Pos, float Radius, const CEntity *
 	return pClosest;
 }
 
-std::vector<CCharacter *> CGameWorld::IntersectedCharacters(vec2 Pos0, vec2 Pos1, float Radius, const CEntity *pNotThis)
+int CGameWorld::IntersectedCharacters(vec2 Pos0, vec2 Pos1, float Radius, CCharacter **ppChars, int Max, const CEntity *pNotThis)
 {
-	std::vector<CCharacter *> vpCharacters;
+	int Num = 0;
 	CCharacter *pChr = (CCharacter *)FindFirst(CGameWorld::ENTTYPE_CHARACTER);
-	for(; pChr; pChr = (CCharacter *)pChr->TypeNext())
+	for(; pChr && Num < Max; pChr = (CCharacter *)pChr->TypeNext())
 	{
 		if(pChr == pNotThis)
 			continue;
@@ -350,11 +478,11 @@ std::vector<CCharacter *> CGameWorld::IntersectedCharacters(vec2 Pos0, vec2 Pos1
 			if(Len < pChr->m_ProximityRadius + Radius)
 			{
 				pChr->m_Intersection = IntersectPos;
-				vpCharacters.push_back(pChr);
+				ppChars[Num++] = pChr;
 			}
 		}
 	}
-	return vpCharacters;
+	return Num;
 }
 
 void CGameWorld::ReleaseHooked(int ClientID)
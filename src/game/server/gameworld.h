@@ -3,8 +3,11 @@
 #ifndef GAME_SERVER_GAMEWORLD_H
 #define GAME_SERVER_GAMEWORLD_H
 
+#include <engine/shared/parallel.h>
+
 #include <game/gamecore.h>
 
+#include <utility>
 #include <vector>
 
 class CEntity;
@@ -39,6 +42,17 @@ private:
 	class CConfig *m_pConfig;
 	class IServer *m_pServer;
 
+	// entities that cache the status of a switch, by switch number
+	std::vector<std::vector<CEntity *>> m_vvSwitchSubscribers;
+	// (switch number, team) pairs that are timed, flagged in m_vTimedSwitchQueued
+	std::vector<std::pair<int, int>> m_vTimedSwitches;
+	std::vector<bool> m_vTimedSwitchQueued;
+
+	// moves the characters of different teams on several threads
+	CParallelRunner m_MoveRunner;
+	std::vector<std::vector<CCharacter *>> m_vvMovePartitions;
+	void MoveCharactersParallel();
+
 public:
 	class CGameContext *GameServer() { return m_pGameServer; }
 	class CConfig *Config() { return m_pConfig; }
@@ -150,6 +164,30 @@ public:
 	// DDRace
 	void ReleaseHooked(int ClientID);
 
+	/*
+		Function: SetSwitch
+			Changes the status of a switch for a team and notifies the
+			entities that subscribed to the switch if the status changed.
+			Timed switches are queued to run out in UpdateTimedSwitches.
+
+		Arguments:
+			Number - Switch number
+			Team - Team whose switch changes
+			Status - Whether the switch is active
+			EndTick - Tick at which a timed switch runs out, 0 otherwise
+			Type - TILE_SWITCHOPEN, TILE_SWITCHCLOSE or a timed variant
+	*/
+	void SetSwitch(int Number, int Team, bool Status, int EndTick, int Type);
+
+	/*
+		Function: UpdateTimedSwitches
+			Toggles the timed switches whose end tick has been reached.
+	*/
+	void UpdateTimedSwitches();
+
+	void SubscribeSwitch(CEntity *pEntity);
+	void UnsubscribeSwitch(CEntity *pEntity);
+
 	/*
 		Function: IntersectedCharacters
 			Finds all CCharacters that intersect the line.
@@ -158,12 +196,15 @@ public:
 			Pos0 - Start position
 			Pos1 - End position
 			Radius - How for from the line the CCharacter is allowed to be.
+			ppChars - Pointer to a list that should be filled with the pointers
+				to the characters.
+			Max - Number of characters that fits into the ppChars array.
 			pNotThis - Entity to ignore intersecting with
 
 		Returns:
-			Returns list with all Characters on line.
+			Number of characters found and added to the ppChars array.
 	*/
-	std::vector<CCharacter *> IntersectedCharacters(vec2 Pos0, vec2 Pos1, float Radius, const CEntity *pNotThis = nullptr);
+	int IntersectedCharacters(vec2 Pos0, vec2 Pos1, float Radius, CCharacter **ppChars, int Max, const CEntity *pNotThis = nullptr);
 
 	CTuningParams *Tuning();
 
@@ -11,6 +11,8 @@
 #include <engine/antibot.h>
 #include <engine/server.h>
 #include <engine/shared/config.h>
+#include <engine/shared/load_shedder.h>
+#include <engine/shared/tick_profiler.h>
 
 #include <game/gamecore.h>
 #include <game/teamscore.h>
@@ -161,13 +163,26 @@ static int PlayerFlags_SixToSeven(int Flags)
 
 void CPlayer::Tick()
 {
-	if(m_ScoreQueryResult != nullptr && m_ScoreQueryResult->m_Completed)
+	// while the server is overloaded, every player processes its score
+	// results only on every tenth tick to spread them out
+	bool DeferScore = false;
+	if(Server()->LoadShedder()->Active(CLoadShedder::LEVEL_SCORE) && (Server()->Tick() + m_ClientID) % 10 != 0)
 	{
+		DeferScore = (m_ScoreQueryResult != nullptr && m_ScoreQueryResult->m_Completed) ||
+			     (m_ScoreFinishResult != nullptr && m_ScoreFinishResult->m_Completed);
+		if(DeferScore)
+			Server()->LoadShedder()->Count(CLoadShedder::COUNTER_SCORE);
+	}
+
+	if(!DeferScore && m_ScoreQueryResult != nullptr && m_ScoreQueryResult->m_Completed)
+	{
+		CTickProfileScope ProfileScope(Server()->TickProfiler(), CTickProfiler::PHASE_SCORE);
 		ProcessScoreResult(*m_ScoreQueryResult);
 		m_ScoreQueryResult = nullptr;
 	}
-	if(m_ScoreFinishResult != nullptr && m_ScoreFinishResult->m_Completed)
+	if(!DeferScore && m_ScoreFinishResult != nullptr && m_ScoreFinishResult->m_Completed)
 	{
+		CTickProfileScope ProfileScope(Server()->TickProfiler(), CTickProfiler::PHASE_SCORE);
 		ProcessScoreResult(*m_ScoreFinishResult);
 		m_ScoreFinishResult = nullptr;
 	}
@@ -6,6 +6,8 @@
 #include <engine/shared/protocol.h>
 #include <game/generated/protocol.h>
 
+#include <vector>
+
 class IGameController;
 class CGameContext;
 class CGameWorld;
@@ -38,6 +40,14 @@ public:
 	};
 
 private:
+	friend class CSaveTeam; // reads and writes the binary form of the tees
+
+	// reads or writes the fields in the binary form, see save_codec.cpp
+	template<typename TStream>
+	void BinaryFields(TStream &Stream, int &HookedPlayer);
+	// index of the hooked player in the team or -1
+	int HookedPlayerIndex(const CSaveTeam *pTeam) const;
+
 	int m_ClientID;
 
 	char m_aString[2048];
@@ -127,9 +137,15 @@ public:
 	CSaveTeam();
 	~CSaveTeam();
 	char *GetString();
+	// compact form of GetString(), valid until the next call
+	const std::vector<unsigned char> &GetBinary();
+	// GetBinary() as base64 with a prefix, for text columns
+	const char *GetBinaryString();
 	int GetMembersCount() const { return m_MembersCount; }
 	// MatchPlayers has to be called afterwards
+	// also accepts the strings of GetBinaryString()
 	int FromString(const char *pString);
+	int FromBinary(const unsigned char *pData, int Size);
 	// returns true if a team can load, otherwise writes a nice error Message in pMessage
 	bool MatchPlayers(const char (*paNames)[MAX_NAME_LENGTH], const int *pClientID, int NumPlayer, char *pMessage, int MessageLen);
 	int Save(CGameContext *pGameServer, int Team, bool Dry = false);
@@ -144,6 +160,7 @@ private:
 	CCharacter *MatchCharacter(CGameContext *pGameServer, int ClientID, int SaveID, bool KeepCurrentCharacter);
 
 	char m_aString[65536];
+	std::vector<unsigned char> m_vBinary;
 
 	struct SSimpleSwitchers
 	{
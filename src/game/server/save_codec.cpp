@@ -0,0 +1,650 @@
+#include "save.h"
+
+#include <cstdio> // sscanf
+#include <cstring> // memchr
+
+#include <engine/shared/compression.h>
+#include <engine/shared/uuid_manager.h>
+
+#include <game/gamecore.h>
+
+// binary saves start with the magic and a version, followed by the fields in
+// the order of the text form. fields added later are only read from saves of
+// the version that introduced them
+static const unsigned char BINARY_MAGIC[4] = {'D', 'S', 'A', 'V'};
+enum
+{
+	BINARY_VERSION_INITIAL = 1,
+	BINARY_VERSION = BINARY_VERSION_INITIAL,
+};
+// the binary form is stored as base64 behind this prefix in text columns
+static const char BINARY_PREFIX[] = "binary:";
+
+class CSaveBinaryWriter
+{
+	std::vector<unsigned char> &m_vData;
+
+public:
+	CSaveBinaryWriter(std::vector<unsigned char> &vData) :
+		m_vData(vData) {}
+
+	int Version() const { return BINARY_VERSION; }
+
+	void Int(int &Value)
+	{
+		unsigned char aBuf[CVariableInt::MAX_BYTES_PACKED];
+		const unsigned char *pEnd = CVariableInt::Pack(aBuf, Value, sizeof(aBuf));
+		m_vData.insert(m_vData.end(), (const unsigned char *)aBuf, pEnd);
+	}
+	void Float(float &Value)
+	{
+		unsigned Bits;
+		mem_copy(&Bits, &Value, sizeof(Bits));
+		unsigned char aBuf[4];
+		uint_to_bytes_be(aBuf, Bits);
+		m_vData.insert(m_vData.end(), aBuf, aBuf + sizeof(aBuf));
+	}
+	void String(char *pString, int Size)
+	{
+		m_vData.insert(m_vData.end(), pString, pString + str_length(pString) + 1);
+	}
+};
+
+class CSaveBinaryReader
+{
+	const unsigned char *m_pData;
+	const unsigned char *m_pEnd;
+	int m_Version = 0;
+	bool m_Error = false;
+
+public:
+	CSaveBinaryReader(const unsigned char *pData, int Size) :
+		m_pData(pData), m_pEnd(pData + Size) {}
+
+	int Version() const { return m_Version; }
+	void SetVersion(int Version) { m_Version = Version; }
+	bool Error() const { return m_Error; }
+	int Left() const { return m_pEnd - m_pData; }
+
+	void Int(int &Value)
+	{
+		const unsigned char *pNext = m_Error ? nullptr : CVariableInt::Unpack(m_pData, &Value, Left());
+		if(!pNext)
+		{
+			m_Error = true;
+			Value = 0;
+			return;
+		}
+		m_pData = pNext;
+	}
+	void Float(float &Value)
+	{
+		if(m_Error || Left() < 4)
+		{
+			m_Error = true;
+			Value = 0.0f;
+			return;
+		}
+		unsigned Bits = bytes_be_to_uint(m_pData);
+		mem_copy(&Value, &Bits, sizeof(Value));
+		m_pData += 4;
+	}
+	void String(char *pString, int Size)
+	{
+		const unsigned char *pTerminator = m_Error ? nullptr : (const unsigned char *)memchr(m_pData, '\0', Left());
+		if(!pTerminator || pTerminator - m_pData >= Size)
+		{
+			m_Error = true;
+			pString[0] = '\0';
+			return;
+		}
+		mem_copy(pString, m_pData, pTerminator - m_pData + 1);
+		m_pData = pTerminator + 1;
+	}
+};
+
+CSaveTee::CSaveTee() = default;
+
+int CSaveTee::HookedPlayerIndex(const CSaveTeam *pTeam) const
+{
+	if(m_HookedPlayer != -1)
+	{
+		for(int n = 0; n < pTeam->GetMembersCount(); n++)
+		{
+			if(m_HookedPlayer == pTeam->m_pSavedTees[n].GetClientID())
+				return n;
+		}
+	}
+	return -1;
+}
+
+void CSaveTee::LoadHookedPlayer(const CSaveTeam *pTeam)
+{
+	if(m_HookedPlayer == -1)
+		return;
+	m_HookedPlayer = pTeam->m_pSavedTees[m_HookedPlayer].GetClientID();
+}
+
+char *CSaveTee::GetString(const CSaveTeam *pTeam)
+{
+	int HookedPlayer = HookedPlayerIndex(pTeam);
+
+	str_format(m_aString, sizeof(m_aString),
+		"%s\t%d\t%d\t%d\t%d\t%d\t"
+		// weapons
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t"
+		// tee stats
+		"%d\t%d\t%d\t%d\t%d\t%d\t%d\t" // m_EndlessJump
+		"%d\t%d\t%d\t%d\t%d\t%d\t%d\t" // m_DDRaceState
+		"%d\t%d\t%d\t%d\t" // m_Pos.x
+		"%d\t%d\t" // m_TeleCheckpoint
+		"%d\t%d\t%f\t%f\t" // m_CorePos.x
+		"%d\t%d\t%d\t%d\t" // m_ActiveWeapon
+		"%d\t%d\t%f\t%f\t" // m_HookPos.x
+		"%d\t%d\t%d\t%d\t" // m_HookTeleBase.x
+		// time checkpoints
+		"%d\t%d\t%d\t"
+		"%f\t%f\t%f\t%f\t%f\t"
+		"%f\t%f\t%f\t%f\t%f\t"
+		"%f\t%f\t%f\t%f\t%f\t"
+		"%f\t%f\t%f\t%f\t%f\t"
+		"%f\t%f\t%f\t%f\t%f\t"
+		"%d\t" // m_NotEligibleForFinish
+		"%d\t%d\t%d\t" // tele weapons
+		"%s\t" // m_aGameUuid
+		"%d\t%d\t" // m_HookedPlayer, m_NewHook
+		"%d\t%d\t%d\t%d\t" // input stuff
+		"%d\t" // m_ReloadTimer
+		"%d\t" // m_TeeStarted
+		"%d", //m_LiveFreeze
+		m_aName, m_Alive, m_Paused, m_NeededFaketuning, m_TeeFinished, m_IsSolo,
+		// weapons
+		m_aWeapons[0].m_AmmoRegenStart, m_aWeapons[0].m_Ammo, m_aWeapons[0].m_Ammocost, m_aWeapons[0].m_Got,
+		m_aWeapons[1].m_AmmoRegenStart, m_aWeapons[1].m_Ammo, m_aWeapons[1].m_Ammocost, m_aWeapons[1].m_Got,
+		m_aWeapons[2].m_AmmoRegenStart, m_aWeapons[2].m_Ammo, m_aWeapons[2].m_Ammocost, m_aWeapons[2].m_Got,
+		m_aWeapons[3].m_AmmoRegenStart, m_aWeapons[3].m_Ammo, m_aWeapons[3].m_Ammocost, m_aWeapons[3].m_Got,
+		m_aWeapons[4].m_AmmoRegenStart, m_aWeapons[4].m_Ammo, m_aWeapons[4].m_Ammocost, m_aWeapons[4].m_Got,
+		m_aWeapons[5].m_AmmoRegenStart, m_aWeapons[5].m_Ammo, m_aWeapons[5].m_Ammocost, m_aWeapons[5].m_Got,
+		m_LastWeapon, m_QueuedWeapon,
+		// tee states
+		m_EndlessJump, m_Jetpack, m_NinjaJetpack, m_FreezeTime, m_FreezeStart, m_DeepFrozen, m_EndlessHook,
+		m_DDRaceState, m_HitDisabledFlags, m_CollisionEnabled, m_TuneZone, m_TuneZoneOld, m_HookHitEnabled, m_Time,
+		(int)m_Pos.x, (int)m_Pos.y, (int)m_PrevPos.x, (int)m_PrevPos.y,
+		m_TeleCheckpoint, m_LastPenalty,
+		(int)m_CorePos.x, (int)m_CorePos.y, m_Vel.x, m_Vel.y,
+		m_ActiveWeapon, m_Jumped, m_JumpedTotal, m_Jumps,
+		(int)m_HookPos.x, (int)m_HookPos.y, m_HookDir.x, m_HookDir.y,
+		(int)m_HookTeleBase.x, (int)m_HookTeleBase.y, m_HookTick, m_HookState,
+		// time checkpoints
+		m_TimeCpBroadcastEndTime, m_LastTimeCp, m_LastTimeCpBroadcasted,
+		m_aCurrentTimeCp[0], m_aCurrentTimeCp[1], m_aCurrentTimeCp[2], m_aCurrentTimeCp[3], m_aCurrentTimeCp[4],
+		m_aCurrentTimeCp[5], m_aCurrentTimeCp[6], m_aCurrentTimeCp[7], m_aCurrentTimeCp[8], m_aCurrentTimeCp[9],
+		m_aCurrentTimeCp[10], m_aCurrentTimeCp[11], m_aCurrentTimeCp[12], m_aCurrentTimeCp[13], m_aCurrentTimeCp[14],
+		m_aCurrentTimeCp[15], m_aCurrentTimeCp[16], m_aCurrentTimeCp[17], m_aCurrentTimeCp[18], m_aCurrentTimeCp[19],
+		m_aCurrentTimeCp[20], m_aCurrentTimeCp[21], m_aCurrentTimeCp[22], m_aCurrentTimeCp[23], m_aCurrentTimeCp[24],
+		m_NotEligibleForFinish,
+		m_HasTelegunGun, m_HasTelegunLaser, m_HasTelegunGrenade,
+		m_aGameUuid,
+		HookedPlayer, m_NewHook,
+		m_InputDirection, m_InputJump, m_InputFire, m_InputHook,
+		m_ReloadTimer,
+		m_TeeStarted,
+		m_LiveFrozen);
+	return m_aString;
+}
+
+int CSaveTee::FromString(const char *pString)
+{
+	int Num;
+	Num = sscanf(pString,
+		"%[^\t]\t%d\t%d\t%d\t%d\t%d\t"
+		// weapons
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t%d\t%d\t"
+		"%d\t%d\t"
+		// tee states
+		"%d\t%d\t%d\t%d\t%d\t%d\t%d\t" // m_EndlessJump
+		"%d\t%d\t%d\t%d\t%d\t%d\t%d\t" // m_DDRaceState
+		"%f\t%f\t%f\t%f\t" // m_Pos.x
+		"%d\t%d\t" // m_TeleCheckpoint
+		"%f\t%f\t%f\t%f\t" // m_CorePos.x
+		"%d\t%d\t%d\t%d\t" // m_ActiveWeapon
+		"%f\t%f\t%f\t%f\t" // m_HookPos.x
+		"%f\t%f\t%d\t%d\t" // m_HookTeleBase.x
+		// time checkpoints
+		"%d\t%d\t%d\t"
+		"%f\t%f\t%f\t%f\t%f\t"
+		"%f\t%f\t%f\t%f\t%f\t"
+		"%f\t%f\t%f\t%f\t%f\t"
+		"%f\t%f\t%f\t%f\t%f\t"
+		"%f\t%f\t%f\t%f\t%f\t"
+		"%d\t" // m_NotEligibleForFinish
+		"%d\t%d\t%d\t" // tele weapons
+		"%36s\t" // m_aGameUuid
+		"%d\t%d\t" // m_HookedPlayer, m_NewHook
+		"%d\t%d\t%d\t%d\t" // input stuff
+		"%d\t" // m_ReloadTimer
+		"%d\t" // m_TeeStarted
+		"%d", // m_LiveFreeze
+		m_aName, &m_Alive, &m_Paused, &m_NeededFaketuning, &m_TeeFinished, &m_IsSolo,
+		// weapons
+		&m_aWeapons[0].m_AmmoRegenStart, &m_aWeapons[0].m_Ammo, &m_aWeapons[0].m_Ammocost, &m_aWeapons[0].m_Got,
+		&m_aWeapons[1].m_AmmoRegenStart, &m_aWeapons[1].m_Ammo, &m_aWeapons[1].m_Ammocost, &m_aWeapons[1].m_Got,
+		&m_aWeapons[2].m_AmmoRegenStart, &m_aWeapons[2].m_Ammo, &m_aWeapons[2].m_Ammocost, &m_aWeapons[2].m_Got,
+		&m_aWeapons[3].m_AmmoRegenStart, &m_aWeapons[3].m_Ammo, &m_aWeapons[3].m_Ammocost, &m_aWeapons[3].m_Got,
+		&m_aWeapons[4].m_AmmoRegenStart, &m_aWeapons[4].m_Ammo, &m_aWeapons[4].m_Ammocost, &m_aWeapons[4].m_Got,
+		&m_aWeapons[5].m_AmmoRegenStart, &m_aWeapons[5].m_Ammo, &m_aWeapons[5].m_Ammocost, &m_aWeapons[5].m_Got,
+		&m_LastWeapon, &m_QueuedWeapon,
+		// tee states
+		&m_EndlessJump, &m_Jetpack, &m_NinjaJetpack, &m_FreezeTime, &m_FreezeStart, &m_DeepFrozen, &m_EndlessHook,
+		&m_DDRaceState, &m_HitDisabledFlags, &m_CollisionEnabled, &m_TuneZone, &m_TuneZoneOld, &m_HookHitEnabled, &m_Time,
+		&m_Pos.x, &m_Pos.y, &m_PrevPos.x, &m_PrevPos.y,
+		&m_TeleCheckpoint, &m_LastPenalty,
+		&m_CorePos.x, &m_CorePos.y, &m_Vel.x, &m_Vel.y,
+		&m_ActiveWeapon, &m_Jumped, &m_JumpedTotal, &m_Jumps,
+		&m_HookPos.x, &m_HookPos.y, &m_HookDir.x, &m_HookDir.y,
+		&m_HookTeleBase.x, &m_HookTeleBase.y, &m_HookTick, &m_HookState,
+		// time checkpoints
+		&m_TimeCpBroadcastEndTime, &m_LastTimeCp, &m_LastTimeCpBroadcasted,
+		&m_aCurrentTimeCp[0], &m_aCurrentTimeCp[1], &m_aCurrentTimeCp[2], &m_aCurrentTimeCp[3], &m_aCurrentTimeCp[4],
+		&m_aCurrentTimeCp[5], &m_aCurrentTimeCp[6], &m_aCurrentTimeCp[7], &m_aCurrentTimeCp[8], &m_aCurrentTimeCp[9],
+		&m_aCurrentTimeCp[10], &m_aCurrentTimeCp[11], &m_aCurrentTimeCp[12], &m_aCurrentTimeCp[13], &m_aCurrentTimeCp[14],
+		&m_aCurrentTimeCp[15], &m_aCurrentTimeCp[16], &m_aCurrentTimeCp[17], &m_aCurrentTimeCp[18], &m_aCurrentTimeCp[19],
+		&m_aCurrentTimeCp[20], &m_aCurrentTimeCp[21], &m_aCurrentTimeCp[22], &m_aCurrentTimeCp[23], &m_aCurrentTimeCp[24],
+		&m_NotEligibleForFinish,
+		&m_HasTelegunGun, &m_HasTelegunLaser, &m_HasTelegunGrenade,
+		m_aGameUuid,
+		&m_HookedPlayer, &m_NewHook,
+		&m_InputDirection, &m_InputJump, &m_InputFire, &m_InputHook,
+		&m_ReloadTimer,
+		&m_TeeStarted,
+		&m_LiveFrozen);
+	switch(Num) // Don't forget to update this when you save / load more / less.
+	{
+	case 96:
+		m_NotEligibleForFinish = false;
+		[[fallthrough]];
+	case 97:
+		m_HasTelegunGrenade = 0;
+		m_HasTelegunLaser = 0;
+		m_HasTelegunGun = 0;
+		FormatUuid(CalculateUuid("game-uuid-nonexistent@ddnet.tw"), m_aGameUuid, sizeof(m_aGameUuid));
+		[[fallthrough]];
+	case 101:
+		m_HookedPlayer = -1;
+		m_NewHook = false;
+		if(m_HookState == HOOK_GRABBED)
+			m_HookState = HOOK_FLYING;
+		m_InputDirection = 0;
+		m_InputJump = 0;
+		m_InputFire = 0;
+		m_InputHook = 0;
+		m_ReloadTimer = 0;
+		[[fallthrough]];
+	case 108:
+		m_TeeStarted = true;
+		[[fallthrough]];
+	case 109:
+		m_LiveFrozen = false;
+		[[fallthrough]];
+	case 110:
+		return 0;
+	default:
+		dbg_msg("load", "failed to load tee-string");
+		dbg_msg("load", "loaded %d vars", Num);
+		return Num + 1; // never 0 here
+	}
+}
+
+template<typename TStream>
+void CSaveTee::BinaryFields(TStream &Stream, int &HookedPlayer)
+{
+	Stream.String(m_aName, sizeof(m_aName));
+	Stream.Int(m_Alive);
+	Stream.Int(m_Paused);
+	Stream.Int(m_NeededFaketuning);
+	Stream.Int(m_TeeFinished);
+	Stream.Int(m_IsSolo);
+	for(auto &Weapon : m_aWeapons)
+	{
+		Stream.Int(Weapon.m_AmmoRegenStart);
+		Stream.Int(Weapon.m_Ammo);
+		Stream.Int(Weapon.m_Ammocost);
+		Stream.Int(Weapon.m_Got);
+	}
+	Stream.Int(m_LastWeapon);
+	Stream.Int(m_QueuedWeapon);
+
+	Stream.Int(m_EndlessJump);
+	Stream.Int(m_Jetpack);
+	Stream.Int(m_NinjaJetpack);
+	Stream.Int(m_FreezeTime);
+	Stream.Int(m_FreezeStart);
+	Stream.Int(m_DeepFrozen);
+	Stream.Int(m_EndlessHook);
+	Stream.Int(m_DDRaceState);
+	Stream.Int(m_HitDisabledFlags);
+	Stream.Int(m_CollisionEnabled);
+	Stream.Int(m_TuneZone);
+	Stream.Int(m_TuneZoneOld);
+	Stream.Int(m_HookHitEnabled);
+	Stream.Int(m_Time);
+	Stream.Float(m_Pos.x);
+	Stream.Float(m_Pos.y);
+	Stream.Float(m_PrevPos.x);
+	Stream.Float(m_PrevPos.y);
+	Stream.Int(m_TeleCheckpoint);
+	Stream.Int(m_LastPenalty);
+	Stream.Float(m_CorePos.x);
+	Stream.Float(m_CorePos.y);
+	Stream.Float(m_Vel.x);
+	Stream.Float(m_Vel.y);
+	Stream.Int(m_ActiveWeapon);
+	Stream.Int(m_Jumped);
+	Stream.Int(m_JumpedTotal);
+	Stream.Int(m_Jumps);
+	Stream.Float(m_HookPos.x);
+	Stream.Float(m_HookPos.y);
+	Stream.Float(m_HookDir.x);
+	Stream.Float(m_HookDir.y);
+	Stream.Float(m_HookTeleBase.x);
+	Stream.Float(m_HookTeleBase.y);
+	Stream.Int(m_HookTick);
+	Stream.Int(m_HookState);
+
+	Stream.Int(m_TimeCpBroadcastEndTime);
+	Stream.Int(m_LastTimeCp);
+	Stream.Int(m_LastTimeCpBroadcasted);
+	for(float &CurrentTimeCp : m_aCurrentTimeCp)
+		Stream.Float(CurrentTimeCp);
+
+	Stream.Int(m_NotEligibleForFinish);
+	Stream.Int(m_HasTelegunGun);
+	Stream.Int(m_HasTelegunLaser);
+	Stream.Int(m_HasTelegunGrenade);
+	Stream.String(m_aGameUuid, sizeof(m_aGameUuid));
+	Stream.Int(HookedPlayer);
+	Stream.Int(m_NewHook);
+	Stream.Int(m_InputDirection);
+	Stream.Int(m_InputJump);
+	Stream.Int(m_InputFire);
+	Stream.Int(m_InputHook);
+	Stream.Int(m_ReloadTimer);
+	Stream.Int(m_TeeStarted);
+	Stream.Int(m_LiveFrozen);
+}
+
+CSaveTeam::CSaveTeam()
+{
+	m_aString[0] = '\0';
+}
+
+CSaveTeam::~CSaveTeam()
+{
+	delete[] m_pSwitchers;
+	delete[] m_pSavedTees;
+}
+
+char *CSaveTeam::GetString()
+{
+	int Length = str_format(m_aString, sizeof(m_aString), "%d\t%d\t%d\t%d\t%d", m_TeamState, m_MembersCount, m_HighestSwitchNumber, m_TeamLocked, m_Practice);
+
+	// append at the known end instead of searching it every time
+	for(int i = 0; i < m_MembersCount; i++)
+	{
+		char aBuf[1024];
+		str_format(aBuf, sizeof(aBuf), "\n%s", m_pSavedTees[i].GetString(this));
+		str_copy(m_aString + Length, aBuf, sizeof(m_aString) - Length);
+		Length += str_length(m_aString + Length);
+	}
+
+	if(m_pSwitchers && m_HighestSwitchNumber)
+	{
+		for(int i = 1; i < m_HighestSwitchNumber + 1; i++)
+		{
+			Length += str_format(m_aString + Length, sizeof(m_aString) - Length, "\n%d\t%d\t%d", m_pSwitchers[i].m_Status, m_pSwitchers[i].m_EndTime, m_pSwitchers[i].m_Type);
+		}
+	}
+
+	return m_aString;
+}
+
+const std::vector<unsigned char> &CSaveTeam::GetBinary()
+{
+	m_vBinary.clear();
+	m_vBinary.insert(m_vBinary.end(), BINARY_MAGIC, BINARY_MAGIC + sizeof(BINARY_MAGIC));
+	CSaveBinaryWriter Writer(m_vBinary);
+	int Version = BINARY_VERSION;
+	Writer.Int(Version);
+
+	Writer.Int(m_TeamState);
+	Writer.Int(m_MembersCount);
+	int HighestSwitchNumber = m_pSwitchers ? m_HighestSwitchNumber : 0;
+	Writer.Int(HighestSwitchNumber);
+	Writer.Int(m_TeamLocked);
+	Writer.Int(m_Practice);
+
+	for(int i = 0; i < m_MembersCount; i++)
+	{
+		int HookedPlayer = m_pSavedTees[i].HookedPlayerIndex(this);
+		m_pSavedTees[i].BinaryFields(Writer, HookedPlayer);
+	}
+
+	for(int i = 1; i < HighestSwitchNumber + 1; i++)
+	{
+		Writer.Int(m_pSwitchers[i].m_Status);
+		Writer.Int(m_pSwitchers[i].m_EndTime);
+		Writer.Int(m_pSwitchers[i].m_Type);
+	}
+	return m_vBinary;
+}
+
+const char *CSaveTeam::GetBinaryString()
+{
+	const std::vector<unsigned char> &vBinary = GetBinary();
+	const int PrefixLength = str_length(BINARY_PREFIX);
+	// base64 takes 4 characters for every 3 bytes
+	if(PrefixLength + ((int)vBinary.size() + 2) / 3 * 4 + 1 > (int)sizeof(m_aString))
+		return GetString();
+
+	str_copy(m_aString, BINARY_PREFIX);
+	str_base64(m_aString + PrefixLength, sizeof(m_aString) - PrefixLength, vBinary.data(), vBinary.size());
+	return m_aString;
+}
+
+int CSaveTeam::FromBinary(const unsigned char *pData, int Size)
+{
+	if(Size < (int)sizeof(BINARY_MAGIC) || mem_comp(pData, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+	{
+		dbg_msg("load", "savegame: wrong format (no binary save)");
+		return 1;
+	}
+	CSaveBinaryReader Reader(pData + sizeof(BINARY_MAGIC), Size - sizeof(BINARY_MAGIC));
+	int Version;
+	Reader.Int(Version);
+	if(Reader.Error() || Version < BINARY_VERSION_INITIAL || Version > BINARY_VERSION)
+	{
+		dbg_msg("load", "savegame: unsupported binary version");
+		return 1;
+	}
+	Reader.SetVersion(Version);
+
+	Reader.Int(m_TeamState);
+	Reader.Int(m_MembersCount);
+	Reader.Int(m_HighestSwitchNumber);
+	Reader.Int(m_TeamLocked);
+	Reader.Int(m_Practice);
+	// every switcher takes at least 3 bytes
+	if(Reader.Error() || m_MembersCount < 0 || m_MembersCount > MAX_CLIENTS || m_HighestSwitchNumber < 0 || m_HighestSwitchNumber > Reader.Left() / 3)
+	{
+		dbg_msg("load", "savegame: wrong format (couldn't load teamstats)");
+		return 1;
+	}
+
+	delete[] m_pSavedTees;
+	m_pSavedTees = nullptr;
+	if(m_MembersCount)
+		m_pSavedTees = new CSaveTee[m_MembersCount];
+	for(int n = 0; n < m_MembersCount; n++)
+	{
+		int HookedPlayer;
+		m_pSavedTees[n].BinaryFields(Reader, HookedPlayer);
+		m_pSavedTees[n].m_HookedPlayer = HookedPlayer;
+		if(Reader.Error() || HookedPlayer < -1 || HookedPlayer >= m_MembersCount)
+		{
+			dbg_msg("load", "savegame: wrong format (couldn't load tee)");
+			return 1;
+		}
+	}
+
+	delete[] m_pSwitchers;
+	m_pSwitchers = nullptr;
+	if(m_HighestSwitchNumber)
+		m_pSwitchers = new SSimpleSwitchers[m_HighestSwitchNumber + 1];
+	for(int n = 1; n < m_HighestSwitchNumber + 1; n++)
+	{
+		Reader.Int(m_pSwitchers[n].m_Status);
+		Reader.Int(m_pSwitchers[n].m_EndTime);
+		Reader.Int(m_pSwitchers[n].m_Type);
+	}
+	if(Reader.Error())
+	{
+		dbg_msg("load", "savegame: wrong format (couldn't load switcher)");
+		return 1;
+	}
+	return 0;
+}
+
+int CSaveTeam::FromString(const char *pString)
+{
+	if(str_startswith(pString, BINARY_PREFIX))
+	{
+		const char *pBase64 = pString + str_length(BINARY_PREFIX);
+		std::vector<unsigned char> vBinary(str_length(pBase64) / 4 * 3 + 3);
+		int Size = str_base64_decode(vBinary.data(), vBinary.size(), pBase64);
+		if(Size < 0)
+		{
+			dbg_msg("load", "savegame: wrong format (invalid base64)");
+			return 1;
+		}
+		return FromBinary(vBinary.data(), Size);
+	}
+
+	char aTeamStats[MAX_CLIENTS];
+	char aSwitcher[64];
+	char aSaveTee[1024];
+
+	// the lines are parsed straight from the given string
+	const char *pLine = pString;
+	int LineLength;
+	auto NextLine = [&]() {
+		pLine += LineLength;
+		if(*pLine == '\n')
+			pLine++;
+		const char *pLineEnd = str_find(pLine, "\n");
+		LineLength = pLineEnd ? pLineEnd - pLine : str_length(pLine);
+	};
+	LineLength = 0;
+	NextLine();
+
+	if(LineLength + 1 < (int)sizeof(aTeamStats))
+	{
+		str_copy(aTeamStats, pLine, LineLength + 1);
+		int Num = sscanf(aTeamStats, "%d\t%d\t%d\t%d\t%d", &m_TeamState, &m_MembersCount, &m_HighestSwitchNumber, &m_TeamLocked, &m_Practice);
+		switch(Num) // Don't forget to update this when you save / load more / less.
+		{
+		case 4:
+			m_Practice = false;
+			[[fallthrough]];
+		case 5:
+			break;
+		default:
+			dbg_msg("load", "failed to load teamstats");
+			dbg_msg("load", "loaded %d vars", Num);
+			return Num + 1; // never 0 here
+		}
+	}
+	else
+	{
+		dbg_msg("load", "savegame: wrong format (couldn't load teamstats, too big)");
+		return 1;
+	}
+
+	if(m_pSavedTees)
+	{
+		delete[] m_pSavedTees;
+		m_pSavedTees = 0;
+	}
+
+	if(m_MembersCount > 64)
+	{
+		dbg_msg("load", "savegame: team has too many players");
+		return 1;
+	}
+	else if(m_MembersCount)
+	{
+		m_pSavedTees = new CSaveTee[m_MembersCount];
+	}
+
+	for(int n = 0; n < m_MembersCount; n++)
+	{
+		NextLine();
+		if(LineLength + 1 < (int)sizeof(aSaveTee))
+		{
+			str_copy(aSaveTee, pLine, LineLength + 1);
+			int Num = m_pSavedTees[n].FromString(aSaveTee);
+			if(Num)
+			{
+				dbg_msg("load", "failed to load tee");
+				dbg_msg("load", "loaded %d vars", Num - 1);
+				return 1;
+			}
+		}
+		else
+		{
+			dbg_msg("load", "savegame: wrong format (couldn't load tee, too big)");
+			return 1;
+		}
+	}
+
+	if(m_pSwitchers)
+	{
+		delete[] m_pSwitchers;
+		m_pSwitchers = 0;
+	}
+
+	if(m_HighestSwitchNumber)
+		m_pSwitchers = new SSimpleSwitchers[m_HighestSwitchNumber + 1];
+
+	for(int n = 1; n < m_HighestSwitchNumber + 1; n++)
+	{
+		NextLine();
+		if(LineLength + 1 < (int)sizeof(aSwitcher))
+		{
+			str_copy(aSwitcher, pLine, LineLength + 1);
+			int Num = sscanf(aSwitcher, "%d\t%d\t%d", &(m_pSwitchers[n].m_Status), &(m_pSwitchers[n].m_EndTime), &(m_pSwitchers[n].m_Type));
+			if(Num != 3)
+			{
+				dbg_msg("load", "failed to load switcher");
+				dbg_msg("load", "loaded %d vars", Num - 1);
+			}
+		}
+		else
+		{
+			dbg_msg("load", "savegame: wrong format (couldn't load switcher, too big)");
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -1547,8 +1547,9 @@ bool CScoreWorker::SaveTeam(IDbConnection *pSqlServer, const ISqlData *pGameData
 	char aSaveID[UUID_MAXSTRSIZE];
 	FormatUuid(pResult->m_SaveID, aSaveID, UUID_MAXSTRSIZE);
 
-	char *pSaveState = pResult->m_SavedTeam.GetString();
-	char aBuf[65536];
+	// the save is bound by pointer, the buffer only holds the query
+	const char *pSaveState = pData->m_Binary ? pResult->m_SavedTeam.GetBinaryString() : pResult->m_SavedTeam.GetString();
+	char aBuf[512];
 
 	dbg_msg("score/dbg", "code=%s failure=%d", pData->m_aCode, (int)w);
 	bool UseGeneratedCode = pData->m_aCode[0] == '\0' || w != Write::NORMAL;
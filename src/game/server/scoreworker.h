@@ -199,6 +199,8 @@ struct CSqlTeamSave : ISqlData
 	char m_aCode[128];
 	char m_aGeneratedCode[128];
 	char m_aServer[5];
+	// store the team in the binary form instead of the text form
+	bool m_Binary;
 };
 
 struct CSqlTeamLoad : ISqlData
@@ -59,11 +59,9 @@ void CGameTeams::ResetRoundState(int Team)
 
 void CGameTeams::ResetSwitchers(int Team)
 {
-	for(auto &Switcher : GameServer()->Switchers())
+	for(int i = 0; i < (int)GameServer()->Switchers().size(); i++)
 	{
-		Switcher.m_aStatus[Team] = Switcher.m_Initial;
-		Switcher.m_aEndTick[Team] = 0;
-		Switcher.m_aType[Team] = TILE_SWITCHOPEN;
+		GameServer()->m_World.SetSwitch(i, Team, GameServer()->Switchers()[i].m_Initial, 0, TILE_SWITCHOPEN);
 	}
 }
 
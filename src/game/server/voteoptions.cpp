@@ -0,0 +1,141 @@
+#include "voteoptions.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/message.h>
+
+#include <game/generated/protocol.h>
+
+std::string CVoteOptions::Key(const char *pDescription)
+{
+	std::string Key(pDescription);
+	for(char &c : Key)
+	{
+		if(c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+	}
+	return Key;
+}
+
+CVoteOptionServer *CVoteOptions::NewOption(const char *pDescription, const char *pCommand)
+{
+	const int Len = str_length(pCommand);
+	CVoteOptionServer *pOption = (CVoteOptionServer *)m_pHeap->Allocate(sizeof(CVoteOptionServer) + Len, alignof(CVoteOptionServer));
+	str_copy(pOption->m_aDescription, pDescription, sizeof(pOption->m_aDescription));
+	mem_copy(pOption->m_aCommand, pCommand, Len + 1);
+	return pOption;
+}
+
+const CVoteOptionServer *CVoteOptions::Find(const char *pDescription) const
+{
+	auto It = m_Indices.find(Key(pDescription));
+	if(It == m_Indices.end())
+		return nullptr;
+	return m_vpOptions[It->second];
+}
+
+bool CVoteOptions::Add(const char *pDescription, const char *pCommand)
+{
+	if(!m_Indices.emplace(Key(pDescription), Num()).second)
+		return false;
+	m_vpOptions.push_back(NewOption(pDescription, pCommand));
+	m_PackedOptionsPerMsg = 0;
+	return true;
+}
+
+bool CVoteOptions::Remove(const char *pDescription)
+{
+	auto It = m_Indices.find(Key(pDescription));
+	if(It == m_Indices.end())
+		return false;
+	const int Removed = It->second;
+
+	// copy the remaining options to a new heap to free the memory of the removed one
+	std::vector<CVoteOptionServer *> vpOldOptions;
+	std::swap(vpOldOptions, m_vpOptions);
+	std::unique_ptr<CHeap> pOldHeap = std::move(m_pHeap);
+	m_pHeap = std::make_unique<CHeap>();
+	m_Indices.clear();
+	for(int i = 0; i < (int)vpOldOptions.size(); i++)
+	{
+		if(i == Removed)
+			continue;
+		m_Indices.emplace(Key(vpOldOptions[i]->m_aDescription), Num());
+		m_vpOptions.push_back(NewOption(vpOldOptions[i]->m_aDescription, vpOldOptions[i]->m_aCommand));
+	}
+	m_PackedOptionsPerMsg = 0;
+	return true;
+}
+
+void CVoteOptions::Clear()
+{
+	m_pHeap->Reset();
+	m_vpOptions.clear();
+	m_Indices.clear();
+	m_PackedOptionsPerMsg = 0;
+}
+
+void CVoteOptions::PackMsg(int Index, int Num, CMsgPacker *pPacker) const
+{
+	CNetMsg_Sv_VoteOptionListAdd OptionMsg;
+	const char **apDescriptions[] = {
+		&OptionMsg.m_pDescription0,
+		&OptionMsg.m_pDescription1,
+		&OptionMsg.m_pDescription2,
+		&OptionMsg.m_pDescription3,
+		&OptionMsg.m_pDescription4,
+		&OptionMsg.m_pDescription5,
+		&OptionMsg.m_pDescription6,
+		&OptionMsg.m_pDescription7,
+		&OptionMsg.m_pDescription8,
+		&OptionMsg.m_pDescription9,
+		&OptionMsg.m_pDescription10,
+		&OptionMsg.m_pDescription11,
+		&OptionMsg.m_pDescription12,
+		&OptionMsg.m_pDescription13,
+		&OptionMsg.m_pDescription14,
+	};
+	dbg_assert(Num <= (int)std::size(apDescriptions), "too many vote options for one message");
+	for(int i = 0; i < (int)std::size(apDescriptions); i++)
+		*apDescriptions[i] = i < Num ? m_vpOptions[Index + i]->m_aDescription : "";
+	OptionMsg.m_NumOptions = Num;
+	OptionMsg.Pack(pPacker);
+}
+
+void CVoteOptions::PackAll(int OptionsPerMsg)
+{
+	m_vPackedData.clear();
+	m_vPackedOffsets.clear();
+	CMsgPacker Packer(NETMSGTYPE_SV_VOTEOPTIONLISTADD, false);
+	for(int Index = 0; Index < Num(); Index += OptionsPerMsg)
+	{
+		Packer.Reset();
+		PackMsg(Index, minimum(OptionsPerMsg, Num() - Index), &Packer);
+		m_vPackedOffsets.push_back(m_vPackedData.size());
+		m_vPackedData.insert(m_vPackedData.end(), Packer.Data(), Packer.Data() + Packer.Size());
+	}
+	m_vPackedOffsets.push_back(m_vPackedData.size());
+	m_PackedOptionsPerMsg = OptionsPerMsg;
+}
+
+int CVoteOptions::PackOptions(int Index, int OptionsPerMsg, CMsgPacker *pPacker)
+{
+	const int NumOptions = minimum(OptionsPerMsg, Num() - Index);
+	if(NumOptions <= 0)
+		return 0;
+
+	// clients that started receiving the list before a change or with another
+	// number of options per message are not aligned to the packed messages
+	if(Index % OptionsPerMsg != 0)
+	{
+		PackMsg(Index, NumOptions, pPacker);
+		return NumOptions;
+	}
+
+	if(m_PackedOptionsPerMsg != OptionsPerMsg)
+		PackAll(OptionsPerMsg);
+	const int Msg = Index / OptionsPerMsg;
+	pPacker->AddRaw(m_vPackedData.data() + m_vPackedOffsets[Msg], m_vPackedOffsets[Msg + 1] - m_vPackedOffsets[Msg]);
+	return NumOptions;
+}
@@ -0,0 +1,58 @@
+#ifndef GAME_SERVER_VOTEOPTIONS_H
+#define GAME_SERVER_VOTEOPTIONS_H
+
+#include <engine/shared/memheap.h>
+
+#include <game/voting.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CMsgPacker;
+
+/**
+ * Vote options of the server, indexed by their position in the list and by
+ * their description. Descriptions are compared case insensitively.
+ *
+ * The NETMSGTYPE_SV_VOTEOPTIONLISTADD messages of the whole list are packed
+ * once after each change and reused for every client that receives it.
+ */
+class CVoteOptions
+{
+	std::unique_ptr<CHeap> m_pHeap = std::make_unique<CHeap>();
+	std::vector<CVoteOptionServer *> m_vpOptions;
+	// lowercase description to index in m_vpOptions
+	std::unordered_map<std::string, int> m_Indices;
+
+	// message i holds the options starting at i * m_PackedOptionsPerMsg,
+	// it is m_vPackedData[m_vPackedOffsets[i]] to m_vPackedData[m_vPackedOffsets[i + 1]]
+	int m_PackedOptionsPerMsg = 0;
+	std::vector<unsigned char> m_vPackedData;
+	std::vector<size_t> m_vPackedOffsets;
+
+	static std::string Key(const char *pDescription);
+	CVoteOptionServer *NewOption(const char *pDescription, const char *pCommand);
+	void PackMsg(int Index, int Num, CMsgPacker *pPacker) const;
+	void PackAll(int OptionsPerMsg);
+
+public:
+	int Num() const { return m_vpOptions.size(); }
+	const CVoteOptionServer *Get(int Index) const { return m_vpOptions[Index]; }
+	// returns nullptr if there is no option with this description
+	const CVoteOptionServer *Find(const char *pDescription) const;
+
+	// returns false if there is an option with this description already
+	bool Add(const char *pDescription, const char *pCommand);
+	// returns false if there is no option with this description
+	bool Remove(const char *pDescription);
+	void Clear();
+
+	// Packs up to OptionsPerMsg options starting at Index into the payload
+	// of a NETMSGTYPE_SV_VOTEOPTIONLISTADD message, returns the number of
+	// packed options.
+	int PackOptions(int Index, int OptionsPerMsg, CMsgPacker *pPacker);
+};
+
+#endif
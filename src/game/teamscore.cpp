@@ -39,6 +39,14 @@ bool CTeamsCore::CanCollide(int ClientID1, int ClientID2) const
 	return m_aTeam[ClientID1] == m_aTeam[ClientID2];
 }
 
+int CTeamsCore::MoveTeam(int ClientID, bool Super) const
+{
+	const int Team = m_aTeam[ClientID];
+	if(Super || Team == (m_IsDDRace16 ? VANILLA_TEAM_SUPER : TEAM_SUPER) || Team < 0 || Team > TEAM_SUPER)
+		return -1;
+	return Team;
+}
+
 void CTeamsCore::Reset()
 {
 	m_IsDDRace16 = false;
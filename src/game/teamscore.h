@@ -35,6 +35,9 @@ public:
 
 	bool CanKeepHook(int ClientID1, int ClientID2) const;
 	bool CanCollide(int ClientID1, int ClientID2) const;
+	// the team whose characters the character can collide with while it
+	// moves, -1 if it can collide with everybody
+	int MoveTeam(int ClientID, bool Super) const;
 
 	int Team(int ClientID) const;
 	void Team(int ClientID, int Team);
@@ -21,8 +21,6 @@ struct CVoteOptionClient
 
 struct CVoteOptionServer
 {
-	CVoteOptionServer *m_pNext;
-	CVoteOptionServer *m_pPrev;
 	char m_aDescription[VOTE_DESC_LENGTH];
 	char m_aCommand[1];
 };
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include <engine/shared/alloc_counter.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST(AllocCounter, Count)
+{
+	if(!CAllocCounter::Enabled())
+	{
+		EXPECT_EQ(CAllocCounter::ThreadAllocations(), 0);
+		return;
+	}
+
+	int64_t Start = CAllocCounter::ThreadAllocations();
+	std::unique_ptr<int> pInt = std::make_unique<int>(1);
+	std::unique_ptr<int[]> pArray(new int[16]);
+	EXPECT_EQ(CAllocCounter::ThreadAllocations() - Start, 2);
+
+	// reusing the memory of a vector doesn't allocate
+	std::vector<int> vInts;
+	vInts.reserve(64);
+	Start = CAllocCounter::ThreadAllocations();
+	for(int i = 0; i < 10; i++)
+	{
+		vInts.clear();
+		for(int j = 0; j < 64; j++)
+			vInts.push_back(j);
+	}
+	EXPECT_EQ(CAllocCounter::ThreadAllocations() - Start, 0);
+
+	// malloc through the counter counts as well
+	Start = CAllocCounter::ThreadAllocations();
+	void *pData = CAllocCounter::Malloc(64);
+	CAllocCounter::Free(pData);
+	EXPECT_EQ(CAllocCounter::ThreadAllocations() - Start, 1);
+}
+
+TEST(AllocCounter, PerThread)
+{
+	const int64_t Start = CAllocCounter::ThreadAllocations();
+	int64_t ThreadAllocations = -1;
+	std::thread Thread([&ThreadAllocations]() {
+		const int64_t ThreadStart = CAllocCounter::ThreadAllocations();
+		std::vector<int> vInts(100);
+		ThreadAllocations = CAllocCounter::ThreadAllocations() - ThreadStart;
+	});
+	Thread.join();
+	EXPECT_EQ(ThreadAllocations, CAllocCounter::Enabled() ? 1 : 0);
+	// starting the thread may allocate, but the vector in it doesn't count here
+	EXPECT_LE(CAllocCounter::ThreadAllocations() - Start, 2);
+}
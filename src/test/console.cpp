@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <engine/shared/config.h>
+#include <engine/shared/console.h>
+
+static void CountCallback(IConsole::IResult *pResult, void *pUserData)
+{
+	(*static_cast<int *>(pUserData))++;
+}
+
+static void StrokeCallback(IConsole::IResult *pResult, void *pUserData)
+{
+	*static_cast<int *>(pUserData) = pResult->GetInteger(0);
+}
+
+TEST(Console, FindCommandNoCase)
+{
+	CConsole Console(CFGFLAG_SERVER);
+	int Count = 0;
+	Console.Register("test_cmd", "", CFGFLAG_SERVER, CountCallback, &Count, "");
+
+	EXPECT_NE(Console.GetCommandInfo("test_cmd", CFGFLAG_SERVER, false), nullptr);
+	EXPECT_NE(Console.GetCommandInfo("TEST_Cmd", CFGFLAG_SERVER, false), nullptr);
+	EXPECT_EQ(Console.GetCommandInfo("test_cmd", CFGFLAG_CLIENT, false), nullptr);
+	EXPECT_EQ(Console.GetCommandInfo("test_cmd", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_EQ(Console.GetCommandInfo("test_cm", CFGFLAG_SERVER, false), nullptr);
+
+	Console.ExecuteLine("test_cmd; TEST_CMD;test_cmd # test_cmd");
+	EXPECT_EQ(Count, 3);
+}
+
+TEST(Console, TempCommands)
+{
+	CConsole Console(CFGFLAG_SERVER);
+	Console.RegisterTemp("temp_a", "", CFGFLAG_SERVER, "");
+	Console.RegisterTemp("temp_b", "", CFGFLAG_SERVER, "");
+	EXPECT_NE(Console.GetCommandInfo("temp_a", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_NE(Console.GetCommandInfo("temp_b", CFGFLAG_SERVER, true), nullptr);
+
+	Console.DeregisterTemp("temp_a");
+	EXPECT_EQ(Console.GetCommandInfo("temp_a", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_NE(Console.GetCommandInfo("temp_b", CFGFLAG_SERVER, true), nullptr);
+
+	// recycled entry must be reachable under its new name only
+	Console.RegisterTemp("temp_c", "", CFGFLAG_SERVER, "");
+	EXPECT_EQ(Console.GetCommandInfo("temp_a", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_NE(Console.GetCommandInfo("temp_c", CFGFLAG_SERVER, true), nullptr);
+
+	Console.DeregisterTempAll();
+	EXPECT_EQ(Console.GetCommandInfo("temp_b", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_EQ(Console.GetCommandInfo("temp_c", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_NE(Console.GetCommandInfo("echo", CFGFLAG_SERVER, false), nullptr);
+}
+
+TEST(Console, StrokeCommand)
+{
+	CConsole Console(CFGFLAG_SERVER);
+	int Count = 0;
+	int Stroke = -1;
+	Console.Register("count", "", CFGFLAG_SERVER, CountCallback, &Count, "");
+	Console.Register("+stroke", "", CFGFLAG_SERVER, StrokeCallback, &Stroke, "");
+
+	IConsole *pConsole = &Console;
+
+	pConsole->ExecuteLineStroked(1, "count; +stroke");
+	EXPECT_EQ(Count, 1);
+	EXPECT_EQ(Stroke, 1);
+	pConsole->ExecuteLineStroked(0, "count; +stroke");
+	EXPECT_EQ(Count, 1);
+	EXPECT_EQ(Stroke, 0);
+
+	// an empty part ends the line for both strokes
+	Stroke = -1;
+	pConsole->ExecuteLineStroked(0, "count; ; +stroke");
+	EXPECT_EQ(Stroke, -1);
+}
@@ -0,0 +1,125 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/client/demoindex.h>
+#include <engine/console.h>
+#include <engine/shared/config.h>
+#include <engine/shared/demo.h>
+#include <engine/shared/snapshot.h>
+#include <engine/storage.h>
+
+#include <memory>
+
+static void WriteDemo(IStorage *pStorage, const char *pFilename, const char *pMapName, int Length, bool Valid)
+{
+	CDemoHeader Header;
+	mem_zero(&Header, sizeof(Header));
+	static const unsigned char s_aMarker[7] = {'T', 'W', 'D', 'E', 'M', 'O', 0};
+	mem_copy(Header.m_aMarker, s_aMarker, sizeof(s_aMarker));
+	if(!Valid)
+		Header.m_aMarker[0] = 'X';
+	Header.m_Version = 5;
+	str_copy(Header.m_aMapName, pMapName);
+	uint_to_bytes_be(Header.m_aLength, Length);
+	CTimelineMarkers TimelineMarkers;
+	mem_zero(&TimelineMarkers, sizeof(TimelineMarkers));
+	uint_to_bytes_be(TimelineMarkers.m_aNumTimelineMarkers, 2);
+
+	IOHANDLE File = pStorage->OpenFile(pFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	ASSERT_TRUE(File);
+	io_write(File, &Header, sizeof(Header));
+	io_write(File, &TimelineMarkers, sizeof(TimelineMarkers));
+	io_close(File);
+}
+
+static std::shared_ptr<CDemoScanJob> Scan(std::shared_ptr<CDemoIndex> pIndex, IStorage *pStorage, const IDemoPlayer *pDemoPlayer, const char **ppFilenames, int NumDemos, int64_t Size, bool ReadUncached)
+{
+	std::vector<CDemoScanJob::CDemo> vDemos(NumDemos);
+	for(int i = 0; i < NumDemos; i++)
+	{
+		str_copy(vDemos[i].m_aFilename, ppFilenames[i]);
+		vDemos[i].m_StorageType = IStorage::TYPE_SAVE;
+		vDemos[i].m_Entry.m_Size = Size;
+		vDemos[i].m_Entry.m_Date = 1234;
+	}
+	auto pJob = std::make_shared<CDemoScanJob>(std::move(pIndex), pStorage, pDemoPlayer, std::move(vDemos), ReadUncached);
+	CJobPool::RunBlocking(pJob.get());
+	EXPECT_EQ(pJob->NumDone(), NumDemos);
+	return pJob;
+}
+
+TEST(DemoIndex, Scan)
+{
+	CTestInfo Info;
+	Info.m_DeleteTestStorageFilesOnSuccess = true;
+
+	auto pConsole = CreateConsole(CFGFLAG_CLIENT);
+	auto pStorage = std::unique_ptr<IStorage>(Info.CreateTestStorage());
+	WriteDemo(pStorage.get(), "a.demo", "Tutorial", 3000, true);
+	WriteDemo(pStorage.get(), "b.demo", "Multeasymap", 100, false);
+	const char *apFilenames[] = {"a.demo", "b.demo"};
+
+	CSnapshotDelta SnapshotDelta;
+	CDemoPlayer DemoPlayer(&SnapshotDelta);
+	auto pIndex = std::make_shared<CDemoIndex>(pConsole.get(), pStorage.get());
+
+	// nothing cached yet
+	auto pJob = Scan(pIndex, pStorage.get(), &DemoPlayer, apFilenames, 2, 1000, false);
+	EXPECT_FALSE(pJob->Demo(0).m_InfosLoaded);
+	EXPECT_FALSE(pJob->Demo(1).m_InfosLoaded);
+
+	pJob = Scan(pIndex, pStorage.get(), &DemoPlayer, apFilenames, 2, 1000, true);
+	ASSERT_TRUE(pJob->Demo(0).m_InfosLoaded);
+	EXPECT_TRUE(pJob->Demo(0).m_Entry.m_Valid);
+	EXPECT_STREQ(pJob->Demo(0).m_Entry.m_MapInfo.m_aName, "Tutorial");
+	ASSERT_TRUE(pJob->Demo(1).m_InfosLoaded);
+	EXPECT_FALSE(pJob->Demo(1).m_Entry.m_Valid);
+
+	// the infos are cached now, without reading the demos
+	ASSERT_TRUE(pStorage->RemoveFile("a.demo", IStorage::TYPE_SAVE));
+	pJob = Scan(pIndex, pStorage.get(), &DemoPlayer, apFilenames, 2, 1000, false);
+	ASSERT_TRUE(pJob->Demo(0).m_InfosLoaded);
+	const CDemoIndex::CEntry &Entry = pJob->Demo(0).m_Entry;
+	EXPECT_TRUE(Entry.m_Valid);
+	EXPECT_STREQ(Entry.m_Info.m_aMapName, "Tutorial");
+	EXPECT_STREQ(Entry.m_MapInfo.m_aName, "Tutorial");
+	EXPECT_EQ(bytes_be_to_uint(Entry.m_Info.m_aLength), 3000u);
+	EXPECT_EQ(bytes_be_to_uint(Entry.m_TimelineMarkers.m_aNumTimelineMarkers), 2u);
+	ASSERT_TRUE(pJob->Demo(1).m_InfosLoaded);
+	EXPECT_FALSE(pJob->Demo(1).m_Entry.m_Valid);
+
+	// and persistent
+	pIndex = std::make_shared<CDemoIndex>(pConsole.get(), pStorage.get());
+	pJob = Scan(pIndex, pStorage.get(), &DemoPlayer, apFilenames, 1, 1000, false);
+	EXPECT_TRUE(pJob->Demo(0).m_InfosLoaded);
+
+	// changed demos are not taken from the cache
+	pJob = Scan(pIndex, pStorage.get(), &DemoPlayer, apFilenames, 2, 1001, false);
+	EXPECT_FALSE(pJob->Demo(0).m_InfosLoaded);
+	EXPECT_FALSE(pJob->Demo(1).m_InfosLoaded);
+}
+
+TEST(DemoIndex, Abort)
+{
+	CTestInfo Info;
+	Info.m_DeleteTestStorageFilesOnSuccess = true;
+	auto pStorage = std::unique_ptr<IStorage>(Info.CreateTestStorage());
+
+	CSnapshotDelta SnapshotDelta;
+	CDemoPlayer DemoPlayer(&SnapshotDelta);
+	std::vector<CDemoScanJob::CDemo> vDemos(3);
+	for(auto &Demo : vDemos)
+	{
+		str_copy(Demo.m_aFilename, "missing.demo");
+		Demo.m_StorageType = IStorage::TYPE_SAVE;
+		Demo.m_Entry.m_Size = 0;
+		Demo.m_Entry.m_Date = 0;
+	}
+	// works without an index
+	auto pJob = std::make_shared<CDemoScanJob>(nullptr, pStorage.get(), &DemoPlayer, std::move(vDemos), true);
+	pJob->Abort();
+	CJobPool::RunBlocking(pJob.get());
+	EXPECT_EQ(pJob->NumDone(), 0);
+	EXPECT_EQ(pJob->NumDemos(), 3);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <engine/shared/load_shedder.h>
+
+static void RunSecond(CLoadShedder *pShedder, int64_t TickCost, bool *pChanged = nullptr)
+{
+	bool Changed = false;
+	for(int i = 0; i < 50; i++)
+		Changed |= pShedder->Update(TickCost, 1);
+	if(pChanged)
+		*pChanged = Changed;
+}
+
+TEST(LoadShedder, RaiseAndLower)
+{
+	CLoadShedder Shedder;
+	Shedder.Init(50);
+	const int64_t Budget = Shedder.Budget();
+	EXPECT_EQ(Budget, 20000000);
+
+	bool Changed;
+	RunSecond(&Shedder, Budget / 2 + 1, &Changed);
+	EXPECT_FALSE(Changed);
+	EXPECT_EQ(Shedder.Level(), CLoadShedder::LEVEL_NONE);
+
+	for(int Level = 1; Level < CLoadShedder::NUM_LEVELS; Level++)
+	{
+		RunSecond(&Shedder, Budget * 2, &Changed);
+		EXPECT_TRUE(Changed);
+		EXPECT_EQ(Shedder.Level(), Level);
+	}
+	RunSecond(&Shedder, Budget * 2, &Changed);
+	EXPECT_FALSE(Changed);
+	EXPECT_TRUE(Shedder.Active(CLoadShedder::LEVEL_SCORE));
+
+	// lowered one level after enough calm seconds
+	for(int i = 0; i < CLoadShedder::CALM_SECONDS - 1; i++)
+		RunSecond(&Shedder, Budget / 10);
+	EXPECT_EQ(Shedder.Level(), CLoadShedder::LEVEL_SCORE);
+	RunSecond(&Shedder, Budget / 10, &Changed);
+	EXPECT_TRUE(Changed);
+	EXPECT_EQ(Shedder.Level(), CLoadShedder::LEVEL_SERVERINFO);
+
+	// a busy second resets the calm streak
+	for(int i = 0; i < CLoadShedder::CALM_SECONDS - 1; i++)
+		RunSecond(&Shedder, Budget / 10);
+	RunSecond(&Shedder, Budget * 7 / 10);
+	RunSecond(&Shedder, Budget / 10);
+	EXPECT_EQ(Shedder.Level(), CLoadShedder::LEVEL_SERVERINFO);
+}
+
+TEST(LoadShedder, MaxLevel)
+{
+	CLoadShedder Shedder;
+	Shedder.Init(50);
+	Shedder.SetMaxLevel(CLoadShedder::LEVEL_SPECTATOR_SNAPS);
+	for(int i = 0; i < 5; i++)
+		RunSecond(&Shedder, Shedder.Budget() * 3);
+	EXPECT_EQ(Shedder.Level(), CLoadShedder::LEVEL_SPECTATOR_SNAPS);
+	EXPECT_FALSE(Shedder.Active(CLoadShedder::LEVEL_DEMO));
+
+	Shedder.SetMaxLevel(CLoadShedder::LEVEL_NONE);
+	EXPECT_EQ(Shedder.Level(), CLoadShedder::LEVEL_NONE);
+	RunSecond(&Shedder, Shedder.Budget() * 3);
+	EXPECT_EQ(Shedder.Level(), CLoadShedder::LEVEL_NONE);
+}
+
+TEST(LoadShedder, NetworkOnlyIterations)
+{
+	CLoadShedder Shedder;
+	Shedder.Init(50);
+	// time spent without ticks is added to the next tick
+	for(int i = 0; i < 50; i++)
+	{
+		Shedder.Update(Shedder.Budget() / 2, 0);
+		Shedder.Update(Shedder.Budget() / 2, 1);
+	}
+	EXPECT_EQ(Shedder.AvgCost(), Shedder.Budget());
+	EXPECT_EQ(Shedder.Level(), CLoadShedder::LEVEL_SPECTATOR_SNAPS);
+}
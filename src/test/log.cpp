@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <base/logger.h>
+#include <base/system.h>
+
+static const int NUM_PRODUCERS = 4;
+static const int NUM_MESSAGES = 2000;
+
+struct CProducerData
+{
+	CLogMessageQueue *m_pQueue;
+	int m_Producer;
+};
+
+static void Produce(void *pUser)
+{
+	CProducerData *pData = (CProducerData *)pUser;
+	CLogMessage Msg;
+	for(int i = 0; i < NUM_MESSAGES; i++)
+	{
+		Msg.m_Level = LEVEL_INFO;
+		Msg.m_SystemLength = pData->m_Producer;
+		Msg.m_LineLength = i;
+		pData->m_pQueue->Push(&Msg);
+	}
+}
+
+TEST(Log, QueueOrder)
+{
+	CLogMessageQueue Queue;
+	CLogMessage Msg;
+	EXPECT_FALSE(Queue.Pop(&Msg));
+	for(int i = 0; i < 3; i++)
+	{
+		Msg.m_LineLength = i;
+		Queue.Push(&Msg);
+	}
+	for(int i = 0; i < 3; i++)
+	{
+		ASSERT_TRUE(Queue.Pop(&Msg));
+		EXPECT_EQ(Msg.m_LineLength, i);
+	}
+	EXPECT_FALSE(Queue.Pop(&Msg));
+
+	// pending messages are freed with the queue
+	Queue.Push(&Msg);
+}
+
+TEST(Log, QueueReusesNodes)
+{
+	// more messages than fit into one chunk, queued and drained repeatedly
+	CLogMessageQueue Queue;
+	CLogMessage Msg;
+	for(int Round = 0; Round < 4; Round++)
+	{
+		for(int i = 0; i < 100; i++)
+		{
+			Msg.m_LineLength = i;
+			ASSERT_TRUE(Queue.Push(&Msg));
+		}
+		for(int i = 0; i < 100; i++)
+		{
+			ASSERT_TRUE(Queue.Pop(&Msg));
+			EXPECT_EQ(Msg.m_LineLength, i);
+		}
+		EXPECT_FALSE(Queue.Pop(&Msg));
+	}
+}
+
+TEST(Log, QueueMultipleProducers)
+{
+	CLogMessageQueue Queue;
+	CProducerData aData[NUM_PRODUCERS];
+	void *apThreads[NUM_PRODUCERS];
+	for(int i = 0; i < NUM_PRODUCERS; i++)
+	{
+		aData[i] = {&Queue, i};
+		apThreads[i] = thread_init(Produce, &aData[i], "log_producer");
+	}
+
+	// messages of every producer must arrive in order
+	int aNext[NUM_PRODUCERS] = {0};
+	int Received = 0;
+	CLogMessage Msg;
+	while(Received < NUM_PRODUCERS * NUM_MESSAGES)
+	{
+		if(!Queue.Pop(&Msg))
+		{
+			thread_yield();
+			continue;
+		}
+		ASSERT_GE(Msg.m_SystemLength, 0);
+		ASSERT_LT(Msg.m_SystemLength, NUM_PRODUCERS);
+		EXPECT_EQ(Msg.m_LineLength, aNext[Msg.m_SystemLength]);
+		aNext[Msg.m_SystemLength]++;
+		Received++;
+	}
+	EXPECT_FALSE(Queue.Pop(&Msg));
+
+	for(auto *pThread : apThreads)
+		thread_wait(pThread);
+}
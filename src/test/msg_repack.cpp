@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <engine/message.h>
+#include <engine/server/msg_repack.h>
+#include <engine/shared/bandwidth_stats.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/protocol7.h>
+#include <game/generated/protocol.h>
+#include <game/generated/protocol7.h>
+
+static int UnpackMsgId(const CPacker &Packer, bool *pSystem)
+{
+	CUnpacker Unpacker;
+	Unpacker.Reset(Packer.Data(), Packer.Size());
+	const int Header = Unpacker.GetInt();
+	*pSystem = Header & 1;
+	return Header >> 1;
+}
+
+TEST(MsgRepack, TranslatesForSixup)
+{
+	CMsgPacker Msg(NETMSGTYPE_SV_KILLMSG, false);
+	Msg.AddInt(1);
+	CPacker Packer;
+	bool System;
+
+	EXPECT_EQ(RepackMsg(&Msg, Packer, false), NETMSGTYPE_SV_KILLMSG);
+	EXPECT_EQ(UnpackMsgId(Packer, &System), NETMSGTYPE_SV_KILLMSG);
+	EXPECT_FALSE(System);
+
+	EXPECT_EQ(RepackMsg(&Msg, Packer, true), protocol7::NETMSGTYPE_SV_KILLMSG);
+	EXPECT_EQ(UnpackMsgId(Packer, &System), protocol7::NETMSGTYPE_SV_KILLMSG);
+	EXPECT_FALSE(System);
+
+	CMsgPacker Ping(NETMSG_PING, true);
+	EXPECT_EQ(RepackMsg(&Ping, Packer, true), protocol7::NETMSG_PING);
+	EXPECT_EQ(UnpackMsgId(Packer, &System), protocol7::NETMSG_PING);
+	EXPECT_TRUE(System);
+
+	// messages that 0.7 doesn't know are dropped
+	CMsgPacker Legacy(NETMSGTYPE_SV_DDRACETIMELEGACY, false);
+	EXPECT_EQ(RepackMsg(&Legacy, Packer, true), -1);
+}
+
+TEST(MsgRepack, CountsSixupUnderPackedId)
+{
+	CBandwidthStats Stats;
+	Stats.Update(1, 0, 0);
+
+	// translated from 0.6, and a 0.7 message that has the 0.6 ID of the
+	// first one, each must end up under its 0.7 ID
+	CMsgPacker KillMsg(NETMSGTYPE_SV_KILLMSG, false);
+	CMsgPacker Team(protocol7::NETMSGTYPE_SV_TEAM, false, true);
+	ASSERT_EQ(protocol7::NETMSGTYPE_SV_TEAM, NETMSGTYPE_SV_KILLMSG);
+	for(const CMsgPacker *pMsg : {&KillMsg, &Team})
+	{
+		CPacker Packer;
+		const int MsgId = RepackMsg(pMsg, Packer, true);
+		ASSERT_GE(MsgId, 0);
+		CountSentMsg(Stats, pMsg, MsgId, Packer.Size(), MSGFLAG_VITAL);
+	}
+	Stats.Update(1 + time_freq(), 0, 0);
+
+	const int Category = CBandwidthStats::CATEGORY_GAME_MSG;
+	EXPECT_EQ(Stats.LastSecond(Category, CBandwidthStats::TypeIndex(protocol7::NETMSGTYPE_SV_KILLMSG)).m_Num, 1);
+	EXPECT_EQ(Stats.LastSecond(Category, CBandwidthStats::TypeIndex(protocol7::NETMSGTYPE_SV_TEAM)).m_Num, 1);
+	EXPECT_EQ(Stats.LastSecondVital().m_Num, 2);
+}
@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 
 #include <base/system.h>
+#include <engine/shared/config.h>
+#include <engine/shared/network.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
 
 TEST(Net, Ipv4AndIpv6Work)
 {
@@ -48,3 +54,174 @@ TEST(Net, Ipv4AndIpv6Work)
 	net_udp_close(Socket1);
 	net_udp_close(Socket2);
 }
+
+// sets a global config variable, and resets it even if an assertion
+// returns early
+class CConfigScope
+{
+	int &m_Variable;
+	int m_Old;
+
+public:
+	CConfigScope(int &Variable, int Value) :
+		m_Variable(Variable), m_Old(Variable)
+	{
+		m_Variable = Value;
+	}
+	~CConfigScope() { m_Variable = m_Old; }
+};
+
+TEST(Net, ServerDropsBeforeDecoding)
+{
+	CConfigScope PerSecond(g_Config.m_SvPrefixPacketsPerSecond, 10);
+
+	// too large for the stack
+	std::unique_ptr<CNetServer> pServer = std::make_unique<CNetServer>();
+	NETADDR BindAddr = {};
+	BindAddr.type = NETTYPE_IPV4;
+	do
+	{
+		BindAddr.port = secure_rand() % 64511 + 1024;
+	} while(!pServer->Open(BindAddr, nullptr, 4, 4));
+
+	NETADDR ClientAddr = {};
+	ClientAddr.type = NETTYPE_IPV4;
+	NETSOCKET ClientSocket = net_udp_create(ClientAddr);
+	ASSERT_TRUE(ClientSocket);
+	NETADDR Target;
+	ASSERT_FALSE(net_addr_from_str(&Target, "127.0.0.1"));
+	Target.port = BindAddr.port;
+
+	EXPECT_EQ(net_udp_send(ClientSocket, &Target, "a", 1), 1);
+	static const unsigned char s_aConnless[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 'i', 'n', 'f', 'o'};
+	for(int i = 0; i < 15; i++)
+		EXPECT_EQ(net_udp_send(ClientSocket, &Target, s_aConnless, sizeof(s_aConnless)), (int)sizeof(s_aConnless));
+
+	int NumChunks = 0;
+	auto NumCounted = [&]() {
+		int64_t Num = 0;
+		for(int i = 0; i < CNetServer::NUM_RECV_COUNTERS; i++)
+			Num += pServer->RecvCounter(i);
+		return Num;
+	};
+	for(int Try = 0; Try < 100 && NumCounted() < 16; Try++)
+	{
+		net_socket_read_wait(pServer->Socket(), 10000);
+		CNetChunk Chunk;
+		SECURITY_TOKEN ResponseToken;
+		while(pServer->Recv(&Chunk, &ResponseToken))
+		{
+			EXPECT_EQ(Chunk.m_DataSize, 4);
+			NumChunks++;
+		}
+	}
+
+	EXPECT_EQ(pServer->RecvCounter(CNetServer::RECV_MALFORMED), 1);
+	EXPECT_EQ(pServer->RecvCounter(CNetServer::RECV_ADMITTED), 10);
+	EXPECT_EQ(pServer->RecvCounter(CNetServer::RECV_RATE_LIMITED), 5);
+	EXPECT_EQ(NumChunks, 10);
+
+	net_udp_close(ClientSocket);
+	pServer->Close();
+}
+
+static int NewClient(int ClientID, void *pUser, bool Sixup)
+{
+	((std::vector<int> *)pUser)->push_back(ClientID);
+	return 0;
+}
+
+static int DelClient(int ClientID, const char *pReason, void *pUser)
+{
+	return 0;
+}
+
+TEST(Net, ServerFindsClientSlots)
+{
+	CNetBase::Init();
+	CConfigScope Timeout(g_Config.m_ConnTimeout, 100);
+
+	std::unique_ptr<CNetServer> pServer = std::make_unique<CNetServer>();
+	NETADDR BindAddr = {};
+	BindAddr.type = NETTYPE_IPV4;
+	do
+	{
+		BindAddr.port = secure_rand() % 64511 + 1024;
+	} while(!pServer->Open(BindAddr, nullptr, 4, 2));
+	std::vector<int> vNewClients;
+	pServer->SetCallbacks(NewClient, DelClient, &vNewClients);
+
+	NETADDR Target;
+	ASSERT_FALSE(net_addr_from_str(&Target, "127.0.0.1"));
+	Target.port = BindAddr.port;
+
+	std::vector<std::unique_ptr<CNetClient>> vpClients;
+	auto Pump = [&](const std::function<bool()> &Done) {
+		for(int Try = 0; Try < 200 && !Done(); Try++)
+		{
+			CNetChunk Chunk;
+			for(auto &pClient : vpClients)
+			{
+				while(pClient->Recv(&Chunk))
+					;
+				pClient->Update();
+			}
+			net_socket_read_wait(pServer->Socket(), 10000);
+			SECURITY_TOKEN ResponseToken;
+			while(pServer->Recv(&Chunk, &ResponseToken))
+				;
+			pServer->Update();
+		}
+	};
+	auto Connect = [&]() {
+		vpClients.push_back(std::make_unique<CNetClient>());
+		NETADDR ClientAddr = {};
+		ClientAddr.type = NETTYPE_IPV4;
+		EXPECT_TRUE(vpClients.back()->Open(ClientAddr));
+		vpClients.back()->Connect(&Target, 1);
+	};
+
+	// the third one is over the limit of clients per address
+	for(int i = 0; i < 3; i++)
+		Connect();
+	Pump([&]() { return vpClients[0]->State() == NETSTATE_ONLINE && vpClients[1]->State() == NETSTATE_ONLINE && vpClients[2]->ErrorString()[0]; });
+	EXPECT_EQ(vNewClients, std::vector<int>({0, 1}));
+	EXPECT_STREQ(vpClients[2]->ErrorString(), "Only 2 players with the same IP are allowed");
+
+	auto Received = [&](CNetClient *pClient, const char *pMessage) {
+		CNetChunk Chunk;
+		Chunk.m_ClientID = 0;
+		Chunk.m_Flags = NETSENDFLAG_VITAL | NETSENDFLAG_FLUSH;
+		Chunk.m_pData = pMessage;
+		Chunk.m_DataSize = str_length(pMessage);
+		pClient->Send(&Chunk);
+
+		int ClientID = -1;
+		SECURITY_TOKEN ResponseToken;
+		for(int Try = 0; Try < 100 && ClientID == -1; Try++)
+		{
+			net_socket_read_wait(pServer->Socket(), 10000);
+			while(pServer->Recv(&Chunk, &ResponseToken))
+			{
+				if(Chunk.m_DataSize == str_length(pMessage) && mem_comp(Chunk.m_pData, pMessage, Chunk.m_DataSize) == 0)
+					ClientID = Chunk.m_ClientID;
+			}
+		}
+		return ClientID;
+	};
+	EXPECT_EQ(Received(vpClients[1].get(), "second"), 1);
+	EXPECT_EQ(Received(vpClients[0].get(), "first"), 0);
+
+	// the slot is reused, with the address of the new client
+	pServer->Drop(0, "dropped");
+	Connect();
+	Pump([&]() { return vpClients[3]->State() == NETSTATE_ONLINE; });
+	EXPECT_EQ(vNewClients, std::vector<int>({0, 1, 0}));
+	EXPECT_EQ(Received(vpClients[3].get(), "fourth"), 0);
+	EXPECT_EQ(Received(vpClients[0].get(), "first again"), -1);
+	EXPECT_EQ(Received(vpClients[1].get(), "second again"), 1);
+
+	for(auto &pClient : vpClients)
+		pClient->Close();
+	pServer->Close();
+}
@@ -0,0 +1,211 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <base/logger.h>
+#include <base/system.h>
+#include <engine/console.h>
+#include <engine/shared/config.h>
+#include <engine/shared/netban.h>
+#include <engine/storage.h>
+
+#include <memory>
+#include <vector>
+
+static NETADDR RandomAddr(int Type)
+{
+	NETADDR Addr = {};
+	Addr.type = Type;
+	secure_random_fill(Addr.ip, Type == NETTYPE_IPV4 ? 4 : 16);
+	// keep away from localhost, it can't be banned
+	if(Addr.ip[0] == 0 || Addr.ip[0] == 127)
+		Addr.ip[0] = 1;
+	return Addr;
+}
+
+// a range whose addresses share the first Prefix bytes
+static CNetRange RandomRange(int Type, int Prefix)
+{
+	const int Length = Type == NETTYPE_IPV4 ? 4 : 16;
+	CNetRange Range;
+	Range.m_LB = RandomAddr(Type);
+	Range.m_UB = RandomAddr(Type);
+	mem_copy(Range.m_UB.ip, Range.m_LB.ip, Prefix);
+	if(Range.m_LB.ip[Prefix] == Range.m_UB.ip[Prefix])
+		Range.m_UB.ip[Prefix] ^= 1;
+	if(Range.m_LB.ip[Prefix] > Range.m_UB.ip[Prefix])
+	{
+		for(int i = Prefix; i < Length; i++)
+			std::swap(Range.m_LB.ip[i], Range.m_UB.ip[i]);
+	}
+	return Range;
+}
+
+static bool InRange(const CNetRange &Range, const NETADDR &Addr)
+{
+	const int Length = Addr.type == NETTYPE_IPV4 ? 4 : 16;
+	return Range.m_LB.type == Addr.type && mem_comp(Range.m_LB.ip, Addr.ip, Length) <= 0 && mem_comp(Range.m_UB.ip, Addr.ip, Length) >= 0;
+}
+
+class NetBan : public ::testing::Test
+{
+protected:
+	CTestInfo m_Info;
+	std::unique_ptr<IStorage> m_pStorage;
+	// the ban messages are not interesting here
+	std::unique_ptr<ILogger> m_pNoLogger = log_logger_collection({});
+	CLogScope m_LogScope{m_pNoLogger.get()};
+
+	NetBan()
+	{
+		m_Info.m_DeleteTestStorageFilesOnSuccess = true;
+		m_pStorage = std::unique_ptr<IStorage>(m_Info.CreateTestStorage());
+	}
+
+	bool IsBanned(const CNetBan &Ban, const NETADDR &Addr)
+	{
+		char aBuf[256];
+		return Ban.IsBanned(&Addr, aBuf, sizeof(aBuf));
+	}
+};
+
+TEST_F(NetBan, RangesMatchScan)
+{
+	auto pConsole = CreateConsole(CFGFLAG_SERVER);
+	CNetBan Ban;
+	Ban.Init(pConsole.get(), m_pStorage.get());
+
+	// more than used to fit into the ban list, with nested and overlapping ranges
+	std::vector<CNetRange> vRanges;
+	for(int i = 0; i < 3000; i++)
+	{
+		const int Type = i % 10 == 0 ? NETTYPE_IPV6 : NETTYPE_IPV4;
+		const int Prefix = Type == NETTYPE_IPV4 ? 1 + i % 3 : 2 + i % 12;
+		vRanges.push_back(RandomRange(Type, Prefix));
+		ASSERT_EQ(Ban.BanRange(&vRanges.back(), 0, "test"), 0);
+	}
+	NETADDR Banned = RandomAddr(NETTYPE_IPV4);
+	ASSERT_EQ(Ban.BanAddr(&Banned, 0, "test"), 0);
+	EXPECT_TRUE(IsBanned(Ban, Banned));
+
+	auto CheckAddresses = [&]() {
+		for(int i = 0; i < 10000; i++)
+		{
+			const CNetRange &Near = vRanges[i % vRanges.size()];
+			NETADDR Addr = RandomAddr(Near.m_LB.type);
+			// mostly addresses that share a prefix with a ban
+			mem_copy(Addr.ip, i % 2 ? Near.m_LB.ip : Near.m_UB.ip, i % 4 + 1);
+			bool Expected = false;
+			for(const CNetRange &Range : vRanges)
+				Expected = Expected || InRange(Range, Addr);
+			ASSERT_EQ(IsBanned(Ban, Addr), Expected || NetComp(&Addr, &Banned) == 0);
+		}
+	};
+	CheckAddresses();
+
+	for(int i = 0; i < 1500; i++)
+	{
+		ASSERT_EQ(Ban.UnbanByRange(&vRanges.back()), 0);
+		vRanges.pop_back();
+	}
+	CheckAddresses();
+
+	Ban.UnbanAll();
+	EXPECT_FALSE(IsBanned(Ban, Banned));
+	EXPECT_FALSE(IsBanned(Ban, vRanges[0].m_LB));
+}
+
+// sv_bans_file is global, reset it even if an assertion returns early
+class CBansFileScope
+{
+public:
+	CBansFileScope(const char *pFilename) { str_copy(g_Config.m_SvBansFile, pFilename); }
+	~CBansFileScope() { g_Config.m_SvBansFile[0] = '\0'; }
+};
+
+static NETADDR Addr(const char *pStr)
+{
+	NETADDR Result;
+	EXPECT_EQ(net_addr_from_str(&Result, pStr), 0);
+	return Result;
+}
+
+static CNetRange Range(const char *pFirst, const char *pLast)
+{
+	CNetRange Result;
+	Result.m_LB = Addr(pFirst);
+	Result.m_UB = Addr(pLast);
+	return Result;
+}
+
+TEST_F(NetBan, BansFile)
+{
+	const NETADDR Addr1 = Addr("1.2.3.4");
+	const NETADDR Addr2 = Addr("[2001:db8::1]");
+	const CNetRange Range1 = Range("10.0.0.0", "10.0.255.255");
+	const CNetRange Range2 = Range("[2001:db8:1::]", "[2001:db8:1::ffff]");
+
+	CBansFileScope BansFile("bans.cfg");
+	int Expires;
+	{
+		auto pConsole = CreateConsole(CFGFLAG_SERVER);
+		CNetBan Ban;
+		Ban.Init(pConsole.get(), m_pStorage.get());
+		Ban.Update();
+		Ban.BanAddr(&Addr1, 0, "permanent");
+		Expires = time_timestamp() + 600;
+		Ban.BanAddr(&Addr2, 600, "timed");
+		Ban.BanRange(&Range1, 0, "range");
+		Ban.BanRange(&Range2, 0, "range");
+		Ban.UnbanByRange(&Range2);
+	}
+
+	// loaded again, and written again without the removed ban
+	for(int Run = 0; Run < 2; Run++)
+	{
+		auto pConsole = CreateConsole(CFGFLAG_SERVER);
+		// like the server, which only loads the bans once it runs
+		pConsole->StoreCommands(false);
+		CNetBan Ban;
+		Ban.Init(pConsole.get(), m_pStorage.get());
+		Ban.Update();
+		EXPECT_TRUE(IsBanned(Ban, Addr1));
+		EXPECT_TRUE(IsBanned(Ban, Addr2));
+		EXPECT_TRUE(IsBanned(Ban, Range1.m_UB));
+		EXPECT_FALSE(IsBanned(Ban, Range2.m_UB));
+	}
+
+	IOHANDLE File = m_pStorage->OpenFile("bans.cfg", IOFLAG_READ, IStorage::TYPE_SAVE);
+	ASSERT_TRUE(File);
+	char *pContents = io_read_all_str(File);
+	io_close(File);
+	ASSERT_TRUE(pContents);
+	EXPECT_FALSE(str_find(pContents, "unban_range"));
+	// the reloads kept the expiry instead of starting the ban again
+	char aLine[128];
+	str_format(aLine, sizeof(aLine), "ban_until [2001:db8::1] %d timed", Expires);
+	const bool Kept = str_find(pContents, aLine);
+	str_format(aLine, sizeof(aLine), "ban_until [2001:db8::1] %d timed", Expires + 1);
+	EXPECT_TRUE(Kept || str_find(pContents, aLine)) << pContents;
+	free(pContents);
+}
+
+TEST_F(NetBan, BansFileSkipsExpired)
+{
+	const int Now = time_timestamp();
+	char aBans[256];
+	str_format(aBans, sizeof(aBans), "ban_until 1.2.3.4 %d expired\nban_until 1.2.3.5 %d valid\nban_range_until 10.0.0.0 10.0.0.255 %d expired\n", Now - 60, Now + 600, Now - 1);
+	IOHANDLE File = m_pStorage->OpenFile("bans.cfg", IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	ASSERT_TRUE(File);
+	io_write(File, aBans, str_length(aBans));
+	io_close(File);
+
+	CBansFileScope BansFile("bans.cfg");
+	auto pConsole = CreateConsole(CFGFLAG_SERVER);
+	pConsole->StoreCommands(false);
+	CNetBan Ban;
+	Ban.Init(pConsole.get(), m_pStorage.get());
+	Ban.Update();
+	EXPECT_FALSE(IsBanned(Ban, Addr("1.2.3.4")));
+	EXPECT_TRUE(IsBanned(Ban, Addr("1.2.3.5")));
+	EXPECT_FALSE(IsBanned(Ban, Addr("10.0.0.1")));
+}
@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+
+#include <engine/map.h>
+#include <engine/shared/parallel.h>
+#include <game/collision.h>
+#include <game/gamecore.h>
+#include <game/layers.h>
+#include <game/mapitems.h>
+#include <game/teamscore.h>
+
+#include <atomic>
+#include <vector>
+
+static void ExpectAllTasksRun(CParallelRunner &Runner, int NumTasks)
+{
+	std::vector<std::atomic<int>> vRuns(NumTasks);
+	for(auto &Runs : vRuns)
+		Runs.store(0);
+	Runner.Run(NumTasks, [&](int Task) { vRuns[Task].fetch_add(1); });
+	for(int i = 0; i < NumTasks; i++)
+		EXPECT_EQ(vRuns[i].load(), 1) << "task " << i;
+}
+
+TEST(ParallelRunner, Serial)
+{
+	CParallelRunner Runner;
+	Runner.Init(0);
+	EXPECT_EQ(Runner.NumThreads(), 0);
+	ExpectAllTasksRun(Runner, 0);
+	ExpectAllTasksRun(Runner, 1);
+	ExpectAllTasksRun(Runner, 17);
+}
+
+TEST(ParallelRunner, Threads)
+{
+	CParallelRunner Runner;
+	Runner.Init(3);
+	EXPECT_EQ(Runner.NumThreads(), 3);
+	for(int i = 0; i < 100; i++)
+		ExpectAllTasksRun(Runner, i % 10);
+	ExpectAllTasksRun(Runner, 1000);
+}
+
+TEST(ParallelRunner, Restart)
+{
+	CParallelRunner Runner;
+	Runner.Init(2);
+	ExpectAllTasksRun(Runner, 8);
+	Runner.Shutdown();
+	EXPECT_EQ(Runner.NumThreads(), 0);
+	Runner.Init(1);
+	ExpectAllTasksRun(Runner, 8);
+}
+
+// a walled map with a few pillars, only the game layer
+class CTestMap : public IMap
+{
+public:
+	enum
+	{
+		WIDTH = 40,
+		HEIGHT = 30,
+	};
+
+	CMapItemGroup m_Group = {};
+	CMapItemLayerTilemap m_Layer = {};
+	CTile m_aTiles[WIDTH * HEIGHT] = {};
+
+	CTestMap()
+	{
+		m_Group.m_Version = CMapItemGroup::CURRENT_VERSION;
+		m_Group.m_NumLayers = 1;
+		m_Layer.m_Layer.m_Type = LAYERTYPE_TILES;
+		m_Layer.m_Version = CMapItemLayerTilemap::CURRENT_VERSION;
+		m_Layer.m_Width = WIDTH;
+		m_Layer.m_Height = HEIGHT;
+		m_Layer.m_Flags = TILESLAYERFLAG_GAME;
+		m_Layer.m_Data = 0;
+		for(int y = 0; y < HEIGHT; y++)
+		{
+			for(int x = 0; x < WIDTH; x++)
+			{
+				const bool Wall = x == 0 || y == 0 || x == WIDTH - 1 || y == HEIGHT - 1;
+				const bool Pillar = x % 8 == 4 && y > HEIGHT / 2;
+				m_aTiles[y * WIDTH + x].m_Index = Wall || Pillar ? TILE_SOLID : TILE_AIR;
+			}
+		}
+	}
+
+	void *GetData(int Index) override { return Index == 0 ? m_aTiles : nullptr; }
+	int GetDataSize(int Index) const override { return Index == 0 ? sizeof(m_aTiles) : 0; }
+	void *GetDataSwapped(int Index) override { return GetData(Index); }
+	void UnloadData(int Index) override {}
+	int NumData() const override { return 1; }
+
+	void *GetItem(int Index, int *pType, int *pID) override
+	{
+		if(pID)
+			*pID = 0;
+		if(pType)
+			*pType = Index == 0 ? MAPITEMTYPE_GROUP : MAPITEMTYPE_LAYER;
+		return Index == 0 ? (void *)&m_Group : (void *)&m_Layer;
+	}
+	int GetItemSize(int Index) override { return Index == 0 ? sizeof(m_Group) : sizeof(m_Layer); }
+	void GetType(int Type, int *pStart, int *pNum) override
+	{
+		*pStart = Type == MAPITEMTYPE_LAYER ? 1 : 0;
+		*pNum = Type == MAPITEMTYPE_GROUP || Type == MAPITEMTYPE_LAYER ? 1 : 0;
+	}
+	void *FindItem(int Type, int ID) override { return nullptr; }
+	int NumItems() const override { return 2; }
+};
+
+class ParallelMove : public ::testing::Test
+{
+protected:
+	enum
+	{
+		NUM_CORES = 24,
+		NUM_TICKS = 200,
+	};
+
+	CTestMap m_Map;
+	CLayers m_Layers;
+	CCollision m_Collision;
+
+	// one world moved serially, one partitioned by team and one without
+	// player collisions, which shows that the characters do collide
+	CWorldCore m_aWorlds[3];
+	CTeamsCore m_aTeams[3];
+	CCharacterCore m_aaCores[3][NUM_CORES];
+
+	ParallelMove()
+	{
+		m_Layers.InitBackground(&m_Map);
+		m_Collision.Init(&m_Layers);
+		m_aWorlds[2].m_aTuning[0].m_PlayerCollision = 0;
+		for(int w = 0; w < 3; w++)
+		{
+			for(int i = 0; i < NUM_CORES; i++)
+			{
+				CCharacterCore &Core = m_aaCores[w][i];
+				Core.Init(&m_aWorlds[w], &m_Collision, &m_aTeams[w]);
+				Core.m_Id = i;
+				// crowded, so that the characters of a team run into each
+				// other and into the ones of other teams
+				Core.m_Pos = vec2(64 + (i % 6) * 180, 96 + (i / 6) * 40);
+				Core.m_Vel = vec2((i * 7 % 11 - 5) * 3.0f, (i * 5 % 9 - 4) * 2.0f);
+				m_aWorlds[w].m_apCharacters[i] = &Core;
+				m_aTeams[w].Team(i, i % 4);
+			}
+		}
+	}
+
+	void MoveSerial(CCharacterCore *pCores)
+	{
+		for(int i = 0; i < NUM_CORES; i++)
+			pCores[i].Move();
+	}
+
+	// like CGameWorld, returns false if the characters have to move one
+	// after another. Reverse moves the last team first, the order of the
+	// teams must not matter
+	bool MoveByTeam(CParallelRunner &Runner, CCharacterCore *pCores, const CTeamsCore &Teams, bool Reverse)
+	{
+		std::vector<std::vector<CCharacterCore *>> vvPartitions;
+		int aPartition[NUM_TEAMS];
+		for(int &Partition : aPartition)
+			Partition = -1;
+		for(int i = 0; i < NUM_CORES; i++)
+		{
+			const int Team = Teams.MoveTeam(pCores[i].m_Id, pCores[i].m_Super);
+			if(Team < 0)
+				return false;
+			if(aPartition[Team] == -1)
+			{
+				aPartition[Team] = vvPartitions.size();
+				vvPartitions.emplace_back();
+			}
+			vvPartitions[aPartition[Team]].push_back(&pCores[i]);
+		}
+		Runner.Run(vvPartitions.size(), [&](int Partition) {
+			if(Reverse)
+				Partition = vvPartitions.size() - 1 - Partition;
+			for(CCharacterCore *pCore : vvPartitions[Partition])
+				pCore->Move();
+		});
+		return true;
+	}
+
+	// returns the number of ticks that could be moved in parallel
+	int Simulate(int NumThreads, bool Reverse)
+	{
+		CParallelRunner Runner;
+		Runner.Init(NumThreads);
+		int NumParallel = 0;
+		for(int Tick = 0; Tick < NUM_TICKS; Tick++)
+		{
+			for(auto &aCores : m_aaCores)
+			{
+				for(CCharacterCore &Core : aCores)
+					Core.m_Vel.y += 0.5f;
+			}
+			MoveSerial(m_aaCores[0]);
+			MoveSerial(m_aaCores[2]);
+			if(MoveByTeam(Runner, m_aaCores[1], m_aTeams[1], Reverse))
+				NumParallel++;
+			else
+				MoveSerial(m_aaCores[1]);
+			for(auto &aCores : m_aaCores)
+			{
+				for(CCharacterCore &Core : aCores)
+					Core.Quantize();
+			}
+			for(int i = 0; i < NUM_CORES; i++)
+			{
+				const CCharacterCore &Serial = m_aaCores[0][i];
+				const CCharacterCore &Parallel = m_aaCores[1][i];
+				EXPECT_EQ(Serial.m_Pos, Parallel.m_Pos) << "tick " << Tick << " core " << i;
+				EXPECT_EQ(Serial.m_Vel, Parallel.m_Vel) << "tick " << Tick << " core " << i;
+				if(Serial.m_Pos != Parallel.m_Pos || Serial.m_Vel != Parallel.m_Vel)
+					return NumParallel;
+			}
+		}
+		return NumParallel;
+	}
+};
+
+TEST_F(ParallelMove, SameAsSerial)
+{
+	EXPECT_EQ(Simulate(3, false), (int)NUM_TICKS);
+
+	int NumCollided = 0;
+	for(int i = 0; i < NUM_CORES; i++)
+		NumCollided += m_aaCores[0][i].m_Pos != m_aaCores[2][i].m_Pos;
+	EXPECT_GT(NumCollided, 0);
+}
+
+TEST_F(ParallelMove, TeamOrderDoesNotMatter)
+{
+	// on the calling thread, so that the teams really move last to first
+	EXPECT_EQ(Simulate(0, true), (int)NUM_TICKS);
+}
+
+TEST_F(ParallelMove, SuperFallsBackToSerial)
+{
+	for(auto &aCores : m_aaCores)
+		aCores[5].m_Super = true;
+	EXPECT_EQ(Simulate(3, false), 0);
+}
+
+TEST_F(ParallelMove, SuperTeamFallsBackToSerial)
+{
+	for(CTeamsCore &Teams : m_aTeams)
+		Teams.Team(3, TEAM_SUPER);
+	EXPECT_EQ(Simulate(3, false), 0);
+}
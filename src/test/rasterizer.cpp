@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+#include <base/system.h>
+#include <engine/client/backend/software/rasterizer.h>
+
+#include <vector>
+
+static const int WIDTH = 64;
+static const int HEIGHT = 80;
+
+static CCommandBuffer::SState DefaultState(int BlendMode = CCommandBuffer::BLEND_ALPHA, int Texture = -1)
+{
+	CCommandBuffer::SState State;
+	State.m_BlendMode = BlendMode;
+	State.m_WrapMode = CCommandBuffer::WRAP_CLAMP;
+	State.m_Texture = Texture;
+	State.m_ScreenTL = vec2(0.0f, 0.0f);
+	State.m_ScreenBR = vec2(WIDTH, HEIGHT);
+	State.m_ClipEnable = false;
+	State.m_ClipX = 0;
+	State.m_ClipY = 0;
+	State.m_ClipW = 0;
+	State.m_ClipH = 0;
+	return State;
+}
+
+static void AddQuad(std::vector<CCommandBuffer::SVertex> &vVertices, float X0, float Y0, float X1, float Y1, ColorRGBA Color)
+{
+	const vec2 aCorners[] = {vec2(X0, Y0), vec2(X1, Y0), vec2(X1, Y1), vec2(X0, Y1)};
+	const vec2 aTexCoords[] = {vec2(0.0f, 0.0f), vec2(1.0f, 0.0f), vec2(1.0f, 1.0f), vec2(0.0f, 1.0f)};
+	for(int i = 0; i < 4; i++)
+	{
+		CCommandBuffer::SVertex Vertex;
+		Vertex.m_Pos = aCorners[i];
+		Vertex.m_Tex = aTexCoords[i];
+		Vertex.m_Color = GL_SColor(round_to_int(Color.r * 255), round_to_int(Color.g * 255), round_to_int(Color.b * 255), round_to_int(Color.a * 255));
+		vVertices.push_back(Vertex);
+	}
+}
+
+static void RenderQuad(CSoftwareRasterizer *pRasterizer, const CCommandBuffer::SState &State, float X0, float Y0, float X1, float Y1, ColorRGBA Color)
+{
+	std::vector<CCommandBuffer::SVertex> vVertices;
+	AddQuad(vVertices, X0, Y0, X1, Y1, Color);
+	pRasterizer->Render(State, CCommandBuffer::PRIMTYPE_QUADS, 1, vVertices.data());
+}
+
+static const uint8_t *Pixel(const CSoftwareRasterizer &Rasterizer, int X, int Y)
+{
+	return Rasterizer.BackBuffer() + ((size_t)Y * Rasterizer.Width() + X) * 4;
+}
+
+TEST(Rasterizer, Clear)
+{
+	CSoftwareRasterizer Rasterizer;
+	Rasterizer.Init(WIDTH, HEIGHT, 0);
+	Rasterizer.Clear(ColorRGBA(1.0f, 0.0f, 0.5f, 1.0f));
+	Rasterizer.Flush();
+	for(int Y = 0; Y < HEIGHT; Y++)
+	{
+		for(int X = 0; X < WIDTH; X++)
+		{
+			const uint8_t *pPixel = Pixel(Rasterizer, X, Y);
+			ASSERT_EQ(pPixel[0], 255);
+			ASSERT_EQ(pPixel[1], 0);
+			ASSERT_EQ(pPixel[2], 128);
+			ASSERT_EQ(pPixel[3], 0);
+		}
+	}
+}
+
+TEST(Rasterizer, QuadCoverage)
+{
+	CSoftwareRasterizer Rasterizer;
+	Rasterizer.Init(WIDTH, HEIGHT, 0);
+	Rasterizer.Clear(ColorRGBA(0.0f, 0.0f, 0.0f, 1.0f));
+	// crosses a tile border, the pixels on the diagonal of the two triangles
+	// must not be blended twice
+	RenderQuad(&Rasterizer, DefaultState(), 8.0f, 8.0f, 24.0f, 40.0f, ColorRGBA(1.0f, 1.0f, 1.0f, 0.5f));
+	Rasterizer.Flush();
+
+	for(int Y = 0; Y < HEIGHT; Y++)
+	{
+		for(int X = 0; X < WIDTH; X++)
+		{
+			const bool Inside = X >= 8 && X < 24 && Y >= 8 && Y < 40;
+			EXPECT_EQ(Pixel(Rasterizer, X, Y)[0], Inside ? 128 : 0) << "at " << X << ", " << Y;
+		}
+	}
+}
+
+TEST(Rasterizer, Blending)
+{
+	CSoftwareRasterizer Rasterizer;
+	Rasterizer.Init(WIDTH, HEIGHT, 0);
+	Rasterizer.Clear(ColorRGBA(0.0f, 0.0f, 1.0f, 1.0f));
+	RenderQuad(&Rasterizer, DefaultState(CCommandBuffer::BLEND_ALPHA), 0.0f, 0.0f, 32.0f, HEIGHT, ColorRGBA(1.0f, 0.0f, 0.0f, 0.5f));
+	RenderQuad(&Rasterizer, DefaultState(CCommandBuffer::BLEND_ADDITIVE), 32.0f, 0.0f, WIDTH, HEIGHT, ColorRGBA(1.0f, 0.0f, 0.0f, 0.5f));
+	Rasterizer.Flush();
+
+	const uint8_t *pAlpha = Pixel(Rasterizer, 10, 10);
+	EXPECT_NEAR(pAlpha[0], 128, 1);
+	EXPECT_EQ(pAlpha[1], 0);
+	EXPECT_NEAR(pAlpha[2], 127, 1);
+
+	const uint8_t *pAdditive = Pixel(Rasterizer, 50, 10);
+	EXPECT_NEAR(pAdditive[0], 128, 1);
+	EXPECT_EQ(pAdditive[1], 0);
+	EXPECT_EQ(pAdditive[2], 255);
+
+	// no blending replaces the pixels
+	RenderQuad(&Rasterizer, DefaultState(CCommandBuffer::BLEND_NONE), 0.0f, 0.0f, WIDTH, HEIGHT, ColorRGBA(0.0f, 1.0f, 0.0f, 0.0f));
+	Rasterizer.Flush();
+	EXPECT_EQ(Pixel(Rasterizer, 10, 10)[0], 0);
+	EXPECT_EQ(Pixel(Rasterizer, 10, 10)[1], 255);
+	EXPECT_EQ(Pixel(Rasterizer, 10, 10)[3], 0);
+}
+
+TEST(Rasterizer, Scissor)
+{
+	CSoftwareRasterizer Rasterizer;
+	Rasterizer.Init(WIDTH, HEIGHT, 0);
+	Rasterizer.Clear(ColorRGBA(0.0f, 0.0f, 0.0f, 1.0f));
+	CCommandBuffer::SState State = DefaultState(CCommandBuffer::BLEND_NONE);
+	// counts from the bottom like glScissor
+	State.m_ClipEnable = true;
+	State.m_ClipX = 8;
+	State.m_ClipY = 10;
+	State.m_ClipW = 16;
+	State.m_ClipH = 20;
+	RenderQuad(&Rasterizer, State, 0.0f, 0.0f, WIDTH, HEIGHT, ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
+	Rasterizer.Flush();
+
+	for(int Y = 0; Y < HEIGHT; Y++)
+	{
+		for(int X = 0; X < WIDTH; X++)
+		{
+			const bool Inside = X >= 8 && X < 24 && Y >= HEIGHT - 30 && Y < HEIGHT - 10;
+			EXPECT_EQ(Pixel(Rasterizer, X, Y)[0], Inside ? 255 : 0) << "at " << X << ", " << Y;
+		}
+	}
+}
+
+TEST(Rasterizer, Texture)
+{
+	CSoftwareRasterizer Rasterizer;
+	Rasterizer.Init(WIDTH, HEIGHT, 0);
+	const uint8_t aTexture[] = {
+		255, 0, 0, 255, 0, 255, 0, 255,
+		0, 0, 255, 255, 255, 255, 255, 128};
+	Rasterizer.CreateTexture(3, 2, 2, 4, aTexture);
+	RenderQuad(&Rasterizer, DefaultState(CCommandBuffer::BLEND_NONE, 3), 0.0f, 0.0f, WIDTH, HEIGHT, ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
+	Rasterizer.Flush();
+
+	// the corners are sampled from a single texel
+	EXPECT_EQ(mem_comp(Pixel(Rasterizer, 0, 0), &aTexture[0], 4), 0);
+	EXPECT_EQ(mem_comp(Pixel(Rasterizer, WIDTH - 1, 0), &aTexture[4], 4), 0);
+	EXPECT_EQ(mem_comp(Pixel(Rasterizer, 0, HEIGHT - 1), &aTexture[8], 4), 0);
+	EXPECT_EQ(mem_comp(Pixel(Rasterizer, WIDTH - 1, HEIGHT - 1), &aTexture[12], 4), 0);
+	// and the center is filtered
+	const uint8_t *pCenter = Pixel(Rasterizer, WIDTH / 2, HEIGHT / 2);
+	EXPECT_NEAR(pCenter[0], 128, 8);
+	EXPECT_NEAR(pCenter[1], 128, 8);
+	EXPECT_NEAR(pCenter[2], 128, 8);
+
+	// alpha-only textures like the ones of the text only modulate the alpha
+	const uint8_t aAlphaTexture[] = {128};
+	Rasterizer.CreateTexture(3, 1, 1, 1, aAlphaTexture);
+	RenderQuad(&Rasterizer, DefaultState(CCommandBuffer::BLEND_NONE, 3), 0.0f, 0.0f, WIDTH, HEIGHT, ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+	Rasterizer.Flush();
+	const uint8_t aExpected[] = {255, 0, 0, 128};
+	EXPECT_EQ(mem_comp(Pixel(Rasterizer, 10, 10), aExpected, 4), 0);
+
+	// destroyed textures are not sampled
+	Rasterizer.DestroyTexture(3);
+	RenderQuad(&Rasterizer, DefaultState(CCommandBuffer::BLEND_NONE, 3), 0.0f, 0.0f, WIDTH, HEIGHT, ColorRGBA(0.0f, 1.0f, 0.0f, 1.0f));
+	Rasterizer.Flush();
+	EXPECT_EQ(Pixel(Rasterizer, 10, 10)[1], 255);
+}
+
+static std::vector<uint8_t> RenderScene(int NumThreads)
+{
+	CSoftwareRasterizer Rasterizer;
+	Rasterizer.Init(WIDTH, HEIGHT, NumThreads);
+	Rasterizer.Clear(ColorRGBA(0.1f, 0.2f, 0.3f, 1.0f));
+
+	std::vector<CCommandBuffer::SVertex> vVertices;
+	unsigned Seed = 1;
+	auto Random = [&Seed](int Max) {
+		Seed = Seed * 1103515245 + 12345;
+		return (int)((Seed >> 16) % Max);
+	};
+	for(int i = 0; i < 200; i++)
+	{
+		const float X = Random(WIDTH + 20) - 10;
+		const float Y = Random(HEIGHT + 20) - 10;
+		AddQuad(vVertices, X, Y, X + Random(30) + 0.3f, Y + Random(30) + 0.7f, ColorRGBA(Random(256) / 255.0f, Random(256) / 255.0f, Random(256) / 255.0f, Random(256) / 255.0f));
+	}
+	Rasterizer.Render(DefaultState(CCommandBuffer::BLEND_ALPHA), CCommandBuffer::PRIMTYPE_QUADS, vVertices.size() / 4, vVertices.data());
+	Rasterizer.Render(DefaultState(CCommandBuffer::BLEND_ADDITIVE), CCommandBuffer::PRIMTYPE_LINES, vVertices.size() / 2, vVertices.data());
+	Rasterizer.Flush();
+	return std::vector<uint8_t>(Rasterizer.BackBuffer(), Rasterizer.BackBuffer() + WIDTH * HEIGHT * 4);
+}
+
+TEST(Rasterizer, ThreadsRenderTheSame)
+{
+	EXPECT_EQ(RenderScene(0), RenderScene(3));
+}
+
+TEST(Rasterizer, Swap)
+{
+	CSoftwareRasterizer Rasterizer;
+	Rasterizer.Init(WIDTH, HEIGHT, 1);
+	Rasterizer.Clear(ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
+	Rasterizer.Swap();
+	EXPECT_EQ(Rasterizer.FrontBuffer()[0], 255);
+	EXPECT_EQ(Rasterizer.BackBuffer()[0], 0);
+
+	Rasterizer.Resize(16, 8);
+	EXPECT_EQ(Rasterizer.Width(), 16);
+	EXPECT_EQ(Rasterizer.Height(), 8);
+	Rasterizer.Clear(ColorRGBA(0.0f, 1.0f, 0.0f, 1.0f));
+	Rasterizer.Swap();
+	EXPECT_EQ(Rasterizer.FrontBuffer()[(16 * 8 - 1) * 4 + 1], 255);
+}
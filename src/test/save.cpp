@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <game/prng.h>
+#include <game/server/save.h>
+
+#include <string>
+#include <vector>
+
+// kinds of the fields of a tee in the text form:
+// n = name, i = int, p = position (written as int), f = float, u = uuid, h = hooked player
+static const char TEE_FIELDS[] =
+	"niiiii"
+	"iiiiiiiiiiiiiiiiiiiiiiii"
+	"ii"
+	"iiiiiiiiiiiiii"
+	"pppp"
+	"ii"
+	"ppff"
+	"iiii"
+	"ppff"
+	"ppii"
+	"iii"
+	"fffffffffffffffffffffffff"
+	"i"
+	"iii"
+	"u"
+	"hi"
+	"iiii"
+	"i"
+	"i"
+	"i";
+
+static int RandomInt(CPrng &Prng, int Min, int Max)
+{
+	return Min + (int)(Prng.RandomBits() % (unsigned)(Max - Min + 1));
+}
+
+// Self is the index of the tee in its team, every other tee can be hooked
+static std::string RandomTee(CPrng &Prng, int Self, int MembersCount, int *pNumHooked)
+{
+	std::string Tee;
+	for(const char *pField = TEE_FIELDS; *pField; pField++)
+	{
+		char aBuf[64];
+		switch(*pField)
+		{
+		case 'n':
+			for(int i = RandomInt(Prng, 1, 15); i > 0; i--)
+				Tee += (char)RandomInt(Prng, 'a', 'z');
+			aBuf[0] = '\0';
+			break;
+		case 'i':
+			// mostly small values, but also ones that need every varint byte
+			str_format(aBuf, sizeof(aBuf), "%d", RandomInt(Prng, 0, 3) == 0 ? (int)Prng.RandomBits() : RandomInt(Prng, -2, 200));
+			break;
+		case 'p':
+			str_format(aBuf, sizeof(aBuf), "%d", RandomInt(Prng, -1000, 100000));
+			break;
+		case 'f':
+			// quarters are exact in both forms
+			str_format(aBuf, sizeof(aBuf), "%f", RandomInt(Prng, -40000, 40000) / 4.0f);
+			break;
+		case 'u':
+			str_format(aBuf, sizeof(aBuf), "%08x-0000-4000-8000-%012x", Prng.RandomBits(), Prng.RandomBits());
+			break;
+		case 'h':
+			if(MembersCount > 1 && RandomInt(Prng, 0, 1))
+			{
+				str_format(aBuf, sizeof(aBuf), "%d", (Self + RandomInt(Prng, 1, MembersCount - 1)) % MembersCount);
+				(*pNumHooked)++;
+			}
+			else
+				str_copy(aBuf, "-1");
+			break;
+		}
+		Tee += aBuf;
+		if(pField[1])
+			Tee += '\t';
+	}
+	return Tee;
+}
+
+static std::string RandomTeam(CPrng &Prng, int *pNumHooked = nullptr)
+{
+	int NumHooked = 0;
+	if(!pNumHooked)
+		pNumHooked = &NumHooked;
+	int MembersCount = RandomInt(Prng, 1, 8);
+	int HighestSwitchNumber = RandomInt(Prng, 0, 3) == 0 ? 0 : RandomInt(Prng, 1, 255);
+	char aBuf[128];
+	str_format(aBuf, sizeof(aBuf), "%d\t%d\t%d\t%d\t%d", RandomInt(Prng, 0, 4), MembersCount, HighestSwitchNumber, RandomInt(Prng, 0, 1), RandomInt(Prng, 0, 1));
+	std::string Team = aBuf;
+	for(int i = 0; i < MembersCount; i++)
+		Team += "\n" + RandomTee(Prng, i, MembersCount, pNumHooked);
+	for(int i = 0; i < HighestSwitchNumber; i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "\n%d\t%d\t%d", RandomInt(Prng, 0, 1), RandomInt(Prng, 0, 1) ? 0 : RandomInt(Prng, 0, 1000000), RandomInt(Prng, 0, 4));
+		Team += aBuf;
+	}
+	return Team;
+}
+
+// like CSaveTeam::MatchPlayers, with client IDs that differ from the
+// indices in the team, so that a hooked player is only written back with
+// the right index if the index was mapped to the client ID and back
+static void SetClientIDs(CSaveTeam &Team)
+{
+	for(int i = 0; i < Team.GetMembersCount(); i++)
+		Team.m_pSavedTees[i].SetClientID((Team.GetMembersCount() - i) * 7 % MAX_CLIENTS);
+	for(int i = 0; i < Team.GetMembersCount(); i++)
+		Team.m_pSavedTees[i].LoadHookedPlayer(&Team);
+}
+
+TEST(Save, RoundTrip)
+{
+	uint64_t aSeed[2] = {47, 11};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	int NumHooked = 0;
+	for(int Run = 0; Run < 50; Run++)
+	{
+		const std::string Text = RandomTeam(Prng, &NumHooked);
+
+		CSaveTeam Team;
+		ASSERT_EQ(Team.FromString(Text.c_str()), 0) << Text;
+		SetClientIDs(Team);
+		EXPECT_EQ(Text, Team.GetString());
+
+		std::vector<unsigned char> vBinary = Team.GetBinary();
+		EXPECT_LT(vBinary.size(), Text.size());
+		CSaveTeam FromBinary;
+		ASSERT_EQ(FromBinary.FromBinary(vBinary.data(), vBinary.size()), 0);
+		SetClientIDs(FromBinary);
+		EXPECT_EQ(Text, FromBinary.GetString());
+		EXPECT_EQ(vBinary, FromBinary.GetBinary());
+
+		const std::string BinaryString = Team.GetBinaryString();
+		ASSERT_TRUE(str_startswith(BinaryString.c_str(), "binary:"));
+		CSaveTeam FromBinaryString;
+		ASSERT_EQ(FromBinaryString.FromString(BinaryString.c_str()), 0);
+		SetClientIDs(FromBinaryString);
+		EXPECT_EQ(Text, FromBinaryString.GetString());
+	}
+	EXPECT_GT(NumHooked, 0);
+}
+
+TEST(Save, RejectCorrupted)
+{
+	uint64_t aSeed[2] = {48, 12};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	const std::string Text = RandomTeam(Prng);
+	CSaveTeam Team;
+	ASSERT_EQ(Team.FromString(Text.c_str()), 0);
+	SetClientIDs(Team);
+	const std::vector<unsigned char> vBinary = Team.GetBinary();
+
+	// every field is required
+	CSaveTeam Loaded;
+	for(size_t Size = 0; Size < vBinary.size(); Size++)
+		EXPECT_NE(Loaded.FromBinary(vBinary.data(), Size), 0) << Size;
+
+	for(size_t Length = 0; Length < Text.size(); Length++)
+		Loaded.FromString(Text.substr(0, Length).c_str());
+
+	EXPECT_NE(Loaded.FromString("binary:"), 0);
+	EXPECT_NE(Loaded.FromString("binary:!!!!"), 0);
+}
+
+TEST(Save, Fuzz)
+{
+	uint64_t aSeed[2] = {49, 13};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	for(int Run = 0; Run < 20; Run++)
+	{
+		CSaveTeam Team;
+		ASSERT_EQ(Team.FromString(RandomTeam(Prng).c_str()), 0);
+		SetClientIDs(Team);
+		const std::vector<unsigned char> vBinary = Team.GetBinary();
+
+		for(int Mutation = 0; Mutation < 200; Mutation++)
+		{
+			std::vector<unsigned char> vMutated = vBinary;
+			for(int i = RandomInt(Prng, 1, 8); i > 0; i--)
+				vMutated[RandomInt(Prng, 0, vMutated.size() - 1)] = Prng.RandomBits();
+			vMutated.resize(RandomInt(Prng, 0, vMutated.size()));
+
+			// must not crash and, if accepted, encode again
+			CSaveTeam Loaded;
+			if(Loaded.FromBinary(vMutated.data(), vMutated.size()) == 0)
+			{
+				SetClientIDs(Loaded);
+				Loaded.GetBinary();
+			}
+		}
+	}
+}
@@ -13,18 +13,6 @@
 int DummyMysqlInit = (MysqlInit(), 1);
 #endif
 
-char *CSaveTeam::GetString()
-{
-	// Dummy implementation for testing
-	return nullptr;
-}
-
-int CSaveTeam::FromString(char const *)
-{
-	// Dummy implementation for testing
-	return 1;
-}
-
 bool CSaveTeam::MatchPlayers(const char (*paNames)[MAX_NAME_LENGTH], const int *pClientID, int NumPlayer, char *pMessage, int MessageLen)
 {
 	// Dummy implementation for testing
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include <memory>
 
+#include <engine/client/serverbrowser.h>
+#include <engine/client/serverbrowser_http.h>
 #include <engine/client/serverbrowser_ping_cache.h>
 #include <engine/console.h>
 #include <engine/engine.h>
@@ -97,3 +99,155 @@ TEST(ServerBrowser, PingCache)
 	EXPECT_EQ(pPingCache->GetPing(&OtherLocalhost4, 1), 1337);
 	EXPECT_EQ(pPingCache->GetPing(&OtherLocalhost6, 1), 345);
 }
+
+static const char SERVER_LIST[] = R"({
+	"servers": [
+		{
+			"addresses": ["tw-0.6+udp://127.0.0.1:8303", "tw-0.6+udp://[::1]:8303"],
+			"location": "eu:de",
+			"info": {"max_clients": 64, "max_players": 64, "passworded": false, "game_type": "DDraceNetwork", "name": "Server \"1\" [test]", "map": {"name": "Tutorial"}, "version": "0.6.4", "clients": []}
+		},
+		{
+			"addresses": ["unknown://127.0.0.1:8304"],
+			"info": {"max_clients": 64, "max_players": 64, "passworded": false, "game_type": "DDraceNetwork", "name": "No address", "map": {"name": "Tutorial"}, "version": "0.6.4", "clients": []}
+		},
+		{
+			"addresses": ["tw-0.6+udp://127.0.0.1:8305"],
+			"info": {"max_clients": 1, "max_players": 2, "passworded": false, "game_type": "DDraceNetwork", "name": "Invalid info", "map": {"name": "Tutorial"}, "version": "0.6.4", "clients": []}
+		},
+		{
+			"addresses": ["tw-0.6+udp://127.0.0.1:8306"],
+			"info": {"max_clients": 16, "max_players": 16, "passworded": true, "game_type": "Race", "name": "Server 2", "map": {"name": "Kobra"}, "version": "0.6.4", "clients": []}
+		}
+	],
+	"servers_legacy": ["127.0.0.1:8307", "[::1]:8308"]
+})";
+
+static void ExpectServerList(const CServerListParser &Parser)
+{
+	ASSERT_EQ(Parser.m_vServers.size(), 2u);
+	EXPECT_EQ(Parser.m_vServers[0].m_NumAddresses, 2);
+	EXPECT_STREQ(Parser.m_vServers[0].m_aName, "Server \"1\" [test]");
+	EXPECT_EQ(Parser.m_vServers[0].m_Location, CServerInfo::LOC_EUROPE);
+	EXPECT_EQ(Parser.m_vServers[1].m_NumAddresses, 1);
+	EXPECT_STREQ(Parser.m_vServers[1].m_aName, "Server 2");
+	EXPECT_STREQ(Parser.m_vServers[1].m_aMap, "Kobra");
+	EXPECT_TRUE(Parser.m_vServers[1].m_Flags & SERVER_FLAG_PASSWORD);
+	ASSERT_EQ(Parser.m_vLegacyServers.size(), 2u);
+	NETADDR Addr;
+	ASSERT_FALSE(net_addr_from_str(&Addr, "[::1]:8308"));
+	EXPECT_EQ(net_addr_comp(&Parser.m_vLegacyServers[1], &Addr), 0);
+}
+
+TEST(ServerBrowser, ServerListParser)
+{
+	CServerListParser Parser;
+	EXPECT_TRUE(Parser.Feed(SERVER_LIST, str_length(SERVER_LIST)));
+	EXPECT_TRUE(Parser.Finish());
+	ExpectServerList(Parser);
+}
+
+TEST(ServerBrowser, ServerListParserChunks)
+{
+	const int Length = str_length(SERVER_LIST);
+	for(int ChunkSize = 1; ChunkSize < 64; ChunkSize += 7)
+	{
+		CServerListParser Parser;
+		for(int Offset = 0; Offset < Length; Offset += ChunkSize)
+		{
+			EXPECT_FALSE(Parser.Finish());
+			ASSERT_TRUE(Parser.Feed(SERVER_LIST + Offset, minimum(ChunkSize, Length - Offset)));
+		}
+		EXPECT_TRUE(Parser.Finish());
+		ExpectServerList(Parser);
+	}
+}
+
+TEST(ServerBrowser, ServerListParserInvalid)
+{
+	const char *apInvalid[] = {
+		"[]",
+		R"({"servers": {}})",
+		R"({"servers": [], "servers_legacy": 1})",
+		R"({"servers": [{"addresses": "tw-0.6+udp://127.0.0.1:8303"}]})",
+		R"({"servers": [1,]})",
+		R"({"servers": [], "servers_legacy": ["not an address"]})",
+		R"({"servers": []} {})",
+	};
+	for(const char *pInvalid : apInvalid)
+	{
+		CServerListParser Parser;
+		EXPECT_FALSE(Parser.Feed(pInvalid, str_length(pInvalid)) && Parser.Finish()) << pInvalid;
+	}
+
+	const char *apIncomplete[] = {
+		R"({"servers_legacy": []})",
+		R"({"servers": [{"addresses": [)",
+	};
+	for(const char *pIncomplete : apIncomplete)
+	{
+		CServerListParser Parser;
+		EXPECT_TRUE(Parser.Feed(pIncomplete, str_length(pIncomplete))) << pIncomplete;
+		EXPECT_FALSE(Parser.Finish()) << pIncomplete;
+	}
+}
+
+TEST(ServerBrowser, FoldSearchKey)
+{
+	char aFolded[64];
+	EXPECT_EQ(CServerBrowser::FoldSearchKey("", aFolded), 1);
+	EXPECT_STREQ(aFolded, "");
+	EXPECT_EQ(CServerBrowser::FoldSearchKey("DDNet GER1", aFolded), 11);
+	EXPECT_STREQ(aFolded, "ddnet ger1");
+	EXPECT_EQ(CServerBrowser::FoldSearchKey("ÄÖÜ Straße", aFolded), str_length("äöü straße") + 1);
+	EXPECT_STREQ(aFolded, "äöü straße");
+
+	// invalid UTF-8 is replaced so it can never match a token
+	EXPECT_EQ(CServerBrowser::FoldSearchKey("a\xff" "B", aFolded), str_length("a\xef\xbf\xbd" "b") + 1);
+	EXPECT_STREQ(aFolded, "a\xef\xbf\xbd" "b");
+
+	// the size is the same without an output buffer
+	EXPECT_EQ(CServerBrowser::FoldSearchKey("ÄÖÜ Straße", nullptr), str_length("äöü straße") + 1);
+}
+
+TEST(ServerBrowser, SearchTokens)
+{
+	std::vector<CServerBrowser::CSearchToken> vTokens;
+	CServerBrowser::ParseSearchTokens("Tutorial;\"Exact Name\";;ÄÖÜ", vTokens);
+	ASSERT_EQ(vTokens.size(), 3u);
+	EXPECT_FALSE(vTokens[0].m_Exact);
+	EXPECT_STREQ(vTokens[0].m_aStr, "tutorial");
+	EXPECT_TRUE(vTokens[1].m_Exact);
+	EXPECT_STREQ(vTokens[1].m_aStr, "Exact Name");
+	EXPECT_FALSE(vTokens[2].m_Exact);
+	EXPECT_STREQ(vTokens[2].m_aStr, "äöü");
+
+	CServerBrowser::ParseSearchTokens("", vTokens);
+	EXPECT_TRUE(vTokens.empty());
+}
+
+TEST(ServerBrowser, MatchesToken)
+{
+	std::vector<CServerBrowser::CSearchToken> vTokens;
+	CServerBrowser::ParseSearchTokens("TUTORIAL;\"Exact Name\";ÄÖ", vTokens);
+	ASSERT_EQ(vTokens.size(), 3u);
+
+	char aFolded[64];
+	const char *pName = "DDNet Tutorial Server";
+	CServerBrowser::FoldSearchKey(pName, aFolded);
+	EXPECT_TRUE(CServerBrowser::MatchesToken(vTokens[0], pName, aFolded));
+	EXPECT_FALSE(CServerBrowser::MatchesToken(vTokens[1], pName, aFolded));
+	EXPECT_FALSE(CServerBrowser::MatchesToken(vTokens[2], pName, aFolded));
+
+	// exact tokens compare the original string, case included
+	pName = "Exact Name";
+	CServerBrowser::FoldSearchKey(pName, aFolded);
+	EXPECT_TRUE(CServerBrowser::MatchesToken(vTokens[1], pName, aFolded));
+	pName = "exact name";
+	CServerBrowser::FoldSearchKey(pName, aFolded);
+	EXPECT_FALSE(CServerBrowser::MatchesToken(vTokens[1], pName, aFolded));
+
+	pName = "Blockäöü";
+	CServerBrowser::FoldSearchKey(pName, aFolded);
+	EXPECT_TRUE(CServerBrowser::MatchesToken(vTokens[2], pName, aFolded));
+}
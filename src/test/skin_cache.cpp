@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <game/client/skin_cache.h>
+
+static CSkinCacheHeader TestHeader()
+{
+	CSkinCacheHeader Header;
+	for(unsigned i = 0; i < sizeof(Header.m_Sha256.data); i++)
+		Header.m_Sha256.data[i] = i * 7;
+	Header.m_Width = 256;
+	Header.m_Height = 128;
+	Header.m_BloodColor = ColorRGBA(0.25f, 0.5f, -0.75f, 1.0f);
+	Header.m_Metrics.m_Body.m_Width = 60;
+	Header.m_Metrics.m_Body.m_Height = 58;
+	Header.m_Metrics.m_Body.m_OffsetX = 2;
+	Header.m_Metrics.m_Body.m_OffsetY = 3;
+	Header.m_Metrics.m_Body.m_MaxWidth = 96;
+	Header.m_Metrics.m_Body.m_MaxHeight = 96;
+	Header.m_Metrics.m_Feet.m_Width = 40;
+	Header.m_Metrics.m_Feet.m_Height = 20;
+	Header.m_Metrics.m_Feet.m_OffsetX = 4;
+	Header.m_Metrics.m_Feet.m_OffsetY = 6;
+	Header.m_Metrics.m_Feet.m_MaxWidth = 64;
+	Header.m_Metrics.m_Feet.m_MaxHeight = 32;
+	return Header;
+}
+
+static void ExpectMetricEq(const CSkin::SSkinMetricVariable &Metric, const CSkin::SSkinMetricVariable &Expected)
+{
+	EXPECT_EQ(Metric.m_Width, Expected.m_Width);
+	EXPECT_EQ(Metric.m_Height, Expected.m_Height);
+	EXPECT_EQ(Metric.m_OffsetX, Expected.m_OffsetX);
+	EXPECT_EQ(Metric.m_OffsetY, Expected.m_OffsetY);
+	EXPECT_EQ(Metric.m_MaxWidth, Expected.m_MaxWidth);
+	EXPECT_EQ(Metric.m_MaxHeight, Expected.m_MaxHeight);
+}
+
+TEST(SkinCache, Roundtrip)
+{
+	const CSkinCacheHeader Header = TestHeader();
+	unsigned char aData[CSkinCacheHeader::SERIALIZED_SIZE];
+	Header.Serialize(aData);
+
+	CSkinCacheHeader Read;
+	ASSERT_TRUE(Read.Unserialize(aData));
+	EXPECT_TRUE(Read.m_Sha256 == Header.m_Sha256);
+	EXPECT_EQ(Read.m_Width, 256);
+	EXPECT_EQ(Read.m_Height, 128);
+	EXPECT_EQ(Read.m_BloodColor.r, 0.25f);
+	EXPECT_EQ(Read.m_BloodColor.g, 0.5f);
+	EXPECT_EQ(Read.m_BloodColor.b, -0.75f);
+	EXPECT_EQ(Read.m_BloodColor.a, 1.0f);
+	ExpectMetricEq(Read.m_Metrics.m_Body, Header.m_Metrics.m_Body);
+	ExpectMetricEq(Read.m_Metrics.m_Feet, Header.m_Metrics.m_Feet);
+	EXPECT_EQ(Read.ImageSize(), 256u * 128u * 4u);
+}
+
+TEST(SkinCache, ByteOrder)
+{
+	// the layout must not depend on the platform that wrote the cache
+	const CSkinCacheHeader Header = TestHeader();
+	unsigned char aData[CSkinCacheHeader::SERIALIZED_SIZE];
+	Header.Serialize(aData);
+	EXPECT_EQ(mem_comp(aData, "DSKC", 4), 0);
+	EXPECT_EQ(bytes_be_to_uint(aData + 4), (unsigned)CSkinCacheHeader::VERSION);
+	EXPECT_EQ(mem_comp(aData + 8, Header.m_Sha256.data, SHA256_DIGEST_LENGTH), 0);
+	EXPECT_EQ(bytes_be_to_uint(aData + 8 + SHA256_DIGEST_LENGTH), 256u);
+	EXPECT_EQ(bytes_be_to_uint(aData + 12 + SHA256_DIGEST_LENGTH), 128u);
+	EXPECT_EQ(bytes_be_to_uint(aData + 16 + SHA256_DIGEST_LENGTH), 0x3e800000u);
+}
+
+TEST(SkinCache, Invalid)
+{
+	unsigned char aData[CSkinCacheHeader::SERIALIZED_SIZE];
+	CSkinCacheHeader Read;
+
+	TestHeader().Serialize(aData);
+	aData[0] = 'X';
+	EXPECT_FALSE(Read.Unserialize(aData));
+
+	TestHeader().Serialize(aData);
+	uint_to_bytes_be(aData + 4, CSkinCacheHeader::VERSION + 1);
+	EXPECT_FALSE(Read.Unserialize(aData));
+
+	CSkinCacheHeader Header = TestHeader();
+	Header.m_Width = 0;
+	Header.Serialize(aData);
+	EXPECT_FALSE(Read.Unserialize(aData));
+
+	Header = TestHeader();
+	Header.m_Height = CSkinCacheHeader::MAX_SIZE + 1;
+	Header.Serialize(aData);
+	EXPECT_FALSE(Read.Unserialize(aData));
+}
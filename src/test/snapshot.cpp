@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <engine/shared/alloc_counter.h>
+#include <engine/shared/compression.h>
+#include <engine/shared/protocol_ex.h>
+#include <engine/shared/snapshot.h>
+
+struct CItemBytes
+{
+	int m_aBytes[8] = {0};
+	int m_Total = 0;
+};
+
+static void CountItemBytes(int Type, int Bytes, void *pUser)
+{
+	CItemBytes *pItemBytes = (CItemBytes *)pUser;
+	ASSERT_GE(Type, 0);
+	ASSERT_LT(Type, 8);
+	pItemBytes->m_aBytes[Type] += Bytes;
+	pItemBytes->m_Total += Bytes;
+}
+
+static int BuildSnapshot(void *pData, int NumItems, int Value)
+{
+	CSnapshotBuilder Builder;
+	Builder.Init();
+	for(int i = 0; i < NumItems; i++)
+	{
+		int *pItem = (int *)Builder.NewItem(1 + i % 3, i, 4 * sizeof(int));
+		for(int j = 0; j < 4; j++)
+			pItem[j] = Value * (j + 1) + i;
+	}
+	return Builder.Finish(pData);
+}
+
+TEST(Snapshot, DeltaItemSizes)
+{
+	CSnapshotDelta Delta;
+	Delta.SetStaticsize(1, 4 * sizeof(int));
+
+	char aFrom[CSnapshot::MAX_SIZE];
+	char aTo[CSnapshot::MAX_SIZE];
+	BuildSnapshot(aFrom, 6, 100);
+	BuildSnapshot(aTo, 5, 1000);
+
+	char aDelta[CSnapshot::MAX_SIZE];
+	CItemBytes ItemBytes;
+	int DeltaSize = Delta.CreateDelta((CSnapshot *)aFrom, (CSnapshot *)aTo, aDelta, CountItemBytes, &ItemBytes);
+	ASSERT_GT(DeltaSize, 0);
+
+	// the items and the three header ints make up the whole compressed delta
+	char aCompressed[CSnapshot::MAX_SIZE];
+	int CompressedSize = CVariableInt::Compress(aDelta, DeltaSize, aCompressed, sizeof(aCompressed));
+	EXPECT_EQ(ItemBytes.m_Total + 3, CompressedSize);
+	EXPECT_GT(ItemBytes.m_aBytes[1], 0);
+	EXPECT_GT(ItemBytes.m_aBytes[2], 0);
+	EXPECT_GT(ItemBytes.m_aBytes[3], 0);
+
+	// the delta must not change when counting
+	char aDeltaUncounted[CSnapshot::MAX_SIZE];
+	ASSERT_EQ(Delta.CreateDelta((CSnapshot *)aFrom, (CSnapshot *)aTo, aDeltaUncounted), DeltaSize);
+	EXPECT_EQ(mem_comp(aDelta, aDeltaUncounted, DeltaSize), 0);
+}
+
+static void CountExtendedItemBytes(int Type, int Bytes, void *pUser)
+{
+	CItemBytes *pItemBytes = (CItemBytes *)pUser;
+	if(Type == NETMSG_WHATIS)
+		pItemBytes->m_aBytes[0] += Bytes;
+	else if(Type == NETMSG_ITIS)
+		pItemBytes->m_aBytes[1] += Bytes;
+	pItemBytes->m_Total += Bytes;
+}
+
+TEST(Snapshot, DeltaDeletedExtendedItemTypes)
+{
+	CSnapshotDelta Delta;
+
+	// the internal types are allocated by each builder in the order the
+	// types are first used, so the deleted item had another internal type
+	char aFrom[CSnapshot::MAX_SIZE];
+	char aTo[CSnapshot::MAX_SIZE];
+	// (the type items are added from the second snapshot of a builder on)
+	CSnapshotBuilder FromBuilder;
+	CSnapshotBuilder ToBuilder;
+	for(int i = 0; i < 2; i++)
+	{
+		FromBuilder.Init();
+		mem_zero(FromBuilder.NewItem(NETMSG_WHATIS, 1, 4 * sizeof(int)), 4 * sizeof(int));
+		mem_zero(FromBuilder.NewItem(NETMSG_ITIS, 2, 4 * sizeof(int)), 4 * sizeof(int));
+		ToBuilder.Init();
+		mem_zero(ToBuilder.NewItem(NETMSG_ITIS, 2, 4 * sizeof(int)), 4 * sizeof(int));
+	}
+	FromBuilder.Finish(aFrom);
+	ToBuilder.Finish(aTo);
+
+	char aDelta[CSnapshot::MAX_SIZE];
+	CItemBytes ItemBytes;
+	ASSERT_GT(Delta.CreateDelta((CSnapshot *)aFrom, (CSnapshot *)aTo, aDelta, CountExtendedItemBytes, &ItemBytes), 0);
+	EXPECT_GT(ItemBytes.m_aBytes[0], 0);
+	EXPECT_GT(ItemBytes.m_aBytes[1], 0);
+}
+
+TEST(Snapshot, StorageReusesHolders)
+{
+	char aData[CSnapshot::MAX_SIZE];
+	const int Size = BuildSnapshot(aData, 10, 1);
+
+	CSnapshotStorage Storage;
+	const int64_t StartAllocations = CAllocCounter::ThreadAllocations();
+	for(int Tick = 0; Tick < 5; Tick++)
+		Storage.Add(Tick, 0, Size, aData, 0, nullptr);
+	EXPECT_EQ(CAllocCounter::ThreadAllocations() - StartAllocations, CAllocCounter::Enabled() ? 5 : 0);
+
+	const int64_t SteadyAllocations = CAllocCounter::ThreadAllocations();
+	for(int Tick = 5; Tick < 50; Tick++)
+	{
+		CSnapshotStorage::CHolder *pPurged = Storage.m_pFirst;
+		Storage.PurgeUntil(Tick - 4);
+		Storage.Add(Tick, 0, Size - (Tick % 3) * 4 * (int)sizeof(int), aData, 0, nullptr);
+		EXPECT_EQ(Storage.m_pLast, pPurged);
+	}
+	EXPECT_EQ(CAllocCounter::ThreadAllocations() - SteadyAllocations, 0);
+
+	CSnapshot *pSnap;
+	EXPECT_EQ(Storage.Get(49, nullptr, &pSnap, nullptr), Size - (49 % 3) * 4 * (int)sizeof(int));
+	EXPECT_EQ(Storage.Get(45, nullptr, nullptr, nullptr), Size - (45 % 3) * 4 * (int)sizeof(int));
+	EXPECT_EQ(Storage.Get(44, nullptr, nullptr, nullptr), -1);
+
+	// bigger snapshots don't fit into the purged holders
+	char aBigData[CSnapshot::MAX_SIZE];
+	const int BigSize = BuildSnapshot(aBigData, 20, 1);
+	CSnapshotStorage::CHolder *pPurged = Storage.m_pFirst;
+	Storage.PurgeUntil(46);
+	Storage.Add(50, 0, BigSize, aBigData, 0, nullptr);
+	ASSERT_EQ(Storage.Get(50, nullptr, &pSnap, nullptr), BigSize);
+	EXPECT_NE(Storage.m_pLast, pPurged);
+	EXPECT_EQ(mem_comp(pSnap, aBigData, BigSize), 0);
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/client/sound_mix.h>
+
+#include <vector>
+
+static std::vector<short> RandomSamples(size_t Num)
+{
+	std::vector<short> vSamples(Num);
+	secure_random_fill(vSamples.data(), vSamples.size() * sizeof(short));
+	return vSamples;
+}
+
+TEST(SoundMix, VoiceMatchesScalar)
+{
+	for(int Channels = 1; Channels <= 2; Channels++)
+	{
+		// frame counts that do not fill the vector width as well
+		for(unsigned Frames : {0u, 1u, 3u, 4u, 7u, 8u, 9u, 61u, 512u})
+		{
+			const std::vector<short> vIn = RandomSamples(Frames * Channels);
+			std::vector<int> vExpected(Frames * 2, 12345);
+			std::vector<int> vOut(Frames * 2, 12345);
+			SoundMixVoiceScalar(vExpected.data(), vIn.data(), Channels, Frames, 255, 17);
+			SoundMixVoice(vOut.data(), vIn.data(), Channels, Frames, 255, 17);
+			EXPECT_EQ(vOut, vExpected) << "Channels=" << Channels << " Frames=" << Frames;
+		}
+	}
+}
+
+TEST(SoundMix, VoiceMono)
+{
+	const short aIn[] = {1, -2, 3, -4, 5, -6, 7, -8, 9};
+	int aOut[18] = {0};
+	SoundMixVoice(aOut, aIn, 1, 9, 2, 3);
+	for(int i = 0; i < 9; i++)
+	{
+		EXPECT_EQ(aOut[i * 2], aIn[i] * 2);
+		EXPECT_EQ(aOut[i * 2 + 1], aIn[i] * 3);
+	}
+}
+
+TEST(SoundMix, Finish)
+{
+	const unsigned Frames = 37;
+	std::vector<int> vMix(Frames * 2);
+	for(unsigned i = 0; i < Frames * 2; i++)
+		vMix[i] = ((int)i - (int)Frames) * 300000;
+	std::vector<short> vExpected(Frames * 2);
+	std::vector<short> vOut(Frames * 2);
+	for(int MasterVol : {0, 50, 100})
+	{
+		SoundMixFinishScalar(vExpected.data(), vMix.data(), Frames, MasterVol);
+		SoundMixFinish(vOut.data(), vMix.data(), Frames, MasterVol);
+		// the vectorized version rounds slightly differently
+		for(unsigned i = 0; i < Frames * 2; i++)
+			EXPECT_NEAR(vOut[i], vExpected[i], 1) << "MasterVol=" << MasterVol << " i=" << i;
+	}
+	EXPECT_EQ(vOut[0], -32768);
+	EXPECT_EQ(vOut[Frames * 2 - 1], 32767);
+}
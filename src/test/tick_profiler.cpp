@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <engine/shared/tick_profiler.h>
+
+#include <memory>
+
+static void RunTick(CTickProfiler *pProfiler, int Tick)
+{
+	pProfiler->BeginLoop(Tick);
+	{
+		CTickProfileScope Scope(pProfiler, CTickProfiler::PHASE_GAME_TICK);
+	}
+	pProfiler->EndLoop(true);
+}
+
+TEST(TickProfiler, DisableKeepsData)
+{
+	auto pProfiler = std::make_unique<CTickProfiler>();
+	pProfiler->SetEnabled(true);
+	for(int Tick = 0; Tick < 5; Tick++)
+		RunTick(pProfiler.get(), Tick);
+	pProfiler->StartTrace(4);
+	RunTick(pProfiler.get(), 5);
+
+	// the trace is recorded to its end
+	pProfiler->SetEnabled(false);
+	EXPECT_TRUE(pProfiler->TraceRunning());
+	for(int Tick = 6; Tick < 9; Tick++)
+		RunTick(pProfiler.get(), Tick);
+	EXPECT_TRUE(pProfiler->TraceFinished());
+	EXPECT_EQ(pProfiler->HistorySize(), 9);
+
+	// and nothing is sampled afterwards
+	RunTick(pProfiler.get(), 9);
+	EXPECT_EQ(pProfiler->HistorySize(), 9);
+	EXPECT_TRUE(pProfiler->TraceFinished());
+
+	pProfiler->SetEnabled(true);
+	EXPECT_EQ(pProfiler->HistorySize(), 0);
+	EXPECT_TRUE(pProfiler->TraceFinished());
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+#include <base/system.h>
+#include <engine/message.h>
+#include <game/generated/protocol.h>
+#include <game/server/voteoptions.h>
+
+static void AddOptions(CVoteOptions *pOptions, int Num)
+{
+	for(int i = 0; i < Num; i++)
+	{
+		char aDescription[VOTE_DESC_LENGTH];
+		char aCommand[VOTE_CMD_LENGTH];
+		str_format(aDescription, sizeof(aDescription), "Option %d", i);
+		str_format(aCommand, sizeof(aCommand), "say %d", i);
+		EXPECT_TRUE(pOptions->Add(aDescription, aCommand));
+	}
+}
+
+static void ExpectSamePayload(CVoteOptions *pOptions, int Index, int OptionsPerMsg)
+{
+	CMsgPacker Packed(NETMSGTYPE_SV_VOTEOPTIONLISTADD, false);
+	const int Num = pOptions->PackOptions(Index, OptionsPerMsg, &Packed);
+	ASSERT_EQ(Num, minimum(OptionsPerMsg, pOptions->Num() - Index));
+
+	CNetMsg_Sv_VoteOptionListAdd Msg;
+	const char **apDescriptions[] = {
+		&Msg.m_pDescription0, &Msg.m_pDescription1, &Msg.m_pDescription2,
+		&Msg.m_pDescription3, &Msg.m_pDescription4, &Msg.m_pDescription5,
+		&Msg.m_pDescription6, &Msg.m_pDescription7, &Msg.m_pDescription8,
+		&Msg.m_pDescription9, &Msg.m_pDescription10, &Msg.m_pDescription11,
+		&Msg.m_pDescription12, &Msg.m_pDescription13, &Msg.m_pDescription14};
+	for(int i = 0; i < (int)std::size(apDescriptions); i++)
+		*apDescriptions[i] = i < Num ? pOptions->Get(Index + i)->m_aDescription : "";
+	Msg.m_NumOptions = Num;
+	CMsgPacker Expected(NETMSGTYPE_SV_VOTEOPTIONLISTADD, false);
+	Msg.Pack(&Expected);
+
+	ASSERT_EQ(Packed.Size(), Expected.Size());
+	EXPECT_EQ(mem_comp(Packed.Data(), Expected.Data(), Expected.Size()), 0);
+}
+
+TEST(VoteOptions, AddFind)
+{
+	CVoteOptions Options;
+	EXPECT_TRUE(Options.Add("Map: Tutorial", "change_map Tutorial"));
+	EXPECT_TRUE(Options.Add("Restart", "restart"));
+	EXPECT_FALSE(Options.Add("restart", "restart 10"));
+	ASSERT_EQ(Options.Num(), 2);
+
+	EXPECT_STREQ(Options.Get(0)->m_aDescription, "Map: Tutorial");
+	EXPECT_STREQ(Options.Get(1)->m_aDescription, "Restart");
+
+	const CVoteOptionServer *pOption = Options.Find("map: TUTORIAL");
+	ASSERT_TRUE(pOption);
+	EXPECT_STREQ(pOption->m_aCommand, "change_map Tutorial");
+	EXPECT_STREQ(Options.Find("RESTART")->m_aCommand, "restart");
+	EXPECT_FALSE(Options.Find("Shutdown"));
+}
+
+TEST(VoteOptions, Remove)
+{
+	CVoteOptions Options;
+	AddOptions(&Options, 5);
+	EXPECT_FALSE(Options.Remove("Option 5"));
+	EXPECT_TRUE(Options.Remove("option 1"));
+	ASSERT_EQ(Options.Num(), 4);
+	EXPECT_FALSE(Options.Find("Option 1"));
+
+	const char *apExpected[] = {"Option 0", "Option 2", "Option 3", "Option 4"};
+	for(int i = 0; i < Options.Num(); i++)
+	{
+		EXPECT_STREQ(Options.Get(i)->m_aDescription, apExpected[i]);
+		EXPECT_EQ(Options.Find(apExpected[i]), Options.Get(i));
+	}
+	EXPECT_STREQ(Options.Find("Option 4")->m_aCommand, "say 4");
+
+	// the description can be used again
+	EXPECT_TRUE(Options.Add("Option 1", "say 1"));
+	EXPECT_STREQ(Options.Get(4)->m_aDescription, "Option 1");
+}
+
+TEST(VoteOptions, Clear)
+{
+	CVoteOptions Options;
+	AddOptions(&Options, 3);
+	Options.Clear();
+	EXPECT_EQ(Options.Num(), 0);
+	EXPECT_FALSE(Options.Find("Option 0"));
+	AddOptions(&Options, 2);
+	EXPECT_EQ(Options.Num(), 2);
+}
+
+TEST(VoteOptions, PackOptions)
+{
+	CVoteOptions Options;
+	AddOptions(&Options, 23);
+
+	// aligned to the prepacked messages, the last one is partial
+	for(int Index = 0; Index < Options.Num(); Index += 4)
+		ExpectSamePayload(&Options, Index, 4);
+	// not aligned
+	ExpectSamePayload(&Options, 3, 4);
+	ExpectSamePayload(&Options, 21, 4);
+	// another number of options per message
+	for(int Index = 0; Index < Options.Num(); Index += 15)
+		ExpectSamePayload(&Options, Index, 15);
+
+	CMsgPacker Packer(NETMSGTYPE_SV_VOTEOPTIONLISTADD, false);
+	EXPECT_EQ(Options.PackOptions(Options.Num(), 4, &Packer), 0);
+
+	// the packed messages are updated after changes
+	EXPECT_TRUE(Options.Remove("Option 0"));
+	ExpectSamePayload(&Options, 0, 4);
+	EXPECT_TRUE(Options.Add("Option 23", "say 23"));
+	ExpectSamePayload(&Options, 20, 4);
+}
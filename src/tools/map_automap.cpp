@@ -0,0 +1,178 @@
+#include <base/logger.h>
+#include <base/system.h>
+#include <engine/engine.h>
+#include <engine/shared/datafile.h>
+#include <engine/shared/map.h>
+#include <engine/storage.h>
+#include <game/editor/auto_map_rules.h>
+#include <game/mapitems.h>
+#include <game/mapitems_ex.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+/*
+	Runs the automapper configurations that the editor stored in a map on their
+	tile layers, so that maps can be automapped without opening the editor.
+	The rules are loaded from editor/automap/<image name>.rules like in the
+	editor.
+*/
+
+static const char *TOOL_NAME = "map_automap";
+
+static bool LoadRules(IStorage *pStorage, const char *pImageName, CAutoMapRules *pRules)
+{
+	char aPath[IO_MAX_PATH_LENGTH];
+	str_format(aPath, sizeof(aPath), "editor/automap/%s.rules", pImageName);
+	IOHANDLE RulesFile = pStorage->OpenFile(aPath, IOFLAG_READ | IOFLAG_SKIP_BOM, IStorage::TYPE_ALL);
+	if(!RulesFile)
+	{
+		dbg_msg(TOOL_NAME, "failed to load %s", aPath);
+		return false;
+	}
+	pRules->Load(RulesFile);
+	io_close(RulesFile);
+	return true;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc < 3 || argc > 4)
+	{
+		dbg_msg(TOOL_NAME, "Usage: %s <map> <output map> [jobs]", argv[0]);
+		return -1;
+	}
+
+	IStorage *pStorage = CreateStorage(IStorage::STORAGETYPE_BASIC, argc, argv);
+	if(!pStorage)
+	{
+		dbg_msg(TOOL_NAME, "error loading storage");
+		return -1;
+	}
+
+	const int Jobs = argc == 4 ? str_toint(argv[3]) : 4;
+	std::unique_ptr<IEngine> pEngine(Jobs > 0 ? CreateTestEngine(TOOL_NAME, Jobs) : nullptr);
+
+	CDataFileReader Reader;
+	if(!Reader.Open(pStorage, argv[1], IStorage::TYPE_ABSOLUTE))
+	{
+		dbg_msg(TOOL_NAME, "failed to open map '%s'", argv[1]);
+		return -1;
+	}
+
+	int GroupsStart, GroupsNum, LayersStart, LayersNum, ImagesStart, ImagesNum, ConfigsStart, ConfigsNum;
+	Reader.GetType(MAPITEMTYPE_GROUP, &GroupsStart, &GroupsNum);
+	Reader.GetType(MAPITEMTYPE_LAYER, &LayersStart, &LayersNum);
+	Reader.GetType(MAPITEMTYPE_IMAGE, &ImagesStart, &ImagesNum);
+	Reader.GetType(MAPITEMTYPE_AUTOMAPPER_CONFIG, &ConfigsStart, &ConfigsNum);
+
+	std::map<int, CAutoMapRules> RulesByImage;
+	// tiles of the automapped layers, by their data index
+	std::map<int, std::vector<CTile>> NewTiles;
+	// item index of the automapped layers
+	std::vector<int> vAutomappedLayers;
+
+	for(int i = 0; i < ConfigsNum; i++)
+	{
+		const CMapItemAutoMapperConfig *pConfig = (CMapItemAutoMapperConfig *)Reader.GetItem(ConfigsStart + i);
+		if(pConfig->m_Version != CMapItemAutoMapperConfig::CURRENT_VERSION || pConfig->m_AutomapperConfig < 0)
+			continue;
+		if(pConfig->m_GroupId < 0 || pConfig->m_GroupId >= GroupsNum)
+			continue;
+
+		const CMapItemGroup *pGroup = (CMapItemGroup *)Reader.GetItem(GroupsStart + pConfig->m_GroupId);
+		if(pConfig->m_LayerId < 0 || pConfig->m_LayerId >= pGroup->m_NumLayers || pGroup->m_StartLayer + pConfig->m_LayerId >= LayersNum)
+			continue;
+
+		const int LayerIndex = LayersStart + pGroup->m_StartLayer + pConfig->m_LayerId;
+		const CMapItemLayer *pLayer = (CMapItemLayer *)Reader.GetItem(LayerIndex);
+		if(pLayer->m_Type != LAYERTYPE_TILES)
+			continue;
+		const CMapItemLayerTilemap *pTilemap = (CMapItemLayerTilemap *)pLayer;
+		// only design layers have an automapper
+		if(pTilemap->m_Flags || pTilemap->m_Image < 0 || pTilemap->m_Image >= ImagesNum)
+			continue;
+
+		auto RulesIt = RulesByImage.find(pTilemap->m_Image);
+		if(RulesIt == RulesByImage.end())
+		{
+			const CMapItemImage *pImage = (CMapItemImage *)Reader.GetItem(ImagesStart + pTilemap->m_Image);
+			const char *pImageName = (char *)Reader.GetData(pImage->m_ImageName);
+			RulesIt = RulesByImage.emplace(pTilemap->m_Image, CAutoMapRules()).first;
+			if(pImageName)
+				LoadRules(pStorage, pImageName, &RulesIt->second);
+		}
+		CAutoMapRules &Rules = RulesIt->second;
+		if(pConfig->m_AutomapperConfig >= Rules.ConfigNamesNum())
+		{
+			dbg_msg(TOOL_NAME, "group %d layer %d: automapper config %d not found", pConfig->m_GroupId, pConfig->m_LayerId, pConfig->m_AutomapperConfig);
+			continue;
+		}
+
+		std::vector<CTile> vTiles((size_t)pTilemap->m_Width * pTilemap->m_Height);
+		const CTile *pSavedTiles = (CTile *)Reader.GetData(pTilemap->m_Data);
+		const size_t SavedSize = Reader.GetDataSize(pTilemap->m_Data);
+		if(!pSavedTiles)
+			continue;
+		if(pTilemap->m_Version >= CMapItemLayerTilemap::TILE_SKIP_MIN_VERSION)
+			CMap::ExtractTiles(vTiles.data(), vTiles.size(), pSavedTiles, SavedSize / sizeof(CTile));
+		else if(SavedSize >= vTiles.size() * sizeof(CTile))
+			mem_copy(vTiles.data(), pSavedTiles, vTiles.size() * sizeof(CTile));
+		else
+			continue;
+
+		Rules.Proceed(vTiles.data(), pTilemap->m_Width, pTilemap->m_Height, pConfig->m_AutomapperConfig, pConfig->m_AutomapperSeed, 0, 0, pEngine.get());
+		dbg_msg(TOOL_NAME, "group %d layer %d: automapped with '%s'", pConfig->m_GroupId, pConfig->m_LayerId, Rules.GetConfigName(pConfig->m_AutomapperConfig));
+
+		NewTiles[pTilemap->m_Data] = std::move(vTiles);
+		vAutomappedLayers.push_back(LayerIndex);
+	}
+
+	CDataFileWriter Writer;
+	if(!Writer.Open(pStorage, argv[2], IStorage::TYPE_ABSOLUTE))
+	{
+		dbg_msg(TOOL_NAME, "failed to open output map '%s'", argv[2]);
+		return -1;
+	}
+
+	for(int Index = 0; Index < Reader.NumItems(); Index++)
+	{
+		int Type, ID;
+		const void *pItem = Reader.GetItem(Index, &Type, &ID);
+
+		// filter ITEMTYPE_EX items, they will be automatically added again
+		if(Type == ITEMTYPE_EX)
+			continue;
+
+		int Size = Reader.GetItemSize(Index);
+		if(std::find(vAutomappedLayers.begin(), vAutomappedLayers.end(), Index) != vAutomappedLayers.end())
+		{
+			// the automapped tiles are saved without tile skipping
+			std::vector<char> vItem((const char *)pItem, (const char *)pItem + Size);
+			CMapItemLayerTilemap *pTilemap = (CMapItemLayerTilemap *)vItem.data();
+			pTilemap->m_Version = minimum<int>(pTilemap->m_Version, CMapItemLayerTilemap::CURRENT_VERSION);
+			Writer.AddItem(Type, ID, Size, vItem.data());
+		}
+		else
+			Writer.AddItem(Type, ID, Size, pItem);
+	}
+
+	for(int Index = 0; Index < Reader.NumData(); Index++)
+	{
+		auto TilesIt = NewTiles.find(Index);
+		if(TilesIt != NewTiles.end())
+			Writer.AddData(TilesIt->second.size() * sizeof(CTile), TilesIt->second.data());
+		else
+			Writer.AddData(Reader.GetDataSize(Index), Reader.GetData(Index));
+	}
+
+	Reader.Close();
+	Writer.Finish();
+	dbg_msg(TOOL_NAME, "automapped %d layers", (int)vAutomappedLayers.size());
+	return 0;
+}
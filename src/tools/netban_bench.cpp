@@ -0,0 +1,79 @@
+#include <base/logger.h>
+#include <base/system.h>
+#include <engine/console.h>
+#include <engine/shared/config.h>
+#include <engine/shared/netban.h>
+
+#include <chrono>
+#include <vector>
+
+/*
+	Measures CNetBan::IsBanned like during a flood with spoofed sources: a
+	ban list with many ranges is checked against random addresses, of which
+	most are not banned.
+*/
+
+static const char *TOOL_NAME = "netban_bench";
+
+static NETADDR RandomAddr(int Type)
+{
+	NETADDR Addr = {};
+	Addr.type = Type;
+	secure_random_fill(Addr.ip, Type == NETTYPE_IPV4 ? 4 : 16);
+	if(Addr.ip[0] == 0 || Addr.ip[0] == 127)
+		Addr.ip[0] = 1;
+	return Addr;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	secure_random_init();
+	net_init();
+
+	if(argc > 3)
+	{
+		log_set_global_logger_default();
+		dbg_msg(TOOL_NAME, "Usage: %s [ranges] [lookups]", argv[0]);
+		return -1;
+	}
+	const int NumRanges = argc > 1 ? str_toint(argv[1]) : 50000;
+	const int NumLookups = argc > 2 ? str_toint(argv[2]) : 1000000;
+
+	// the ban messages are not logged, the global logger is only set afterwards
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_SERVER);
+	CNetBan NetBan;
+	NetBan.Init(pConsole.get(), nullptr);
+
+	// mostly IPv4 ranges of /24 and /16, like the ones of hosting providers
+	for(int i = 0; i < NumRanges; i++)
+	{
+		const int Type = i % 8 == 0 ? NETTYPE_IPV6 : NETTYPE_IPV4;
+		const int Prefix = Type == NETTYPE_IPV4 ? 2 + i % 2 : 4 + i % 4;
+		CNetRange Range;
+		Range.m_LB = RandomAddr(Type);
+		Range.m_UB = Range.m_LB;
+		for(int Byte = Prefix; Byte < (Type == NETTYPE_IPV4 ? 4 : 16); Byte++)
+		{
+			Range.m_LB.ip[Byte] = 0;
+			Range.m_UB.ip[Byte] = 255;
+		}
+		NetBan.BanRange(&Range, 0, "bench");
+	}
+	log_set_global_logger_default();
+
+	std::vector<NETADDR> vAddrs(4096);
+	for(size_t i = 0; i < vAddrs.size(); i++)
+		vAddrs[i] = RandomAddr(i % 8 == 0 ? NETTYPE_IPV6 : NETTYPE_IPV4);
+
+	int NumBanned = 0;
+	char aReason[256];
+	const auto Start = time_get_nanoseconds();
+	for(int i = 0; i < NumLookups; i++)
+		NumBanned += NetBan.IsBanned(&vAddrs[i % vAddrs.size()], aReason, sizeof(aReason));
+	const std::chrono::nanoseconds Duration = time_get_nanoseconds() - Start;
+
+	dbg_msg(TOOL_NAME, "%d ranges, %d lookups, %d banned", NumRanges, NumLookups, NumBanned);
+	dbg_msg(TOOL_NAME, "%.1f ns per lookup, %.2f million lookups per second", (double)Duration.count() / NumLookups, NumLookups / (Duration.count() / 1e3));
+	return 0;
+}
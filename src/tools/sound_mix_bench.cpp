@@ -0,0 +1,78 @@
+#include <base/logger.h>
+#include <base/system.h>
+#include <engine/client/sound_mix.h>
+
+#include <chrono>
+#include <vector>
+
+/*
+	Measures the sound mixer without an audio device: a number of voices
+	with random samples is mixed into blocks of the usual callback size, with
+	both the scalar and the vectorized implementation.
+*/
+
+static const char *TOOL_NAME = "sound_mix_bench";
+
+enum
+{
+	BLOCK_FRAMES = 1024,
+	SAMPLE_FRAMES = 48000,
+};
+
+typedef void (*FMixVoice)(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR);
+typedef void (*FMixFinish)(short *pFinalOut, const int *pMix, unsigned Frames, int MasterVol);
+
+static std::chrono::nanoseconds Run(FMixVoice pfnMixVoice, FMixFinish pfnMixFinish, const std::vector<std::vector<short>> &vvSamples, int Blocks)
+{
+	std::vector<int> vMix(BLOCK_FRAMES * 2);
+	std::vector<short> vOut(BLOCK_FRAMES * 2);
+	const auto Start = time_get_nanoseconds();
+	for(int Block = 0; Block < Blocks; Block++)
+	{
+		mem_zero(vMix.data(), vMix.size() * sizeof(int));
+		const unsigned Tick = (Block * BLOCK_FRAMES) % (SAMPLE_FRAMES - BLOCK_FRAMES);
+		for(size_t Voice = 0; Voice < vvSamples.size(); Voice++)
+		{
+			const int Channels = Voice % 2 + 1;
+			pfnMixVoice(vMix.data(), vvSamples[Voice].data() + Tick * Channels, Channels, BLOCK_FRAMES, 200, 100 + Voice % 100);
+		}
+		pfnMixFinish(vOut.data(), vMix.data(), BLOCK_FRAMES, 100);
+	}
+	return time_get_nanoseconds() - Start;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+	secure_random_init();
+
+	if(argc > 3)
+	{
+		dbg_msg(TOOL_NAME, "Usage: %s [voices] [blocks]", argv[0]);
+		return -1;
+	}
+	const int NumVoices = argc > 1 ? str_toint(argv[1]) : 64;
+	const int NumBlocks = argc > 2 ? str_toint(argv[2]) : 2000;
+	if(NumVoices <= 0 || NumBlocks <= 0)
+	{
+		dbg_msg(TOOL_NAME, "voices and blocks must be positive");
+		return -1;
+	}
+
+	// every other voice is mono
+	std::vector<std::vector<short>> vvSamples(NumVoices);
+	for(int Voice = 0; Voice < NumVoices; Voice++)
+	{
+		vvSamples[Voice].resize(SAMPLE_FRAMES * (Voice % 2 + 1));
+		secure_random_fill(vvSamples[Voice].data(), vvSamples[Voice].size() * sizeof(short));
+	}
+
+	const std::chrono::nanoseconds Scalar = Run(SoundMixVoiceScalar, SoundMixFinishScalar, vvSamples, NumBlocks);
+	const std::chrono::nanoseconds Vectorized = Run(SoundMixVoice, SoundMixFinish, vvSamples, NumBlocks);
+	const double BlockSeconds = BLOCK_FRAMES / 48000.0;
+	dbg_msg(TOOL_NAME, "%d voices, %d blocks of %d frames", NumVoices, NumBlocks, (int)BLOCK_FRAMES);
+	dbg_msg(TOOL_NAME, "scalar:     %8.2f us per block, %6.3f%% of real time", Scalar.count() / 1000.0 / NumBlocks, Scalar.count() / 1e7 / (NumBlocks * BlockSeconds));
+	dbg_msg(TOOL_NAME, "vectorized: %8.2f us per block, %6.3f%% of real time", Vectorized.count() / 1000.0 / NumBlocks, Vectorized.count() / 1e7 / (NumBlocks * BlockSeconds));
+	return 0;
+}